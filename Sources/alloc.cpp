@@ -1,98 +1,622 @@
 #include "../alloc.h"
+#include <new>
+#include <cstring>
+#if defined(_WIN32)
+#include <malloc.h>
+    #define __MALLOC_USABLE_SIZE(ptr) _msize(ptr)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+    #define __MALLOC_USABLE_SIZE(ptr) malloc_size(ptr)
+#elif defined(__GLIBC__) || defined(__linux__) || defined(__FreeBSD__)
+#include <malloc.h>
+    #define __MALLOC_USABLE_SIZE(ptr) malloc_usable_size(ptr)
+#else
+    #define __MALLOC_USABLE_SIZE(ptr) ((size_t)0) // 不知道实际大小, 大区块一律不能原地扩展
+#endif
+#ifndef TINYSTL_NO_THREADS
+#include <mutex>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+    #define __TINYSTL_HAS_MMAP
+    #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+        #define MAP_ANONYMOUS MAP_ANON
+    #endif
+#endif
 
 namespace TinySTL{
     // 下面的四条语句为给alloc.h里的静态变量赋初值
     char *Alloc::start_free = 0;
     char *Alloc::end_free = 0;
     size_t Alloc::heap_size = 0;
-    Alloc::obj *Alloc::free_list[__NFREELISTS] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    Alloc::chunk_header *Alloc::chunk_list = 0;
+    size_t Alloc::depot_free_bytes = 0;
+    size_t Alloc::trim_threshold = 0;
+    size_t Alloc::next_auto_trim = 0;
+    size_t Alloc::batch_objs[__NFREELISTS] = {0};
+    bool Alloc::adaptive_refill = true;
+#if defined(TINYSTL_ALLOC_MMAP) && defined(__TINYSTL_HAS_MMAP)
+    bool Alloc::mmap_chunks = true;
+#else
+    bool Alloc::mmap_chunks = false;
+#endif
+    Alloc::obj *Alloc::free_list[__NFREELISTS] = {0};
+    const unsigned short Alloc::class_size[__NFREELISTS] = {
+        8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120, 128,
+        160, 192, 224, 256,
+        320, 384, 448, 512,
+        640, 768, 896, 1024,
+        1280, 1536, 1792, 2048,
+        2560, 3072, 3584, 4096
+    };
+    const unsigned char Alloc::log2_table[32] = {
+        0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+    };
+
+    __TINYSTL_THREAD_LOCAL Alloc::thread_cache Alloc::tls_cache;
+
+#ifdef TINYSTL_ALLOC_STATS
+    Alloc::thread_cache *Alloc::registered_caches = 0;
+    size_t Alloc::retired_alloc_count[__NFREELISTS] = {0};
+    size_t Alloc::retired_free_count[__NFREELISTS] = {0};
+    size_t Alloc::retired_large_alloc_count = 0;
+    size_t Alloc::retired_large_free_count = 0;
+    size_t Alloc::depot_count[__NFREELISTS] = {0};
+    size_t Alloc::depot_out[__NFREELISTS] = {0};
+    size_t Alloc::peak_out[__NFREELISTS] = {0};
+    size_t Alloc::refill_count[__NFREELISTS] = {0};
+    size_t Alloc::chunk_alloc_count = 0;
+    size_t Alloc::system_alloc_count = 0;
+    size_t Alloc::peak_heap_size = 0;
+    size_t Alloc::trimmed_bytes = 0;
+    std::atomic<size_t> Alloc::large_live_bytes(0);
+    std::atomic<size_t> Alloc::peak_large_bytes(0);
+#endif
+
+    // 中心仓库(free_list, start_free, end_free, heap_size)的锁
+    // 单线程模式下换成什么都不做的空锁, thread_local也退化成普通的静态变量
+#ifndef TINYSTL_NO_THREADS
+    static std::mutex depot_mutex;
+    typedef std::lock_guard<std::mutex> depot_lock;
+#else
+    struct depot_lock{
+        depot_lock(int) {}
+    };
+    static int depot_mutex = 0;
+#endif
+
+    // 线程退出时, 把线程缓存中剩余的区块整条链表接回中心仓库
+    // 比它后构造的thread_local对象先析构, 但比它先构造的对象在它之后才析构, 那时释放的区块不能再放进这份缓存
+    Alloc::thread_cache::~thread_cache(){
+        depot_lock lock(depot_mutex);
+        destroyed = true;
+#ifdef TINYSTL_ALLOC_STATS
+        // 把本线程的计数并入已退出线程的计数, 并从注册链表上摘掉
+        if(registered){
+            for (int i = 0; i < __NFREELISTS; ++i){
+                retired_alloc_count[i] += alloc_count[i].load(std::memory_order_relaxed);
+                retired_free_count[i] += free_count[i].load(std::memory_order_relaxed);
+            }
+            retired_large_alloc_count += large_alloc_count.load(std::memory_order_relaxed);
+            retired_large_free_count += large_free_count.load(std::memory_order_relaxed);
+            thread_cache **link = &registered_caches;
+            while(*link != this)
+                link = &(*link)->next_registered;
+            *link = next_registered;
+            registered = false;
+        }
+#endif
+        for (int i = 0; i < __NFREELISTS; ++i){
+            obj *first = list[i];
+            if(0 == first)
+                continue;
+            obj *last = first;
+            while(last->next != 0)
+                last = last->next;
+            last->next = free_list[i];
+            free_list[i] = first;
+            depot_free_bytes += count[i] * CLASS_SIZE(i);
+            __ALLOC_STAT(depot_count[i] += count[i]);
+            __ALLOC_STAT(depot_out[i] -= count[i]);
+            list[i] = 0;
+            count[i] = 0;
+        }
+    }
 
     // 此函数用于申请内存
     void *Alloc::allocate(size_t bytes){
-        // 超过128字节,则交给malloc分配
+        // 超过4096字节,则交给malloc分配
         if(bytes > __MAX_BYTES){
+            __ALLOC_STAT(stat_large(bytes, true));
             return malloc(bytes);
         }
-        obj **my_free_list; // my_free_list指的是free_list下面挂着的那16个链表其中一个
-        obj *result; // 用来暂存上面说的链表
-
-        my_free_list = free_list + FREELIST_INDEX(bytes);
-        result = *my_free_list;
-        // 如果没有找到可用的free_list, 则去内存池挖一块填充
+        // 只在本线程的缓存上操作, 不需要加锁
+        thread_cache &cache = local_cache();
+        size_t index = FREELIST_INDEX(bytes);
+        if(cache.destroyed)
+            return depot_allocate(index);
+        __ALLOC_STAT(stat_add(cache.alloc_count[index], 1));
+        obj *result = cache.list[index];
+        // 如果线程缓存中没有可用的区块, 则去中心仓库成批取一些回来
         if(0 == result){
-            return refill(bytes);
+            return refill(index);
         }
-        // 如果找到可用的, 则将my_free_list往下挪一位,然后把可用的空间返回给客户端
-        *my_free_list = result->next;
+        // 如果找到可用的, 则将链表往下挪一位,然后把可用的空间返回给客户端
+        cache.list[index] = result->next;
+        --cache.count[index];
         return (result);
     }
 
     //  此函数用于释放内存
     void Alloc::deallocate(void *ptr, size_t bytes){
-        // 超过128字节,则交给free释放
+        // 超过4096字节,则交给free释放
         if(bytes > __MAX_BYTES){
+            __ALLOC_STAT(stat_large(bytes, false));
             return free(ptr);
         }
-        obj **my_free_list;
+        thread_cache &cache = local_cache();
+        size_t index = FREELIST_INDEX(bytes);
+        if(cache.destroyed)
+            return depot_deallocate(ptr, index);
+        __ALLOC_STAT(stat_add(cache.free_count[index], 1));
         obj *q = (obj *)ptr;
-        // 找到对应的my_free_list
-        my_free_list = free_list + FREELIST_INDEX(bytes);
-        // 调整指针进行回收, 这一步可以看作是在链表my_free_list头部插入一个节点ptr
-        q->next = *my_free_list;
-        *my_free_list = q;
+        // 调整指针进行回收, 这一步可以看作是在本线程的链表头部插入一个节点ptr
+        q->next = cache.list[index];
+        cache.list[index] = q;
+        // 线程缓存超过上限, 把一批区块还给中心仓库, 避免某个线程囤积太多内存
+        if(++cache.count[index] > cache.limit[index]){
+            cache_overflow(cache, index);
+        }
     }
 
-    // 此函数用于追加内存
+    // 此函数用于追加内存, 原有的内容(新旧大小中较小的那部分)会被保留
     void *Alloc::reallocate(void* ptr, size_t old_sz, size_t new_sz){
-        // 释放掉原有的旧内存
+        if(ptr == 0)
+            return allocate(new_sz);
+        // 新旧都是大区块, 交给realloc, 它可能原地扩展, 或者用mremap搬移, 不会出现新旧两份同时存在的峰值
+        if(old_sz > __MAX_BYTES && new_sz > __MAX_BYTES){
+            void *result = realloc(ptr, new_sz);
+            if(result == 0)
+                throw std::bad_alloc();
+            __ALLOC_STAT(stat_large(old_sz, false));
+            __ALLOC_STAT(stat_large(new_sz, true));
+            return result;
+        }
+        // 新旧落在同一档, 区块本身就够大, 什么都不用做
+        if(old_sz <= __MAX_BYTES && new_sz <= __MAX_BYTES && FREELIST_INDEX(old_sz) == FREELIST_INDEX(new_sz))
+            return ptr;
+        // 跨档了, 重新申请一块, 把内容拷贝过去, 再释放掉原有的旧内存
+        void *result = allocate(new_sz);
+        memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
         deallocate(ptr, old_sz);
-        // 重新申请一块新的大小
-        ptr = allocate(new_sz);
-        return ptr;
-    }
-
-    // 这个函数主要用来切割由chunk_alloc得到的大区块，并且把第一个区块返回给客户端
-    void *Alloc::refill(size_t n){
-        int nobjs = 20; // 20个区块
-        // 尝试调用chunk_alloc函数问内存池要nobjs个大小为n的空间给free_list
-        char *chunk = chunk_alloc(n, nobjs); // nobjs是按引用传递
-        // 如果只得到了一个区块, 则直接返回给客户端, 否则的话把得到的大区块进行切割
-        if(nobjs == 1) { return (chunk); };
-
-        // 下面过程是把得到的大区块切割成nobjs个大小为n的小区块
-        obj *result = (obj*)chunk; //第一个小区块是要返回给客户端使用的, 暂存一下地址
-        obj **my_free_list;
-        obj *cur_obj, *next_obj;
-        // 求出在free_list内的标号
-        my_free_list = free_list + FREELIST_INDEX(n);
-        *my_free_list = next_obj = (obj *)(chunk + n); //由于第一块是要返回给客户端的,因此*my_free_list里存的是下一块的地址
-
-        for (int i = 1; ;++i){ // 从1开始切割,因为第0号区块是分配给客户端的
-            cur_obj = next_obj;
-            next_obj = (obj *)((char *)next_obj + n); // 每个切割的区块大小为n
-            if(i == nobjs - 1){ // 最后一个区块
-                cur_obj->next = 0;
-                break;
+        return result;
+    }
+
+    // 对齐要求alignment超过8字节时, 找一个自然对齐不小于alignment并且能放下bytes的档, 返回它的大小
+    // 找不到(对齐要求太大或者bytes太大)则返回0, 表示要直接向系统申请对齐的内存
+    size_t Alloc::aligned_class_bytes(size_t bytes, size_t alignment){
+        if(alignment > __MAX_CLASS_ALIGN)
+            return 0;
+        bytes = bytes == 0 ? alignment : (bytes + alignment - 1) & ~(alignment - 1);
+        if(bytes > __MAX_BYTES)
+            return 0;
+        for (size_t index = FREELIST_INDEX(bytes); index < __NFREELISTS; ++index)
+            if(CLASS_ALIGN(index) >= alignment)
+                return CLASS_SIZE(index);
+        return 0;
+    }
+
+    void *Alloc::allocate_aligned(size_t bytes, size_t alignment){
+        size_t class_bytes = aligned_class_bytes(bytes, alignment);
+        if(class_bytes != 0)
+            return allocate(class_bytes);
+        __ALLOC_STAT(stat_large(bytes, true));
+        void *result;
+#if defined(_WIN32)
+        result = _aligned_malloc(bytes, alignment);
+#else
+        if(posix_memalign(&result, alignment, bytes) != 0)
+            result = 0;
+#endif
+        if(result == 0)
+            throw std::bad_alloc();
+        return result;
+    }
+
+    void Alloc::deallocate_aligned(void *ptr, size_t bytes, size_t alignment){
+        size_t class_bytes = aligned_class_bytes(bytes, alignment);
+        if(class_bytes != 0)
+            return deallocate(ptr, class_bytes);
+        __ALLOC_STAT(stat_large(bytes, false));
+#if defined(_WIN32)
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+
+    // 对齐的区块不能交给realloc(它不保证对齐), 落在同一档时原地不动, 否则重新申请再拷贝
+    void *Alloc::reallocate_aligned(void *ptr, size_t old_sz, size_t new_sz, size_t alignment){
+        if(ptr == 0)
+            return allocate_aligned(new_sz, alignment);
+        if(try_expand_aligned(ptr, old_sz, new_sz, alignment))
+            return ptr;
+        void *result = allocate_aligned(new_sz, alignment);
+        memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
+        deallocate_aligned(ptr, old_sz, alignment);
+        return result;
+    }
+
+    bool Alloc::try_expand_aligned(void *ptr, size_t old_sz, size_t new_sz, size_t alignment){
+        if(ptr == 0)
+            return false;
+        size_t old_class = aligned_class_bytes(old_sz, alignment);
+        size_t new_class = aligned_class_bytes(new_sz, alignment);
+        if(old_class != 0 || new_class != 0)
+            return old_class == new_class;
+#if defined(_WIN32)
+        return false; // _aligned_malloc得到的区块不能用_msize查询大小
+#else
+        return new_sz <= __MALLOC_USABLE_SIZE(ptr);
+#endif
+    }
+
+    // 判断大小为old_sz的区块ptr能否原地变成new_sz大小, 能的话之后要以new_sz释放它
+    bool Alloc::try_expand(void *ptr, size_t old_sz, size_t new_sz){
+        if(ptr == 0)
+            return false;
+        if(old_sz <= __MAX_BYTES)
+            return new_sz <= __MAX_BYTES && FREELIST_INDEX(old_sz) == FREELIST_INDEX(new_sz);
+        if(new_sz <= __MAX_BYTES)
+            return false;
+        // 大区块看malloc实际给出的大小, free不需要知道区块大小, 所以只要装得下就行
+        return new_sz <= __MALLOC_USABLE_SIZE(ptr);
+    }
+
+    // 线程缓存为空时调用, 从中心仓库成批取回第index号链表的区块, 并且把第一个区块返回给客户端
+    void *Alloc::refill(size_t index){
+        size_t n = CLASS_SIZE(index);
+        int nobjs;
+        size_t limit;
+        obj *result;
+        {
+            depot_lock lock(depot_mutex);
+            __ALLOC_STAT(++refill_count[index]);
+            // 初始时小区块一次搬运20个, 大区块一次搬运不超过16KB
+            nobjs = (int)current_batch(index);
+            result = free_list[index];
+            if(result != 0){
+                // 中心仓库的链表上有空闲区块, 从头部摘下最多nobjs个
+                obj *last = result;
+                int i = 1;
+                for (; i < nobjs && last->next != 0; ++i)
+                    last = last->next;
+                nobjs = i;
+                free_list[index] = last->next;
+                last->next = 0;
+                depot_free_bytes -= nobjs * n;
+                __ALLOC_STAT(depot_count[index] -= nobjs);
             }
             else{
-                cur_obj->next = next_obj; // 把切割的区块串起来
+                // 尝试调用chunk_alloc函数问内存池要nobjs个大小为n的空间
+                __ALLOC_STAT(++chunk_alloc_count);
+                char *chunk = chunk_alloc(n, nobjs); // nobjs是按引用传递
+                // 下面过程是把得到的大区块切割成nobjs个大小为n的小区块, 并串成一条链表
+                result = (obj *)chunk;
+                obj *cur_obj = result;
+                for (int i = 1; i < nobjs; ++i){
+                    obj *next_obj = (obj *)((char *)cur_obj + n); // 每个切割的区块大小为n
+                    cur_obj->next = next_obj; // 把切割的区块串起来
+                    cur_obj = next_obj;
+                }
+                cur_obj->next = 0; // 最后一个区块
+                // 中心仓库里已经没有这一档的区块了, 说明这一档很热, 下次多搬一些
+                if(adaptive_refill && (batch_objs[index] * 2) * n <= __MAX_BATCH_BYTES)
+                    batch_objs[index] *= 2;
             }
+            limit = 2 * batch_objs[index];
+#ifdef TINYSTL_ALLOC_STATS
+            depot_out[index] += nobjs;
+            if(depot_out[index] > peak_out[index])
+                peak_out[index] = depot_out[index];
+#endif
         }
+        // 第一个区块是要返回给客户端使用的, 其余的放进本线程的缓存(此时缓存的这条链表一定为空)
+        thread_cache &cache = local_cache();
+        __ALLOC_STAT(if(!cache.registered) register_cache(cache));
+        cache.list[index] = result->next;
+        cache.count[index] = nobjs - 1;
+        cache.limit[index] = limit;
         return (result);
     }
 
+    // 线程缓存的第index号链表超过上限时调用
+    void Alloc::cache_overflow(thread_cache &cache, size_t index){
+        if(cache.limit[index] == 0){
+            // 这个线程还没有从中心仓库取过这一档的区块(比如只负责释放别的线程申请的区块), 先定下上限
+            depot_lock lock(depot_mutex);
+            cache.limit[index] = 2 * current_batch(index);
+            if(cache.count[index] <= cache.limit[index])
+                return;
+        }
+        release_to_depot(cache, index, cache.limit[index] / 2, true);
+    }
+
+    // 线程缓存已经析构, 不能再往里面放区块, 每次只从中心仓库取一个; 计数记在已退出线程的名下
+    void *Alloc::depot_allocate(size_t index){
+        depot_lock lock(depot_mutex);
+        __ALLOC_STAT(++retired_alloc_count[index]);
+#ifdef TINYSTL_ALLOC_STATS
+        if(++depot_out[index] > peak_out[index])
+            peak_out[index] = depot_out[index];
+#endif
+        obj *result = free_list[index];
+        if(result != 0){
+            free_list[index] = result->next;
+            depot_free_bytes -= CLASS_SIZE(index);
+            __ALLOC_STAT(--depot_count[index]);
+            return result;
+        }
+        int nobjs = 1;
+        __ALLOC_STAT(++chunk_alloc_count);
+        return chunk_alloc(CLASS_SIZE(index), nobjs);
+    }
+
+    void Alloc::depot_deallocate(void *ptr, size_t index){
+        depot_lock lock(depot_mutex);
+        __ALLOC_STAT(++retired_free_count[index]);
+        obj *q = (obj *)ptr;
+        q->next = free_list[index];
+        free_list[index] = q;
+        depot_free_bytes += CLASS_SIZE(index);
+        __ALLOC_STAT(++depot_count[index]);
+        __ALLOC_STAT(--depot_out[index]);
+    }
+
+    // 把线程缓存第index号链表头部的nobjs个区块归还给中心仓库
+    void Alloc::release_to_depot(thread_cache &cache, size_t index, size_t nobjs, bool overflow){
+        __ALLOC_STAT(if(!cache.registered) register_cache(cache));
+        obj *first = cache.list[index];
+        obj *last = first;
+        for (size_t i = 1; i < nobjs; ++i)
+            last = last->next;
+        cache.list[index] = last->next;
+        cache.count[index] -= nobjs;
+
+        depot_lock lock(depot_mutex);
+        last->next = free_list[index];
+        free_list[index] = first;
+        depot_free_bytes += nobjs * CLASS_SIZE(index);
+        __ALLOC_STAT(depot_count[index] += nobjs);
+        __ALLOC_STAT(depot_out[index] -= nobjs);
+        // 线程用不完取走的区块, 下次少搬一些; trim只是归还内存, 不说明取多了
+        if(overflow && adaptive_refill && current_batch(index) / 2 >= BATCH_OBJS(index) / 4 && batch_objs[index] > 2){
+            batch_objs[index] /= 2;
+            cache.limit[index] = 2 * batch_objs[index];
+        }
+        // 中心仓库的空闲字节数超过了阈值, 自动trim一次
+        // 下一次自动trim的时机推迟到空闲字节数再增长threshold之后, 避免每次归还都去扫描链表
+        if(trim_threshold != 0 && depot_free_bytes + (end_free - start_free) > next_auto_trim){
+            trim_depot();
+            next_auto_trim = depot_free_bytes + (end_free - start_free) + trim_threshold;
+        }
+    }
+
+    // trim时用来给chunk按地址排序
+    static int chunk_address_compare(const void *a, const void *b){
+        const char *x = *(const char *const *)a;
+        const char *y = *(const char *const *)b;
+        return x < y ? -1 : (x > y ? 1 : 0);
+    }
+
+    // 找到地址p所属的chunk, chunks已按地址从小到大排好序
+    Alloc::chunk_header *Alloc::find_chunk(chunk_header **chunks, size_t n, const char *p){
+        // 二分查找最后一个起始地址不大于p的chunk
+        size_t lo = 0, hi = n;
+        while(hi - lo > 1){
+            size_t mid = (lo + hi) / 2;
+            if((const char *)chunks[mid] <= p)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return chunks[lo];
+    }
+
+    // 把当前线程缓存中的区块全部还给中心仓库, 然后归还完全空闲的chunk
+    size_t Alloc::trim(){
+        thread_cache &cache = local_cache();
+        for (size_t i = 0; i < __NFREELISTS; ++i){
+            if(cache.count[i] != 0)
+                release_to_depot(cache, i, cache.count[i], false);
+        }
+        depot_lock lock(depot_mutex);
+        return trim_depot();
+    }
+
+    void Alloc::set_adaptive_refill(bool on){
+        depot_lock lock(depot_mutex);
+        adaptive_refill = on;
+        for (size_t i = 0; i < __NFREELISTS; ++i)
+            batch_objs[i] = 0;
+    }
+
+    bool Alloc::set_mmap_chunks(bool on){
+#ifdef __TINYSTL_HAS_MMAP
+        depot_lock lock(depot_mutex);
+        mmap_chunks = on;
+        return true;
+#else
+        return !on;
+#endif
+    }
+
+    void Alloc::set_trim_threshold(size_t bytes){
+        depot_lock lock(depot_mutex);
+        trim_threshold = bytes;
+        next_auto_trim = depot_free_bytes + (end_free - start_free) + bytes;
+    }
+
+    // 统计每个chunk中有多少字节在中心仓库的链表上或者还在内存池中
+    // 如果整个chunk都是空闲的, 就把它的区块从链表上摘掉, 然后把chunk还给系统
+    // 调用前必须已持有中心仓库的锁
+    size_t Alloc::trim_depot(){
+        size_t n = 0;
+        for (chunk_header *c = chunk_list; c != 0; c = c->next)
+            ++n;
+        if(n == 0)
+            return 0;
+        chunk_header **chunks = (chunk_header **)malloc(n * sizeof(chunk_header *));
+        if(chunks == 0)
+            return 0;
+        n = 0;
+        for (chunk_header *c = chunk_list; c != 0; c = c->next){
+            c->free_bytes = 0;
+            chunks[n++] = c;
+        }
+        qsort(chunks, n, sizeof(chunk_header *), chunk_address_compare);
+
+        // 累加每个chunk的空闲字节数
+        for (size_t i = 0; i < __NFREELISTS; ++i){
+            for (obj *p = free_list[i]; p != 0; p = p->next)
+                find_chunk(chunks, n, (char *)p)->free_bytes += CLASS_SIZE(i);
+        }
+        if(end_free != start_free)
+            find_chunk(chunks, n, start_free)->free_bytes += end_free - start_free;
+
+        // 找出完全空闲的chunk, 把它们的free_bytes标记为0, 其余的标记为1
+        size_t releasable = 0;
+        for (size_t i = 0; i < n; ++i){
+            if(chunks[i]->free_bytes == chunks[i]->size - CHUNK_HEADER_SIZE){
+                chunks[i]->free_bytes = 0;
+                ++releasable;
+            }
+            else{
+                chunks[i]->free_bytes = 1;
+            }
+        }
+        size_t released = 0;
+        if(releasable != 0){
+            // 把属于空闲chunk的区块从链表上摘掉
+            for (size_t i = 0; i < __NFREELISTS; ++i){
+                obj **link = free_list + i;
+                while(*link != 0){
+                    if(find_chunk(chunks, n, (char *)*link)->free_bytes == 0){
+                        *link = (*link)->next;
+                        depot_free_bytes -= CLASS_SIZE(i);
+                        __ALLOC_STAT(--depot_count[i]);
+                    }
+                    else{
+                        link = &(*link)->next;
+                    }
+                }
+            }
+            if(end_free != start_free && find_chunk(chunks, n, start_free)->free_bytes == 0)
+                start_free = end_free = 0;
+            // 从chunk_list上摘掉空闲chunk, 并还给系统
+            chunk_header **link = &chunk_list;
+            while(*link != 0){
+                chunk_header *c = *link;
+                if(c->free_bytes == 0){
+                    *link = c->next;
+                    heap_size -= c->size;
+                    released += c->size;
+                    system_free_chunk(c);
+                }
+                else{
+                    link = &c->next;
+                }
+            }
+        }
+        free(chunks);
+        __ALLOC_STAT(trimmed_bytes += released);
+        return released;
+    }
+
+    // 向系统申请chunk. mmap模式下chunk的大小取整到2MB的倍数, 起始地址也按2MB对齐,
+    // 这样透明大页才能覆盖整个chunk; mmap失败(例如地址空间受限)时退回到malloc
+    Alloc::chunk_header *Alloc::system_alloc_chunk(size_t &bytes){
+        chunk_header *chunk = 0;
+#ifdef __TINYSTL_HAS_MMAP
+        if(mmap_chunks){
+            size_t size = (CHUNK_HEADER_SIZE + bytes + __MMAP_CHUNK_BYTES - 1) & ~((size_t)__MMAP_CHUNK_BYTES - 1);
+            // 多映射2MB, 再把首尾不对齐的部分解除映射
+            char *p = (char *)mmap(0, size + __MMAP_CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(p != (char *)MAP_FAILED){
+                char *aligned = ALIGN_UP(p, __MMAP_CHUNK_BYTES);
+                if(aligned != p)
+                    munmap(p, aligned - p);
+                if(aligned + size != p + size + __MMAP_CHUNK_BYTES)
+                    munmap(aligned + size, p + __MMAP_CHUNK_BYTES - aligned);
+#ifdef MADV_HUGEPAGE
+                madvise(aligned, size, MADV_HUGEPAGE); // 只是建议, 系统没有开启透明大页时忽略失败
+#endif
+                chunk = (chunk_header *)aligned;
+                chunk->mapped = true;
+                chunk->size = size;
+                bytes = size - CHUNK_HEADER_SIZE;
+                return chunk;
+            }
+        }
+#endif
+        chunk = (chunk_header *)malloc(CHUNK_HEADER_SIZE + bytes);
+        if(chunk != 0){
+            chunk->mapped = false;
+            chunk->size = CHUNK_HEADER_SIZE + bytes;
+        }
+        return chunk;
+    }
+
+    void Alloc::system_free_chunk(chunk_header *chunk){
+#ifdef __TINYSTL_HAS_MMAP
+        if(chunk->mapped){
+            munmap(chunk, chunk->size);
+            return;
+        }
+#endif
+        free(chunk);
+    }
+
+    // 把内存池中的一段零头[p, p + bytes)切成若干区块挂到中心仓库的链表上, 调用前必须已持有中心仓库的锁
+    // 零头不一定正好是某一档的大小, 每次切下不超过剩余量并且地址满足对齐要求的最大一档, 直到切完为止
+    // 零头和各档大小都是8的倍数, 而8字节那一档只要求8字节对齐, 因此一定能切完
+    // 内存池起始处不对齐时零头可能超过__MAX_BYTES, 每次最多切下最大的一档
+    void Alloc::give_to_free_lists(char *p, size_t bytes){
+        while(bytes > 0){
+            size_t index = FREELIST_INDEX(bytes > __MAX_BYTES ? (size_t)__MAX_BYTES : bytes);
+            if(CLASS_SIZE(index) > bytes)
+                --index;
+            while(((size_t)p & (CLASS_ALIGN(index) - 1)) != 0)
+                --index;
+            // 可看作是头插节点到链表
+            ((obj *)p)->next = free_list[index];
+            free_list[index] = (obj *)p;
+            __ALLOC_STAT(++depot_count[index]);
+            depot_free_bytes += CLASS_SIZE(index);
+            p += CLASS_SIZE(index);
+            bytes -= CLASS_SIZE(index);
+        }
+    }
+
     // 这个函数主要用来从内存池中取空间给free_list
-    // 假设size已经调整到8的倍数
+    // 假设size是某一档的区块大小, 并且调用者已经持有中心仓库的锁
     char *Alloc::chunk_alloc(size_t size, int &nobjs){
         char *result = 0;
         size_t total_bytes = size * nobjs; // 总共需要分配的字节数
+        // 区块要按这一档的自然对齐来切割, 内存池起始处不对齐的零头先切给别的档
+        char *aligned = ALIGN_UP(start_free, CLASS_ALIGN(FREELIST_INDEX(size)));
+        if(aligned != start_free && aligned + size <= end_free){
+            give_to_free_lists(start_free, aligned - start_free);
+            start_free = aligned;
+        }
         size_t bytes_left = end_free - start_free; // bytes_left表示内存池中还剩下的字节数
-        if(bytes_left >= total_bytes){ // 如果内存池中剩余的空间满足需求量
+        if(aligned == start_free && bytes_left >= total_bytes){ // 如果内存池中剩余的空间满足需求量
             result = start_free;
             start_free += total_bytes;
             return result;
         }
-        else if(bytes_left >= size){ // 内存池中剩余的空间不够总的需求量,但是至少能够满足供应一个区块
+        else if(aligned == start_free && bytes_left >= size){ // 内存池中剩余的空间不够总的需求量,但是至少能够满足供应一个区块
             nobjs = bytes_left / size; // 重新计算能够分配多少个区块
             total_bytes = size * nobjs;
             result = start_free;
@@ -104,35 +628,176 @@ namespace TinySTL{
             // 每次加上一个调整到8的倍数的追加量,STL的设计着没有讲为什么追加量是heap_size >> 4,可能是团队的经验值
             size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size >> 4);
             // 以下试着让内存池中的残余量还有利用价值
-            if(bytes_left > 0){
-                obj **my_free_list = free_list + FREELIST_INDEX(bytes_left); // 找到剩余量属于哪一号链表
-                // 可看作是头插节点到链表
-                ((obj *)start_free)->next = *my_free_list;
-                *my_free_list = (obj *)start_free;
-            }
-            start_free = (char *)malloc(bytes_to_get);
-            if(start_free == 0){ // 假设堆空间内存已经不足以分配这么多了
+            give_to_free_lists(start_free, bytes_left);
+            start_free = end_free = 0;
+            // 每个chunk的头部记录它的大小, 并且挂到chunk_list上, 以便trim时能够找到并归还给系统
+            chunk_header *chunk = system_alloc_chunk(bytes_to_get);
+            if(chunk == 0){ // 假设堆空间内存已经不足以分配这么多了
                 // 试着从链表中找还没用的空闲内存
                 obj **my_free_list;
                 obj *p;
-                for (int i = size; i <= __MAX_BYTES; i+=__ALIGN){
-                    my_free_list = free_list + FREELIST_INDEX(i);
+                size_t align = CLASS_ALIGN(FREELIST_INDEX(size));
+                for (size_t i = FREELIST_INDEX(size); i < __NFREELISTS; ++i){
+                    my_free_list = free_list + i;
                     p = *my_free_list;
-                    if(p != 0){ // 如果这一号链表有空闲位置
+                    // 如果这一号链表有空闲位置, 并且对齐之后还能切出一个区块
+                    if(p != 0 && ALIGN_UP((char *)p, align) + size <= (char *)p + CLASS_SIZE(i)){
                         // 调整free_list以释放未用的区块
                         *my_free_list = p->next;
+                        depot_free_bytes -= CLASS_SIZE(i);
+                        __ALLOC_STAT(--depot_count[i]);
                         start_free = (char *)p;
-                        end_free = start_free + i;
+                        end_free = start_free + CLASS_SIZE(i);
                         // 递归调用自己,再申请一遍空间,以调整nobjs
                         return chunk_alloc(size, nobjs);
                     }
                 }
-                end_free = 0; // 假如经过上面的循环还是没找到空间,则没内存可用了
+                throw std::bad_alloc(); // 假如经过上面的循环还是没找到空间,则没内存可用了
             }
-            heap_size += bytes_to_get;
+            chunk->next = chunk_list;
+            chunk_list = chunk;
+            heap_size += chunk->size;
+#ifdef TINYSTL_ALLOC_STATS
+            ++system_alloc_count;
+            if(heap_size > peak_heap_size)
+                peak_heap_size = heap_size;
+#endif
+            start_free = (char *)chunk + CHUNK_HEADER_SIZE;
             end_free = start_free + bytes_to_get;
             // 递归调用自己,再申请一遍空间,以调整nobjs
             return chunk_alloc(size, nobjs);
         }
     }
-}
\ No newline at end of file
+
+    // ***************** 统计信息 ***********************
+#ifdef TINYSTL_ALLOC_STATS
+    // 把线程缓存挂到注册链表上, 取快照时才能读到它的计数器
+    void Alloc::register_cache(thread_cache &cache){
+        depot_lock lock(depot_mutex);
+        cache.next_registered = registered_caches;
+        registered_caches = &cache;
+        cache.registered = true;
+    }
+
+    // 大区块直接交给malloc, 相比之下原子操作的开销可以忽略
+    void Alloc::stat_large(size_t bytes, bool alloc){
+        thread_cache &cache = local_cache();
+        if(cache.destroyed){
+            // 已经从注册链表上摘掉的缓存不能再注册回去, 计数直接记在已退出线程的名下
+            depot_lock lock(depot_mutex);
+            ++(alloc ? retired_large_alloc_count : retired_large_free_count);
+        }
+        else{
+            if(!cache.registered)
+                register_cache(cache);
+            stat_add(alloc ? cache.large_alloc_count : cache.large_free_count, 1);
+        }
+        if(alloc){
+            size_t live = large_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            size_t peak = peak_large_bytes.load(std::memory_order_relaxed);
+            while(live > peak && !peak_large_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+                ;
+        }
+        else{
+            large_live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    void Alloc::get_stats(stats &s){
+        memset(&s, 0, sizeof(s));
+        depot_lock lock(depot_mutex);
+        s.heap_size = heap_size;
+        s.pool_bytes = end_free - start_free;
+        for (chunk_header *c = chunk_list; c != 0; c = c->next){
+            ++s.chunk_count;
+            if(c->mapped)
+                s.mapped_bytes += c->size;
+        }
+        for (size_t i = 0; i < __NFREELISTS; ++i)
+            s.classes[i].block_size = CLASS_SIZE(i);
+#ifdef TINYSTL_ALLOC_STATS
+        s.enabled = true;
+        s.peak_heap_size = peak_heap_size;
+        s.chunk_alloc_count = chunk_alloc_count;
+        s.system_alloc_count = system_alloc_count;
+        s.trimmed_bytes = trimmed_bytes;
+        s.large_alloc_count = retired_large_alloc_count;
+        s.large_free_count = retired_large_free_count;
+        for (size_t i = 0; i < __NFREELISTS; ++i){
+            s.classes[i].alloc_count = retired_alloc_count[i];
+            s.classes[i].free_count = retired_free_count[i];
+        }
+        for (thread_cache *c = registered_caches; c != 0; c = c->next_registered){
+            for (size_t i = 0; i < __NFREELISTS; ++i){
+                s.classes[i].alloc_count += c->alloc_count[i].load(std::memory_order_relaxed);
+                s.classes[i].free_count += c->free_count[i].load(std::memory_order_relaxed);
+            }
+            s.large_alloc_count += c->large_alloc_count.load(std::memory_order_relaxed);
+            s.large_free_count += c->large_free_count.load(std::memory_order_relaxed);
+        }
+        s.large_live_bytes = large_live_bytes.load(std::memory_order_relaxed);
+        s.peak_large_bytes = peak_large_bytes.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < __NFREELISTS; ++i){
+            stats::size_class &c = s.classes[i];
+            // 从中心仓库分出去的区块, 不是在客户端手里就是在某个线程缓存里
+            c.live_blocks = c.alloc_count > c.free_count ? c.alloc_count - c.free_count : 0;
+            if(c.live_blocks > depot_out[i])
+                c.live_blocks = depot_out[i];
+            c.depot_blocks = depot_count[i];
+            c.free_blocks = depot_count[i] + depot_out[i] - c.live_blocks;
+            c.peak_blocks = peak_out[i];
+            c.refill_count = refill_count[i];
+            c.batch_objs = batch_objs[i] != 0 ? batch_objs[i] : BATCH_OBJS(i);
+            s.live_bytes += c.live_blocks * c.block_size;
+            s.free_bytes += c.free_blocks * c.block_size;
+        }
+        if(heap_size != 0)
+            s.fragmentation = 1.0 - (double)s.live_bytes / heap_size;
+#endif
+    }
+
+    void Alloc::print_stats(FILE *out){
+        stats s;
+        get_stats(s);
+        fprintf(out, "TinySTL::Alloc stats%s\n", s.enabled ? "" : " (counters disabled, define TINYSTL_ALLOC_STATS)");
+        fprintf(out, "  heap size:       %zu (peak %zu) in %zu chunks (%zu bytes mmapped)\n", s.heap_size, s.peak_heap_size,
+                s.chunk_count, s.mapped_bytes);
+        fprintf(out, "  pool bytes left: %zu\n", s.pool_bytes);
+        fprintf(out, "  live bytes:      %zu\n", s.live_bytes);
+        fprintf(out, "  free bytes:      %zu\n", s.free_bytes);
+        fprintf(out, "  fragmentation:   %.4f\n", s.fragmentation);
+        fprintf(out, "  chunk_alloc:     %zu calls, %zu system allocations\n", s.chunk_alloc_count, s.system_alloc_count);
+        fprintf(out, "  trimmed bytes:   %zu\n", s.trimmed_bytes);
+        fprintf(out, "  large (malloc):  %zu allocs, %zu frees, %zu live bytes (peak %zu)\n",
+                s.large_alloc_count, s.large_free_count, s.large_live_bytes, s.peak_large_bytes);
+        fprintf(out, "  %6s %12s %12s %10s %10s %10s %10s %10s %6s\n",
+                "size", "allocs", "frees", "live", "free", "depot", "peak", "refills", "batch");
+        for (size_t i = 0; i < stats::class_count; ++i){
+            const stats::size_class &c = s.classes[i];
+            fprintf(out, "  %6zu %12zu %12zu %10zu %10zu %10zu %10zu %10zu %6zu\n", c.block_size, c.alloc_count,
+                    c.free_count, c.live_blocks, c.free_blocks, c.depot_blocks, c.peak_blocks, c.refill_count,
+                    c.batch_objs);
+        }
+    }
+
+    void Alloc::print_stats_json(FILE *out){
+        stats s;
+        get_stats(s);
+        fprintf(out, "{\"enabled\":%s,\"heap_size\":%zu,\"peak_heap_size\":%zu,\"chunk_count\":%zu,\"mapped_bytes\":%zu,"
+                "\"chunk_alloc_count\":%zu,\"system_alloc_count\":%zu,\"pool_bytes\":%zu,\"live_bytes\":%zu,"
+                "\"free_bytes\":%zu,\"large_alloc_count\":%zu,\"large_free_count\":%zu,\"large_live_bytes\":%zu,"
+                "\"peak_large_bytes\":%zu,\"trimmed_bytes\":%zu,\"fragmentation\":%.6f,\"classes\":[",
+                s.enabled ? "true" : "false", s.heap_size, s.peak_heap_size, s.chunk_count, s.mapped_bytes,
+                s.chunk_alloc_count, s.system_alloc_count, s.pool_bytes, s.live_bytes, s.free_bytes, s.large_alloc_count,
+                s.large_free_count, s.large_live_bytes, s.peak_large_bytes, s.trimmed_bytes, s.fragmentation);
+        for (size_t i = 0; i < stats::class_count; ++i){
+            const stats::size_class &c = s.classes[i];
+            fprintf(out, "%s{\"block_size\":%zu,\"alloc_count\":%zu,\"free_count\":%zu,\"live_blocks\":%zu,"
+                    "\"free_blocks\":%zu,\"depot_blocks\":%zu,\"peak_blocks\":%zu,\"refill_count\":%zu,\"batch_objs\":%zu}",
+                    i == 0 ? "" : ",", c.block_size, c.alloc_count, c.free_count, c.live_blocks,
+                    c.free_blocks, c.depot_blocks, c.peak_blocks, c.refill_count, c.batch_objs);
+        }
+        fprintf(out, "]}\n");
+    }
+}
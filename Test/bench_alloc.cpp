@@ -0,0 +1,117 @@
+#define TINYSTL_ALLOC_STATS // 需要统计chunk_alloc的调用次数
+#include <iostream>
+#include <chrono>
+#include "../allocator.h"
+#include "../Sources/alloc.cpp"
+
+// 分配器的性能测试
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+static size_t chunk_alloc_calls(){
+    TinySTL::Alloc::stats s;
+    TinySTL::Alloc::get_stats(s);
+    return s.chunk_alloc_count;
+}
+
+// 和list节点一样大的双向链表节点, 每个节点单独向Alloc申请
+// list现在从slab中成块配置节点, 不再逐个经过Alloc, 因此这里自己建链表来测分配器
+struct chain_node{
+    chain_node *prev, *next;
+    int value;
+};
+typedef TinySTL::allocator<chain_node> chain_allocator;
+
+struct chain{
+    chain_node *head, *tail;
+    chain() : head(0), tail(0) {}
+    ~chain(){
+        while(head){
+            chain_node *next = head->next;
+            chain_allocator::deallocate(head);
+            head = next;
+        }
+    }
+    void push_back(int value){
+        chain_node *x = chain_allocator::allocate();
+        x->value = value;
+        x->prev = tail;
+        x->next = 0;
+        if(tail)
+            tail->next = x;
+        else
+            head = x;
+        tail = x;
+    }
+};
+
+// 大量push_back, 对比固定搬运个数和自适应搬运个数, 每种跑rounds次取最好的一次
+static void bench_refill(bool adaptive, int n, int rounds){
+    double best = 0;
+    size_t calls = 0;
+    for (int r = 0; r < rounds; ++r){
+        TinySTL::Alloc::trim(); // 每次都从空的内存池开始
+        TinySTL::Alloc::set_adaptive_refill(adaptive);
+        size_t before = chunk_alloc_calls();
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            chain l;
+            for (int i = 0; i < n; ++i)
+                l.push_back(i);
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+        calls = chunk_alloc_calls() - before;
+    }
+    std::cout << (adaptive ? "adaptive refill: " : "fixed refill:    ")
+              << calls << " chunk_alloc calls, " << best << " M push_back/s" << std::endl;
+}
+
+// chunk分别从malloc和mmap(透明大页)申请, 对比建链表的速度和遍历链表的速度
+// 两条链表交替push_back, 让相邻节点在内存中隔开, 遍历时跨越更多的页
+static void bench_backend(bool mmap_chunks, int n, int rounds){
+    TinySTL::Alloc::trim();
+    if(!TinySTL::Alloc::set_mmap_chunks(mmap_chunks)){
+        std::cout << "mmap backend: not supported" << std::endl;
+        return;
+    }
+    double best_build = 0, best_walk = 0;
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        TinySTL::Alloc::trim();
+        bench_clock::time_point begin = bench_clock::now();
+        chain a, b;
+        for (int i = 0; i < n; ++i){
+            a.push_back(i);
+            b.push_back(-i);
+        }
+        double rate = 2.0 * n / seconds_since(begin) / 1e6;
+        if(rate > best_build)
+            best_build = rate;
+        begin = bench_clock::now();
+        for (int k = 0; k < 5; ++k)
+            for (chain_node *x = a.head; x; x = x->next)
+                sum += x->value;
+        rate = 5.0 * n / seconds_since(begin) / 1e6;
+        if(rate > best_walk)
+            best_walk = rate;
+    }
+    std::cout << (mmap_chunks ? "mmap backend:   " : "malloc backend: ")
+              << best_build << " M push_back/s, " << best_walk << " M nodes walked/s"
+              << " (checksum " << sum << ")" << std::endl;
+}
+
+int main()
+{
+    const int n = 10000000;
+    bench_refill(false, n, 5);
+    bench_refill(true, n, 5);
+    bench_backend(false, n / 2, 3);
+    bench_backend(true, n / 2, 3);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <stdint.h>
+#include "../btree_map.h"
+#include "../vector.h"
+#include "../algorithm.h"
+#include "../Sources/alloc.cpp"
+
+// btree_map和std::map的对比: 随机插入、有序构造、随机查找、区间扫描, 单位是每秒百万个元素
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+static uint64_t seed = 1;
+static uint64_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+template <class Map>
+static void run(const char *name, TinySTL::vector<uint64_t> &keys, TinySTL::vector<std::pair<uint64_t, uint64_t>> &sorted){
+    const size_t n = keys.size();
+    volatile uint64_t sink = 0;
+
+    bench_clock::time_point begin = bench_clock::now();
+    Map m;
+    for (size_t i = 0; i < n; ++i)
+        m[keys[i]] = i;
+    const double insert_rate = n / seconds_since(begin) / 1e6;
+
+    begin = bench_clock::now();
+    Map loaded(sorted.begin(), sorted.end());
+    const double load_rate = n / seconds_since(begin) / 1e6;
+
+    begin = bench_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += m.find(keys[i])->second;
+    const double find_rate = n / seconds_since(begin) / 1e6;
+    sink = sum;
+
+    // 1000次区间扫描, 每次从随机位置开始顺序读1000个元素
+    const size_t scans = 1000, length = 1000;
+    begin = bench_clock::now();
+    sum = 0;
+    for (size_t s = 0; s < scans; ++s){
+        typename Map::iterator it = m.lower_bound(keys[s]);
+        for (size_t k = 0; k < length && it != m.end(); ++k, ++it)
+            sum += it->second;
+    }
+    const double scan_rate = scans * length / seconds_since(begin) / 1e6;
+    sink = sum;
+
+    begin = bench_clock::now();
+    sum = 0;
+    for (typename Map::iterator it = loaded.begin(); it != loaded.end(); ++it)
+        sum += it->second;
+    const double full_scan_rate = n / seconds_since(begin) / 1e6;
+    sink = sum;
+    (void)sink;
+
+    std::cout << "  " << name << "insert " << insert_rate << ", sorted load " << load_rate << ", find " << find_rate
+              << ", range scan " << scan_rate << ", full scan " << full_scan_rate << " M/s" << std::endl;
+}
+
+int main()
+{
+    const size_t sizes[] = {100000, 4000000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s){
+        const size_t n = sizes[s];
+        TinySTL::vector<uint64_t> keys;
+        TinySTL::vector<std::pair<uint64_t, uint64_t>> sorted;
+        for (size_t i = 0; i < n; ++i)
+            keys.push_back(next_random());
+        for (size_t i = 0; i < n; ++i)
+            sorted.push_back(std::make_pair(keys[i], (uint64_t)i));
+        TinySTL::sort(sorted.begin(), sorted.end());
+        std::cout << n << " uint64_t keys:" << std::endl;
+        run<std::map<uint64_t, uint64_t>>("std::map:          ", keys, sorted);
+        run<TinySTL::btree_map<uint64_t, uint64_t>>("TinySTL::btree_map: ", keys, sorted);
+    }
+    return 0;
+}
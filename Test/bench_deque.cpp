@@ -0,0 +1,97 @@
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <stdint.h>
+#include "../deque.h"
+#include "../list.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// deque作为FIFO队列的性能测试: 和list、vector(只能在尾部插入)、std::deque对比, 单位是每秒百万次操作
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// 先放入n个元素, 再全部从队头取出
+template <class Queue>
+static double bench_fill_drain(size_t n, int rounds){
+    double best = 0;
+    uint64_t sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            Queue q;
+            for (size_t i = 0; i < n; ++i)
+                q.push_back(i);
+            while(!q.empty()){
+                sum += q.front();
+                q.pop_front();
+            }
+        }
+        double rate = 2 * n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    if(sum == 42)
+        std::cout << std::endl; // 防止循环被优化掉
+    return best;
+}
+
+// 队列长度保持在backlog左右, 每次放入一个取出一个
+template <class Queue>
+static double bench_steady(size_t n, size_t backlog, int rounds){
+    double best = 0;
+    uint64_t sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        Queue q;
+        for (size_t i = 0; i < backlog; ++i)
+            q.push_back(i);
+        bench_clock::time_point begin = bench_clock::now();
+        for (size_t i = 0; i < n; ++i){
+            q.push_back(i);
+            sum += q.front();
+            q.pop_front();
+        }
+        double rate = 2 * n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    if(sum == 42)
+        std::cout << std::endl;
+    return best;
+}
+
+// vector只能在尾部插入, 只测试放入n个元素(包括扩容时的搬移)
+static double bench_vector_fill(size_t n, int rounds){
+    double best = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            TinySTL::vector<uint64_t> v;
+            for (size_t i = 0; i < n; ++i)
+                v.push_back(i);
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    return best;
+}
+
+int main()
+{
+    const size_t n = 10000000;
+    std::cout << "fill + drain " << n << " uint64_t:" << std::endl;
+    std::cout << "  TinySTL::deque: " << bench_fill_drain<TinySTL::deque<uint64_t> >(n, 3) << " M ops/s" << std::endl;
+    std::cout << "  std::deque:     " << bench_fill_drain<std::deque<uint64_t> >(n, 3) << " M ops/s" << std::endl;
+    std::cout << "  TinySTL::list:  " << bench_fill_drain<TinySTL::list<uint64_t> >(n, 3) << " M ops/s" << std::endl;
+    std::cout << "  TinySTL::vector (push_back only): " << bench_vector_fill(n, 3) << " M ops/s" << std::endl;
+    std::cout << "steady queue of 100000, " << n << " push/pop pairs:" << std::endl;
+    std::cout << "  TinySTL::deque: " << bench_steady<TinySTL::deque<uint64_t> >(n, 100000, 3) << " M ops/s" << std::endl;
+    std::cout << "  std::deque:     " << bench_steady<std::deque<uint64_t> >(n, 100000, 3) << " M ops/s" << std::endl;
+    std::cout << "  TinySTL::list:  " << bench_steady<TinySTL::list<uint64_t> >(n, 100000, 3) << " M ops/s" << std::endl;
+    return 0;
+}
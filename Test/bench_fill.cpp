@@ -0,0 +1,67 @@
+#include <iostream>
+#include <chrono>
+#include "../algorithm.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// fill的性能测试: 逐个元素赋值的循环和SIMD内核的对比, 单位是GB/s
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// 原来的fill: 逐个元素赋值, 并且禁止编译器自动向量化, 作为对比的基准
+template <class T>
+__attribute__((noinline, optimize("no-tree-vectorize")))
+void scalar_fill(T *first, T *last, const T &value){
+    for (; first != last; ++first)
+        *first = value;
+}
+
+template <class T>
+static void bench_type(const char *name, T value, size_t n, int rounds){
+    T *buf = TinySTL::allocator<T>::allocate(n);
+    scalar_fill(buf, buf + n, value); // 先把页面都映射好
+    double best_scalar = 0, best_simd = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        scalar_fill(buf, buf + n, value);
+        double rate = n * sizeof(T) / seconds_since(begin) / 1e9;
+        if(rate > best_scalar)
+            best_scalar = rate;
+        begin = bench_clock::now();
+        TinySTL::fill(buf, buf + n, value);
+        rate = n * sizeof(T) / seconds_since(begin) / 1e9;
+        if(rate > best_simd)
+            best_simd = rate;
+    }
+    std::cout << name << ": scalar " << best_scalar << " GB/s, TinySTL::fill " << best_simd << " GB/s" << std::endl;
+    TinySTL::allocator<T>::deallocate(buf, n);
+}
+
+int main()
+{
+    const size_t bytes = 64 * 1024; // 放得进L1/L2 cache
+    const size_t big_bytes = 400 * 1024 * 1024; // 远大于cache, 受内存带宽限制
+    std::cout << "in cache (" << bytes / 1024 << " KB):" << std::endl;
+    bench_type<char>("  char  'x'   ", 'x', bytes, 2000);
+    bench_type<short>("  short 0x1234", 0x1234, bytes / 2, 2000);
+    bench_type<int>("  int   7     ", 7, bytes / 4, 2000);
+    bench_type<int>("  int   0     ", 0, bytes / 4, 2000);
+    bench_type<double>("  double 1.5  ", 1.5, bytes / 8, 2000);
+    std::cout << "in memory (" << big_bytes / 1024 / 1024 << " MB):" << std::endl;
+    bench_type<int>("  int   7     ", 7, big_bytes / 4, 5);
+    bench_type<double>("  double 1.5  ", 1.5, big_bytes / 8, 5);
+
+    // 构造一个1亿个元素的vector<int>, 包括申请内存和缺页的时间
+    bench_clock::time_point begin = bench_clock::now();
+    {
+        TinySTL::vector<int> v(100000000, 7);
+        double sec = seconds_since(begin);
+        std::cout << "vector<int>(100M, 7): " << sec * 1000 << " ms, "
+                  << 4e8 / sec / 1e9 << " GB/s (v[99999999] = " << v[99999999] << ")" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include <unordered_map>
+#include <stdint.h>
+#include "../flat_hash_map.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// flat_hash_map和std::unordered_map的对比: 插入、命中查找、未命中查找、删除, 单位是每秒百万次操作
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+static uint64_t seed = 1;
+static uint64_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+struct rates{
+    double insert, hit, miss, erase;
+};
+
+template <class Map>
+static rates run(TinySTL::vector<uint64_t> &keys, TinySTL::vector<uint64_t> &missing){
+    const size_t n = keys.size();
+    volatile uint64_t sink = 0;
+    rates r;
+    Map m;
+
+    bench_clock::time_point begin = bench_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        m[keys[i]] = i;
+    r.insert = n / seconds_since(begin) / 1e6;
+
+    begin = bench_clock::now();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += m.find(keys[i])->second;
+    r.hit = n / seconds_since(begin) / 1e6;
+    sink = sum;
+
+    begin = bench_clock::now();
+    size_t found = 0;
+    for (size_t i = 0; i < n; ++i)
+        found += m.count(missing[i]);
+    r.miss = n / seconds_since(begin) / 1e6;
+    sink = found;
+
+    begin = bench_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        m.erase(keys[i]);
+    r.erase = n / seconds_since(begin) / 1e6;
+    (void)sink;
+    return r;
+}
+
+// 每一项取几轮中最好的一次
+template <class Map>
+static void report(const char *name, int rounds, TinySTL::vector<uint64_t> &keys, TinySTL::vector<uint64_t> &missing){
+    rates best = {0, 0, 0, 0};
+    for (int i = 0; i < rounds; ++i){
+        rates r = run<Map>(keys, missing);
+        best.insert = r.insert > best.insert ? r.insert : best.insert;
+        best.hit = r.hit > best.hit ? r.hit : best.hit;
+        best.miss = r.miss > best.miss ? r.miss : best.miss;
+        best.erase = r.erase > best.erase ? r.erase : best.erase;
+    }
+    std::cout << "  " << name << "insert " << best.insert << ", hit " << best.hit
+              << ", miss " << best.miss << ", erase " << best.erase << " M ops/s" << std::endl;
+}
+
+int main()
+{
+    const size_t sizes[] = {1000, 100000, 4000000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s){
+        const size_t n = sizes[s];
+        // 奇数做键, 偶数做未命中查找的键
+        TinySTL::vector<uint64_t> keys, missing;
+        for (size_t i = 0; i < n; ++i){
+            keys.push_back(next_random() | 1);
+            missing.push_back(next_random() & ~(uint64_t)1);
+        }
+        const int rounds = n < 100000 ? 200 : 3;
+        std::cout << n << " uint64_t keys:" << std::endl;
+        report<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map:     ", rounds, keys, missing);
+        report<TinySTL::flat_hash_map<uint64_t, uint64_t>>("TinySTL::flat_hash_map: ", rounds, keys, missing);
+    }
+    return 0;
+}
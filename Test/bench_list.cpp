@@ -0,0 +1,64 @@
+#include <iostream>
+#include <chrono>
+#include <list>
+#include "../list.h"
+#include "../Sources/alloc.cpp"
+
+// list的性能测试: 1000万个节点的push_back、遍历和clear, 和std::list对比, 单位是每秒百万个节点
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+template <class List>
+static long long walk(List &l){
+    long long sum = 0;
+    for (typename List::iterator it = l.begin(); it != l.end(); ++it)
+        sum += *it;
+    return sum;
+}
+
+// 一条list连续push_back之后遍历和clear
+// interleaved为true时两条list交替push_back, 节点逐个配置的话两条list的节点在内存中交错
+template <class List>
+static void bench(const char *name, int n, bool interleaved, int rounds){
+    double best_build = 0, best_walk = 0, best_clear = 0;
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        List a, b;
+        bench_clock::time_point begin = bench_clock::now();
+        for (int i = 0; i < n; ++i){
+            a.push_back(i);
+            if(interleaved)
+                b.push_back(-i);
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        best_build = rate > best_build ? rate : best_build;
+
+        begin = bench_clock::now();
+        sum += walk(a);
+        rate = n / seconds_since(begin) / 1e6;
+        best_walk = rate > best_walk ? rate : best_walk;
+
+        begin = bench_clock::now();
+        a.clear();
+        rate = n / seconds_since(begin) / 1e6;
+        best_clear = rate > best_clear ? rate : best_clear;
+    }
+    std::cout << "  " << name << "push_back " << best_build << ", walk " << best_walk << ", clear " << best_clear
+              << " M nodes/s (checksum " << sum << ")" << std::endl;
+}
+
+int main()
+{
+    const int n = 10000000;
+    std::cout << n << " nodes, one list:" << std::endl;
+    bench<std::list<int>>("std::list:     ", n, false, 3);
+    bench<TinySTL::list<int>>("TinySTL::list: ", n, false, 3);
+    std::cout << n << " nodes, two lists built alternately:" << std::endl;
+    bench<std::list<int>>("std::list:     ", n, true, 3);
+    bench<TinySTL::list<int>>("TinySTL::list: ", n, true, 3);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <list>
+#include <stdint.h>
+#include "../list.h"
+#include "../parallel.h"
+#include "../Sources/alloc.cpp"
+
+// list::sort的性能测试: 随机和基本有序(每100个元素有一个放错位置)的int链表, 单位是每秒百万个元素
+// 用法: bench_list_sort [元素个数...], 默认100万、1000万、5000万; std::list只测到1000万
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static int make_key(size_t i, bool mostly_sorted){
+    if(!mostly_sorted)
+        return (int)next_random();
+    return i % 100 == 0 ? (int)(next_random() & 0x7fffffff) : (int)i;
+}
+
+// 元素交替插在两条链表里, 节点在内存中不是按链表顺序排列的, 接近长时间使用之后的链表
+template <class List>
+static void build(List &l, size_t n, bool mostly_sorted){
+    List other;
+    seed = 1;
+    for (size_t i = 0; i < n; ++i){
+        l.push_back(make_key(i, mostly_sorted));
+        other.push_back(0);
+    }
+}
+
+template <class List>
+static bool is_sorted(List &l){
+    typename List::iterator it = l.begin(), prev = it;
+    for (++it; it != l.end(); prev = it, ++it)
+        if(*it < *prev)
+            return false;
+    return true;
+}
+
+enum engine { std_sort, no_buffer, buffer, automatic, parallel };
+
+static void sort_with(std::list<int> &l, engine) { l.sort(); }
+static void sort_with(TinySTL::list<int> &l, engine e){
+    if(e == no_buffer)
+        TinySTL::__list_merge_sort(l.end().node, TinySTL::__list_node_compare<int, TinySTL::_less>(TinySTL::_less()));
+    else if(e == buffer)
+        TinySTL::__list_sort_values<int>(l.end().node, TinySTL::_less(), TinySTL::__list_natural_sorter(), TinySTL::_true_type());
+    else if(e == parallel)
+        TinySTL::sort(TinySTL::par, l);
+    else
+        l.sort();
+}
+
+template <class List>
+static void bench(const char *name, engine e, size_t n, bool mostly_sorted){
+    List l;
+    build(l, n, mostly_sorted);
+    bench_clock::time_point begin = bench_clock::now();
+    sort_with(l, e);
+    const double rate = n / seconds_since(begin) / 1e6;
+    std::cout << "    " << name << rate << " M/s" << (is_sorted(l) ? "" : " (NOT SORTED)") << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t sizes[16] = {1000000, 10000000, 50000000};
+    int count = 3;
+    if(argc > 1){
+        count = 0;
+        for (int i = 1; i < argc && count < 16; ++i)
+            sizes[count++] = (size_t)std::strtoull(argv[i], 0, 10);
+    }
+    std::cout << "threads: " << TinySTL::thread_pool::instance().concurrency() << std::endl;
+    for (int s = 0; s < count; ++s){
+        const size_t n = sizes[s];
+        for (int mostly_sorted = 0; mostly_sorted < 2; ++mostly_sorted){
+            std::cout << n << " ints, " << (mostly_sorted ? "mostly sorted" : "random") << ":" << std::endl;
+            if(n <= 10000000)
+                bench<std::list<int>>("std::list::sort:                ", std_sort, n, mostly_sorted);
+            bench<TinySTL::list<int>>("TinySTL::list, in-place merge:  ", no_buffer, n, mostly_sorted);
+            bench<TinySTL::list<int>>("TinySTL::list, buffer:          ", buffer, n, mostly_sorted);
+            bench<TinySTL::list<int>>("TinySTL::list::sort:            ", automatic, n, mostly_sorted);
+            bench<TinySTL::list<int>>("TinySTL::sort(par, list):       ", parallel, n, mostly_sorted);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <stdint.h>
+#include "../parallel.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 并行算法的扩展性测试: 线程数从1增加到N(默认是CPU核数, 可以用第一个参数指定), 单位是毫秒
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double ms_since(bench_clock::time_point begin){
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = 50000000;
+    size_t max_threads = argc > 1 ? (size_t)atoi(argv[1]) : std::thread::hardware_concurrency();
+    if(max_threads == 0)
+        max_threads = 1;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << ", " << n << " ints" << std::endl;
+
+    TinySTL::vector<uint32_t> input(n);
+    for (size_t i = 0; i < n; ++i)
+        input[i] = next_random();
+
+    double base[6] = {0};
+    for (size_t threads = 1; threads <= max_threads; threads *= 2){
+        TinySTL::thread_pool::instance().resize(threads - 1);
+        double t[6];
+
+        // 构造: 各个线程分别写入(first touch)自己那一段
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            TinySTL::vector<uint32_t> v(TinySTL::par, n, 7u);
+            t[0] = ms_since(begin);
+
+            begin = bench_clock::now();
+            TinySTL::fill(TinySTL::par, v.begin(), v.end(), 3u);
+            t[1] = ms_since(begin);
+
+            begin = bench_clock::now();
+            TinySTL::copy(TinySTL::par, input.begin(), input.end(), v.begin());
+            t[2] = ms_since(begin);
+
+            begin = bench_clock::now();
+            TinySTL::transform(TinySTL::par, input.begin(), input.end(), v.begin(), [](uint32_t x){ return x * 2654435761u >> 7; });
+            t[3] = ms_since(begin);
+
+            begin = bench_clock::now();
+            volatile uint64_t sum = TinySTL::reduce(TinySTL::par, v.begin(), v.end(), (uint64_t)0,
+                                                    [](uint64_t a, uint64_t b){ return a + b; });
+            (void)sum;
+            t[4] = ms_since(begin);
+
+            begin = bench_clock::now();
+            TinySTL::sort(TinySTL::par, v.begin(), v.end());
+            t[5] = ms_since(begin);
+        }
+
+        static const char *names[] = {"vector(par)", "fill", "copy", "transform", "reduce", "sort"};
+        std::cout << threads << " thread(s):" << std::endl;
+        for (int i = 0; i < 6; ++i){
+            if(threads == 1)
+                base[i] = t[i];
+            std::cout << "  " << names[i] << ": " << t[i] << " ms (speedup " << base[i] / t[i] << "x)" << std::endl;
+        }
+        if(threads < max_threads && threads * 2 > max_threads)
+            threads = max_threads / 2; // 最后一次测试恰好N个线程
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "../algorithm.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 基数排序的性能测试: 和比较排序(TinySTL::sort、std::sort)对比, 单位是毫秒
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double ms_since(bench_clock::time_point begin){
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+static uint64_t seed = 88172645463325252ull;
+static uint64_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+// 键加上负载, 按key排序
+struct pair64{
+    uint64_t key;
+    uint64_t value;
+};
+static bool operator<(const pair64 &a, const pair64 &b) { return a.key < b.key; }
+struct pair64_key{
+    uint64_t operator()(const pair64 &p) const { return p.key; }
+};
+
+template <class T> T make_value();
+template <> uint32_t make_value<uint32_t>() { return (uint32_t)next_random(); }
+template <> int32_t make_value<int32_t>() { return (int32_t)next_random(); }
+template <> uint64_t make_value<uint64_t>() { return next_random(); }
+template <> float make_value<float>() { return (float)(int32_t)next_random() / 1024.0f; }
+template <> double make_value<double>() { return (double)(int64_t)next_random() / 1048576.0; }
+template <> pair64 make_value<pair64>() { pair64 p = {next_random(), next_random()}; return p; }
+
+template <class T>
+struct radix_sorter{
+    void operator()(T *first, T *last) const { TinySTL::radix_sort(first, last); }
+};
+template <>
+struct radix_sorter<pair64>{
+    void operator()(pair64 *first, pair64 *last) const { TinySTL::radix_sort(first, last, pair64_key()); }
+};
+
+template <class T>
+static void bench_type(const char *name, size_t n, int rounds){
+    TinySTL::vector<T> input(n), v(n);
+    for (size_t i = 0; i < n; ++i)
+        input[i] = make_value<T>();
+    double best_radix = 1e100, best_sort = 1e100, best_std = 1e100;
+    for (int r = 0; r < rounds; ++r){
+        TinySTL::copy(input.begin(), input.end(), v.begin());
+        bench_clock::time_point begin = bench_clock::now();
+        radix_sorter<T>()(v.begin(), v.end());
+        best_radix = std::min(best_radix, ms_since(begin));
+        if(!std::is_sorted(v.begin(), v.end()))
+            std::cout << "NOT SORTED" << std::endl;
+
+        TinySTL::copy(input.begin(), input.end(), v.begin());
+        begin = bench_clock::now();
+        TinySTL::sort(v.begin(), v.end());
+        best_sort = std::min(best_sort, ms_since(begin));
+
+        TinySTL::copy(input.begin(), input.end(), v.begin());
+        begin = bench_clock::now();
+        std::sort(v.begin(), v.end());
+        best_std = std::min(best_std, ms_since(begin));
+    }
+    std::cout << "  " << name << ": radix_sort " << best_radix << " ms, TinySTL::sort " << best_sort
+              << " ms, std::sort " << best_std << " ms (" << best_sort / best_radix << "x)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "1M elements:" << std::endl;
+    bench_type<uint32_t>("uint32      ", 1000000, 5);
+    bench_type<int32_t>("int32       ", 1000000, 5);
+    bench_type<uint64_t>("uint64      ", 1000000, 5);
+    bench_type<float>("float       ", 1000000, 5);
+    bench_type<double>("double      ", 1000000, 5);
+    bench_type<pair64>("key+payload ", 1000000, 5);
+
+    std::cout << "100M elements:" << std::endl;
+    bench_type<uint32_t>("uint32      ", 100000000, 1);
+
+    // 键的取值范围很小时, 高位字节都相同的趟会被跳过
+    TinySTL::vector<uint32_t> small(10000000);
+    for (size_t i = 0; i < small.size(); ++i)
+        small[i] = (uint32_t)(next_random() % 65536);
+    bench_clock::time_point begin = bench_clock::now();
+    TinySTL::radix_sort(small.begin(), small.end());
+    std::cout << "10M uint32 keys below 65536 (2 of 3 passes): " << ms_since(begin) << " ms" << std::endl;
+    return 0;
+}
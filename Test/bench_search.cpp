@@ -0,0 +1,130 @@
+#include <iostream>
+#include <chrono>
+#include "../algorithm.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 查找和归约算法的性能测试: 逐个元素处理的循环和SIMD内核的对比, 单位是每秒处理的元素个数(G/s)
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// 原来的实现: 逐个元素处理, 并且禁止编译器自动向量化, 作为对比的基准
+#define SCALAR __attribute__((noinline, optimize("no-tree-vectorize")))
+
+template <class T>
+SCALAR const T *scalar_find(const T *first, const T *last, T value){
+    for (; first != last; ++first)
+        if(*first == value)
+            break;
+    return first;
+}
+template <class T>
+SCALAR size_t scalar_count(const T *first, const T *last, T value){
+    size_t n = 0;
+    for (; first != last; ++first)
+        if(*first == value)
+            ++n;
+    return n;
+}
+template <class T>
+SCALAR const T *scalar_min(const T *first, const T *last){
+    const T *result = first;
+    for (++first; first < last; ++first)
+        if(*first < *result)
+            result = first;
+    return result;
+}
+template <class T>
+SCALAR const T *scalar_max(const T *first, const T *last){
+    const T *result = first;
+    for (++first; first < last; ++first)
+        if(*result < *first)
+            result = first;
+    return result;
+}
+template <class T>
+SCALAR T scalar_sum(const T *first, const T *last, T init){
+    for (; first != last; ++first)
+        init = init + *first;
+    return init;
+}
+template <class T>
+SCALAR bool scalar_equal(const T *first1, const T *last1, const T *first2){
+    for (; first1 != last1; ++first1, ++first2)
+        if(!(*first1 == *first2))
+            return false;
+    return true;
+}
+
+static volatile size_t sink;
+
+// 对一个操作重复rounds次, 返回最好的一次的吞吐量
+template <class F>
+static double rate(F f, size_t n, int rounds){
+    double best = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        sink = sink + f();
+        double g = n / seconds_since(begin) / 1e9;
+        if(g > best)
+            best = g;
+    }
+    return best;
+}
+
+static void report(const char *name, double scalar, double simd){
+    std::cout << "  " << name << ": scalar " << scalar << " G/s, TinySTL " << simd
+              << " G/s (" << simd / scalar << "x)" << std::endl;
+}
+
+template <class T>
+static void bench_type(const char *type_name, size_t n, int rounds){
+    TinySTL::vector<T> v(n), w;
+    for (size_t i = 0; i < n; ++i)
+        v[i] = (T)(i * 7919 % 1000);
+    v[n / 2] = (T)-1;
+    v[n / 3] = (T)5000;
+    w = v;
+    const T *first = &v[0], *last = first + n, *first2 = &w[0];
+    const T missing = (T)3000; // 找不到的值, 需要扫描整个区间
+
+    std::cout << type_name << " x " << n << ":" << std::endl;
+    report("find         ",
+           rate([&]{ return (size_t)(scalar_find(first, last, missing) - first); }, n, rounds),
+           rate([&]{ return (size_t)(TinySTL::find(first, last, missing) - first); }, n, rounds));
+    report("count        ",
+           rate([&]{ return scalar_count(first, last, (T)7); }, n, rounds),
+           rate([&]{ return (size_t)TinySTL::count(first, last, (T)7); }, n, rounds));
+    report("min_element  ",
+           rate([&]{ return (size_t)(scalar_min(first, last) - first); }, n, rounds),
+           rate([&]{ return (size_t)(TinySTL::min_element(first, last) - first); }, n, rounds));
+    report("max_element  ",
+           rate([&]{ return (size_t)(scalar_max(first, last) - first); }, n, rounds),
+           rate([&]{ return (size_t)(TinySTL::max_element(first, last) - first); }, n, rounds));
+    report("minmax       ",
+           rate([&]{ return (size_t)(scalar_min(first, last) - scalar_max(first, last)); }, n, rounds),
+           rate([&]{ std::pair<const T *, const T *> p = TinySTL::minmax_element(first, last);
+                     return (size_t)(p.first - p.second); }, n, rounds));
+    report("accumulate   ",
+           rate([&]{ return (size_t)scalar_sum(first, last, T()); }, n, rounds),
+           rate([&]{ return (size_t)TinySTL::accumulate(first, last, T()); }, n, rounds));
+    report("equal        ",
+           rate([&]{ return (size_t)scalar_equal(first, last, first2); }, n, rounds),
+           rate([&]{ return (size_t)TinySTL::equal(first, last, first2); }, n, rounds));
+}
+
+int main()
+{
+    const size_t in_cache = 16 * 1024; // 放得进L1/L2 cache
+    const size_t in_memory = 32 * 1024 * 1024; // 远大于cache, 受内存带宽限制
+    bench_type<int>("int", in_cache, 2000);
+    bench_type<int>("int", in_memory, 5);
+    bench_type<float>("float", in_cache, 2000);
+    bench_type<float>("float", in_memory, 5);
+    bench_type<short>("short", in_cache, 2000);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <chrono>
+#include <stdint.h>
+#include "../soa_vector.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 只访问一两个字段的扫描: vector<struct>和soa_vector的对比, 单位是每秒百万行
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// 一条典型的记录, 一行48字节, 每次扫描只用到其中4到8字节
+struct order{
+    int64_t id;
+    int64_t timestamp;
+    float price;
+    int quantity;
+    int customer;
+    int product;
+    double discount;
+};
+
+typedef TinySTL::soa_vector<int64_t, int64_t, float, int, int, int, double> order_table;
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class Function>
+static double best_rate(size_t rows, int rounds, Function f){
+    double best = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        f();
+        double rate = rows / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    return best;
+}
+
+int main()
+{
+    const size_t n = 20000000;
+    TinySTL::vector<order> rows;
+    order_table columns;
+    columns.reserve(n);
+    for (size_t i = 0; i < n; ++i){
+        order o = {(int64_t)i, (int64_t)next_random(), (float)(next_random() % 10000) / 100, (int)(next_random() % 100),
+                   (int)(next_random() % 50000), (int)(next_random() % 1000), 0.0};
+        rows.push_back(o);
+        columns.push_back(o.id, o.timestamp, o.price, o.quantity, o.customer, o.product, o.discount);
+    }
+    volatile double sink = 0;
+
+    std::cout << n << " rows, sum(quantity):" << std::endl;
+    std::cout << "  vector<struct>: " << best_rate(n, 5, [&]{
+        long long sum = 0;
+        for (size_t i = 0; i < n; ++i)
+            sum += rows[i].quantity;
+        sink = (double)sum;
+    }) << " M rows/s" << std::endl;
+    std::cout << "  soa_vector:     " << best_rate(n, 5, [&]{
+        TinySTL::span<int> q = columns.column<3>();
+        sink = (double)TinySTL::accumulate(q.begin(), q.end(), 0ll);
+    }) << " M rows/s" << std::endl;
+
+    std::cout << n << " rows, max(price):" << std::endl;
+    std::cout << "  vector<struct>: " << best_rate(n, 5, [&]{
+        float best = rows[0].price;
+        for (size_t i = 1; i < n; ++i)
+            best = rows[i].price > best ? rows[i].price : best;
+        sink = best;
+    }) << " M rows/s" << std::endl;
+    std::cout << "  soa_vector:     " << best_rate(n, 5, [&]{
+        TinySTL::span<float> p = columns.column<2>();
+        sink = *TinySTL::max_element(p.begin(), p.end());
+    }) << " M rows/s" << std::endl;
+
+    std::cout << n << " rows, revenue of product 7 (three columns):" << std::endl;
+    std::cout << "  vector<struct>: " << best_rate(n, 5, [&]{
+        double revenue = 0;
+        for (size_t i = 0; i < n; ++i)
+            if(rows[i].product == 7)
+                revenue += rows[i].price * rows[i].quantity;
+        sink = revenue;
+    }) << " M rows/s" << std::endl;
+    std::cout << "  soa_vector:     " << best_rate(n, 5, [&]{
+        const int *product = columns.column<5>().data();
+        const float *price = columns.column<2>().data();
+        const int *quantity = columns.column<3>().data();
+        double revenue = 0;
+        for (size_t i = 0; i < n; ++i)
+            if(product[i] == 7)
+                revenue += price[i] * quantity[i];
+        sink = revenue;
+    }) << " M rows/s" << std::endl;
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../algorithm.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 排序的性能测试: 各种输入分布下TinySTL::sort/stable_sort和标准库的对比, 单位是毫秒
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double ms_since(bench_clock::time_point begin){
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+static unsigned seed = 12345;
+static unsigned next_random(){
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 4;
+}
+
+static const char *kind_names[] = {"random      ", "sorted      ", "reversed    ", "16 distinct ", "organ pipe  ", "sorted+tail "};
+
+template <class T>
+static T make_value(size_t i, size_t n, int kind){
+    switch(kind){
+    case 0: return (T)next_random();
+    case 1: return (T)i;
+    case 2: return (T)(n - i);
+    case 3: return (T)(next_random() % 16);
+    case 4: return (T)(i < n / 2 ? i : n - i);
+    default: return i + 100 < n ? (T)i : (T)next_random();
+    }
+}
+template <>
+std::string make_value<std::string>(size_t i, size_t n, int kind){
+    return std::to_string(make_value<unsigned>(i, n, kind));
+}
+
+// 对同一份输入分别用两个排序函数排序rounds次, 输出最好的一次的时间
+template <class T, class F1, class F2>
+static void compare(const char *name, const std::vector<T> &input, int rounds, F1 std_sort, F2 tiny_sort){
+    double best_std = 1e100, best_tiny = 1e100;
+    std::vector<T> v;
+    for (int r = 0; r < rounds; ++r){
+        v = input;
+        bench_clock::time_point begin = bench_clock::now();
+        std_sort(v.data(), v.data() + v.size());
+        best_std = std::min(best_std, ms_since(begin));
+        v = input;
+        begin = bench_clock::now();
+        tiny_sort(v.data(), v.data() + v.size());
+        best_tiny = std::min(best_tiny, ms_since(begin));
+        if(!std::is_sorted(v.begin(), v.end()))
+            std::cout << "NOT SORTED" << std::endl;
+    }
+    std::cout << "    " << name << ": std " << best_std << " ms, TinySTL " << best_tiny
+              << " ms (" << best_std / best_tiny << "x)" << std::endl;
+}
+
+template <class T>
+static void bench_type(const char *type_name, size_t n, int rounds){
+    std::cout << type_name << " x " << n << ":" << std::endl;
+    for (int kind = 0; kind < 6; ++kind){
+        std::vector<T> input(n);
+        for (size_t i = 0; i < n; ++i)
+            input[i] = make_value<T>(i, n, kind);
+        std::cout << "  " << kind_names[kind] << std::endl;
+        compare("sort       ", input, rounds,
+                [](T *f, T *l){ std::sort(f, l); }, [](T *f, T *l){ TinySTL::sort(f, l); });
+        compare("stable_sort", input, rounds,
+                [](T *f, T *l){ std::stable_sort(f, l); }, [](T *f, T *l){ TinySTL::stable_sort(f, l); });
+    }
+}
+
+int main()
+{
+    bench_type<int>("int", 1000000, 5);
+    bench_type<double>("double", 1000000, 5);
+    bench_type<std::string>("string", 200000, 3);
+
+    // 小数组: 反复排序很多个16个元素的数组
+    std::vector<int> small(16 * 100000);
+    for (size_t i = 0; i < small.size(); ++i)
+        small[i] = (int)next_random();
+    std::vector<int> v = small;
+    bench_clock::time_point begin = bench_clock::now();
+    for (size_t i = 0; i < v.size(); i += 16)
+        std::sort(v.data() + i, v.data() + i + 16);
+    double std_ms = ms_since(begin);
+    v = small;
+    begin = bench_clock::now();
+    for (size_t i = 0; i < v.size(); i += 16)
+        TinySTL::sort(v.data() + i, v.data() + i + 16);
+    double tiny_ms = ms_since(begin);
+    std::cout << "100000 x 16 ints: std " << std_ms << " ms, TinySTL " << tiny_ms << " ms" << std::endl;
+    return 0;
+}
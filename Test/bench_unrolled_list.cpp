@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <list>
+#include <stdint.h>
+#include "../unrolled_list.h"
+#include "../vector.h"
+#include "../algorithm.h"
+#include "../Sources/alloc.cpp"
+
+// unrolled_list和std::list、TinySTL::vector的对比: 顺序构造、遍历、排序、边遍历边在中间插入, 单位是每秒百万个元素
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class Seq>
+static long long walk(Seq &s){
+    long long sum = 0;
+    for (typename Seq::iterator it = s.begin(); it != s.end(); ++it)
+        sum += *it;
+    return sum;
+}
+
+static void sort_all(std::list<int> &s) { s.sort(); }
+static void sort_all(TinySTL::vector<int> &s) { TinySTL::sort(s.begin(), s.end()); }
+static void sort_all(TinySTL::unrolled_list<int> &s) { s.sort(); }
+
+// 每隔step个元素在当前位置之前插入一个新元素, vector每次都要挪动后面所有的元素
+static void insert_every(std::list<int> &s, int step){
+    int k = 0;
+    for (std::list<int>::iterator it = s.begin(); it != s.end(); ++it)
+        if(++k % step == 0)
+            s.insert(it, -k);
+}
+static void insert_every(TinySTL::vector<int> &s, int step){
+    int k = 0;
+    for (TinySTL::vector<int>::iterator it = s.begin(); it != s.end(); ++it)
+        if(++k % step == 0)
+            it = s.insert(it, -k) + 1;
+}
+static void insert_every(TinySTL::unrolled_list<int> &s, int step){
+    int k = 0;
+    for (TinySTL::unrolled_list<int>::iterator it = s.begin(); it != s.end(); ++it)
+        if(++k % step == 0)
+            it = ++s.insert(it, -k);
+}
+
+template <class Seq>
+static void bench(const char *name, int n, int inserts_n, int rounds){
+    double best_build = 0, best_walk = 0, best_sort = 0, best_insert = 0;
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        seed = 1;
+        Seq s;
+        bench_clock::time_point begin = bench_clock::now();
+        for (int i = 0; i < n; ++i)
+            s.push_back((int)next_random());
+        double rate = n / seconds_since(begin) / 1e6;
+        best_build = rate > best_build ? rate : best_build;
+
+        begin = bench_clock::now();
+        sum += walk(s);
+        rate = n / seconds_since(begin) / 1e6;
+        best_walk = rate > best_walk ? rate : best_walk;
+
+        begin = bench_clock::now();
+        sort_all(s);
+        rate = n / seconds_since(begin) / 1e6;
+        best_sort = rate > best_sort ? rate : best_sort;
+
+        // 插入单独用一个较小的序列, 否则vector跑不完
+        Seq t;
+        for (int i = 0; i < inserts_n; ++i)
+            t.push_back(i);
+        begin = bench_clock::now();
+        insert_every(t, 10);
+        rate = inserts_n / seconds_since(begin) / 1e6;
+        best_insert = rate > best_insert ? rate : best_insert;
+        sum += walk(t);
+    }
+    std::cout << "  " << name << "push_back " << best_build << ", walk " << best_walk << ", sort " << best_sort
+              << ", insert every 10th " << best_insert << " M/s (checksum " << sum << ")" << std::endl;
+}
+
+int main()
+{
+    const int n = 4000000, inserts_n = 200000;
+    std::cout << n << " ints (" << inserts_n << " for the insert pass):" << std::endl;
+    bench<std::list<int>>("std::list:              ", n, inserts_n, 3);
+    bench<TinySTL::vector<int>>("TinySTL::vector:        ", n, inserts_n, 3);
+    bench<TinySTL::unrolled_list<int>>("TinySTL::unrolled_list: ", n, inserts_n, 3);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "../vector.h"
+#include "../small_vector.h"
+#include "../Sources/alloc.cpp"
+
+// vector扩容的性能测试: 元素持有堆内存时, 扩容移动元素和扩容复制元素的对比
+// 以及只放几个元素、用完就丢弃的vector和small_vector的对比
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point begin){
+    return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// 和std::string一样持有堆内存, 但移动构造没有声明为noexcept, 扩容时只能复制, 相当于原来的扩容方式
+struct copied_string{
+    std::string s;
+    copied_string(const std::string &x) : s(x) {}
+    copied_string(const copied_string &x) : s(x.s) {}
+    copied_string(copied_string &&x) : s(std::move(x.s)) {}
+    copied_string &operator=(const copied_string &x) { s = x.s; return *this; }
+};
+
+// 每个元素都先构造好再push_back, 两种型别的差别只在扩容时搬移旧元素的方式
+template <class T>
+static double bench_growth(int n, int rounds){
+    const std::string value(64, 'x'); // 放不进短字符串缓冲区, 每次复制都要申请堆内存
+    double best = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            TinySTL::vector<T> v;
+            for (int i = 0; i < n; ++i)
+                v.push_back(T(value));
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    return best;
+}
+
+// 直接在尾部构造和先构造临时对象再移动进去的对比
+static double bench_emplace(int n, int rounds){
+    double best = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        {
+            TinySTL::vector<std::string> v;
+            for (int i = 0; i < n; ++i)
+                v.emplace_back(64, 'x');
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    return best;
+}
+
+// 反复创建只有几个元素的临时容器, vector每次都要向配置器申请空间, small_vector不需要
+template <class Vector>
+static double bench_short_lived(int n, int elements, int rounds){
+    double best = 0;
+    long long sum = 0;
+    for (int r = 0; r < rounds; ++r){
+        bench_clock::time_point begin = bench_clock::now();
+        for (int i = 0; i < n; ++i){
+            Vector v;
+            for (int j = 0; j < elements; ++j)
+                v.push_back(i + j);
+            sum += v[elements / 2];
+        }
+        double rate = n / seconds_since(begin) / 1e6;
+        if(rate > best)
+            best = rate;
+    }
+    if(sum == 42)
+        std::cout << std::endl; // 防止循环被优化掉
+    return best;
+}
+
+int main()
+{
+    const int n = 1000000;
+    std::cout << "copy growth (copied_string):  " << bench_growth<copied_string>(n, 5) << " M push_back/s" << std::endl;
+    std::cout << "move growth (std::string):    " << bench_growth<std::string>(n, 5) << " M push_back/s" << std::endl;
+    std::cout << "emplace_back (std::string):   " << bench_emplace(n, 5) << " M emplace_back/s" << std::endl;
+    for (int elements = 2; elements <= 8; elements *= 2){
+        std::cout << "short-lived, " << elements << " ints: vector " << bench_short_lived<TinySTL::vector<int> >(n, elements, 5)
+                  << ", small_vector<8> " << bench_short_lived<TinySTL::small_vector<int, 8> >(n, elements, 5) << " M containers/s" << std::endl;
+    }
+    return 0;
+}
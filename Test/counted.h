@@ -0,0 +1,60 @@
+#ifndef _TEST_COUNTED_H_
+#define _TEST_COUNTED_H_
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+
+/* 测试容器用的元素型别: 统计存活的对象个数以及复制、移动、比较的次数
+ * 第throw_at次复制时、第compare_throw_at次比较时抛出std::runtime_error, 用来检查异常之后对象一个不多一个不少
+ * V是保存的值value; Move决定移动构造:
+ *   counted_no_move        移动和复制一样计入copies, 也可能抛出异常(相当于没有移动构造)
+ *   counted_nothrow_move   noexcept的移动, 计入moves
+ *   counted_may_throw_move 没有声明noexcept的移动, 计入moves
+ * 计数器都是原子的, 可以在线程池的线程里构造和析构
+ */
+enum counted_move { counted_no_move, counted_nothrow_move, counted_may_throw_move };
+
+template <class V, counted_move Move = counted_no_move>
+struct basic_counted{
+    static std::atomic<int> live, copies, moves, compares;
+    static int throw_at, compare_throw_at;
+    V value;
+
+    basic_counted(V v = V()) : value(std::move(v)) { ++live; }
+    basic_counted(const char *p) : value(p) { ++live; }
+    basic_counted(const basic_counted &x) : value(x.value){
+        count_copy();
+        ++live;
+    }
+    basic_counted(basic_counted &&x) noexcept(Move == counted_nothrow_move) : value(std::move(x.value)){
+        if(Move == counted_no_move)
+            count_copy();
+        else
+            ++moves;
+        ++live;
+    }
+    basic_counted &operator=(const basic_counted &x) { value = x.value; return *this; }
+    basic_counted &operator=(basic_counted &&x) noexcept(Move == counted_nothrow_move) { value = std::move(x.value); return *this; }
+    ~basic_counted() { --live; }
+
+    bool operator<(const basic_counted &x) const{
+        if(++compares == compare_throw_at)
+            throw std::runtime_error("compare");
+        return value < x.value;
+    }
+private:
+    static void count_copy(){
+        if(++copies == throw_at)
+            throw std::runtime_error("copy");
+    }
+};
+
+template <class V, counted_move Move> std::atomic<int> basic_counted<V, Move>::live(0);
+template <class V, counted_move Move> std::atomic<int> basic_counted<V, Move>::copies(0);
+template <class V, counted_move Move> std::atomic<int> basic_counted<V, Move>::moves(0);
+template <class V, counted_move Move> std::atomic<int> basic_counted<V, Move>::compares(0);
+template <class V, counted_move Move> int basic_counted<V, Move>::throw_at = -1;
+template <class V, counted_move Move> int basic_counted<V, Move>::compare_throw_at = -1;
+
+#endif
@@ -0,0 +1,335 @@
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <numeric>
+#include <string>
+#include <functional>
+#include "../algorithm.h"
+#include "../vector.h"
+#include "../list.h"
+#include "../Sources/alloc.cpp"
+
+// algorithm.h的正确性测试
+
+struct pair32{
+    int a, b; // 8字节, 但只按4字节对齐
+};
+
+// 对各种长度和起始偏移, 检查fill只写了[first, last), 并且每个元素都等于value
+template <class T>
+bool check_fill(const T &value, const T &guard){
+    const size_t max_n = 300;
+    T buf[max_n + 40];
+    for (size_t offset = 0; offset < 8; ++offset){
+        for (size_t n = 0; n < max_n; n += (n < 70 ? 1 : 37)){
+            for (size_t i = 0; i < max_n + 40; ++i)
+                buf[i] = guard;
+            TinySTL::fill(buf + offset, buf + offset + n, value);
+            for (size_t i = 0; i < max_n + 40; ++i){
+                const T &expect = (i >= offset && i < offset + n) ? value : guard;
+                if(memcmp(&buf[i], &expect, sizeof(T)) != 0)
+                    return false;
+            }
+            T *end = TinySTL::fill_n(buf + offset, n, guard);
+            if(end != buf + offset + n || memcmp(&buf[offset], &guard, sizeof(T)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+bool test_fill(){
+    bool ok = check_fill<char>('x', 0);
+    ok = check_fill<short>(0x1234, -1) && ok;
+    ok = check_fill<int>(0x12345678, 0) && ok;
+    ok = check_fill<int>(0, 7) && ok; // 字节重复的模式走memset
+    ok = check_fill<long long>(0x0102030405060708ll, -1) && ok;
+    ok = check_fill<float>(1.5f, 0.0f) && ok;
+    ok = check_fill<double>(-2.25, 0.0) && ok;
+    pair32 p = {1, 2}, g = {0, 0};
+    ok = check_fill<pair32>(p, g) && ok;
+
+    // 用不同型别的值填充
+    double d[100];
+    TinySTL::fill(d, d + 100, 3);
+    ok = ok && d[0] == 3.0 && d[99] == 3.0;
+
+    // 超过non-temporal store阈值的大块填充
+    TinySTL::vector<int> big(10000000, 7);
+    ok = ok && big[0] == 7 && big[5000000] == 7 && big[9999999] == 7;
+    big.insert(big.begin() + 3, 1000, -5);
+    ok = ok && big[2] == 7 && big[3] == -5 && big[1002] == -5 && big[1003] == 7;
+    return ok;
+}
+
+static unsigned seed = 2024;
+static unsigned next_random(){
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// 和标准库的结果逐个比较, 覆盖各种长度、起始偏移和取值范围(取值范围小的时候重复元素多)
+template <class T>
+bool check_search(){
+    bool ok = true;
+    T buf[2600];
+    for (int round = 0; round < 300; ++round){
+        size_t n = next_random() % 2500;
+        size_t offset = next_random() % 8;
+        unsigned range = round % 3 == 0 ? 4 : 100;
+        T *first = buf + offset, *last = first + n;
+        for (T *p = first; p != last; ++p)
+            *p = (T)(next_random() % range);
+        T value = (T)(next_random() % range);
+        const T *cfirst = first, *clast = last;
+        ok = ok && TinySTL::find(first, last, value) == std::find(first, last, value);
+        ok = ok && TinySTL::find(cfirst, clast, value) == std::find(cfirst, clast, value);
+        ok = ok && TinySTL::count(first, last, value) == std::count(first, last, value);
+        ok = ok && TinySTL::min_element(first, last) == std::min_element(first, last);
+        ok = ok && TinySTL::max_element(first, last) == std::max_element(first, last);
+        ok = ok && TinySTL::minmax_element(first, last) == std::minmax_element(first, last);
+        ok = ok && TinySTL::accumulate(first, last, T(1)) == std::accumulate(first, last, T(1));
+        T copy[2600];
+        memcpy(copy, first, n * sizeof(T));
+        ok = ok && TinySTL::equal(first, last, copy);
+        if(n > 0){
+            copy[next_random() % n] = (T)(range + 1);
+            ok = ok && !TinySTL::equal(first, last, copy);
+        }
+    }
+    return ok;
+}
+
+// 浮点数中有NaN和正负零时, 结果要和逐个比较完全相同
+template <class T>
+bool check_float_special(){
+    bool ok = true;
+    T buf[100];
+    for (int i = 0; i < 100; ++i)
+        buf[i] = (T)(i % 7);
+    buf[3] = (T)-0.0;
+    buf[50] = (T)0.0;
+    ok = ok && TinySTL::min_element(buf, buf + 100) == std::min_element(buf, buf + 100);
+    ok = ok && TinySTL::find(buf, buf + 100, (T)0.0) == buf;
+    ok = ok && TinySTL::count(buf, buf + 100, (T)-0.0) == std::count(buf, buf + 100, (T)-0.0);
+    buf[40] = (T)NAN;
+    ok = ok && TinySTL::min_element(buf, buf + 100) == std::min_element(buf, buf + 100);
+    ok = ok && TinySTL::max_element(buf, buf + 100) == std::max_element(buf, buf + 100);
+    ok = ok && TinySTL::minmax_element(buf, buf + 100) == std::minmax_element(buf, buf + 100);
+    ok = ok && TinySTL::find(buf, buf + 100, (T)NAN) == buf + 100;
+    ok = ok && !TinySTL::equal(buf, buf + 100, buf);
+    buf[0] = (T)NAN; // 第一个元素就是NaN
+    ok = ok && TinySTL::min_element(buf, buf + 100) == std::min_element(buf, buf + 100);
+    return ok;
+}
+
+bool test_search(){
+    bool ok = check_search<char>() && check_search<signed char>() && check_search<unsigned char>();
+    ok = check_search<short>() && check_search<unsigned short>() && ok;
+    ok = check_search<int>() && check_search<unsigned int>() && ok;
+    ok = check_search<long long>() && check_search<unsigned long long>() && ok;
+    ok = check_search<float>() && check_search<double>() && ok;
+    // 没有向量化内核的算术型别逐个元素处理
+    ok = check_search<long double>() && ok;
+    ok = check_float_special<float>() && check_float_special<double>() && ok;
+
+    // 查找的值和元素型别不同
+    TinySTL::vector<double> d(10, 1.5);
+    d[7] = 2;
+    ok = ok && TinySTL::find(d.begin(), d.end(), 2) == d.begin() + 7;
+    ok = ok && TinySTL::accumulate(d.begin(), d.end(), 0) == 11; // init是int, 每一步都截断成int
+
+    // list的迭代器走逐个元素处理的版本
+    TinySTL::list<int> l;
+    for (int i = 0; i < 100; ++i)
+        l.push_back((i * 37) % 100);
+    ok = ok && *TinySTL::find(l.begin(), l.end(), 74) == 74 && TinySTL::count(l.begin(), l.end(), 5) == 1;
+    ok = ok && *TinySTL::min_element(l.begin(), l.end()) == 0 && *TinySTL::max_element(l.begin(), l.end()) == 99;
+    ok = ok && TinySTL::accumulate(l.begin(), l.end(), 0) == 4950;
+    ok = ok && TinySTL::equal(l.begin(), l.end(), l.begin());
+    return ok;
+}
+
+// 生成各种分布的输入: 随机、有序、逆序、大量重复、全部相等、先升后降、有序后追加随机元素
+static void make_input(std::vector<int> &v, size_t n, int kind){
+    v.resize(n);
+    for (size_t i = 0; i < n; ++i){
+        switch(kind){
+        case 0: v[i] = (int)next_random(); break;
+        case 1: v[i] = (int)i; break;
+        case 2: v[i] = (int)(n - i); break;
+        case 3: v[i] = (int)(next_random() % 16); break;
+        case 4: v[i] = 42; break;
+        case 5: v[i] = (int)(i < n / 2 ? i : n - i); break;
+        default: v[i] = i + 10 < n ? (int)i : (int)next_random(); break;
+        }
+    }
+}
+
+static void load(TinySTL::vector<int> &v, const std::vector<int> &input){
+    TinySTL::vector<int> tmp(input.size());
+    std::copy(input.begin(), input.end(), tmp.begin());
+    v.swap(tmp);
+}
+
+struct keyed{
+    int key, order;
+};
+static bool key_less(const keyed &a, const keyed &b) { return a.key < b.key; }
+
+bool test_sort(){
+    bool ok = true;
+    std::vector<int> input, expect;
+    const size_t sizes[] = {0, 1, 2, 3, 5, 23, 24, 25, 100, 129, 1000, 4097, 100000};
+    for (int kind = 0; kind < 7; ++kind){
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s){
+            make_input(input, sizes[s], kind);
+            expect = input;
+            std::sort(expect.begin(), expect.end());
+
+            TinySTL::vector<int> v;
+            load(v, input);
+            TinySTL::sort(v.begin(), v.end());
+            ok = ok && std::equal(v.begin(), v.end(), expect.begin());
+
+            load(v, input);
+            TinySTL::sort(v.begin(), v.end(), std::greater<int>());
+            ok = ok && std::equal(v.begin(), v.end(), expect.rbegin());
+
+            load(v, input);
+            TinySTL::stable_sort(v.begin(), v.end());
+            ok = ok && std::equal(v.begin(), v.end(), expect.begin());
+
+            // 非算术型别走有分支的分割
+            std::vector<std::string> strs, sorted_strs;
+            for (size_t i = 0; i < input.size() && i < 5000; ++i)
+                strs.push_back(std::to_string(input[i]));
+            sorted_strs = strs;
+            std::sort(sorted_strs.begin(), sorted_strs.end());
+            TinySTL::sort(strs.data(), strs.data() + strs.size()); // std::vector的迭代器没有TinySTL的iterator_category, 用指针
+            ok = ok && strs == sorted_strs;
+
+            if(!input.empty()){
+                size_t k = next_random() % input.size();
+                load(v, input);
+                TinySTL::nth_element(v.begin(), v.begin() + k, v.end());
+                ok = ok && v[k] == expect[k];
+                for (size_t i = 0; i < v.size(); ++i)
+                    ok = ok && (i < k ? v[i] <= v[k] : v[i] >= v[k]);
+
+                load(v, input);
+                TinySTL::partial_sort(v.begin(), v.begin() + k, v.end());
+                ok = ok && std::equal(v.begin(), v.begin() + k, expect.begin());
+            }
+        }
+    }
+
+    // 稳定性: 键相同的元素保持原来的次序
+    std::vector<keyed> items(50000);
+    for (size_t i = 0; i < items.size(); ++i){
+        items[i].key = (int)(next_random() % 100);
+        items[i].order = (int)i;
+    }
+    TinySTL::stable_sort(items.data(), items.data() + items.size(), key_less);
+    for (size_t i = 1; i < items.size(); ++i)
+        ok = ok && (items[i - 1].key < items[i].key ||
+                    (items[i - 1].key == items[i].key && items[i - 1].order < items[i].order));
+
+    // 堆操作
+    std::vector<int> h;
+    make_input(h, 1000, 0);
+    TinySTL::make_heap(h.data(), h.data() + h.size());
+    ok = ok && std::is_heap(h.begin(), h.end());
+    h.push_back(-7);
+    TinySTL::push_heap(h.data(), h.data() + h.size());
+    ok = ok && std::is_heap(h.begin(), h.end());
+    int top = h.front();
+    TinySTL::pop_heap(h.data(), h.data() + h.size());
+    ok = ok && h.back() == top && std::is_heap(h.begin(), h.end() - 1);
+    TinySTL::sort_heap(h.data(), h.data() + h.size() - 1);
+    ok = ok && std::is_sorted(h.begin(), h.end());
+
+    // 原生数组和double
+    double d[7] = {3.5, -1, 2, 2, 9, 0.5, -1};
+    TinySTL::sort(d, d + 7);
+    ok = ok && std::is_sorted(d, d + 7) && d[0] == -1 && d[6] == 9;
+    return ok;
+}
+
+template <class T>
+bool check_radix(T (*gen)()){
+    bool ok = true;
+    const size_t sizes[] = {0, 1, 2, 63, 64, 65, 1000, 100000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s){
+        std::vector<T> v(sizes[s]);
+        for (size_t i = 0; i < v.size(); ++i)
+            v[i] = gen();
+        std::vector<T> expect = v;
+        std::sort(expect.begin(), expect.end());
+        TinySTL::radix_sort(v.data(), v.data() + v.size());
+        ok = ok && v == expect;
+    }
+    return ok;
+}
+static unsigned gen_u32() { return next_random() * 2654435761u; }
+static int gen_i32() { return (int)(next_random() * 2654435761u); }
+static long long gen_i64() { return (long long)(((unsigned long long)gen_u32() << 32) ^ next_random()); }
+static unsigned long long gen_small_u64() { return next_random() % 1000; } // 高位字节都相同, 会跳过那几趟
+static signed char gen_i8() { return (signed char)next_random(); }
+static float gen_float() { return ((float)gen_i32()) / 1e6f; }
+static double gen_double() { return ((double)gen_i64()) / 1e12; }
+
+struct record{
+    unsigned key;
+    std::string payload;
+};
+struct record_key{
+    unsigned operator()(const record &r) const { return r.key; }
+};
+
+bool test_radix_sort(){
+    bool ok = check_radix<unsigned>(gen_u32) && check_radix<int>(gen_i32);
+    ok = check_radix<long long>(gen_i64) && check_radix<unsigned long long>(gen_small_u64) && ok;
+    ok = check_radix<signed char>(gen_i8) && ok;
+    ok = check_radix<float>(gen_float) && check_radix<double>(gen_double) && ok;
+
+    // 浮点数的特殊值: -0.0排在+0.0前面, 无穷大在两端
+    TinySTL::vector<float> f;
+    const float specials[] = {0.0f, -0.0f, INFINITY, -INFINITY, 1.0f, -1.0f, 1e-40f, -1e-40f};
+    for (int r = 0; r < 20; ++r)
+        for (size_t i = 0; i < 8; ++i)
+            f.push_back(specials[i]);
+    TinySTL::radix_sort(f.begin(), f.end());
+    ok = ok && std::is_sorted(f.begin(), f.end()) && f[0] == -INFINITY && f.back() == INFINITY;
+    ok = ok && std::signbit(f[79]) && !std::signbit(f[80]) && f[79] == 0.0f;
+
+    // 用键提取函数排序带有非平凡成员的结构体, 相同键保持原来的次序
+    std::vector<record> recs(20000);
+    for (size_t i = 0; i < recs.size(); ++i){
+        recs[i].key = next_random() % 300;
+        recs[i].payload = std::to_string(i);
+    }
+    TinySTL::radix_sort(recs.data(), recs.data() + recs.size(), record_key());
+    for (size_t i = 1; i < recs.size(); ++i)
+        ok = ok && (recs[i - 1].key < recs[i].key ||
+                    (recs[i - 1].key == recs[i].key && std::stoi(recs[i - 1].payload) < std::stoi(recs[i].payload)));
+    return ok;
+}
+
+int main()
+{
+    bool ok = test_fill();
+    std::cout << "fill: " << (ok ? "ok" : "FAILED") << std::endl;
+    bool search_ok = test_search();
+    std::cout << "search and reduction: " << (search_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && search_ok;
+    bool sort_ok = test_sort();
+    std::cout << "sort: " << (sort_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && sort_ok;
+    bool radix_ok = test_radix_sort();
+    std::cout << "radix sort: " << (radix_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && radix_ok;
+    return ok ? 0 : 1;
+}
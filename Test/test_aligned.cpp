@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstring>
+#include "../vector.h"
+#include "../list.h"
+#include "../Sources/alloc.cpp"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+// 对齐要求超过8字节的型别的配置测试
+
+struct alignas(16) vec4{
+    float x, y, z, w;
+};
+
+struct alignas(32) block32{
+    double d[3];
+};
+
+// 按cache line对齐, 避免伪共享的计数器
+struct alignas(64) padded_counter{
+    long value;
+};
+
+static bool is_aligned(const void *p, size_t alignment){
+    return ((size_t)p & (alignment - 1)) == 0;
+}
+
+// vector的每次扩容都要保持对齐
+template<class T>
+bool check_vector(int n){
+    TinySTL::vector<T> v;
+    for (int i = 0; i < n; ++i){
+        v.push_back(T());
+        if(!is_aligned(&v[0], alignof(T)))
+            return false;
+    }
+    return v.size() == (size_t)n;
+}
+
+// list的节点包含一个over-aligned的成员, 节点本身也必须按它对齐
+template<class T>
+bool check_list(int n){
+    TinySTL::list<T> l;
+    for (int i = 0; i < n; ++i)
+        l.push_back(T());
+    for (typename TinySTL::list<T>::iterator it = l.begin(); it != l.end(); ++it)
+        if(!is_aligned(&*it, alignof(T)))
+            return false;
+    return l.size() == (size_t)n;
+}
+
+namespace TinySTL{
+    // 内存池起始处不对齐、剩余的字节数比一个区块多一点时, chunk_alloc要把超过__MAX_BYTES的零头挂到链表上
+    struct __alloc_test_access{
+        static bool unaligned_pool_leftover(){
+            // 这块内存会留在中心仓库的链表上, 它不属于任何chunk, 因此放在最后检查, 之后不再trim
+            alignas(64) static char pool[2 * Alloc::__MAX_BYTES];
+            depot_lock lock(depot_mutex);
+            // 原来内存池中剩下的部分先挂到链表上
+            Alloc::give_to_free_lists(Alloc::start_free, Alloc::end_free - Alloc::start_free);
+            const size_t leftover = Alloc::__MAX_BYTES + 8;
+            const size_t before = Alloc::depot_free_bytes;
+            Alloc::start_free = pool + 8;
+            Alloc::end_free = Alloc::start_free + leftover;
+            int nobjs = 1;
+            char *p = Alloc::chunk_alloc(Alloc::__MAX_BYTES, nobjs);
+            // 零头全部挂到链表上, 新chunk开头不对齐的部分也会挂上去
+            return nobjs == 1 && ((size_t)p & 63) == 0 && Alloc::depot_free_bytes >= before + leftover;
+        }
+    };
+}
+
+int main()
+{
+    bool ok = true;
+
+    // 各种大小和对齐混在一起申请, 让内存池的起始位置不断错开
+    const size_t alignments[] = {8, 16, 32, 64, 128, 4096};
+    void *ptrs[600];
+    size_t sizes[600], aligns[600];
+    for (int i = 0; i < 600; ++i){
+        sizes[i] = 1 + (i * 37) % 5000;
+        aligns[i] = alignments[i % 6];
+        ptrs[i] = TinySTL::Alloc::allocate(sizes[i], aligns[i]);
+        if(!is_aligned(ptrs[i], aligns[i]))
+            ok = false;
+        memset(ptrs[i], i & 0xff, sizes[i]);
+    }
+    for (int i = 0; i < 600; ++i){
+        unsigned char *p = (unsigned char *)ptrs[i];
+        for (size_t k = 0; k < sizes[i]; ++k)
+            if(p[k] != (unsigned char)(i & 0xff))
+                ok = false;
+        // 扩大之后内容不变, 并且仍然对齐
+        ptrs[i] = TinySTL::Alloc::reallocate(ptrs[i], sizes[i], sizes[i] * 2, aligns[i]);
+        p = (unsigned char *)ptrs[i];
+        if(!is_aligned(p, aligns[i]) || p[0] != (unsigned char)(i & 0xff) || p[sizes[i] - 1] != (unsigned char)(i & 0xff))
+            ok = false;
+        TinySTL::Alloc::deallocate(ptrs[i], sizes[i] * 2, aligns[i]);
+    }
+    std::cout << "Alloc aligned test: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    ok = check_vector<vec4>(1000) && ok;
+    ok = check_vector<block32>(1000) && ok;
+    ok = check_vector<padded_counter>(1000) && ok;
+    ok = check_list<block32>(1000) && ok;
+    ok = check_list<padded_counter>(1000) && ok;
+#ifdef __AVX__
+    ok = check_vector<__m256>(1000) && ok;
+    ok = check_list<__m256>(1000) && ok;
+#endif
+    std::cout << "container aligned test: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    // 显式要求按cache line对齐的缓冲区
+    char *buf = TinySTL::allocator<char>::allocate(100, 64);
+    ok = ok && is_aligned(buf, 64);
+    TinySTL::allocator<char>::deallocate(buf, 100, 64);
+
+    bool leftover_ok = TinySTL::__alloc_test_access::unaligned_pool_leftover();
+    std::cout << "unaligned pool leftover: " << (leftover_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && leftover_ok;
+
+    std::cout << "aligned test: " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
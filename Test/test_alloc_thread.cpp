@@ -0,0 +1,160 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 多线程下的压力测试和吞吐量测试
+
+static const int kMaxThreads = 8;
+
+// 每个线程随机申请、填充、校验、释放各种大小的区块
+void stress_worker(int id, int rounds, bool *ok){
+    const int kSlots = 512;
+    void *ptrs[kSlots] = {0};
+    size_t sizes[kSlots] = {0};
+    unsigned seed = 12345u + id * 7919u;
+    for (int r = 0; r < rounds; ++r){
+        seed = seed * 1103515245u + 12345u;
+        int slot = (seed >> 8) % kSlots;
+        if(ptrs[slot]){
+            // 校验区块内容没有被别的线程改写
+            unsigned char *p = (unsigned char *)ptrs[slot];
+            for (size_t i = 0; i < sizes[slot]; ++i){
+                if(p[i] != (unsigned char)(slot + id)){
+                    *ok = false;
+                    break;
+                }
+            }
+            TinySTL::Alloc::deallocate(ptrs[slot], sizes[slot]);
+            ptrs[slot] = 0;
+        }
+        else{
+            sizes[slot] = 1 + (seed >> 16) % 5000; // 偶尔会走到大于4096字节的malloc分支
+            ptrs[slot] = TinySTL::Alloc::allocate(sizes[slot]);
+            memset(ptrs[slot], slot + id, sizes[slot]);
+        }
+    }
+    for (int i = 0; i < kSlots; ++i)
+        if(ptrs[i])
+            TinySTL::Alloc::deallocate(ptrs[i], sizes[i]);
+}
+
+// 每个线程各自使用TinySTL::vector
+void vector_worker(int id, bool *ok){
+    for (int r = 0; r < 200; ++r){
+        TinySTL::vector<int> v;
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i + id);
+        for (int i = 0; i < 100; ++i)
+            if(v[i] != i + id)
+                *ok = false;
+    }
+}
+
+// 一个线程申请, 另一个线程释放, 区块会在不同线程的缓存之间流动
+void cross_thread_test(bool *ok){
+    const int n = 100000;
+    void **ptrs = (void **)malloc(n * sizeof(void *));
+    std::thread producer([&]{
+        for (int i = 0; i < n; ++i){
+            ptrs[i] = TinySTL::Alloc::allocate(24);
+            *(int *)ptrs[i] = i;
+        }
+    });
+    producer.join();
+    std::thread consumer([&]{
+        for (int i = 0; i < n; ++i){
+            if(*(int *)ptrs[i] != i)
+                *ok = false;
+            TinySTL::Alloc::deallocate(ptrs[i], 24);
+        }
+    });
+    consumer.join();
+    free(ptrs);
+}
+
+// 比线程缓存先构造的thread_local对象在线程缓存析构之后才析构, 它释放的区块要回到中心仓库
+struct late_holder{
+    void *p;
+    ~late_holder(){
+        if(p)
+            TinySTL::Alloc::deallocate(p, 3000);
+    }
+};
+// 同一个文件里的thread_local变量按定义的次序一起构造, 所以用函数内的thread_local, 保证它先于线程缓存构造
+late_holder &late(){
+    static thread_local late_holder h;
+    return h;
+}
+
+void late_free_worker(){
+    late_holder &h = late();
+    h.p = TinySTL::Alloc::allocate(3000);
+}
+
+// 很多线程各自留一个区块到线程缓存析构之后才释放, 这些区块不能丢在已经析构的缓存里, 否则内存只增不减
+void late_free_test(bool *ok){
+    TinySTL::Alloc::stats before, after;
+    TinySTL::Alloc::get_stats(before);
+    const int n = 2000;
+    for (int i = 0; i < n; ++i){
+        std::thread t(late_free_worker);
+        t.join();
+    }
+    TinySTL::Alloc::get_stats(after);
+    if(after.heap_size - before.heap_size > n * 3072 / 4)
+        *ok = false;
+    // 计数器没有定义时不检查; 定义了时每次申请都有对应的释放
+    for (size_t i = 0; after.enabled && i < TinySTL::Alloc::stats::class_count; ++i)
+        if(after.classes[i].alloc_count - before.classes[i].alloc_count != after.classes[i].free_count - before.classes[i].free_count)
+            *ok = false;
+}
+
+// 每个线程反复申请释放一批小区块, 统计总的吞吐量
+void throughput_worker(int ops){
+    void *ptrs[64];
+    for (int r = 0; r < ops / 64; ++r){
+        for (int i = 0; i < 64; ++i)
+            ptrs[i] = TinySTL::Alloc::allocate(8 + (i & 7) * 8);
+        for (int i = 0; i < 64; ++i)
+            TinySTL::Alloc::deallocate(ptrs[i], 8 + (i & 7) * 8);
+    }
+}
+
+int main()
+{
+    bool ok = true;
+    std::thread threads[kMaxThreads];
+
+    for (int i = 0; i < kMaxThreads; ++i)
+        threads[i] = std::thread(stress_worker, i, 200000, &ok);
+    for (int i = 0; i < kMaxThreads; ++i)
+        threads[i].join();
+    std::cout << "stress test: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    for (int i = 0; i < kMaxThreads; ++i)
+        threads[i] = std::thread(vector_worker, i, &ok);
+    for (int i = 0; i < kMaxThreads; ++i)
+        threads[i].join();
+    std::cout << "vector test: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    cross_thread_test(&ok);
+    std::cout << "cross thread test: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    late_free_test(&ok);
+    std::cout << "free after thread cache teardown: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    const int ops = 4000000;
+    for (int n = 1; n <= kMaxThreads; n *= 2){
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i)
+            threads[i] = std::thread(throughput_worker, ops);
+        for (int i = 0; i < n; ++i)
+            threads[i].join();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << n << " threads: " << (2.0 * ops * n / sec / 1e6) << " M ops/s" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
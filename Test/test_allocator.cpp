@@ -1,3 +1,4 @@
+#define TINYSTL_ALLOC_STATS // 打开分配器的统计信息
 #include <iostream>
 #include <vector>
 #include "../allocator.h"
@@ -10,6 +11,63 @@ int main()
     vector<int, TinySTL::allocator<int>> v;
     for (int i = 0; i < 10000000;++i)
         v.push_back(i);
-    cout << v.capacity();
-    return 0;
-}
\ No newline at end of file
+    cout << v.capacity() << endl;
+
+    // 申请大量小区块再全部释放, trim之后这些chunk应该都能还给系统
+    const int n = 1000000;
+    void **ptrs = (void **)malloc(n * sizeof(void *));
+    for (int i = 0; i < n; ++i)
+        ptrs[i] = TinySTL::Alloc::allocate(8 + (i % 16) * 8);
+    for (int i = 0; i < n; ++i)
+        TinySTL::Alloc::deallocate(ptrs[i], 8 + (i % 16) * 8);
+    size_t released = TinySTL::Alloc::trim();
+    cout << "trim released " << released << " bytes" << endl;
+
+    // 打开自动trim后再来一次, 大部分chunk应该在释放的过程中就已经被归还了
+    TinySTL::Alloc::set_trim_threshold(1 << 20);
+    for (int i = 0; i < n; ++i)
+        ptrs[i] = TinySTL::Alloc::allocate(8 + (i % 16) * 8);
+    for (int i = 0; i < n; ++i)
+        TinySTL::Alloc::deallocate(ptrs[i], 8 + (i % 16) * 8);
+    size_t remain = TinySTL::Alloc::trim();
+    cout << "after auto trim, trim released " << remain << " bytes" << endl;
+    TinySTL::Alloc::set_trim_threshold(0);
+
+    // 显式trim只归还内存, 不减少各档的搬运个数
+    // 留一个区块不释放, 它所在的chunk不会被trim归还, 之后的refill都能直接从中心仓库取到区块, 搬运个数不会翻倍
+    TinySTL::Alloc::set_adaptive_refill(true);
+    for (int i = 0; i < 100; ++i)
+        ptrs[i] = TinySTL::Alloc::allocate(48);
+    for (int i = 1; i < 100; ++i)
+        TinySTL::Alloc::deallocate(ptrs[i], 48);
+    TinySTL::Alloc::stats before_trim, after_trim;
+    TinySTL::Alloc::get_stats(before_trim);
+    for (int i = 0; i < 3; ++i){
+        void *p = TinySTL::Alloc::allocate(48);
+        TinySTL::Alloc::deallocate(p, 48);
+        TinySTL::Alloc::trim();
+    }
+    TinySTL::Alloc::get_stats(after_trim);
+    TinySTL::Alloc::deallocate(ptrs[0], 48);
+    bool batch_kept = true;
+    for (int i = 0; i < TinySTL::Alloc::stats::class_count; ++i)
+        if(before_trim.classes[i].block_size == 48)
+            batch_kept = after_trim.classes[i].batch_objs == before_trim.classes[i].batch_objs;
+    cout << "trim keeps batch size: " << (batch_kept ? "ok" : "FAILED") << endl;
+
+    // 留一部分区块不释放, 看看统计信息
+    for (int i = 0; i < 1000; ++i)
+        ptrs[i] = TinySTL::Alloc::allocate(8 + (i % 16) * 8);
+    TinySTL::Alloc::stats s;
+    TinySTL::Alloc::get_stats(s);
+    size_t live = 0;
+    for (int i = 0; i < TinySTL::Alloc::stats::class_count; ++i)
+        live += s.classes[i].live_blocks;
+    cout << "live blocks: " << live << endl;
+    TinySTL::Alloc::print_stats();
+    TinySTL::Alloc::print_stats_json();
+    for (int i = 0; i < 1000; ++i)
+        TinySTL::Alloc::deallocate(ptrs[i], 8 + (i % 16) * 8);
+    free(ptrs);
+    return released > 0 && remain < released && live == 1000 && batch_kept ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include "../arena.h"
+#include "../vector.h"
+#include "../list.h"
+#include "../Sources/alloc.cpp"
+
+// 模拟一个请求: 在arena上建一批临时的vector和list, 请求结束时整体释放
+bool handle_request(TinySTL::arena &region, int id){
+    typedef TinySTL::arena_allocator<int> int_alloc;
+    bool ok = true;
+    for (int k = 0; k < 20; ++k){
+        TinySTL::vector<int, int_alloc> v((int_alloc(region)));
+        TinySTL::list<int, int_alloc> l((int_alloc(region)));
+        for (int i = 0; i < 1000; ++i){
+            v.push_back(i + id);
+            l.push_back(i * 2);
+        }
+        int i = 0;
+        for (TinySTL::list<int, int_alloc>::iterator it = l.begin(); it != l.end(); ++it, ++i)
+            if(*it != i * 2 || v[i] != i + id)
+                ok = false;
+        if(l.size() != 1000 || v.size() != 1000)
+            ok = false;
+    }
+    return ok;
+}
+
+int main()
+{
+    TinySTL::arena region;
+    bool ok = true;
+    for (int r = 0; r < 100; ++r){
+        ok = handle_request(region, r) && ok;
+        if(r == 0)
+            std::cout << "one request used " << region.bytes_used() << " bytes" << std::endl;
+        region.release(); // O(内存块个数)地释放整个请求用到的空间
+    }
+
+    // 有状态的配置器不同实例使用各自的arena
+    TinySTL::arena a1, a2;
+    TinySTL::vector<int, TinySTL::arena_allocator<int> > v1((TinySTL::arena_allocator<int>(a1)));
+    TinySTL::vector<int, TinySTL::arena_allocator<int> > v2((TinySTL::arena_allocator<int>(a2)));
+    v1.push_back(1);
+    v2.push_back(2);
+    v2.push_back(3);
+    ok = ok && a1.bytes_used() > 0 && a2.bytes_used() > a1.bytes_used();
+    ok = ok && v1.get_allocator() != v2.get_allocator();
+
+    // swap时配置器跟着节点走, 之后新的节点从原来那条链表的arena上配置
+    {
+        typedef TinySTL::list<int, TinySTL::arena_allocator<int> > arena_list;
+        TinySTL::arena b1, b2;
+        arena_list l1((TinySTL::arena_allocator<int>(b1))), l2((TinySTL::arena_allocator<int>(b2)));
+        l1.push_back(1);
+        l2.push_back(2);
+        l1.swap(l2);
+        ok = ok && l1.get_allocator() == TinySTL::arena_allocator<int>(b2);
+        ok = ok && l2.get_allocator() == TinySTL::arena_allocator<int>(b1);
+        const size_t used1 = b1.bytes_used(), used2 = b2.bytes_used();
+        for (int i = 0; i < 10000; ++i)
+            l1.push_back(i);
+        ok = ok && b1.bytes_used() == used1 && b2.bytes_used() > used2;
+        ok = ok && l1.front() == 2 && l1.size() == 10001 && l2.front() == 1 && l2.size() == 1;
+        // 换回来以后各自回到原来的arena
+        l1.swap(l2);
+        ok = ok && l1.get_allocator() == TinySTL::arena_allocator<int>(b1) && l1.front() == 1;
+    }
+
+    // 默认配置器的list现在配置的是整个节点
+    TinySTL::list<int> l;
+    for (int i = 0; i < 5; ++i)
+        l.push_back(i);
+    ok = ok && l.size() == 5 && l.back() == 4;
+
+    std::cout << "arena test: " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+#include <iostream>
+#include <string>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <stdint.h>
+#include "../btree_map.h"
+#include "../btree_set.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// btree_map和btree_set的测试: 随机的插入、删除和std::map逐步对照, 遍历、区间查找、有序批量构造
+
+typedef basic_counted<int> counted;
+
+// 很大的元素, 一个节点只放得下3个, 用来制造很高的树
+struct wide{
+    int key;
+    std::string payload;
+    char pad[100];
+    wide(int k = 0) : key(k), payload(std::to_string(k)) { pad[0] = 0; }
+    bool operator<(const wide &x) const { return key < x.key; }
+};
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class Map, class Ref>
+bool same(Map &m, Ref &ref){
+    if(m.size() != ref.size())
+        return false;
+    typename Ref::iterator r = ref.begin();
+    for (typename Map::iterator it = m.begin(); it != m.end(); ++it, ++r)
+        if(r == ref.end() || it->first != r->first || it->second != r->second)
+            return false;
+    if(r != ref.end())
+        return false;
+    // 反向遍历
+    typename Ref::reverse_iterator rr = ref.rbegin();
+    for (typename Map::iterator it = m.end(); it != m.begin(); ++rr){
+        --it;
+        if(it->first != rr->first)
+            return false;
+    }
+    return true;
+}
+
+template <class Map>
+bool check_random(int key_range){
+    bool ok = true;
+    Map m;
+    std::map<int, int> ref;
+    for (int step = 0; step < 200000 && ok; ++step){
+        const int key = (int)(next_random() % key_range);
+        switch(next_random() % 6){
+        case 0:
+        case 1:
+            ok = m.insert(std::make_pair(key, step)).second == ref.insert(std::make_pair(key, step)).second;
+            break;
+        case 2:
+            m[key] = step;
+            ref[key] = step;
+            break;
+        case 3:
+            ok = m.erase(key) == ref.erase(key);
+            break;
+        case 4:{
+            // erase返回下一个元素
+            typename Map::iterator it = m.lower_bound(key);
+            std::map<int, int>::iterator r = ref.lower_bound(key);
+            ok = (it == m.end()) == (r == ref.end());
+            if(ok && it != m.end()){
+                ok = it->first == r->first;
+                it = m.erase(it);
+                r = ref.erase(r);
+                ok = ok && (it == m.end()) == (r == ref.end()) && (it == m.end() || it->first == r->first);
+            }
+            break;
+        }
+        default:{
+            typename Map::iterator it = m.upper_bound(key);
+            std::map<int, int>::iterator r = ref.upper_bound(key);
+            ok = (it == m.end()) == (r == ref.end()) && (it == m.end() || it->first == r->first);
+            ok = ok && (m.find(key) == m.end()) == (ref.find(key) == ref.end());
+        }
+        }
+        if(step % 10007 == 0)
+            ok = ok && same(m, ref);
+    }
+    return ok && same(m, ref);
+}
+
+bool check_interface(){
+    bool ok = true;
+    TinySTL::btree_map<std::string, int> m;
+    ok = ok && m.empty() && m.begin() == m.end() && m.find("none") == m.end() && m.lower_bound("a") == m.end();
+    for (int i = 0; i < 1000; ++i)
+        m.emplace(std::to_string(i), i);
+    ok = ok && m.size() == 1000 && m["999"] == 999 && m.at("5") == 5 && !m.emplace("5", 0).second;
+    ok = ok && m.begin()->first == "0" && (--m.end())->first == "999";
+
+    // try_emplace在键已经存在时不移动参数
+    std::string value = "moved?";
+    TinySTL::btree_map<int, std::string> s;
+    s.try_emplace(1, "one");
+    ok = ok && !s.try_emplace(1, std::move(value)).second && value == "moved?" && s[1] == "one";
+
+    bool thrown = false;
+    try{
+        m.at("missing");
+    }
+    catch(const std::out_of_range &){
+        thrown = true;
+    }
+    ok = ok && thrown;
+
+    // 区间删除
+    TinySTL::btree_map<std::string, int>::iterator first = m.lower_bound("2"), last = m.lower_bound("5");
+    TinySTL::btree_map<std::string, int>::iterator next = m.erase(first, last);
+    ok = ok && next->first == "5" && m.size() == 667 && m.count("3") == 0 && m.count("20") == 0 && m.count("1") == 1;
+    std::pair<TinySTL::btree_map<std::string, int>::iterator, TinySTL::btree_map<std::string, int>::iterator> range = m.equal_range("7");
+    ok = ok && range.first->first == "7" && range.second->first == "70";
+
+    // 复制、移动、swap、clear
+    TinySTL::btree_map<std::string, int> copy(m);
+    ok = ok && copy.size() == 667 && copy["123"] == 123;
+    TinySTL::btree_map<std::string, int> moved(std::move(copy));
+    ok = ok && copy.empty() && moved.size() == 667;
+    copy = moved;
+    moved.clear();
+    ok = ok && moved.empty() && moved.begin() == moved.end() && copy.size() == 667;
+    TinySTL::swap(moved, copy);
+    ok = ok && copy.empty() && moved["142"] == 142;
+    moved.erase(moved.begin(), moved.end());
+    ok = ok && moved.empty();
+
+    // 插入树中已有元素的值, 挪动元素时参数不能失效
+    TinySTL::btree_map<int, std::string> grow;
+    grow[100000] = std::string(100, 'x');
+    for (int i = 0; i < 10000; ++i)
+        grow.try_emplace(i, grow[100000]);
+    ok = ok && grow.size() == 10001 && grow[9999] == std::string(100, 'x');
+
+    TinySTL::btree_map<int, int> init = {{1, 2}, {3, 4}, {1, 5}};
+    ok = ok && init.size() == 2 && init[1] == 2 && init[3] == 4;
+    return ok;
+}
+
+bool check_bulk_load(){
+    bool ok = true;
+    TinySTL::vector<int> sorted;
+    for (int i = 0; i < 1000000; ++i)
+        sorted.push_back(i * 2);
+    TinySTL::btree_set<int> s(sorted.begin(), sorted.end());
+    ok = ok && s.size() == sorted.size() && *s.begin() == 0 && *--s.end() == 1999998;
+    ok = ok && *s.lower_bound(1001) == 1002 && *s.upper_bound(1002) == 1004 && s.lower_bound(1999999) == s.end();
+    int expected = 0;
+    for (TinySTL::btree_set<int>::iterator it = s.begin(); it != s.end(); ++it, expected += 2)
+        ok = ok && *it == expected;
+    // 乱序、重复的输入也能正确处理
+    const int messy[] = {5, 3, 9, 3, 1, 9, 7};
+    TinySTL::btree_set<int> t(messy, messy + 7);
+    ok = ok && t.size() == 5 && *t.begin() == 1 && *--t.end() == 9;
+    // 从中间删掉一半, 剩下的仍然有序
+    for (int i = 0; i < 2000000; i += 4)
+        s.erase(i);
+    expected = 2;
+    for (TinySTL::btree_set<int>::iterator it = s.begin(); it != s.end(); ++it, expected += 4)
+        ok = ok && *it == expected;
+    return ok && s.size() == 500000;
+}
+
+bool check_tall_tree(){
+    bool ok = true;
+    TinySTL::btree_set<wide> s;
+    std::set<int> ref;
+    for (int step = 0; step < 50000 && ok; ++step){
+        const int key = (int)(next_random() % 2000);
+        if(next_random() % 3 == 0){
+            ok = s.erase(wide(key)) == ref.erase(key);
+        }
+        else{
+            ok = s.insert(wide(key)).second == ref.insert(key).second;
+        }
+    }
+    std::set<int>::iterator r = ref.begin();
+    for (TinySTL::btree_set<wide>::iterator it = s.begin(); it != s.end(); ++it, ++r)
+        ok = ok && r != ref.end() && it->key == *r && it->payload == std::to_string(*r);
+    return ok && r == ref.end() && s.size() == ref.size();
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::btree_map<int, counted> m;
+        for (int i = 0; i < 1000; ++i)
+            m.try_emplace(i * 7 % 1000, i);
+        for (int i = 0; i < 1000; i += 3)
+            m.erase(i);
+        ok = ok && counted::live == 666;
+        TinySTL::btree_map<int, counted> copy(m);
+        ok = ok && counted::live == 2 * 666;
+
+        // 复制到一半抛出异常, 已经复制的元素被析构
+        counted::copies = 0;
+        counted::throw_at = 300;
+        try{
+            TinySTL::btree_map<int, counted> bad(m);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && counted::live == 2 * 666;
+
+        // 构造新元素时抛出异常, 树不变
+        counted::copies = 0;
+        counted::throw_at = 1;
+        const counted c(7);
+        try{
+            m.try_emplace(501, c);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && m.size() == 666 && m.count(501) == 0 && counted::live == 2 * 666 + 1;
+        m.try_emplace(501, c);
+        ok = ok && m.size() == 667 && m[501].value == 7;
+        copy.clear();
+        ok = ok && counted::live == 667 + 1;
+    }
+    return ok && counted::live == 0;
+}
+
+int main()
+{
+    bool dense_ok = check_random<TinySTL::btree_map<int, int>>(300);
+    bool sparse_ok = check_random<TinySTL::btree_map<int, int>>(100000);
+    std::cout << "btree_map random ops: " << (dense_ok && sparse_ok ? "ok" : "FAILED") << std::endl;
+    bool interface_ok = check_interface();
+    std::cout << "btree_map interface: " << (interface_ok ? "ok" : "FAILED") << std::endl;
+    bool bulk_ok = check_bulk_load();
+    std::cout << "sorted bulk load: " << (bulk_ok ? "ok" : "FAILED") << std::endl;
+    bool tall_ok = check_tall_tree();
+    std::cout << "small nodes: " << (tall_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    return dense_ok && sparse_ok && interface_ok && bulk_ok && tall_ok && lifetimes_ok ? 0 : 1;
+}
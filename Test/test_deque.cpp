@@ -0,0 +1,187 @@
+#include <iostream>
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <stdexcept>
+#include "../deque.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// deque的测试: 随机的两端插入删除、中间插入删除都和std::deque的结果相同
+
+static unsigned seed = 11;
+static unsigned next_random(){
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+typedef basic_counted<std::string, counted_nothrow_move> counted;
+
+template <class Deque, class Reference>
+bool same(Deque &a, Reference &b){
+    if(a.size() != b.size())
+        return false;
+    typename Deque::iterator it = a.begin();
+    for (size_t i = 0; i < b.size(); ++i, ++it)
+        if(!(a[i] == b[i]) || !(*it == b[i]))
+            return false;
+    return it == a.end();
+}
+
+bool check_random_ops(){
+    bool ok = true;
+    TinySTL::deque<int> d;
+    std::deque<int> ref;
+    for (int step = 0; step < 200000 && ok; ++step){
+        const unsigned op = next_random() % 16;
+        const int value = (int)(next_random() % 1000);
+        if(op < 5){
+            d.push_back(value);
+            ref.push_back(value);
+        }
+        else if(op < 10){
+            d.push_front(value);
+            ref.push_front(value);
+        }
+        else if(op < 12 && !ref.empty()){
+            d.pop_back();
+            ref.pop_back();
+        }
+        else if(op < 14 && !ref.empty()){
+            d.pop_front();
+            ref.pop_front();
+        }
+        else if(op == 14){
+            const size_t pos = ref.empty() ? 0 : next_random() % (ref.size() + 1);
+            const size_t n = next_random() % 4;
+            if(n == 0){
+                d.insert(d.begin() + pos, value);
+                ref.insert(ref.begin() + pos, value);
+            }
+            else{
+                d.insert(d.begin() + pos, n, value);
+                ref.insert(ref.begin() + pos, n, value);
+            }
+        }
+        else if(!ref.empty()){
+            const size_t pos = next_random() % ref.size();
+            const size_t n = std::min<size_t>(next_random() % 3, ref.size() - pos);
+            if(n == 0){
+                TinySTL::deque<int>::iterator it = d.erase(d.begin() + pos);
+                ref.erase(ref.begin() + pos);
+                ok = ok && it - d.begin() == (ptrdiff_t)pos;
+            }
+            else{
+                d.erase(d.begin() + pos, d.begin() + pos + n);
+                ref.erase(ref.begin() + pos, ref.begin() + pos + n);
+            }
+        }
+        if(step % 1000 == 0)
+            ok = ok && same(d, ref);
+    }
+    return ok && same(d, ref);
+}
+
+bool check_iterators(){
+    bool ok = true;
+    TinySTL::deque<int> d;
+    for (int i = 0; i < 5000; ++i)
+        d.push_front(i);
+    // 随机访问迭代器的运算跨越缓冲区边界
+    TinySTL::deque<int>::iterator first = d.begin(), last = d.end();
+    ok = ok && last - first == 5000 && first + 5000 == last && last - 5000 == first;
+    ok = ok && first[4321] == 5000 - 1 - 4321 && *(last - 1) == 0 && 3000 + first == first + 3000;
+    TinySTL::deque<int>::iterator mid = first + 2500;
+    mid -= 1999;
+    mid += 3333;
+    ok = ok && mid - first == 2500 - 1999 + 3333 && first < mid && mid <= last && last > mid;
+    TinySTL::deque<int>::const_iterator cit = mid;
+    ok = ok && cit == mid && *cit == *mid;
+    ok = ok && TinySTL::distance(first, last) == 5000;
+
+    // 可以直接用于随机访问迭代器的算法
+    TinySTL::sort(d.begin(), d.end());
+    bool sorted = true;
+    for (int i = 0; i < 5000; ++i)
+        sorted = sorted && d[i] == i;
+    ok = ok && sorted;
+
+    // 两端插入删除不会使其他元素的引用失效
+    int *p = &d[2000];
+    for (int i = 0; i < 100000; ++i){
+        d.push_back(i);
+        d.push_front(i);
+    }
+    for (int i = 0; i < 50000; ++i){
+        d.pop_back();
+        d.pop_front();
+    }
+    ok = ok && p == &d[52000] && *p == 2000;
+
+    // 只在一端进一端出(FIFO)时map不会一直增长
+    TinySTL::deque<int> fifo;
+    for (int i = 0; i < 1000000; ++i){
+        fifo.push_back(i);
+        if(i >= 100)
+            ok = ok && fifo.front() == i - 100 && (fifo.pop_front(), true);
+    }
+    ok = ok && fifo.size() == 100;
+    return ok;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::deque<counted> d;
+        for (int i = 0; i < 1000; ++i){
+            d.emplace_back("element that does not fit in the small string buffer");
+            d.emplace_front("front");
+        }
+        d.insert(d.begin() + 5, 300, counted("x"));
+        d.erase(d.begin() + 10, d.begin() + 800);
+        d.erase(d.end() - 600, d.end() - 100);
+        d.push_back(d[0]); // 引用自己的元素
+        d.insert(d.begin() + 3, d[4]);
+        TinySTL::deque<counted> copy(d);
+        ok = ok && counted::live == (int)(2 * d.size()) && copy.back().value == "front" && copy[3].value == "front" && copy[6].value == "x";
+        // 空区间什么也不删, 靠近头部和尾部时都不能把一侧的元素移动给自己
+        copy.erase(copy.begin() + 2, copy.begin() + 2);
+        copy.erase(copy.end() - 2, copy.end() - 2);
+        ok = ok && copy.size() == d.size() && copy[0].value == "front" && copy[1].value == "front" && copy.back().value == "front";
+        TinySTL::deque<counted> moved(std::move(copy));
+        ok = ok && copy.empty() && moved.size() == d.size();
+        copy = moved;
+        moved.resize(3);
+        moved.resize(10, counted("y"));
+        ok = ok && moved[9].value == "y" && counted::live == (int)(2 * d.size() + 10);
+        d.clear();
+        ok = ok && d.empty() && counted::live == (int)(copy.size() + 10);
+        d = std::move(moved);
+        ok = ok && d.size() == 10 && moved.empty();
+
+        // 复制时抛出异常, 已经构造的元素被析构
+        const int before = counted::live;
+        counted::copies = 0;
+        counted::throw_at = 1500;
+        try{
+            TinySTL::deque<counted> big(3000, counted("z"));
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && counted::live == before;
+    }
+    return ok && counted::live == 0;
+}
+
+int main()
+{
+    bool ok = check_random_ops();
+    std::cout << "deque random operations: " << (ok ? "ok" : "FAILED") << std::endl;
+    bool it_ok = check_iterators();
+    std::cout << "deque iterators: " << (it_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    return ok && it_ok && lifetimes_ok ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+#include <iostream>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <stdexcept>
+#include <stdint.h>
+#include "../flat_hash_map.h"
+#include "../flat_hash_set.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// flat_hash_map和flat_hash_set的测试: 随机的插入、删除和std::unordered_map逐步对照
+
+typedef basic_counted<int> counted;
+
+// 所有键的哈希值都相同, 用来制造很长的探测序列
+struct bad_hash{
+    size_t operator()(int) const { return 42; }
+};
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class Map>
+bool same(const Map &m, const std::unordered_map<int, int> &ref){
+    if(m.size() != ref.size())
+        return false;
+    size_t visited = 0;
+    for (typename Map::const_iterator it = m.begin(); it != m.end(); ++it, ++visited){
+        std::unordered_map<int, int>::const_iterator r = ref.find(it->first);
+        if(r == ref.end() || r->second != it->second)
+            return false;
+    }
+    return visited == ref.size();
+}
+
+// 键的范围很小, 插入和删除交替进行, 表里会留下很多墓碑
+template <class Map>
+bool check_random(int key_range){
+    bool ok = true;
+    Map m;
+    std::unordered_map<int, int> ref;
+    for (int step = 0; step < 200000 && ok; ++step){
+        const int key = (int)(next_random() % key_range);
+        switch(next_random() % 5){
+        case 0:
+        case 1:
+            ok = m.insert(std::make_pair(key, step)).second == ref.insert(std::make_pair(key, step)).second;
+            break;
+        case 2:
+            m[key] = step;
+            ref[key] = step;
+            break;
+        case 3:
+            ok = m.erase(key) == ref.erase(key);
+            break;
+        default:{
+            typename Map::iterator it = m.find(key);
+            if(it != m.end()){
+                ok = ref.count(key) == 1 && ref[key] == it->second;
+                m.erase(it);
+                ref.erase(key);
+            }
+            else{
+                ok = ref.count(key) == 0;
+            }
+        }
+        }
+        if(step % 10007 == 0)
+            ok = ok && same(m, ref);
+    }
+    ok = ok && same(m, ref) && m.load_factor() <= 0.875f;
+    return ok;
+}
+
+bool check_interface(){
+    bool ok = true;
+    TinySTL::flat_hash_map<std::string, int> m;
+    ok = ok && m.empty() && m.begin() == m.end() && m.find("none") == m.end() && m.bucket_count() == 0;
+    ok = ok && m.erase("none") == 0;
+    for (int i = 0; i < 1000; ++i)
+        m.emplace(std::to_string(i), i);
+    ok = ok && m.size() == 1000 && m["999"] == 999 && m.at("5") == 5;
+    ok = ok && !m.emplace("5", 0).second && m["5"] == 5;
+
+    // try_emplace在键已经存在时不移动参数
+    std::string value = "moved?";
+    TinySTL::flat_hash_map<int, std::string> s;
+    s.try_emplace(1, "one");
+    ok = ok && !s.try_emplace(1, std::move(value)).second && value == "moved?" && s[1] == "one";
+    ok = ok && s.try_emplace(2, std::move(value)).second && s[2] == "moved?";
+
+    bool thrown = false;
+    try{
+        m.at("missing");
+    }
+    catch(const std::out_of_range &){
+        thrown = true;
+    }
+    ok = ok && thrown;
+
+    // 复制、移动、swap、clear
+    TinySTL::flat_hash_map<std::string, int> copy(m);
+    ok = ok && copy.size() == 1000 && copy["123"] == 123;
+    TinySTL::flat_hash_map<std::string, int> moved(std::move(copy));
+    ok = ok && copy.empty() && moved.size() == 1000;
+    copy = moved;
+    moved.clear();
+    ok = ok && moved.empty() && moved.begin() == moved.end() && copy.size() == 1000;
+    TinySTL::swap(moved, copy);
+    ok = ok && copy.empty() && moved["42"] == 42;
+    moved = std::move(copy);
+    ok = ok && moved.empty();
+
+    // 插入表中已有元素的值, 引起扩容时参数不能失效
+    TinySTL::flat_hash_map<int, std::string> grow;
+    grow[0] = std::string(100, 'x');
+    for (int i = 1; i < 10000; ++i)
+        grow.try_emplace(i, grow[i - 1]);
+    ok = ok && grow.size() == 10000 && grow[9999] == std::string(100, 'x');
+
+    // reserve之后插入不会使迭代器失效
+    TinySTL::flat_hash_map<int, int> r;
+    r.reserve(5000);
+    const size_t buckets = r.bucket_count();
+    r[-1] = -1;
+    TinySTL::flat_hash_map<int, int>::iterator first = r.find(-1);
+    for (int i = 0; i < 4999; ++i)
+        r[i] = i;
+    ok = ok && r.bucket_count() == buckets && first == r.find(-1) && first->second == -1;
+    r.rehash(0);
+    ok = ok && r.size() == 5000 && r[4998] == 4998;
+
+    TinySTL::flat_hash_map<int, int> init = {{1, 2}, {3, 4}, {1, 5}};
+    ok = ok && init.size() == 2 && init[1] == 2 && init[3] == 4;
+    return ok;
+}
+
+bool check_heterogeneous(){
+    bool ok = true;
+    TinySTL::flat_hash_map<std::string, int, TinySTL::string_hash, TinySTL::string_equal> m;
+    for (int i = 0; i < 100; ++i)
+        m[std::string("key number ") + std::to_string(i)] = i;
+    // 用const char*查找, 不构造std::string
+    ok = ok && m.find("key number 17") != m.end() && m.find("key number 17")->second == 17;
+    ok = ok && m.count("key number 99") == 1 && m.count("key number 100") == 0;
+    const char *key = "key number 5";
+    ok = ok && m.find(key)->second == 5;
+
+    TinySTL::flat_hash_set<std::string, TinySTL::string_hash, TinySTL::string_equal> s = {"a", "bb", "ccc"};
+    ok = ok && s.count("bb") == 1 && s.find("d") == s.end() && s.size() == 3;
+    ok = ok && !s.insert("a").second && s.emplace("dddd").second && s.count(std::string("dddd")) == 1;
+    size_t length = 0;
+    for (TinySTL::flat_hash_set<std::string, TinySTL::string_hash, TinySTL::string_equal>::iterator it = s.begin(); it != s.end(); ++it)
+        length += it->size();
+    ok = ok && length == 10;
+    return ok;
+}
+
+bool check_collisions(){
+    bool ok = true;
+    TinySTL::flat_hash_set<int, bad_hash> s;
+    for (int i = 0; i < 2000; ++i)
+        s.insert(i);
+    for (int i = 0; i < 2000; i += 2)
+        s.erase(i);
+    for (int i = 0; i < 2000; ++i)
+        ok = ok && s.count(i) == (size_t)(i % 2);
+    for (int i = 0; i < 2000; i += 2)
+        s.insert(i);
+    ok = ok && s.size() == 2000;
+    long long sum = 0;
+    for (TinySTL::flat_hash_set<int, bad_hash>::iterator it = s.begin(); it != s.end(); ++it)
+        sum += *it;
+    return ok && sum == 1999LL * 2000 / 2;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::flat_hash_map<int, counted> m;
+        for (int i = 0; i < 1000; ++i)
+            m.try_emplace(i, i);
+        for (int i = 0; i < 1000; i += 3)
+            m.erase(i);
+        ok = ok && counted::live == 666;
+        TinySTL::flat_hash_map<int, counted> copy(m);
+        ok = ok && counted::live == 2 * 666;
+
+        // 复制到一半抛出异常, 已经复制的元素被析构
+        counted::copies = 0;
+        counted::throw_at = 300;
+        try{
+            TinySTL::flat_hash_map<int, counted> bad(m);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && counted::live == 2 * 666;
+
+        // 构造新元素时抛出异常, 表不变
+        counted::copies = 0;
+        counted::throw_at = 1;
+        const counted c(7);
+        try{
+            m.try_emplace(5000, c);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && m.size() == 666 && m.count(5000) == 0 && counted::live == 2 * 666 + 1;
+        m.try_emplace(5000, c);
+        ok = ok && m.size() == 667 && m[5000].value == 7;
+        copy.clear();
+        ok = ok && counted::live == 667 + 1;
+    }
+    return ok && counted::live == 0;
+}
+
+int main()
+{
+    bool dense_ok = check_random<TinySTL::flat_hash_map<int, int>>(100);
+    bool sparse_ok = check_random<TinySTL::flat_hash_map<int, int>>(100000);
+    std::cout << "flat_hash_map random ops: " << (dense_ok && sparse_ok ? "ok" : "FAILED") << std::endl;
+    bool interface_ok = check_interface();
+    std::cout << "flat_hash_map interface: " << (interface_ok ? "ok" : "FAILED") << std::endl;
+    bool heterogeneous_ok = check_heterogeneous();
+    std::cout << "heterogeneous lookup: " << (heterogeneous_ok ? "ok" : "FAILED") << std::endl;
+    bool collisions_ok = check_collisions();
+    std::cout << "colliding hashes: " << (collisions_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    return dense_ok && sparse_ok && interface_ok && heterogeneous_ok && collisions_ok && lifetimes_ok ? 0 : 1;
+}
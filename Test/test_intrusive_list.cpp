@@ -0,0 +1,177 @@
+#include <iostream>
+#include <list>
+#include <algorithm>
+#include <stdint.h>
+#include "../intrusive_list.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// intrusive_list的测试: 同一个对象同时挂在多条链表上, splice/merge/sort/reverse只改链接, 钩子析构时自动摘下
+
+struct by_age {};
+struct by_name {};
+
+// 两个继承的钩子和一个成员钩子, 可以同时在三条链表里
+struct task : public TinySTL::list_base_hook<by_age>, public TinySTL::list_base_hook<by_name>{
+    int id;
+    int priority;
+    TinySTL::list_hook ready;
+    explicit task(int id = 0, int priority = 0) : id(id), priority(priority) {}
+    bool operator<(const task &x) const { return priority < x.priority; }
+    bool operator==(const task &x) const { return id == x.id; }
+};
+
+typedef TinySTL::intrusive_list<task, TinySTL::base_hook<task, by_age>> age_list;
+typedef TinySTL::intrusive_list<task, TinySTL::base_hook<task, by_name>> name_list;
+typedef TinySTL::intrusive_list<task, TinySTL::member_hook<task, &task::ready>> ready_list;
+
+// 只有一个默认钩子的对象
+struct item : public TinySTL::list_base_hook<>{
+    int value;
+    explicit item(int v = 0) : value(v) {}
+    bool operator<(const item &x) const { return value < x.value; }
+};
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class List>
+bool ids_are(List &l, const int *ids, int n){
+    int i = 0;
+    for (typename List::iterator it = l.begin(); it != l.end(); ++it, ++i)
+        if(i >= n || it->id != ids[i])
+            return false;
+    return i == n && l.size() == (size_t)n;
+}
+
+bool check_several_lists(){
+    bool ok = true;
+    TinySTL::vector<task> tasks;
+    for (int i = 0; i < 6; ++i)
+        tasks.push_back(task(i, (i * 5) % 6));
+    age_list ages;
+    name_list names;
+    ready_list ready;
+    for (int i = 0; i < 6; ++i){
+        ages.push_back(tasks[i]);
+        names.push_front(tasks[i]);
+        if(i % 2 == 0)
+            ready.push_back(tasks[i]);
+    }
+    // 链表里就是原来的对象, 没有复制
+    ok = ok && &ages.front() == &tasks[0] && &names.front() == &tasks[5] && &ready.back() == &tasks[4];
+    const int age_ids[] = {0, 1, 2, 3, 4, 5}, name_ids[] = {5, 4, 3, 2, 1, 0}, ready_ids[] = {0, 2, 4};
+    ok = ok && ids_are(ages, age_ids, 6) && ids_are(names, name_ids, 6) && ids_are(ready, ready_ids, 3);
+
+    // 从一条链表摘下, 不影响其他链表
+    tasks[2].ready.unlink();
+    ages.erase(age_list::iterator_to(tasks[3]));
+    const int age_ids2[] = {0, 1, 2, 4, 5}, ready_ids2[] = {0, 4};
+    ok = ok && ids_are(ages, age_ids2, 5) && ids_are(names, name_ids, 6) && ids_are(ready, ready_ids2, 2);
+    ok = ok && !tasks[2].ready.is_linked() && static_cast<TinySTL::list_base_hook<by_name> &>(tasks[3]).is_linked();
+
+    // 按priority排序只改变链接: priority依次是0, 5, 4, 3, 2, 1
+    names.sort();
+    const int sorted_ids[] = {0, 5, 4, 3, 2, 1};
+    ok = ok && ids_are(names, sorted_ids, 6) && ids_are(ages, age_ids2, 5);
+    names.reverse();
+    const int reversed_ids[] = {1, 2, 3, 4, 5, 0};
+    ok = ok && ids_are(names, reversed_ids, 6);
+    ready.clear();
+    ok = ok && ready.empty() && !tasks[0].ready.is_linked() && !tasks[4].ready.is_linked();
+    // tasks先于链表析构时, 钩子自己从链表里摘下来
+    tasks.clear();
+    return ok && ages.empty() && names.empty();
+}
+
+bool check_random_splice(){
+    bool ok = true;
+    const int n = 2000;
+    TinySTL::vector<item> items;
+    for (int i = 0; i < n; ++i)
+        items.push_back(item(i));
+    TinySTL::intrusive_list<item> a, b;
+    std::list<int> ra, rb;
+    for (int i = 0; i < n; ++i){
+        (i % 2 ? a : b).push_back(items[i]);
+        (i % 2 ? ra : rb).push_back(i);
+    }
+    for (int step = 0; step < 3000 && ok; ++step){
+        const int v = (int)(next_random() % n);
+        const int w = (int)(next_random() % n);
+        item &x = items[v], &y = items[w];
+        // 把x挪到y之前, x和y可能在同一条或者不同的链表里
+        TinySTL::intrusive_list<item> &dst = std::find(ra.begin(), ra.end(), w) != ra.end() ? a : b;
+        std::list<int> &rdst = &dst == &a ? ra : rb;
+        std::list<int> &rsrc = std::find(ra.begin(), ra.end(), v) != ra.end() ? ra : rb;
+        TinySTL::intrusive_list<item> &src = &rsrc == &ra ? a : b;
+        dst.splice(TinySTL::intrusive_list<item>::iterator_to(y), src, TinySTL::intrusive_list<item>::iterator_to(x));
+        rdst.splice(std::find(rdst.begin(), rdst.end(), w), rsrc, std::find(rsrc.begin(), rsrc.end(), v));
+        if(step % 97 == 0){
+            // 区间整段挪过去
+            if(!rb.empty()){
+                a.splice(a.begin(), b, b.begin(), b.end());
+                ra.splice(ra.begin(), rb, rb.begin(), rb.end());
+            }
+            b.splice(b.end(), a, TinySTL::intrusive_list<item>::iterator_to(items[v]), a.end());
+            rb.splice(rb.end(), ra, std::find(ra.begin(), ra.end(), v), ra.end());
+        }
+        std::list<int>::iterator r = ra.begin();
+        for (TinySTL::intrusive_list<item>::iterator it = a.begin(); it != a.end() && ok; ++it, ++r)
+            ok = r != ra.end() && it->value == *r;
+        ok = ok && a.size() == ra.size() && b.size() == rb.size();
+    }
+    // 稳定排序和归并
+    a.sort();
+    b.sort();
+    a.merge(b);
+    int expected = 0;
+    for (TinySTL::intrusive_list<item>::iterator it = a.begin(); it != a.end(); ++it, ++expected)
+        ok = ok && &*it == &items[expected];
+    return ok && b.empty() && expected == n;
+}
+
+bool check_sort_stability(){
+    bool ok = true;
+    TinySTL::vector<task> tasks;
+    for (int i = 0; i < 10000; ++i)
+        tasks.push_back(task(i, (int)(next_random() % 100)));
+    age_list l;
+    for (size_t i = 0; i < tasks.size(); ++i)
+        l.push_back(tasks[i]);
+    l.sort();
+    const task *prev = 0;
+    for (age_list::iterator it = l.begin(); it != l.end(); prev = &*it, ++it)
+        ok = ok && (prev == 0 || prev->priority < it->priority || (prev->priority == it->priority && prev->id < it->id));
+    // 自定义比较
+    struct by_id_desc{
+        bool operator()(const task &a, const task &b) const { return a.id > b.id; }
+    };
+    l.sort(by_id_desc());
+    ok = ok && l.front().id == 9999 && l.back().id == 0 && l.size() == 10000;
+
+    // 移动构造和swap之后哨兵的链接是正确的
+    age_list moved(std::move(l));
+    age_list other;
+    other.swap(moved);
+    ok = ok && l.empty() && moved.empty() && other.size() == 10000 && (--other.end())->id == 0;
+    other.remove_if([](const task &t) { return t.id % 2 == 0; });
+    ok = ok && other.size() == 5000 && other.front().id == 9999 && other.back().id == 1;
+    return ok;
+}
+
+int main()
+{
+    bool several_ok = check_several_lists();
+    std::cout << "one object on several lists: " << (several_ok ? "ok" : "FAILED") << std::endl;
+    bool splice_ok = check_random_splice();
+    std::cout << "splice/merge: " << (splice_ok ? "ok" : "FAILED") << std::endl;
+    bool sort_ok = check_sort_stability();
+    std::cout << "stable sort: " << (sort_ok ? "ok" : "FAILED") << std::endl;
+    return several_ok && splice_ok && sort_ok ? 0 : 1;
+}
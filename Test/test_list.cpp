@@ -1,13 +1,324 @@
 #include <iostream>
+#include <string>
+#include <functional>
+#include <stdexcept>
 #include "../list.h"
 #include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// list的测试: 节点从slab中配置, splice之后节点的内存仍然有效, clear整块释放
+
+typedef basic_counted<int> counted;
+
+template <class List>
+bool equals(List &l, const int *values, int n){
+    int i = 0;
+    for (typename List::iterator it = l.begin(); it != l.end(); ++it, ++i)
+        if(i >= n || *it != values[i])
+            return false;
+    return i == n;
+}
+
+bool check_slabs(){
+    bool ok = true;
+    TinySTL::list<int> l;
+    for (int i = 0; i < 100000; ++i)
+        l.push_back(i);
+    ok = ok && l.size() == 100000 && l.front() == 0 && l.back() == 99999;
+
+    // 连续push_back的节点在同一个slab里按顺序相邻
+    int adjacent = 0;
+    TinySTL::list<int>::iterator prev = l.begin();
+    for (TinySTL::list<int>::iterator it = ++l.begin(); it != l.end(); prev = it, ++it)
+        if((char *)it.node - (char *)prev.node == sizeof(*it.node))
+            ++adjacent;
+    ok = ok && adjacent > 99900;
+
+    // erase之后的节点被重用
+    void *freed = l.begin().node;
+    l.pop_front();
+    l.push_front(-1);
+    ok = ok && (void *)l.begin().node == freed;
+
+    l.clear();
+    ok = ok && l.empty() && l.size() == 0;
+    for (int i = 0; i < 10; ++i)
+        l.push_back(i);
+    const int expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    return ok && equals(l, expected, 10);
+}
+
+bool check_splice(){
+    bool ok = true;
+    // 从另一条list接过来的节点, 在原来的list销毁之后仍然有效
+    TinySTL::list<std::string> a;
+    {
+        TinySTL::list<std::string> b;
+        for (int i = 0; i < 1000; ++i)
+            b.push_back("string that does not fit in the small buffer " + std::to_string(i));
+        TinySTL::list<std::string>::iterator first = b.begin(), last = b.begin();
+        for (int i = 0; i < 10; ++i)
+            ++last;
+        a.splice(a.end(), b, first, last);
+        a.splice(a.begin(), b, --b.end());
+    }
+    ok = ok && a.size() == 11 && a.front().find("999") != std::string::npos && a.back().find(" 9") != std::string::npos;
+    a.clear();
+
+    // 整条list接过来之后销毁原来的list, 然后clear
+    TinySTL::list<int> c;
+    {
+        TinySTL::list<int> d;
+        for (int i = 0; i < 5; ++i){
+            c.push_back(i);
+            d.push_back(i + 5);
+        }
+        c.splice(c.end(), d);
+        ok = ok && d.empty();
+        d.push_back(100);
+    }
+    const int expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    ok = ok && equals(c, expected, 10);
+
+    // 部分splice之后两条list共用节点, 各自clear和销毁的顺序任意
+    TinySTL::list<int> *e = new TinySTL::list<int>, *f = new TinySTL::list<int>, *g = new TinySTL::list<int>;
+    for (int i = 0; i < 100; ++i){
+        e->push_back(i);
+        f->push_back(-i);
+        g->push_back(i * 2);
+    }
+    e->splice(e->end(), *f, f->begin());
+    g->splice(g->begin(), *f, f->begin());
+    f->splice(f->end(), *e, e->begin());
+    f->clear();
+    delete f;
+    e->clear();
+    for (int i = 0; i < 100; ++i)
+        e->push_back(i);
+    delete g;
+    ok = ok && e->size() == 100 && e->back() == 99;
+    delete e;
+
+    // merge会接过x的全部节点
+    TinySTL::list<int> h, k;
+    for (int i = 0; i < 10; i += 2){
+        h.push_back(i);
+        k.push_back(i + 1);
+    }
+    h.merge(k);
+    ok = ok && k.empty() && equals(h, expected, 10);
+    TinySTL::swap(h, k);
+    ok = ok && h.empty() && equals(k, expected, 10);
+    return ok;
+}
+
+// 统计还没有归还的字节数, rebind出来的配置器共用同一个计数
+static long outstanding_bytes = 0;
+template <class T>
+struct counting_allocator : TinySTL::allocator<T>{
+    template <class U>
+    struct rebind{
+        typedef counting_allocator<U> other;
+    };
+    counting_allocator() {}
+    template <class U>
+    counting_allocator(const counting_allocator<U> &) {}
+    static T *allocate(size_t n){
+        outstanding_bytes += n * sizeof(T);
+        return TinySTL::allocator<T>::allocate(n);
+    }
+    static T *allocate() { return allocate(1); }
+    static void deallocate(T *p, size_t n){
+        outstanding_bytes -= n * sizeof(T);
+        TinySTL::allocator<T>::deallocate(p, n);
+    }
+    static void deallocate(T *p) { deallocate(p, 1); }
+};
+
+// 反复从短命的list里splice一个节点: 原来的list销毁之后, 它其余节点所在的slab要被回收, 内存不能随次数增长
+bool check_shared_pool_memory(){
+    bool ok = true;
+    typedef TinySTL::list<int, counting_allocator<int> > counting_list;
+    {
+        counting_list r;
+        for (int i = 0; i < 2000; ++i){
+            counting_list d;
+            for (int j = 0; j < 1000; ++j)
+                d.push_back(i);
+            r.splice(r.end(), d, d.begin());
+        }
+        // 每个接过来的节点最多留住一个最小的slab, 再加上还没有回收的空闲节点
+        ok = ok && outstanding_bytes < 2000 * 2 * TinySTL::_list_first_slab_bytes && r.size() == 2000 && r.back() == 1999;
+    }
+    return ok && outstanding_bytes == 0;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::list<counted> l, m;
+        for (int i = 0; i < 1000; ++i){
+            l.push_back(counted(i));
+            m.push_back(counted(-i));
+        }
+        ok = ok && counted::live == 2000;
+        l.pop_front();
+        l.splice(l.begin(), m, m.begin());
+        ok = ok && counted::live == 1999;
+        m.clear();
+        ok = ok && counted::live == 1000;
+    }
+    ok = ok && counted::live == 0;
+
+    // merge时比较抛出异常, 两条list各自留下的节点在另一条销毁之后仍然有效
+    {
+        TinySTL::list<counted> *a = new TinySTL::list<counted>, b;
+        for (int i = 0; i < 1000; ++i){
+            a->push_back(counted(2 * i));
+            b.push_back(counted(2 * i + 1));
+        }
+        counted::compares = 0;
+        counted::compare_throw_at = 50;
+        try{
+            a->merge(b);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::compare_throw_at = -1;
+        ok = ok && counted::live == 2000 && !b.empty();
+        delete a;
+        int sum = 0;
+        for (TinySTL::list<counted>::iterator it = b.begin(); it != b.end(); ++it)
+            sum += it->value;
+        b.push_back(counted(0));
+        ok = ok && sum > 0 && counted::live == (int)b.size();
+    }
+    return ok && counted::live == 0;
+}
+
+static unsigned sort_seed = 1;
+static int sort_random(){
+    sort_seed = sort_seed * 1103515245 + 12345;
+    return (int)(sort_seed >> 16);
+}
+
+// 键相同的元素按seq保持插入的次序
+struct keyed{
+    int key, seq;
+    bool operator<(const keyed &x) const { return key < x.key; }
+};
+
+template <class List>
+bool sorted_stably(List &l, size_t n){
+    size_t count = 0;
+    bool ok = true;
+    const keyed *prev = 0;
+    for (typename List::iterator it = l.begin(); it != l.end(); prev = &*it, ++it, ++count)
+        ok = ok && (prev == 0 || prev->key < it->key || (prev->key == it->key && prev->seq < it->seq));
+    return ok && count == n;
+}
+
+// 超过16字节, 排序时比较节点而不是元素的副本
+struct padded : keyed{
+    char pad[16];
+};
+
+// 随机、有序、逆序、基本有序(每100个元素有一个乱序)、只有几种键、有序段拼接
+template <class T>
+bool check_sort_kinds(){
+    bool ok = true;
+    const size_t n = 100000;
+    for (int kind = 0; kind < 6; ++kind){
+        TinySTL::list<T> l;
+        for (size_t i = 0; i < n; ++i){
+            T x = T();
+            x.key = kind == 0 ? sort_random() : kind == 1 ? (int)i : kind == 2 ? (int)(n - i) :
+                    kind == 3 ? (i % 100 == 0 ? sort_random() % (int)n : (int)i) :
+                    kind == 4 ? sort_random() % 4 : (int)(i % 5000);
+            x.seq = (int)i;
+            l.push_back(x);
+        }
+        const T *first = &l.front();
+        l.sort();
+        ok = ok && sorted_stably(l, n);
+        // 节点没有复制, 原来的第一个元素还在链表里
+        bool found = false;
+        for (typename TinySTL::list<T>::iterator it = l.begin(); it != l.end(); ++it)
+            found = found || &*it == first;
+        ok = ok && found;
+    }
+    return ok;
+}
+
+// sort和reverse只改变链接, 和intrusive_list共用同一套实现
+bool check_sort(){
+    bool ok = check_sort_kinds<keyed>() && check_sort_kinds<padded>();
+
+    // 自定义比较, merge也可以带比较
+    TinySTL::list<int> a, b;
+    for (int i = 0; i < 1000; ++i){
+        a.push_back(sort_random() % 500);
+        b.push_back(sort_random() % 500);
+    }
+    a.sort(std::greater<int>());
+    b.sort(std::greater<int>());
+    a.merge(b, std::greater<int>());
+    int prev = 1 << 30, n_a = 0;
+    for (TinySTL::list<int>::iterator it = a.begin(); it != a.end(); ++it, ++n_a){
+        ok = ok && prev >= *it;
+        prev = *it;
+    }
+    ok = ok && n_a == 2000 && b.empty();
+    a.reverse();
+    ok = ok && a.front() == prev && a.size() == 2000;
+    TinySTL::list<int> e;
+    e.sort();
+    e.reverse();
+    ok = ok && e.empty();
+
+    // 预扫描: 基本有序时在链表上归并, 随机时使用缓冲区
+    {
+        TinySTL::list<int> mostly, random;
+        for (int i = 0; i < 10000; ++i){
+            mostly.push_back(i % 100 == 0 ? sort_random() : i);
+            random.push_back(sort_random());
+        }
+        TinySTL::__list_node_compare<int, TinySTL::_less> comp((TinySTL::_less()));
+        ok = ok && TinySTL::__list_has_long_runs(mostly.end().node, comp);
+        ok = ok && !TinySTL::__list_has_long_runs(random.end().node, comp);
+        ok = ok && TinySTL::__list_has_long_runs(e.end().node, comp);
+    }
+
+    // 缓冲区配置失败时使用的、不需要额外内存的归并排序
+    for (int kind = 0; kind < 3; ++kind){
+        TinySTL::list<keyed> l;
+        for (size_t i = 0; i < 20000; ++i){
+            keyed k = {kind == 0 ? sort_random() % 100 : kind == 1 ? (int)i : (int)(i % 700), (int)i};
+            l.push_back(k);
+        }
+        TinySTL::__list_merge_sort(l.end().node, TinySTL::__list_node_compare<keyed, TinySTL::_less>(TinySTL::_less()));
+        ok = ok && sorted_stably(l, 20000);
+    }
+    return ok;
+}
 
 int main()
 {
     TinySTL::list<int> l;
-    
+
     for (int i = 0; i < 5;++i)
         l.push_back(i);
     std::cout << "l.size() = " << l.size() << std::endl;
-    return 0;
-}
\ No newline at end of file
+    bool slabs_ok = check_slabs();
+    std::cout << "slab nodes: " << (slabs_ok ? "ok" : "FAILED") << std::endl;
+    bool splice_ok = check_splice();
+    std::cout << "splice between lists: " << (splice_ok ? "ok" : "FAILED") << std::endl;
+    bool memory_ok = check_shared_pool_memory();
+    std::cout << "shared pool memory: " << (memory_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    bool sort_ok = check_sort();
+    std::cout << "sort/reverse: " << (sort_ok ? "ok" : "FAILED") << std::endl;
+    return slabs_ok && splice_ok && memory_ok && lifetimes_ok && sort_ok ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include "../parallel.h"
+#include "../vector.h"
+#include "../list.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// 线程池和带执行策略的算法的测试
+
+static unsigned seed = 7;
+static unsigned next_random(){
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+typedef basic_counted<int> counted;
+
+bool test_pool(){
+    bool ok = true;
+    TinySTL::thread_pool &pool = TinySTL::thread_pool::instance();
+
+    // 任务里再拆分任务
+    std::atomic<int> sum(0);
+    {
+        TinySTL::task_group outer;
+        for (int i = 0; i < 16; ++i){
+            outer.run([i, &sum]{
+                TinySTL::task_group inner;
+                for (int j = 0; j < 16; ++j)
+                    inner.run([i, j, &sum]{ sum += i * 16 + j; });
+                inner.wait();
+            });
+        }
+        outer.wait();
+    }
+    ok = ok && sum == 255 * 256 / 2;
+
+    // 任务抛出的异常在wait()中重新抛出
+    bool caught = false;
+    try{
+        TinySTL::task_group group;
+        for (int i = 0; i < 8; ++i)
+            group.run([i]{ if(i == 5) throw std::runtime_error("task"); });
+        group.wait();
+    }
+    catch(const std::runtime_error &){
+        caught = true;
+    }
+    ok = ok && caught;
+
+    // 队列空了之后等待的线程睡眠而不是空转: 等待200ms期间调用者几乎不占用CPU
+    std::clock_t cpu = std::clock();
+    {
+        TinySTL::task_group group;
+        for (int i = 0; i < 3; ++i)
+            group.run([]{ std::this_thread::sleep_for(std::chrono::milliseconds(200)); });
+        group.wait();
+    }
+    ok = ok && double(std::clock() - cpu) / CLOCKS_PER_SEC < 0.1;
+
+    // 不属于线程池的多个线程同时提交和等待任务
+    std::atomic<int> total(0);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 4; ++t){
+        callers.push_back(std::thread([&total]{
+            for (int round = 0; round < 200; ++round){
+                TinySTL::task_group group;
+                for (int i = 0; i < 8; ++i)
+                    group.run([&total]{ ++total; });
+                group.wait();
+            }
+        }));
+    }
+    for (size_t t = 0; t < callers.size(); ++t)
+        callers[t].join();
+    ok = ok && total == 4 * 200 * 8;
+
+    // parallel_for覆盖每个下标恰好一次, 每块的起点是grain的整数倍
+    std::vector<int> hits(100003, 0);
+    TinySTL::parallel_for(hits.size(), 1000, [&hits](size_t b, size_t e){
+        if(b % 1000 != 0)
+            hits[b] += 100;
+        for (size_t i = b; i < e; ++i)
+            ++hits[i];
+    });
+    ok = ok && std::count(hits.begin(), hits.end(), 1) == (long)hits.size();
+    ok = ok && pool.concurrency() == 4;
+    return ok;
+}
+
+bool test_algorithms(){
+    bool ok = true;
+    const size_t n = 3000000;
+
+    // vector的first touch构造, fill和copy
+    TinySTL::vector<int> v(TinySTL::par, n, 7);
+    ok = ok && v.size() == n && v[0] == 7 && v[n - 1] == 7 && std::count(v.begin(), v.end(), 7) == (long)n;
+    TinySTL::fill(TinySTL::par, v.begin() + 1, v.end() - 1, -3);
+    ok = ok && v[0] == 7 && v[1] == -3 && v[n - 2] == -3 && v[n - 1] == 7;
+    TinySTL::vector<int> w(n);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = (int)next_random();
+    TinySTL::copy(TinySTL::par, v.begin(), v.end(), w.begin());
+    ok = ok && std::equal(v.begin(), v.end(), w.begin());
+
+    // transform和reduce, 结果和串行的版本相同
+    TinySTL::transform(TinySTL::par, v.begin(), v.end(), w.begin(), [](int x){ return x % 1000; });
+    long long expect = 0;
+    for (size_t i = 0; i < n; ++i)
+        expect += v[i] % 1000;
+    ok = ok && TinySTL::reduce(TinySTL::par, w.begin(), w.end(), 0ll,
+                               [](long long a, long long b){ return a + b; }) == expect;
+    ok = ok && (long long)TinySTL::reduce(TinySTL::par, w.begin(), w.end()) == (long long)(int)expect;
+    ok = ok && TinySTL::reduce(TinySTL::par, w.begin(), w.end(), 5) == TinySTL::reduce(TinySTL::seq, w.begin(), w.end(), 5);
+    TinySTL::transform(TinySTL::par, v.begin(), v.end(), w.begin(), w.begin(), std::minus<int>());
+    ok = ok && w[12345] == v[12345] - v[12345] % 1000;
+
+    // sort: 随机、有序、逆序、大量重复
+    for (int kind = 0; kind < 4; ++kind){
+        std::vector<int> input(n);
+        for (size_t i = 0; i < n; ++i)
+            input[i] = kind == 0 ? (int)next_random() : kind == 1 ? (int)i : kind == 2 ? (int)(n - i) : (int)(next_random() % 8);
+        TinySTL::copy(input.data(), input.data() + n, v.begin());
+        std::sort(input.begin(), input.end());
+        TinySTL::sort(TinySTL::par, v.begin(), v.end());
+        ok = ok && std::equal(v.begin(), v.end(), input.begin());
+    }
+    std::vector<std::string> strs(200000);
+    for (size_t i = 0; i < strs.size(); ++i)
+        strs[i] = std::to_string(next_random());
+    std::vector<std::string> sorted_strs = strs;
+    std::sort(sorted_strs.begin(), sorted_strs.end(), std::greater<std::string>());
+    TinySTL::sort(TinySTL::par, strs.data(), strs.data() + strs.size(), std::greater<std::string>());
+    ok = ok && strs == sorted_strs;
+
+    // stable_sort: 键只有1000种, 相等的键保持原来的次序
+    std::vector<std::pair<int, int>> pairs(n), sorted_pairs;
+    for (size_t i = 0; i < n; ++i)
+        pairs[i] = std::make_pair((int)(next_random() % 1000), (int)i);
+    sorted_pairs = pairs;
+    std::stable_sort(sorted_pairs.begin(), sorted_pairs.end(),
+                     [](const std::pair<int, int> &a, const std::pair<int, int> &b){ return a.first < b.first; });
+    TinySTL::stable_sort(TinySTL::par, pairs.data(), pairs.data() + n,
+                         [](const std::pair<int, int> &a, const std::pair<int, int> &b){ return a.first < b.first; });
+    ok = ok && pairs == sorted_pairs;
+
+    // list的并行排序只重新链接节点
+    TinySTL::list<std::pair<int, int>> pl;
+    for (size_t i = 0; i < n; ++i)
+        pl.push_back(std::make_pair((int)(next_random() % 1000), (int)i));
+    std::pair<int, int> *first_node = &pl.front();
+    TinySTL::sort(TinySTL::par, pl, [](const std::pair<int, int> &a, const std::pair<int, int> &b){ return a.first > b.first; });
+    bool in_order = true, found = false;
+    std::pair<int, int> prev(1000, -1);
+    for (TinySTL::list<std::pair<int, int>>::iterator it = pl.begin(); it != pl.end(); prev = *it, ++it){
+        in_order = in_order && (prev.first > it->first || (prev.first == it->first && prev.second < it->second));
+        found = found || &*it == first_node;
+    }
+    ok = ok && in_order && found;
+
+    // 非随机访问迭代器退回到串行版本
+    TinySTL::list<int> l;
+    for (int i = 0; i < 100; ++i)
+        l.push_back(i);
+    TinySTL::fill(TinySTL::par, l.begin(), l.end(), 1);
+    ok = ok && TinySTL::reduce(TinySTL::par, l.begin(), l.end(), 0) == 100;
+
+    // uninitialized_copy: 非平凡的型别, 某一块抛出异常时已经构造的元素全部析构
+    const size_t m = 200000;
+    std::vector<counted> src(m);
+    counted *raw = TinySTL::allocator<counted>::allocate(m);
+    counted::copies = 0;
+    TinySTL::uninitialized_copy(TinySTL::par, src.data(), src.data() + m, raw);
+    ok = ok && counted::live == (int)(2 * m);
+    TinySTL::destory(raw, raw + m);
+    counted::copies = 0;
+    counted::throw_at = (int)(m / 2);
+    bool caught = false;
+    try{
+        TinySTL::uninitialized_copy(TinySTL::par, src.data(), src.data() + m, raw);
+    }
+    catch(const std::runtime_error &){
+        caught = true;
+    }
+    ok = ok && caught && counted::live == (int)m;
+    counted::throw_at = -1;
+    TinySTL::uninitialized_fill_n(TinySTL::par, raw, m, counted(3));
+    ok = ok && counted::live == (int)(2 * m) && raw[m - 1].value == 3;
+    TinySTL::destory(raw, raw + m);
+    TinySTL::allocator<counted>::deallocate(raw, m);
+    return ok;
+}
+
+int main()
+{
+    // 固定为4个线程(3个工作线程加上调用者), 和机器的核数无关
+    TinySTL::thread_pool::instance().resize(3);
+    bool ok = test_pool();
+    std::cout << "thread pool: " << (ok ? "ok" : "FAILED") << std::endl;
+    bool alg_ok = test_algorithms();
+    std::cout << "parallel algorithms: " << (alg_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && alg_ok;
+    return ok ? 0 : 1;
+}
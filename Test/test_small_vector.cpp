@@ -0,0 +1,197 @@
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include "../small_vector.h"
+#include "../vector.h"
+#include "../arena.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// small_vector的测试: 内联缓冲区和配置器空间两种状态下的操作结果都和vector相同
+
+typedef basic_counted<std::string, counted_nothrow_move> counted;
+
+template <class SmallVector, class Vector>
+bool same(const SmallVector &a, Vector &b){
+    if(a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if(!(a[i] == b[i]))
+            return false;
+    return true;
+}
+
+template <class SmallVector>
+bool stored_inline(const SmallVector &v){
+    const char *p = (const char *)v.begin();
+    return v.is_inline() && p >= (const char *)&v && p < (const char *)(&v + 1);
+}
+
+bool check_ints(){
+    bool ok = true;
+    TinySTL::small_vector<int, 4> v;
+    TinySTL::vector<int> ref;
+    ok = ok && v.empty() && v.capacity() == 4 && stored_inline(v);
+    for (int i = 0; i < 4; ++i){
+        v.push_back(i);
+        ref.push_back(i);
+    }
+    ok = ok && stored_inline(v) && same(v, ref);
+    v.push_back(4); // 超过N个, 搬到配置器空间
+    ref.push_back(4);
+    ok = ok && !v.is_inline() && v.capacity() >= 5 && same(v, ref);
+
+    // insert / erase / resize
+    v.insert(v.begin() + 1, 3, 9);
+    ref.insert(ref.begin() + 1, 3, 9);
+    v.insert(v.begin() + 7, 2, -1);
+    ref.insert(ref.begin() + 7, 2, -1);
+    v.insert(v.begin(), 42);
+    ref.insert(ref.begin(), 42);
+    v.erase(v.begin() + 2);
+    ref.erase(ref.begin() + 2);
+    v.erase(v.begin() + 1, v.begin() + 4);
+    ref.erase(ref.begin() + 1, ref.begin() + 4);
+    ok = ok && same(v, ref);
+    v.resize(20, 5);
+    ref.resize(20, 5);
+    ok = ok && same(v, ref);
+    v.resize(3);
+    ref.resize(3);
+    ok = ok && same(v, ref);
+    v.pop_back();
+    ref.pop_back();
+    ok = ok && same(v, ref) && v.back() == ref.back() && v.front() == ref.front();
+
+    // 插入自己的元素
+    TinySTL::small_vector<int, 2> w(1, 7);
+    w.push_back(w[0]);
+    w.push_back(w[1]);
+    w.insert(w.begin(), 4, w[2]);
+    w.emplace(w.begin() + 1, w[6]);
+    ok = ok && w.size() == 8;
+    for (size_t i = 0; i < w.size(); ++i)
+        ok = ok && w[i] == 7;
+
+    TinySTL::small_vector<int, 8> z(5);
+    ok = ok && stored_inline(z) && z.size() == 5 && z[4] == 0;
+    z.reserve(100);
+    ok = ok && !z.is_inline() && z.capacity() == 100 && z.size() == 5;
+    z.clear();
+    ok = ok && z.empty();
+    return ok;
+}
+
+bool check_strings(){
+    bool ok = true;
+    typedef TinySTL::small_vector<std::string, 3> sv;
+    const std::string longer(40, 'x'); // 比std::string的内部缓冲区长, 移动时会检查是否真的移动
+    sv small, big;
+    small.push_back("a");
+    small.push_back(longer);
+    for (int i = 0; i < 10; ++i)
+        big.push_back(longer + std::to_string(i));
+    ok = ok && stored_inline(small) && !big.is_inline();
+
+    // 复制
+    sv small_copy(small), big_copy(big);
+    ok = ok && stored_inline(small_copy) && !big_copy.is_inline() && small_copy[1] == longer && big_copy[9] == longer + "9";
+    small_copy = big;
+    big_copy = small;
+    ok = ok && small_copy.size() == 10 && big_copy.size() == 2 && big_copy[0] == "a";
+    // 空区间什么也不删, 后面的元素不能自己移动给自己
+    small_copy.erase(small_copy.begin() + 2, small_copy.begin() + 2);
+    ok = ok && small_copy.size() == 10 && small_copy[2] == longer + "2" && small_copy[9] == longer + "9";
+
+    // 移动: 配置器空间直接接管, 内联缓冲区逐个移动
+    const std::string *heap = big.begin();
+    sv moved_big(std::move(big));
+    ok = ok && moved_big.begin() == heap && big.empty() && stored_inline(big);
+    sv moved_small(std::move(small));
+    ok = ok && stored_inline(moved_small) && moved_small[1] == longer && small.empty();
+    small = std::move(moved_big);
+    ok = ok && small.begin() == heap && moved_big.empty();
+
+    // swap: 一边内联一边在配置器空间
+    TinySTL::swap(small, moved_small);
+    ok = ok && stored_inline(small) && small.size() == 2 && small[0] == "a"
+            && moved_small.begin() == heap && moved_small.size() == 10;
+    big.push_back("b");
+    small.swap(big);
+    ok = ok && small.size() == 1 && big.size() == 2 && big[1] == longer;
+    return ok;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::small_vector<counted, 4> v;
+        for (int i = 0; i < 10; ++i)
+            v.emplace_back("element that does not fit in the small string buffer");
+        v.erase(v.begin() + 2, v.begin() + 5);
+        v.insert(v.begin() + 1, 6, counted("y"));
+        TinySTL::small_vector<counted, 4> w(v);
+        w.resize(2);
+        v = w;
+        ok = ok && counted::live == 4 && v[1].value == "y";
+
+        // 复制时抛出异常, 已经构造的元素被析构, 原来的内容不变
+        counted::copies = 0;
+        counted::throw_at = 3;
+        try{
+            TinySTL::small_vector<counted, 4> big(20, counted("z"));
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && counted::live == 4;
+    }
+    return ok && counted::live == 0;
+}
+
+// 有状态的配置器: 赋值和swap之后配置器跟着空间走, 空间由配置它的arena释放
+bool check_allocators(){
+    bool ok = true;
+    typedef TinySTL::arena_allocator<int> int_alloc;
+    typedef TinySTL::small_vector<int, 2, int_alloc> sv;
+    TinySTL::arena a1, a2;
+    sv v1((int_alloc(a1))), v2((int_alloc(a2)));
+    for (int i = 0; i < 100; ++i){
+        v1.push_back(i);
+        v2.push_back(-i);
+    }
+    v1.swap(v2);
+    ok = ok && v1.get_allocator() == int_alloc(a2) && v2.get_allocator() == int_alloc(a1) && v1[99] == -99 && v2[99] == 99;
+    size_t used1 = a1.bytes_used(), used2 = a2.bytes_used();
+    v1.reserve(1000); // 扩容时在a2上配置
+    v1.push_back(1000);
+    ok = ok && a1.bytes_used() == used1 && a2.bytes_used() > used2 && v1.size() == 101;
+
+    sv v3((int_alloc(a1)));
+    used1 = a1.bytes_used();
+    v3 = v1; // 复制赋值: 复制出来的空间也在a2上
+    ok = ok && v3.get_allocator() == int_alloc(a2) && a1.bytes_used() == used1 && v3[100] == 1000;
+    sv v4((int_alloc(a1)));
+    v4.push_back(7);
+    v4 = std::move(v2);
+    ok = ok && v4.get_allocator() == int_alloc(a1) && v4.size() == 100 && v4[99] == 99 && v2.empty();
+    v3 = std::move(v4);
+    used2 = a2.bytes_used();
+    v3.reserve(1000); // 接管了a1上的空间, 扩容也在a1上
+    ok = ok && v3.get_allocator() == int_alloc(a1) && a2.bytes_used() == used2 && v3[99] == 99;
+    return ok;
+}
+
+int main()
+{
+    bool ok = check_ints();
+    std::cout << "small_vector<int>: " << (ok ? "ok" : "FAILED") << std::endl;
+    bool strings_ok = check_strings();
+    std::cout << "small_vector<std::string>: " << (strings_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    bool alloc_ok = check_allocators();
+    std::cout << "stateful allocator: " << (alloc_ok ? "ok" : "FAILED") << std::endl;
+    return ok && strings_ok && lifetimes_ok && alloc_ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "../soa_vector.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// soa_vector的测试: 各列的内容和逐行操作的std::vector<struct>相同, 各列可以直接交给算法
+
+struct record{
+    int id;
+    double price;
+    std::string name;
+};
+
+typedef basic_counted<int> counted;
+
+typedef TinySTL::soa_vector<int, double, std::string> table;
+
+bool same(const table &t, const std::vector<record> &ref){
+    if(t.size() != ref.size())
+        return false;
+    for (size_t i = 0; i < ref.size(); ++i){
+        if(t.get<0>(i) != ref[i].id || t.get<1>(i) != ref[i].price || t.get<2>(i) != ref[i].name)
+            return false;
+    }
+    return true;
+}
+
+bool check_rows(){
+    bool ok = true;
+    table t;
+    std::vector<record> ref;
+    for (int i = 0; i < 1000; ++i){
+        const std::string name = "name that does not fit in the small string buffer " + std::to_string(i);
+        if(i % 2)
+            t.push_back(i, i * 0.5, name);
+        else
+            t.emplace_back(i, i * 0.5, name.c_str());
+        record r = {i, i * 0.5, name};
+        ref.push_back(r);
+    }
+    ok = ok && same(t, ref) && t.capacity() >= 1000;
+
+    t.erase(10);
+    ref.erase(ref.begin() + 10);
+    t.erase(100, 300);
+    ref.erase(ref.begin() + 100, ref.begin() + 300);
+    t.pop_back();
+    ref.pop_back();
+    ok = ok && same(t, ref);
+
+    // 通过行引用修改, 再按行读出
+    std::get<1>(t[5]) = -1.0;
+    ref[5].price = -1.0;
+    std::get<2>(t.back()) = "last";
+    ref.back().name = "last";
+    ok = ok && same(t, ref) && std::get<0>(t[7]) == ref[7].id;
+
+    // 插入自己的元素
+    t.push_back(t.get<0>(0), t.get<1>(0), t.get<2>(0));
+    ref.push_back(ref[0]);
+    t.push_back(table::value_type(1, 2.0, "tuple"));
+    record r = {1, 2.0, "tuple"};
+    ref.push_back(r);
+    ok = ok && same(t, ref);
+
+    // 复制、移动、swap
+    table copy(t);
+    ok = ok && same(copy, ref);
+    table moved(std::move(copy));
+    ok = ok && copy.empty() && same(moved, ref);
+    copy = moved;
+    moved.clear();
+    ok = ok && moved.empty() && same(copy, ref);
+    TinySTL::swap(moved, copy);
+    ok = ok && copy.empty() && same(moved, ref);
+
+    moved.resize(3);
+    ok = ok && moved.size() == 3 && moved.get<0>(2) == ref[2].id;
+    moved.resize(5);
+    ok = ok && moved.get<0>(4) == 0 && moved.get<1>(4) == 0.0 && moved.get<2>(4).empty();
+    return ok;
+}
+
+bool check_columns(){
+    bool ok = true;
+    TinySTL::soa_vector<int, float, char> t;
+    long long sum = 0;
+    int max_value = 0;
+    for (int i = 0; i < 100003; ++i){
+        const int v = (i * 7919) % 100000;
+        t.push_back(v, v * 0.25f, (char)(i % 3));
+        sum += v;
+        max_value = v > max_value ? v : max_value;
+    }
+    TinySTL::span<int> ids = t.column<0>();
+    ok = ok && ids.size() == t.size() && ids.data() == &t.get<0>(0);
+    ok = ok && TinySTL::accumulate(ids.begin(), ids.end(), 0ll) == sum;
+    ok = ok && *TinySTL::max_element(ids.begin(), ids.end()) == max_value;
+    ok = ok && TinySTL::count(t.column<2>().begin(), t.column<2>().end(), (char)1) == 100003 / 3;
+    TinySTL::fill(t.column<1>().begin(), t.column<1>().end(), 2.0f);
+    ok = ok && t.get<1>(100002) == 2.0f && t.get<0>(100002) == (100002 * 7919) % 100000;
+    TinySTL::sort(ids.begin(), ids.end());
+    ok = ok && t.get<0>(0) == 0 && t.get<0>(100002) == max_value;
+    const TinySTL::soa_vector<int, float, char> &ct = t;
+    TinySTL::span<const float> prices = ct.column<1>();
+    ok = ok && prices[7] == 2.0f;
+    return ok;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::soa_vector<counted, std::string, counted> t;
+        for (int i = 0; i < 100; ++i)
+            t.emplace_back(i, "s", -i);
+        t.erase(10, 20);
+        TinySTL::soa_vector<counted, std::string, counted> copy(t);
+        ok = ok && counted::live == 4 * 90;
+
+        // 复制到第二列counted时抛出异常, 已经复制的列被析构
+        counted::copies = 0;
+        counted::throw_at = 90 + 50;
+        try{
+            TinySTL::soa_vector<counted, std::string, counted> bad(t);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && counted::live == 4 * 90;
+
+        // 构造一行中间的列时抛出异常, 前面的列被析构
+        counted::copies = 0;
+        counted::throw_at = 2;
+        const counted a(1), b(2);
+        try{
+            t.emplace_back(a, "x", b);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::throw_at = -1;
+        ok = ok && t.size() == 90 && counted::live == 4 * 90 + 2;
+    }
+    return ok && counted::live == 0;
+}
+
+int main()
+{
+    bool ok = check_rows();
+    std::cout << "soa_vector rows: " << (ok ? "ok" : "FAILED") << std::endl;
+    bool columns_ok = check_columns();
+    std::cout << "soa_vector columns: " << (columns_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    return ok && columns_ok && lifetimes_ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <string>
+#include "../type_traits.h"
+#include "../vector.h"
+#include "../Sources/alloc.cpp"
+
+// 型别萃取的测试: 自动判断平凡性, 以及可平凡搬移的opt-in
+
+struct plain{
+    int a;
+    float b;
+};
+
+struct with_string{
+    int a;
+    std::string s;
+};
+
+// 只持有一个指向堆内存的指针, 按字节搬移是安全的, 但它有自己的复制和移动构造函数
+struct handle{
+    static int moves, copies, destroys;
+    int *p;
+    explicit handle(int v) : p(new int(v)) {}
+    handle(const handle &x) : p(new int(*x.p)) { ++copies; }
+    handle(handle &&x) noexcept : p(x.p) { x.p = 0; ++moves; }
+    handle &operator=(handle x) { int *t = p; p = x.p; x.p = t; return *this; }
+    ~handle() { ++destroys; delete p; }
+};
+int handle::moves = 0;
+int handle::copies = 0;
+int handle::destroys = 0;
+
+namespace TinySTL{
+    template<>
+    struct _relocatable_traits<handle>{
+        typedef _true_type is_relocatable_type;
+    };
+}
+
+template <class Tag>
+bool is_true(Tag) { return false; }
+bool is_true(TinySTL::_true_type) { return true; }
+
+template <class T>
+bool pod() { return is_true(typename TinySTL::_type_traits<T>::is_POD_type()); }
+template <class T>
+bool relocatable() { return is_true(typename TinySTL::_type_traits<T>::is_relocatable_type()); }
+template <class T>
+bool trivial_destructor() { return is_true(typename TinySTL::_type_traits<T>::has_trivial_destructor()); }
+
+int main()
+{
+    bool ok = pod<int>() && pod<double>() && pod<char *>() && pod<const int *>() && pod<plain>();
+    ok = ok && !pod<std::string>() && !pod<with_string>() && !pod<handle>();
+    ok = ok && relocatable<plain>() && relocatable<handle>() && !relocatable<std::string>();
+    ok = ok && relocatable<TinySTL::vector<std::string> >();
+    ok = ok && trivial_destructor<plain>() && !trivial_destructor<with_string>();
+    std::cout << "traits: " << (ok ? "ok" : "FAILED") << std::endl;
+
+    // 用户定义的POD结构体走memmove的路径
+    TinySTL::vector<plain> v;
+    for (int i = 0; i < 10000; ++i){
+        plain x = {i, i * 0.5f};
+        v.push_back(x);
+    }
+    v.erase(v.begin(), v.begin() + 10);
+    ok = ok && v.size() == 9990 && v[0].a == 10 && v[9989].b == 9999 * 0.5f;
+
+    // 可平凡搬移的型别扩容时既不移动也不析构旧元素
+    // 只有每次扩容时新插入的那个元素会先构造在临时对象里再移动进去, 1000个元素大约扩容10次
+    int moves = 0;
+    {
+        TinySTL::vector<handle> h;
+        for (int i = 0; i < 1000; ++i)
+            h.emplace_back(i);
+        moves = handle::moves;
+        ok = ok && moves <= 11 && handle::copies == 0 && handle::destroys == moves;
+        ok = ok && *h[0].p == 0 && *h[999].p == 999;
+    }
+    ok = ok && handle::destroys == 1000 + moves;
+
+    // vector<vector<T> >扩容时整块搬移内层vector
+    TinySTL::vector<TinySTL::vector<std::string> > vv;
+    for (int i = 0; i < 100; ++i){
+        vv.push_back(TinySTL::vector<std::string>());
+        vv.back().push_back(std::string(50, 'a' + i % 26));
+    }
+    ok = ok && vv.size() == 100 && vv[99][0] == std::string(50, 'a' + 99 % 26) && vv[0][0][0] == 'a';
+
+    std::cout << "type traits test: " << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
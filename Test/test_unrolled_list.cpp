@@ -0,0 +1,361 @@
+#include <iostream>
+#include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
+#include "../unrolled_list.h"
+#include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// unrolled_list的测试: 随机位置的插入、删除和std::list逐步对照, splice、merge、sort、reverse, 构造和析构的配对
+
+typedef basic_counted<int, counted_may_throw_move> counted;
+
+static uint32_t seed = 1;
+static uint32_t next_random(){
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+template <class List>
+bool same(const List &l, const std::list<int> &ref){
+    if(l.size() != ref.size())
+        return false;
+    std::list<int>::const_iterator r = ref.begin();
+    for (typename List::const_iterator it = l.begin(); it != l.end(); ++it, ++r)
+        if(r == ref.end() || *it != *r)
+            return false;
+    if(r != ref.end())
+        return false;
+    // 反向遍历
+    std::list<int>::const_reverse_iterator rr = ref.rbegin();
+    for (typename List::const_iterator it = l.end(); it != l.begin(); ++rr){
+        --it;
+        if(*it != *rr)
+            return false;
+    }
+    return true;
+}
+
+// 第k个位置的迭代器
+template <class List>
+typename List::iterator nth(List &l, size_t k){
+    typename List::iterator it = l.begin();
+    while(k-- > 0)
+        ++it;
+    return it;
+}
+
+template <class List>
+bool check_random(){
+    bool ok = true;
+    List l;
+    std::list<int> ref;
+    for (int step = 0; step < 100000 && ok; ++step){
+        const size_t k = ref.empty() ? 0 : next_random() % (ref.size() + 1);
+        switch(next_random() % 8){
+        case 0:
+            l.push_back(step);
+            ref.push_back(step);
+            break;
+        case 1:
+            l.push_front(step);
+            ref.push_front(step);
+            break;
+        case 2:
+        case 3:{
+            // insert返回新元素
+            typename List::iterator it = l.insert(nth(l, k), step);
+            ref.insert(nth(ref, k), step);
+            ok = *it == step;
+            break;
+        }
+        case 4:
+        case 5:
+            if(k < ref.size()){
+                // erase返回下一个元素
+                typename List::iterator it = l.erase(nth(l, k));
+                std::list<int>::iterator r = ref.erase(nth(ref, k));
+                ok = (it == l.end()) == (r == ref.end()) && (it == l.end() || *it == *r);
+            }
+            break;
+        case 6:
+            if(!ref.empty()){
+                ok = l.front() == ref.front() && l.back() == ref.back();
+                l.pop_front();
+                ref.pop_front();
+            }
+            break;
+        default:
+            if(!ref.empty()){
+                l.pop_back();
+                ref.pop_back();
+            }
+        }
+        if(step % 1009 == 0)
+            ok = ok && same(l, ref);
+    }
+    return ok && same(l, ref);
+}
+
+template <class List>
+bool check_splice(){
+    bool ok = true;
+    List a, b;
+    std::list<int> ra, rb;
+    for (int i = 0; i < 1000; ++i){
+        a.push_back(i);
+        ra.push_back(i);
+        b.push_back(-i);
+        rb.push_back(-i);
+    }
+    for (int step = 0; step < 2000 && ok; ++step){
+        const bool from_b = next_random() % 2 == 0;
+        List &src = from_b ? b : a;
+        std::list<int> &rsrc = from_b ? rb : ra;
+        if(rsrc.empty())
+            continue;
+        size_t p = next_random() % (ra.size() + 1);
+        size_t f = next_random() % rsrc.size();
+        size_t n = next_random() % 50;
+        if(f + n > rsrc.size())
+            n = rsrc.size() - f;
+        // 同一条表时position不能落在[first, last)里
+        if(!from_b && p >= f && p < f + n)
+            p = f + n;
+        if(next_random() % 3 == 0){
+            if(!from_b && p == f + 1)
+                continue;
+            a.splice(nth(a, p), src, nth(src, f));
+            ra.splice(nth(ra, p), rsrc, nth(rsrc, f));
+        }
+        else{
+            a.splice(nth(a, p), src, nth(src, f), nth(src, f + n));
+            ra.splice(nth(ra, p), rsrc, nth(rsrc, f), nth(rsrc, f + n));
+        }
+        ok = same(a, ra) && same(b, rb);
+        // 搬回去一些, 不让b变空
+        if(rb.size() < 100){
+            b.splice(b.end(), a, nth(a, ra.size() / 2), a.end());
+            rb.splice(rb.end(), ra, nth(ra, ra.size() / 2), ra.end());
+        }
+    }
+    // 整条表接过来, 被接过来的元素上的迭代器仍然有效
+    typename List::iterator kept = b.begin();
+    const int kept_value = *kept;
+    a.splice(nth(a, a.size() / 3), b);
+    ra.splice(nth(ra, ra.size() / 3), rb);
+    ok = ok && b.empty() && b.begin() == b.end() && same(a, ra) && *kept == kept_value;
+    b.push_back(1);
+    return ok && b.size() == 1 && b.front() == 1;
+}
+
+template <class List>
+bool check_sort(){
+    bool ok = true;
+    List l;
+    std::list<int> ref;
+    for (int i = 0; i < 100000; ++i){
+        const int v = (int)(next_random() % 1000);
+        l.push_back(v);
+        ref.push_back(v);
+    }
+    l.sort();
+    ref.sort();
+    ok = ok && same(l, ref);
+    l.sort(std::greater<int>());
+    ref.sort(std::greater<int>());
+    ok = ok && same(l, ref);
+    l.reverse();
+    ref.reverse();
+    ok = ok && same(l, ref);
+
+    List m;
+    std::list<int> rm;
+    for (int i = 0; i < 5000; ++i){
+        const int v = (int)(next_random() % 2000);
+        m.push_front(v);
+        rm.push_front(v);
+    }
+    m.sort();
+    rm.sort();
+    l.merge(m);
+    ref.merge(rm);
+    ok = ok && m.empty() && same(l, ref);
+
+    List e;
+    e.sort();
+    e.reverse();
+    e.merge(l);
+    ref.swap(rm);
+    return ok && l.empty() && same(e, rm);
+}
+
+// 键相同的元素按seq保持原来的次序
+struct keyed{
+    int key, seq;
+};
+
+template <class List>
+bool check_sort_stability(){
+    List l;
+    for (int i = 0; i < 5000; ++i){
+        keyed k = {(int)(next_random() % 50), i};
+        l.push_back(k);
+    }
+    l.sort([](const keyed &a, const keyed &b) { return a.key < b.key; });
+    bool ok = l.size() == 5000;
+    const keyed *prev = 0;
+    for (typename List::iterator it = l.begin(); it != l.end(); prev = &*it, ++it)
+        ok = ok && (prev == 0 || prev->key < it->key || (prev->key == it->key && prev->seq < it->seq));
+    return ok;
+}
+
+bool check_interface(){
+    bool ok = true;
+    TinySTL::unrolled_list<std::string> l;
+    ok = ok && l.empty() && l.begin() == l.end();
+    for (int i = 0; i < 1000; ++i)
+        l.emplace_back(std::to_string(i));
+    ok = ok && l.size() == 1000 && l.front() == "0" && l.back() == "999";
+
+    // 插入表中已有元素的值, 挪动元素时参数不能失效
+    for (int i = 0; i < 1000; ++i)
+        l.insert(nth(l, i * 2), l.back());
+    ok = ok && l.size() == 2000 && *nth(l, 1998) == "999" && *nth(l, 1999) == "999" && *nth(l, 1) == "0";
+    l.insert(nth(l, 10), 100, l.front());
+    ok = ok && l.size() == 2100 && *nth(l, 109) == "999";
+
+    // 区间删除
+    TinySTL::unrolled_list<std::string>::iterator it = l.erase(nth(l, 10), nth(l, 110));
+    ok = ok && l.size() == 2000 && *it == "999" && *nth(l, 11) == "5";
+
+    // 复制、移动、swap、clear
+    TinySTL::unrolled_list<std::string> copy(l);
+    ok = ok && copy == l;
+    TinySTL::unrolled_list<std::string> moved(std::move(copy));
+    ok = ok && copy.empty() && copy.begin() == copy.end() && moved == l;
+    copy = moved;
+    moved.clear();
+    ok = ok && moved.empty() && copy.size() == 2000;
+    TinySTL::swap(moved, copy);
+    ok = ok && copy.empty() && moved == l;
+    copy.push_back("x");
+    moved.push_back("y");
+    ok = ok && copy.size() == 1 && moved.back() == "y";
+    moved.erase(moved.begin(), moved.end());
+    ok = ok && moved.empty();
+
+    TinySTL::unrolled_list<int> init = {1, 2, 3};
+    TinySTL::unrolled_list<int> fill(5, 7);
+    const int values[] = {4, 5};
+    TinySTL::unrolled_list<int> range(values, values + 2);
+    ok = ok && init.size() == 3 && init.back() == 3 && fill.size() == 5 && fill.front() == 7 && range.back() == 5;
+    return ok;
+}
+
+bool check_lifetimes(){
+    bool ok = true;
+    {
+        TinySTL::unrolled_list<counted, 8> l, m;
+        for (int i = 0; i < 1000; ++i){
+            l.push_back(counted((i * 7) % 1000));
+            m.insert(m.begin(), counted(i));
+        }
+        ok = ok && counted::live == 2000;
+        for (int i = 0; i < 100; ++i)
+            l.erase(nth(l, (size_t)i * 3));
+        l.splice(nth(l, 10), m, nth(m, 5), nth(m, 500));
+        l.splice(l.begin(), m, m.begin());
+        ok = ok && counted::live == 1900 && l.size() + m.size() == 1900;
+        l.sort();
+        m.sort();
+        l.merge(m);
+        ok = ok && counted::live == 1900 && l.size() == 1900;
+
+        // 比较时抛出异常, 元素一个不少
+        counted::compares = 0;
+        counted::compare_throw_at = 1000;
+        try{
+            l.sort();
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted::compare_throw_at = -1;
+        ok = ok && counted::live == 1900 && l.size() == 1900;
+        l.sort();
+        int prev = -1;
+        for (TinySTL::unrolled_list<counted, 8>::iterator it = l.begin(); it != l.end(); ++it){
+            ok = ok && prev <= it->value;
+            prev = it->value;
+        }
+        m.clear();
+        ok = ok && counted::live == 1900;
+    }
+    ok = ok && counted::live == 0;
+
+    // merge时比较抛出异常, 已经归并的元素留在l, 两条表都仍然有序, 元素一个不少(被移动过的string是空的)
+    {
+        typedef basic_counted<std::string, counted_may_throw_move> counted_string;
+        typedef TinySTL::unrolled_list<counted_string, 8> string_list;
+        string_list l, m;
+        std::vector<std::string> all;
+        for (int i = 0; i < 2000; ++i){
+            std::string v = std::to_string(100000 + (i * 7919) % 2000) + " does not fit in the small string buffer";
+            (i % 3 ? l : m).push_back(counted_string(v));
+            all.push_back(v);
+        }
+        l.sort();
+        m.sort();
+        counted_string::compares = 0;
+        counted_string::compare_throw_at = 1000;
+        try{
+            l.merge(m);
+            ok = false;
+        }
+        catch(const std::runtime_error &){
+        }
+        counted_string::compare_throw_at = -1;
+        ok = ok && counted_string::live == 2000 && l.size() + m.size() == 2000 && !m.empty();
+        std::vector<std::string> kept;
+        for (string_list::iterator it = l.begin(); it != l.end(); ++it){
+            ok = ok && (kept.empty() || kept.back() <= it->value);
+            kept.push_back(it->value);
+        }
+        for (string_list::iterator it = m.begin(); it != m.end(); ++it){
+            ok = ok && (it == m.begin() || kept.back() <= it->value);
+            kept.push_back(it->value);
+        }
+        std::sort(all.begin(), all.end());
+        std::sort(kept.begin(), kept.end());
+        ok = ok && kept == all;
+        l.merge(m);
+        kept.clear();
+        for (string_list::iterator it = l.begin(); it != l.end(); ++it)
+            kept.push_back(it->value);
+        ok = ok && m.empty() && kept == all;
+    }
+    return ok && basic_counted<std::string, counted_may_throw_move>::live == 0;
+}
+
+int main()
+{
+    bool random_ok = check_random<TinySTL::unrolled_list<int, 4>>() && check_random<TinySTL::unrolled_list<int>>();
+    std::cout << "random insert/erase: " << (random_ok ? "ok" : "FAILED") << std::endl;
+    bool splice_ok = check_splice<TinySTL::unrolled_list<int, 5>>() && check_splice<TinySTL::unrolled_list<int>>();
+    std::cout << "splice: " << (splice_ok ? "ok" : "FAILED") << std::endl;
+    bool sort_ok = check_sort<TinySTL::unrolled_list<int, 4>>() && check_sort<TinySTL::unrolled_list<int>>() &&
+                   check_sort_stability<TinySTL::unrolled_list<keyed, 5>>() && check_sort_stability<TinySTL::unrolled_list<keyed>>();
+    std::cout << "sort/merge/reverse: " << (sort_ok ? "ok" : "FAILED") << std::endl;
+    bool interface_ok = check_interface();
+    std::cout << "interface: " << (interface_ok ? "ok" : "FAILED") << std::endl;
+    bool lifetimes_ok = check_lifetimes();
+    std::cout << "construct/destroy balance: " << (lifetimes_ok ? "ok" : "FAILED") << std::endl;
+    return random_ok && splice_ok && sort_ok && interface_ok && lifetimes_ok ? 0 : 1;
+}
@@ -1,6 +1,85 @@
 #include <iostream>
+#include <string>
+#include <memory>
 #include "../vector.h"
 #include "../Sources/alloc.cpp"
+#include "counted.h"
+
+// nothrow_move决定移动构造是否声明为noexcept
+template <bool nothrow_move>
+using counted = basic_counted<std::string, nothrow_move ? counted_nothrow_move : counted_may_throw_move>;
+
+// 扩容时, 移动构造为noexcept的元素被移动, 否则被复制
+template <bool nothrow_move>
+bool check_growth(){
+    TinySTL::vector<counted<nothrow_move> > v;
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back("element that does not fit in the small string buffer");
+    counted<nothrow_move>::copies = counted<nothrow_move>::moves = 0;
+    for (int i = 0; i < 100; ++i)
+        v.emplace_back("x");
+    if(nothrow_move)
+        return counted<nothrow_move>::copies == 0 && counted<nothrow_move>::moves > 0;
+    return counted<nothrow_move>::moves == 0 && counted<nothrow_move>::copies > 0;
+}
+
+// 只提供allocate/deallocate的配置器, vector扩容时不能使用try_expand/reallocate
+template <class T>
+struct plain_allocator{
+    template <class U>
+    struct rebind{
+        typedef plain_allocator<U> other;
+    };
+    plain_allocator() {}
+    template <class U>
+    plain_allocator(const plain_allocator<U> &) {}
+    T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T))); }
+    void deallocate(T *p, size_t) { ::operator delete(p); }
+};
+
+bool check_plain_allocator(){
+    TinySTL::vector<int, plain_allocator<int> > v;
+    for (int i = 0; i < 100000; ++i)
+        v.push_back(i);
+    v.insert(v.begin() + 10, 3, v[50000]);
+    bool ok = v.size() == 100003 && v[9] == 9 && v[11] == 50000 && v[13] == 10 && v[100002] == 99999;
+    TinySTL::vector<int, plain_allocator<int> > w(v);
+    w.insert(w.end(), 200000, 7);
+    return ok && w.size() == 300003 && w[100003] == 7 && w[100002] == 99999;
+}
+
+bool check_strings(){
+    TinySTL::vector<std::string> v;
+    for (int i = 0; i < 1000; ++i)
+        v.push_back(std::string(40, 'a' + i % 26));
+    std::string s = "moved";
+    v.push_back(std::move(s));
+    v.emplace_back(3, 'z');
+    v.emplace(v.begin() + 1, "emplaced");
+    v.insert(v.begin(), v[500]); // 插入的值就是vector里的元素
+    bool ok = v.size() == 1004 && v[0] == v[501] && v[2] == "emplaced" && v[1002] == "moved" && v[1003] == "zzz";
+    v.erase(v.begin(), v.begin() + 2);
+    ok = ok && v[0] == "emplaced" && v.size() == 1002;
+    // 空区间什么也不删, 后面的元素不能自己移动给自己
+    v.erase(v.begin() + 2, v.begin() + 2);
+    ok = ok && v.size() == 1002 && v[2] == std::string(40, 'a' + 2) && v[1001] == "zzz";
+
+    TinySTL::vector<std::string> copy(v);
+    TinySTL::vector<std::string> moved(std::move(v));
+    ok = ok && copy.size() == 1002 && moved.size() == 1002 && v.size() == 0 && copy[1001] == moved[1001];
+    v = copy;
+    copy = std::move(moved);
+    ok = ok && v.size() == 1002 && copy.size() == 1002 && v[0] == copy[0];
+
+    // 只能移动的元素
+    TinySTL::vector<std::unique_ptr<int> > p;
+    for (int i = 0; i < 100; ++i)
+        p.push_back(std::unique_ptr<int>(new int(i)));
+    p.emplace(p.begin(), new int(-1));
+    p.erase(p.begin() + 50);
+    ok = ok && p.size() == 100 && *p[0] == -1 && *p[50] == 50 && *p[99] == 99;
+    return ok;
+}
 
 int main()
 {
@@ -11,6 +90,23 @@ int main()
         //std::cout << v.capacity() << std::endl;
     }
     std::cout << "begin()里存储的元素为：" << *(v.begin()) << std::endl;
+
+    // 大vector<int>的增长会走try_expand/realloc, 检查元素没有丢
+    TinySTL::vector<int> big;
+    for (int i = 0; i < 1000000; ++i)
+        big.push_back(i);
+    big.insert(big.begin() + 10, 3, big[500000]); // 插入的值就是vector里的元素
+    big.insert(big.begin(), big[999]);
+    bool ok = big.size() == 1000004 && big[0] == 996 && big[11] == 500000 && big[13] == 500000
+              && big[14] == 10 && big[1000003] == 999999;
+    std::cout << "big vector: " << (ok ? "ok" : "FAILED") << ", capacity = " << big.capacity() << std::endl;
+
+    bool plain_ok = check_plain_allocator();
+    std::cout << "allocator without reallocate: " << (plain_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && plain_ok;
+    bool move_ok = check_strings() && check_growth<true>() && check_growth<false>();
+    std::cout << "move semantics: " << (move_ok ? "ok" : "FAILED") << std::endl;
+    ok = ok && move_ok;
     /*std::cout << "v的size为：" << v.size() << std::endl;
     std::cout << "begin()里存储的元素为：" << *(v.begin()) << std::endl;
     std::cout << "end()里存储的元素为：" << *(v.end()-1) << std::endl;
@@ -28,5 +124,5 @@ int main()
         std::cout << v[i] << " ";
     std::cout << "v的size为：" << v.size() << std::endl;
     std::cout << "v.capacity() = " << v.capacity() << std::endl;*/
-    return 0;
+    return ok ? 0 : 1;
 }
\ No newline at end of file
@@ -1,10 +1,29 @@
 #ifndef _ALGORITHM_H_
 #define _ALGORITHM_H_
 #include <string.h>
+#include <stdint.h>
+#include <utility>
+#include <type_traits>
+#include <functional>
 #include "type_traits.h"
 #include "iterator.h"
+#include "construct.h"
+#include "allocator.h"
+#include "simd.h"
 
 namespace TinySTL{
+    // 只有输入输出都是指向同一种平凡可复制型别的指针时, 才能直接memmove
+    template <class InputIterator, class OutputIterator>
+    struct _memmove_traits{
+        typedef _false_type is_memmovable;
+    };
+    template <class T, class U>
+    struct _memmove_traits<T*, U*>{
+        typedef typename _bool_type<std::is_same<typename std::remove_const<T>::type, U>::value &&
+                                    std::is_trivially_copyable<U>::value &&
+                                    std::is_trivially_copy_assignable<U>::value>::type is_memmovable;
+    };
+
     // *************[copy]的相关函数*************
     template <class InputIterator, class OutputIterator>
     inline OutputIterator __copy(InputIterator first, InputIterator last, OutputIterator result, _true_type){
@@ -17,16 +36,12 @@ namespace TinySTL{
             *result = *first;
         return result;
     }
-    // T*指针形式版本
-    template <class InputIterator, class OutputIterator, class T>
-    inline OutputIterator _copy(InputIterator first, InputIterator last, OutputIterator result, T*){
-        typedef typename TinySTL::_type_traits<T>::is_POD_type is_POD;
-        return __copy(first, last, result, is_POD());
-    }
     // copy完全泛化的版本,把区间[first, last)的内容复制到以result为起始位置的空间去
+    // 指向平凡可复制型别的指针直接memmove, 其他的逐个赋值
     template <class InputIterator, class OutputIterator>
     inline OutputIterator copy(InputIterator first, InputIterator last, OutputIterator result){
-        return _copy(first, last, result, value_type(first));
+        typedef typename _memmove_traits<InputIterator, OutputIterator>::is_memmovable is_memmovable;
+        return __copy(first, last, result, is_memmovable());
     }
     // copy针对原生指针的重载版本
     inline char* copy(const char* first, const char* last, char* result){
@@ -40,35 +55,319 @@ namespace TinySTL{
     
     // *************[copy_backward]****************
     template <class BidirectionalIterator1, class BidirectionalIterator2>
+    inline BidirectionalIterator2 __copy_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
+                                                  BidirectionalIterator2 result, _true_type){
+        const ptrdiff_t n = last - first;
+        result -= n;
+        memmove(result, first, sizeof(*first) * n);
+        return result;
+    }
+    template <class BidirectionalIterator1, class BidirectionalIterator2>
+    inline BidirectionalIterator2 __copy_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
+                                                  BidirectionalIterator2 result, _false_type){
+        while (first != last)
+            *--result = *--last;
+        return result;
+    }
+    // 把区间[first, last)从后往前复制到以result为结束位置的空间, 返回复制后的起始位置
+    template <class BidirectionalIterator1, class BidirectionalIterator2>
     inline BidirectionalIterator2 copy_backward(BidirectionalIterator1 first,
                                                  BidirectionalIterator1 last,
                                                  BidirectionalIterator2 result){
-        for (; first != last; --result, --last)
-            *result = *last;
-        return result - (last - first);
+        typedef typename _memmove_traits<BidirectionalIterator1, BidirectionalIterator2>::is_memmovable is_memmovable;
+        return __copy_backward(first, last, result, is_memmovable());
+    }
+
+    // *************[move]、[move_backward]****************
+    // 和copy一样, 只是元素以右值的形式赋值过去, 平凡可复制的型别仍然用memmove
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator result, _true_type){
+        return __copy(first, last, result, _true_type());
+    }
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator result, _false_type){
+        for (; first != last; ++result, ++first)
+            *result = std::move(*first);
+        return result;
+    }
+    // 把区间[first, last)的元素移动到以result为起始位置的空间去
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator move(InputIterator first, InputIterator last, OutputIterator result){
+        typedef typename _memmove_traits<InputIterator, OutputIterator>::is_memmovable is_memmovable;
+        return __move(first, last, result, is_memmovable());
+    }
+
+    template <class BidirectionalIterator1, class BidirectionalIterator2>
+    inline BidirectionalIterator2 __move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
+                                                  BidirectionalIterator2 result, _true_type){
+        return __copy_backward(first, last, result, _true_type());
+    }
+    template <class BidirectionalIterator1, class BidirectionalIterator2>
+    inline BidirectionalIterator2 __move_backward(BidirectionalIterator1 first, BidirectionalIterator1 last,
+                                                  BidirectionalIterator2 result, _false_type){
+        while (first != last)
+            *--result = std::move(*--last);
+        return result;
+    }
+    // 把区间[first, last)从后往前移动到以result为结束位置的空间, 返回移动后的起始位置
+    template <class BidirectionalIterator1, class BidirectionalIterator2>
+    inline BidirectionalIterator2 move_backward(BidirectionalIterator1 first,
+                                                BidirectionalIterator1 last,
+                                                BidirectionalIterator2 result){
+        typedef typename _memmove_traits<BidirectionalIterator1, BidirectionalIterator2>::is_memmovable is_memmovable;
+        return __move_backward(first, last, result, is_memmovable());
+    }
+
+    // *************[find]、[count]、[equal]、[min_element]、[max_element]、[accumulate]****************
+    // 指向有内核的算术型别的指针(vector<int>、vector<float>的迭代器等)使用simd.h里的向量化内核,
+    // 其他迭代器(例如list的迭代器)和其他型别(例如long double)使用逐个元素处理的版本
+    template <class Iterator>
+    struct _simd_traits{
+        typedef _false_type is_simd_range;
+        typedef void value_type;
+    };
+    template <class T>
+    struct _simd_traits<T*>{
+        typedef typename _bool_type<simd::has_kernel<typename std::remove_const<T>::type>::value &&
+                                    !std::is_volatile<T>::value>::type is_simd_range;
+        typedef typename std::remove_const<T>::type value_type;
+    };
+    template <class T>
+    struct _simd_traits<const T*> : _simd_traits<T*> {};
+
+    // 查找的值和元素型别相同时才能直接比较, 否则(例如在vector<double>里找int)按通常的类型转换规则逐个比较
+    template <class Iterator, class T>
+    struct _simd_value_traits{
+        typedef typename _bool_type<std::is_same<typename _simd_traits<Iterator>::is_simd_range, _true_type>::value &&
+                                    std::is_same<typename _simd_traits<Iterator>::value_type, T>::value>::type is_simd_value;
+    };
+
+    template <class InputIterator, class T>
+    inline InputIterator __find(InputIterator first, InputIterator last, const T& value, _false_type){
+        while(first != last && !(*first == value))
+            ++first;
+        return first;
+    }
+    template <class InputIterator, class T>
+    inline InputIterator __find(InputIterator first, InputIterator last, const T& value, _true_type){
+        return first + (simd::find(&*first, &*first + (last - first), value) - &*first);
+    }
+    // 返回区间[first, last)中第一个等于value的元素的位置, 找不到则返回last
+    template <class InputIterator, class T>
+    inline InputIterator find(InputIterator first, InputIterator last, const T& value){
+        typedef typename _simd_value_traits<InputIterator, T>::is_simd_value is_simd_value;
+        return __find(first, last, value, is_simd_value());
+    }
+
+    template <class InputIterator, class T>
+    inline typename iterator_traits<InputIterator>::difference_type
+    __count(InputIterator first, InputIterator last, const T& value, _false_type){
+        typename iterator_traits<InputIterator>::difference_type n = 0;
+        for (; first != last; ++first)
+            if(*first == value)
+                ++n;
+        return n;
+    }
+    template <class InputIterator, class T>
+    inline typename iterator_traits<InputIterator>::difference_type
+    __count(InputIterator first, InputIterator last, const T& value, _true_type){
+        return simd::count(first, last, value);
+    }
+    // 返回区间[first, last)中等于value的元素个数
+    template <class InputIterator, class T>
+    inline typename iterator_traits<InputIterator>::difference_type
+    count(InputIterator first, InputIterator last, const T& value){
+        typedef typename _simd_value_traits<InputIterator, T>::is_simd_value is_simd_value;
+        return __count(first, last, value, is_simd_value());
+    }
+
+    template <class InputIterator1, class InputIterator2>
+    inline bool __equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, _false_type){
+        for (; first1 != last1; ++first1, ++first2)
+            if(!(*first1 == *first2))
+                return false;
+        return true;
+    }
+    template <class InputIterator1, class InputIterator2>
+    inline bool __equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, _true_type){
+        typedef typename _simd_traits<InputIterator1>::value_type T;
+        return simd::equal((const T *)first1, (const T *)last1, (const T *)first2);
+    }
+    // 判断区间[first1, last1)和以first2开始的同样长度的区间是否逐个元素相等
+    template <class InputIterator1, class InputIterator2>
+    inline bool equal(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2){
+        typedef typename _simd_value_traits<InputIterator1, typename _simd_traits<InputIterator2>::value_type>::is_simd_value is_simd_value;
+        return __equal(first1, last1, first2, is_simd_value());
+    }
+
+    // 逐个比较的版本, 返回第一个最小的元素
+    template <class ForwardIterator>
+    inline ForwardIterator __min_element(ForwardIterator first, ForwardIterator last, _false_type){
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last)
+            if(*first < *result)
+                result = first;
+        return result;
+    }
+    // 逐个比较的版本, 返回第一个最大的元素
+    template <class ForwardIterator>
+    inline ForwardIterator __max_element(ForwardIterator first, ForwardIterator last, _false_type){
+        if(first == last)
+            return first;
+        ForwardIterator result = first;
+        while(++first != last)
+            if(*result < *first)
+                result = first;
+        return result;
+    }
+    // 逐个比较的版本, 返回第一个最小的元素和最后一个最大的元素
+    template <class ForwardIterator>
+    inline std::pair<ForwardIterator, ForwardIterator>
+    __minmax_element(ForwardIterator first, ForwardIterator last, _false_type){
+        std::pair<ForwardIterator, ForwardIterator> result(first, first);
+        if(first == last)
+            return result;
+        while(++first != last){
+            if(*first < *result.first)
+                result.first = first;
+            if(!(*first < *result.second))
+                result.second = first;
+        }
+        return result;
+    }
+
+    template <class T>
+    struct _minmax_traits{
+        typedef _false_type has_kernel;
+    };
+    template <class T>
+    struct _minmax_traits<T*>{
+        typedef typename _bool_type<std::is_same<typename _simd_traits<T*>::is_simd_range, _true_type>::value &&
+                                    simd::has_minmax_kernel<typename std::remove_const<T>::type>::value>::type has_kernel;
+    };
+
+    // 向量化的版本, 遇到NaN时(此时<不是严格弱序)退回到逐个比较的版本, 以保持完全相同的结果
+    template <class T>
+    inline T *__min_element(T *first, T *last, _true_type){
+        typedef typename std::remove_const<T>::type U;
+        std::pair<const U *, const U *> r = simd::minmax_positions<U>(first, last, true, false, false);
+        return r.first != 0 ? first + (r.first - first) : __min_element(first, last, _false_type());
+    }
+    template <class T>
+    inline T *__max_element(T *first, T *last, _true_type){
+        typedef typename std::remove_const<T>::type U;
+        std::pair<const U *, const U *> r = simd::minmax_positions<U>(first, last, false, true, false);
+        return r.second != 0 ? first + (r.second - first) : __max_element(first, last, _false_type());
+    }
+    template <class T>
+    inline std::pair<T *, T *> __minmax_element(T *first, T *last, _true_type){
+        typedef typename std::remove_const<T>::type U;
+        std::pair<const U *, const U *> r = simd::minmax_positions<U>(first, last, true, true, true);
+        if(r.first == 0)
+            return __minmax_element(first, last, _false_type());
+        return std::pair<T *, T *>(first + (r.first - first), first + (r.second - first));
+    }
+
+    // 返回区间[first, last)中第一个最小的元素, 区间为空时返回last
+    template <class ForwardIterator>
+    inline ForwardIterator min_element(ForwardIterator first, ForwardIterator last){
+        return __min_element(first, last, typename _minmax_traits<ForwardIterator>::has_kernel());
+    }
+    // 返回区间[first, last)中第一个最大的元素, 区间为空时返回last
+    template <class ForwardIterator>
+    inline ForwardIterator max_element(ForwardIterator first, ForwardIterator last){
+        return __max_element(first, last, typename _minmax_traits<ForwardIterator>::has_kernel());
+    }
+    // 同时返回第一个最小的元素和最后一个最大的元素(和std::minmax_element相同), 只遍历一遍
+    template <class ForwardIterator>
+    inline std::pair<ForwardIterator, ForwardIterator> minmax_element(ForwardIterator first, ForwardIterator last){
+        return __minmax_element(first, last, typename _minmax_traits<ForwardIterator>::has_kernel());
+    }
+
+    template <class InputIterator, class T>
+    inline T __accumulate(InputIterator first, InputIterator last, T init, _false_type){
+        for (; first != last; ++first)
+            init = init + *first;
+        return init;
+    }
+    template <class InputIterator, class T>
+    inline T __accumulate(InputIterator first, InputIterator last, T init, _true_type){
+        typedef typename std::make_unsigned<T>::type U;
+        return (T)((U)init + (U)simd::sum(&*first, &*first + (last - first)));
+    }
+    // 把区间[first, last)的元素依次加到init上
+    // 只有整数并且init和元素型别相同时才使用向量化内核, 它按元素型别的宽度回绕, 和逐个相加的结果相同;
+    // 浮点数的加法不满足结合律, 重排顺序会改变结果, 因此仍然逐个相加
+    template <class InputIterator, class T>
+    inline T accumulate(InputIterator first, InputIterator last, T init){
+        typedef typename _bool_type<std::is_same<typename _simd_value_traits<InputIterator, T>::is_simd_value, _true_type>::value &&
+                                    simd::has_sum_kernel<T>::value>::type has_kernel;
+        return __accumulate(first, last, init, has_kernel());
+    }
+
+    // [reduce]和accumulate相同, 但是允许按任意顺序结合, 因此op必须满足结合律和交换律, 并行版本见parallel.h
+    template <class InputIterator, class T, class BinaryOperation>
+    inline T reduce(InputIterator first, InputIterator last, T init, BinaryOperation op){
+        for (; first != last; ++first)
+            init = op(init, *first);
+        return init;
+    }
+    template <class InputIterator, class T>
+    inline T reduce(InputIterator first, InputIterator last, T init){
+        return TinySTL::accumulate(first, last, init);
+    }
+    template <class InputIterator>
+    inline typename iterator_traits<InputIterator>::value_type reduce(InputIterator first, InputIterator last){
+        typedef typename iterator_traits<InputIterator>::value_type T;
+        return TinySTL::accumulate(first, last, T());
     }
 
     // ***********[max]、[min]****************
     template <class T>
-    inline T max(T a, T b){
-        return a > b;
+    inline const T& max(const T& a, const T& b){
+        return a < b ? b : a;
     }
 
     template <class T>
-    inline T min(T a, T b){
-        return a < b;
+    inline const T& min(const T& a, const T& b){
+        return b < a ? b : a;
     }
 
     // ********[fill]、[fill_n]*********************
-    // 将区间[first, last)以元素value填充
+    // 指向1/2/4/8字节的平凡可复制型别的指针可以使用SIMD内核填充
+    template <class ForwardIterator>
+    struct _fill_traits{
+        typedef _false_type is_simd_fillable;
+    };
+    template <class T>
+    struct _fill_traits<T*>{
+        typedef typename _bool_type<!std::is_const<T>::value && !std::is_volatile<T>::value &&
+                                    std::is_trivially_copyable<T>::value &&
+                                    std::is_trivially_copy_assignable<T>::value &&
+                                    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>::type is_simd_fillable;
+    };
+
     template <class ForwardIterator, class T>
-    void fill(ForwardIterator first, ForwardIterator last, const T& value){
+    inline void __fill(ForwardIterator first, ForwardIterator last, const T& value, _false_type){
         for (; first != last; ++first)
             *first = value;
     }
-    // 以first为起始位置填充n个value,返回填充后最后一个元素的下一个位置
+    template <class U, class T>
+    inline void __fill(U *first, U *last, const T& value, _true_type){
+        const U x = value; // value的型别可能和元素不同(例如用0填充double), 先转换成元素型别
+        simd::fill_value(first, x, last - first);
+    }
+    // 将区间[first, last)以元素value填充
+    template <class ForwardIterator, class T>
+    void fill(ForwardIterator first, ForwardIterator last, const T& value){
+        typedef typename _fill_traits<ForwardIterator>::is_simd_fillable is_simd_fillable;
+        __fill(first, last, value, is_simd_fillable());
+    }
+
     template <class ForwardIterator, class Size, class T>
-    ForwardIterator fill_n(ForwardIterator first, Size n, const T& value){
+    inline ForwardIterator __fill_n(ForwardIterator first, Size n, const T& value, _false_type){
         while(n > 0){
             *first = value;
             ++first;
@@ -76,5 +375,901 @@ namespace TinySTL{
         }
         return first;
     }
+    template <class U, class Size, class T>
+    inline U *__fill_n(U *first, Size n, const T& value, _true_type){
+        if(n <= 0)
+            return first;
+        __fill(first, first + n, value, _true_type());
+        return first + n;
+    }
+    // 以first为起始位置填充n个value,返回填充后最后一个元素的下一个位置
+    template <class ForwardIterator, class Size, class T>
+    ForwardIterator fill_n(ForwardIterator first, Size n, const T& value){
+        typedef typename _fill_traits<ForwardIterator>::is_simd_fillable is_simd_fillable;
+        return __fill_n(first, n, value, is_simd_fillable());
+    }
+
+    // ***********[transform]****************
+    // 对区间[first, last)的每个元素调用op, 结果依次写到以result为起始位置的空间去
+    template <class InputIterator, class OutputIterator, class UnaryOperation>
+    OutputIterator transform(InputIterator first, InputIterator last, OutputIterator result, UnaryOperation op){
+        for (; first != last; ++first, ++result)
+            *result = op(*first);
+        return result;
+    }
+    // 对两个区间对应位置的元素调用op
+    template <class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
+    OutputIterator transform(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                             OutputIterator result, BinaryOperation op){
+        for (; first1 != last1; ++first1, ++first2, ++result)
+            *result = op(*first1, *first2);
+        return result;
+    }
+
+    // ***********[iter_swap]****************
+    // 交换两个迭代器所指的元素, 通过ADL找到元素型别自己的swap
+    template <class ForwardIterator1, class ForwardIterator2>
+    inline void iter_swap(ForwardIterator1 a, ForwardIterator2 b){
+        using std::swap;
+        swap(*a, *b);
+    }
+
+    // 没有指定比较函数时使用的默认比较, 即operator<
+    struct _less{
+        template <class T1, class T2>
+        bool operator()(const T1& a, const T2& b) const { return a < b; }
+    };
+
+    // ***********[push_heap]、[pop_heap]、[make_heap]、[sort_heap]****************
+    // 以comp为序的最大堆, 堆顶*first是最大的元素
+    template <class RandomAccessIterator, class Distance, class T, class Compare>
+    void __push_heap(RandomAccessIterator first, Distance holeIndex, Distance topIndex, T value, Compare comp){
+        Distance parent = (holeIndex - 1) / 2;
+        while(holeIndex > topIndex && comp(*(first + parent), value)){
+            *(first + holeIndex) = std::move(*(first + parent));
+            holeIndex = parent;
+            parent = (holeIndex - 1) / 2;
+        }
+        *(first + holeIndex) = std::move(value);
+    }
+    // 把洞从holeIndex一直下沉到叶子, 再把value从叶子上浮到合适的位置, 比逐层比较value少一半的比较次数
+    template <class RandomAccessIterator, class Distance, class T, class Compare>
+    void __adjust_heap(RandomAccessIterator first, Distance holeIndex, Distance len, T value, Compare comp){
+        const Distance topIndex = holeIndex;
+        Distance secondChild = holeIndex;
+        while(secondChild < (len - 1) / 2){
+            secondChild = 2 * (secondChild + 1);
+            if(comp(*(first + secondChild), *(first + (secondChild - 1))))
+                --secondChild;
+            *(first + holeIndex) = std::move(*(first + secondChild));
+            holeIndex = secondChild;
+        }
+        if((len & 1) == 0 && secondChild == (len - 2) / 2){
+            secondChild = 2 * (secondChild + 1);
+            *(first + holeIndex) = std::move(*(first + (secondChild - 1)));
+            holeIndex = secondChild - 1;
+        }
+        TinySTL::__push_heap(first, holeIndex, topIndex, std::move(value), comp);
+    }
+    // 把堆顶放到result, 原来*result的值重新插入堆[first, last)
+    template <class RandomAccessIterator, class Compare>
+    inline void __pop_heap(RandomAccessIterator first, RandomAccessIterator last, RandomAccessIterator result, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        T value = std::move(*result);
+        *result = std::move(*first);
+        TinySTL::__adjust_heap(first, Distance(0), Distance(last - first), std::move(value), comp);
+    }
+
+    // [first, last - 1)已经是堆, 把*(last - 1)加入堆中
+    template <class RandomAccessIterator, class Compare>
+    inline void push_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        if(last - first < 2)
+            return;
+        T value = std::move(*(last - 1));
+        TinySTL::__push_heap(first, Distance((last - first) - 1), Distance(0), std::move(value), comp);
+    }
+    template <class RandomAccessIterator>
+    inline void push_heap(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::push_heap(first, last, _less());
+    }
+
+    // 把堆顶移到last - 1, [first, last - 1)仍然是堆
+    template <class RandomAccessIterator, class Compare>
+    inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        if(last - first > 1){
+            --last;
+            TinySTL::__pop_heap(first, last, last, comp);
+        }
+    }
+    template <class RandomAccessIterator>
+    inline void pop_heap(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::pop_heap(first, last, _less());
+    }
+
+    // 从最后一个非叶子节点开始逐个下沉, O(n)建堆
+    template <class RandomAccessIterator, class Compare>
+    void make_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        const Distance len = last - first;
+        if(len < 2)
+            return;
+        for (Distance parent = (len - 2) / 2; ; --parent){
+            T value = std::move(*(first + parent));
+            TinySTL::__adjust_heap(first, parent, len, std::move(value), comp);
+            if(parent == 0)
+                return;
+        }
+    }
+    template <class RandomAccessIterator>
+    inline void make_heap(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::make_heap(first, last, _less());
+    }
+
+    // 反复把堆顶移到末尾, 得到升序的区间
+    template <class RandomAccessIterator, class Compare>
+    void sort_heap(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        while(last - first > 1){
+            --last;
+            TinySTL::__pop_heap(first, last, last, comp);
+        }
+    }
+    template <class RandomAccessIterator>
+    inline void sort_heap(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::sort_heap(first, last, _less());
+    }
+
+    // ***********[sort]、[stable_sort]、[partial_sort]、[nth_element]****************
+    /* sort是pattern-defeating quicksort(pdqsort):
+     * 1. 小区间(少于_insertion_sort_threshold个元素)用插入排序
+     * 2. 枢轴取三数中值, 大区间取九数中值(ninther)
+     * 3. 枢轴和左边界外的元素相等时(重复元素很多), 把等于枢轴的元素都分到左边并直接跳过它们
+     * 4. 分割时没有交换任何元素(区间可能已经有序), 就尝试有限次数的插入排序, 成功就直接返回, 因此已排序、逆序的输入是O(n)的
+     * 5. 分割很不平衡时打乱几个元素破坏造成不平衡的模式, 不平衡的次数超过log(n)次就改用堆排序, 保证最坏O(nlogn)
+     * 算术型别用默认比较时, 分割使用无分支的块分割(BlockQuicksort), 避免比较结果难以预测造成的分支预测失败
+     */
+    enum {
+        _insertion_sort_threshold = 24,     // 少于这个数目的区间用插入排序
+        _ninther_threshold = 128,           // 多于这个数目的区间取九数中值
+        _partial_insertion_sort_limit = 8,  // 尝试插入排序时最多移动的元素个数
+        _partition_block_size = 64,         // 无分支分割每块的元素个数, 偏移量要能放进unsigned char
+        _stable_sort_chunk = 8              // stable_sort先对这么长的小段做插入排序, 再两两归并
+    };
+
+    // 默认比较作用在算术型别上时, 比较结果可以直接当作0/1参与运算, 使用无分支的分割
+    template <class Compare>
+    struct _is_default_compare{
+        enum {value = 0};
+    };
+    template <>
+    struct _is_default_compare<_less>{
+        enum {value = 1};
+    };
+    template <class T>
+    struct _is_default_compare<std::less<T> >{
+        enum {value = 1};
+    };
+    template <class T>
+    struct _is_default_compare<std::greater<T> >{
+        enum {value = 1};
+    };
+
+    template <class RandomAccessIterator, class Compare>
+    struct _sort_traits{
+        typedef typename _bool_type<std::is_arithmetic<typename iterator_traits<RandomAccessIterator>::value_type>::value &&
+                                    _is_default_compare<Compare>::value>::type is_branchless;
+    };
+
+    // floor(log2(n))
+    template <class Size>
+    inline int __lg(Size n){
+        int k = 0;
+        for (; n > 1; n >>= 1)
+            ++k;
+        return k;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    void __insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        if(first == last)
+            return;
+        for (RandomAccessIterator cur = first + 1; cur != last; ++cur){
+            RandomAccessIterator sift = cur, sift_1 = cur - 1;
+            if(comp(*sift, *sift_1)){
+                T tmp = std::move(*sift);
+                do{
+                    *sift-- = std::move(*sift_1);
+                } while(sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+    // 要求*(first - 1)不大于区间里的任何元素, 因此内层循环不需要检查边界
+    template <class RandomAccessIterator, class Compare>
+    void __unguarded_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        if(first == last)
+            return;
+        for (RandomAccessIterator cur = first + 1; cur != last; ++cur){
+            RandomAccessIterator sift = cur, sift_1 = cur - 1;
+            if(comp(*sift, *sift_1)){
+                T tmp = std::move(*sift);
+                do{
+                    *sift-- = std::move(*sift_1);
+                } while(comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+    // 尝试插入排序, 移动的元素超过_partial_insertion_sort_limit个就放弃并返回false
+    template <class RandomAccessIterator, class Compare>
+    bool __partial_insertion_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        if(first == last)
+            return true;
+        ptrdiff_t moved = 0;
+        for (RandomAccessIterator cur = first + 1; cur != last; ++cur){
+            RandomAccessIterator sift = cur, sift_1 = cur - 1;
+            if(comp(*sift, *sift_1)){
+                T tmp = std::move(*sift);
+                do{
+                    *sift-- = std::move(*sift_1);
+                } while(sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+                moved += cur - sift;
+            }
+            if(moved > _partial_insertion_sort_limit)
+                return false;
+        }
+        return true;
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void __sort2(RandomAccessIterator a, RandomAccessIterator b, Compare comp){
+        if(comp(*b, *a))
+            TinySTL::iter_swap(a, b);
+    }
+    // 把*a、*b、*c排成有序
+    template <class RandomAccessIterator, class Compare>
+    inline void __sort3(RandomAccessIterator a, RandomAccessIterator b, RandomAccessIterator c, Compare comp){
+        TinySTL::__sort2(a, b, comp);
+        TinySTL::__sort2(b, c, comp);
+        TinySTL::__sort2(a, b, comp);
+    }
+    // 把中值放到*first作为枢轴; 之后区间里一定有不大于和不小于枢轴的元素, 分割时可以不检查边界
+    template <class RandomAccessIterator, class Compare>
+    inline void __choose_pivot(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        const Distance size = last - first, s2 = size / 2;
+        if(size > _ninther_threshold){
+            TinySTL::__sort3(first, first + s2, last - 1, comp);
+            TinySTL::__sort3(first + 1, first + (s2 - 1), last - 2, comp);
+            TinySTL::__sort3(first + 2, first + (s2 + 1), last - 3, comp);
+            TinySTL::__sort3(first + (s2 - 1), first + s2, first + (s2 + 1), comp);
+            TinySTL::iter_swap(first, first + s2);
+        }
+        else
+            TinySTL::__sort3(first + s2, first, last - 1, comp);
+    }
+
+    // 以*first为枢轴分割, 小于枢轴的在左边, 不小于的在右边, 返回枢轴最后的位置以及分割前是否已经分好
+    template <class RandomAccessIterator, class Compare>
+    std::pair<RandomAccessIterator, bool>
+    __partition_right(RandomAccessIterator begin, RandomAccessIterator end, Compare comp, _false_type){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        T pivot(std::move(*begin));
+        RandomAccessIterator first = begin, last = end;
+        while(comp(*++first, pivot)) {}
+        if(first - 1 == begin)
+            while(first < last && !comp(*--last, pivot)) {}
+        else
+            while(!comp(*--last, pivot)) {}
+        const bool already_partitioned = first >= last;
+        while(first < last){
+            TinySTL::iter_swap(first, last);
+            while(comp(*++first, pivot)) {}
+            while(!comp(*--last, pivot)) {}
+        }
+        RandomAccessIterator pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return std::pair<RandomAccessIterator, bool>(pivot_pos, already_partitioned);
+    }
+
+    // 把左边offsets_l指出的num个元素和右边offsets_r指出的num个元素交换
+    // 两边个数不同时用循环移动代替交换, 每对元素只需要两次移动
+    template <class RandomAccessIterator>
+    inline void __swap_offsets(RandomAccessIterator first, RandomAccessIterator last,
+                               const unsigned char *offsets_l, const unsigned char *offsets_r,
+                               size_t num, bool use_swaps){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        if(use_swaps){
+            for (size_t i = 0; i < num; ++i)
+                TinySTL::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+        }
+        else if(num > 0){
+            RandomAccessIterator l = first + offsets_l[0], r = last - offsets_r[0];
+            T tmp(std::move(*l));
+            *l = std::move(*r);
+            for (size_t i = 1; i < num; ++i){
+                l = first + offsets_l[i];
+                *r = std::move(*l);
+                r = last - offsets_r[i];
+                *l = std::move(*r);
+            }
+            *r = std::move(tmp);
+        }
+    }
+
+    /* 无分支的块分割, 结果和上面的版本相同
+     * 左右两边各扫描一块, 把放错边的元素的偏移量记在数组里, 记录时不判断比较结果, 而是把结果(0或1)加到计数上,
+     * 这样扫描循环里没有依赖比较结果的分支; 之后再成对交换两边放错边的元素
+     */
+    template <class RandomAccessIterator, class Compare>
+    std::pair<RandomAccessIterator, bool>
+    __partition_right(RandomAccessIterator begin, RandomAccessIterator end, Compare comp, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        const size_t block_size = _partition_block_size;
+        T pivot(std::move(*begin));
+        RandomAccessIterator first = begin, last = end;
+        while(comp(*++first, pivot)) {}
+        if(first - 1 == begin)
+            while(first < last && !comp(*--last, pivot)) {}
+        else
+            while(!comp(*--last, pivot)) {}
+        const bool already_partitioned = first >= last;
+        if(!already_partitioned){
+            TinySTL::iter_swap(first, last);
+            ++first;
+
+            alignas(64) unsigned char offsets_l[_partition_block_size];
+            alignas(64) unsigned char offsets_r[_partition_block_size];
+            size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            // 未扫描的部分是[first, last)
+            while(last - first > 2 * _partition_block_size){
+                if(num_l == 0){
+                    start_l = 0;
+                    RandomAccessIterator it = first;
+                    for (unsigned char i = 0; i < block_size; ){
+                        offsets_l[num_l] = i++; num_l += !comp(*it, pivot); ++it;
+                        offsets_l[num_l] = i++; num_l += !comp(*it, pivot); ++it;
+                        offsets_l[num_l] = i++; num_l += !comp(*it, pivot); ++it;
+                        offsets_l[num_l] = i++; num_l += !comp(*it, pivot); ++it;
+                    }
+                }
+                if(num_r == 0){
+                    start_r = 0;
+                    RandomAccessIterator it = last;
+                    for (unsigned char i = 0; i < block_size; ){
+                        offsets_r[num_r] = ++i; num_r += comp(*--it, pivot);
+                        offsets_r[num_r] = ++i; num_r += comp(*--it, pivot);
+                        offsets_r[num_r] = ++i; num_r += comp(*--it, pivot);
+                        offsets_r[num_r] = ++i; num_r += comp(*--it, pivot);
+                    }
+                }
+                const size_t num = num_l < num_r ? num_l : num_r;
+                TinySTL::__swap_offsets(first, last, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+                num_l -= num; num_r -= num;
+                start_l += num; start_r += num;
+                if(num_l == 0)
+                    first += block_size;
+                if(num_r == 0)
+                    last -= block_size;
+            }
+
+            // 剩下不到两块, 还没扫描的元素分给没有剩余偏移量的一边
+            size_t l_size = 0, r_size = 0;
+            const size_t unknown_left = (size_t)(last - first) - ((num_r || num_l) ? block_size : 0);
+            if(num_r){
+                l_size = unknown_left;
+                r_size = block_size;
+            }
+            else if(num_l){
+                l_size = block_size;
+                r_size = unknown_left;
+            }
+            else{
+                l_size = unknown_left / 2;
+                r_size = unknown_left - l_size;
+            }
+            if(unknown_left && !num_l){
+                start_l = 0;
+                RandomAccessIterator it = first;
+                for (unsigned char i = 0; i < l_size; ){
+                    offsets_l[num_l] = i++; num_l += !comp(*it, pivot); ++it;
+                }
+            }
+            if(unknown_left && !num_r){
+                start_r = 0;
+                RandomAccessIterator it = last;
+                for (unsigned char i = 0; i < r_size; ){
+                    offsets_r[num_r] = ++i; num_r += comp(*--it, pivot);
+                }
+            }
+            const size_t num = num_l < num_r ? num_l : num_r;
+            TinySTL::__swap_offsets(first, last, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+            num_l -= num; num_r -= num;
+            start_l += num; start_r += num;
+            if(num_l == 0)
+                first += l_size;
+            if(num_r == 0)
+                last -= r_size;
+
+            // 最多只有一边还有放错边的元素, 把它们逐个换到分界处
+            if(num_l){
+                const unsigned char *offsets = offsets_l + start_l;
+                while(num_l--)
+                    TinySTL::iter_swap(first + offsets[num_l], --last);
+                first = last;
+            }
+            if(num_r){
+                const unsigned char *offsets = offsets_r + start_r;
+                while(num_r--){
+                    TinySTL::iter_swap(last - offsets[num_r], first);
+                    ++first;
+                }
+                last = first;
+            }
+        }
+        RandomAccessIterator pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return std::pair<RandomAccessIterator, bool>(pivot_pos, already_partitioned);
+    }
+
+    // 以*first为枢轴分割, 不大于枢轴的在左边, 大于的在右边, 返回枢轴最后的位置
+    // 用于枢轴等于左边界外的元素的情况, 此时左边的元素都等于枢轴, 不需要再排序
+    template <class RandomAccessIterator, class Compare>
+    RandomAccessIterator __partition_left(RandomAccessIterator begin, RandomAccessIterator end, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        T pivot(std::move(*begin));
+        RandomAccessIterator first = begin, last = end;
+        while(comp(pivot, *--last)) {}
+        if(last + 1 == end)
+            while(first < last && !comp(pivot, *++first)) {}
+        else
+            while(!comp(pivot, *++first)) {}
+        while(first < last){
+            TinySTL::iter_swap(first, last);
+            while(comp(pivot, *--last)) {}
+            while(!comp(pivot, *++first)) {}
+        }
+        RandomAccessIterator pivot_pos = last;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return pivot_pos;
+    }
+
+    // 分割很不平衡时, 把两边各交换几个元素, 打破造成不平衡的输入模式
+    template <class RandomAccessIterator>
+    void __break_patterns(RandomAccessIterator first, RandomAccessIterator pivot_pos, RandomAccessIterator last){
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        const Distance l_size = pivot_pos - first, r_size = last - (pivot_pos + 1);
+        if(l_size >= _insertion_sort_threshold){
+            TinySTL::iter_swap(first, first + l_size / 4);
+            TinySTL::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+            if(l_size > _ninther_threshold){
+                TinySTL::iter_swap(first + 1, first + (l_size / 4 + 1));
+                TinySTL::iter_swap(first + 2, first + (l_size / 4 + 2));
+                TinySTL::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                TinySTL::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+            }
+        }
+        if(r_size >= _insertion_sort_threshold){
+            TinySTL::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+            TinySTL::iter_swap(last - 1, last - r_size / 4);
+            if(r_size > _ninther_threshold){
+                TinySTL::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                TinySTL::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                TinySTL::iter_swap(last - 2, last - (1 + r_size / 4));
+                TinySTL::iter_swap(last - 3, last - (2 + r_size / 4));
+            }
+        }
+    }
+
+    // leftmost为false时, *(first - 1)不大于区间里的任何元素
+    template <class RandomAccessIterator, class Compare, class Branchless>
+    void __pdqsort_loop(RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+                        int bad_allowed, bool leftmost, Branchless is_branchless){
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        while(true){
+            const Distance size = last - first;
+            if(size < _insertion_sort_threshold){
+                if(leftmost)
+                    TinySTL::__insertion_sort(first, last, comp);
+                else
+                    TinySTL::__unguarded_insertion_sort(first, last, comp);
+                return;
+            }
+            TinySTL::__choose_pivot(first, last, comp);
+
+            // 枢轴等于左边界外的元素, 说明有很多重复元素, 等于枢轴的元素都分到左边后就不用再管了
+            if(!leftmost && !comp(*(first - 1), *first)){
+                first = TinySTL::__partition_left(first, last, comp) + 1;
+                continue;
+            }
+
+            std::pair<RandomAccessIterator, bool> part = TinySTL::__partition_right(first, last, comp, is_branchless);
+            RandomAccessIterator pivot_pos = part.first;
+            const Distance l_size = pivot_pos - first, r_size = last - (pivot_pos + 1);
+            if(l_size < size / 8 || r_size < size / 8){
+                if(--bad_allowed == 0){
+                    TinySTL::make_heap(first, last, comp);
+                    TinySTL::sort_heap(first, last, comp);
+                    return;
+                }
+                TinySTL::__break_patterns(first, pivot_pos, last);
+            }
+            else if(part.second && TinySTL::__partial_insertion_sort(first, pivot_pos, comp)
+                                && TinySTL::__partial_insertion_sort(pivot_pos + 1, last, comp))
+                return;
+
+            // 递归处理左边, 循环处理右边
+            TinySTL::__pdqsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, is_branchless);
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void __sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, random_access_iterator_tag){
+        if(last - first < 2)
+            return;
+        typedef typename _sort_traits<RandomAccessIterator, Compare>::is_branchless is_branchless;
+        TinySTL::__pdqsort_loop(first, last, comp, TinySTL::__lg(last - first), true, is_branchless());
+    }
+    // 把区间[first, last)按comp排成升序, 不保证相等元素的相对次序, 只接受随机访问迭代器(list有自己的sort成员函数)
+    template <class RandomAccessIterator, class Compare>
+    inline void sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::__sort(first, last, comp, iterator_category(first));
+    }
+    template <class RandomAccessIterator>
+    inline void sort(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::__sort(first, last, _less(), iterator_category(first));
+    }
+
+    /* stable_sort的临时缓冲区, 里面的元素都是已经构造好的
+     * 元素从*seed开始依次移动构造(每个都从前一个移动过来), 最后再移回*seed, 因此只要求T可以移动, 不要求有默认构造函数
+     */
+    template <class T>
+    class _temporary_buffer{
+    public:
+        template <class Iterator>
+        _temporary_buffer(Iterator seed, size_t n) : buffer(allocator<T>::allocate(n)), len(0), capacity(n){
+            if(n == 0)
+                return;
+            try{
+                TinySTL::construct(buffer, std::move(*seed));
+                for (len = 1; len < n; ++len)
+                    TinySTL::construct(buffer + len, std::move(buffer[len - 1]));
+            }
+            catch(...){
+                TinySTL::destory(buffer, buffer + len);
+                allocator<T>::deallocate(buffer, capacity);
+                throw;
+            }
+            *seed = std::move(buffer[len - 1]);
+        }
+        ~_temporary_buffer(){
+            TinySTL::destory(buffer, buffer + len);
+            allocator<T>::deallocate(buffer, capacity);
+        }
+        T *begin() { return buffer; }
+    private:
+        _temporary_buffer(const _temporary_buffer &);
+        _temporary_buffer &operator=(const _temporary_buffer &);
+        T *buffer;
+        size_t len, capacity;
+    };
+
+    // 把有序的[first1, last1)和[first2, last2)归并到result, 相等时先取第一个区间的元素, 返回结果的末尾
+    template <class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+    OutputIterator __move_merge(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2,
+                                OutputIterator result, Compare comp){
+        if(first1 != last1 && first2 != last2 && !comp(*first2, *(last1 - 1))) // 两段首尾相接(例如输入本来就有序), 不用比较
+            return TinySTL::move(first2, last2, TinySTL::move(first1, last1, result));
+        while(first1 != last1 && first2 != last2){
+            if(comp(*first2, *first1))
+                *result = std::move(*first2++);
+            else
+                *result = std::move(*first1++);
+            ++result;
+        }
+        return TinySTL::move(first2, last2, TinySTL::move(first1, last1, result));
+    }
+
+    // 把[first, last)里每step个元素一段, 相邻两段归并后写到result
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class Distance, class Compare>
+    void __merge_sort_loop(RandomAccessIterator1 first, RandomAccessIterator1 last, RandomAccessIterator2 result,
+                           Distance step, Compare comp){
+        const Distance two_step = 2 * step;
+        while(last - first >= two_step){
+            result = TinySTL::__move_merge(first, first + step, first + step, first + two_step, result, comp);
+            first += two_step;
+        }
+        if(last - first < step)
+            step = last - first;
+        TinySTL::__move_merge(first, first + step, first + step, last, result, comp);
+    }
+
+    /* 自底向上的归并排序, 缓冲区要能放下整个区间
+     * 先对每_stable_sort_chunk个元素的小段做插入排序, 然后在原区间和缓冲区之间来回归并, 每一轮每个元素只移动一次
+     */
+    template <class RandomAccessIterator, class T, class Compare>
+    void __merge_sort_with_buffer(RandomAccessIterator first, RandomAccessIterator last, T *buffer, Compare comp){
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        const Distance len = last - first;
+        T *const buffer_last = buffer + len;
+        Distance step = _stable_sort_chunk;
+        RandomAccessIterator it = first;
+        for (; last - it >= step; it += step)
+            TinySTL::__insertion_sort(it, it + step, comp);
+        TinySTL::__insertion_sort(it, last, comp);
+        while(step < len){
+            TinySTL::__merge_sort_loop(first, last, buffer, step, comp);
+            step *= 2;
+            TinySTL::__merge_sort_loop(buffer, buffer_last, first, step, comp);
+            step *= 2;
+        }
+    }
+
+    // 借助缓冲区归并有序的[first, middle)和[middle, last), 缓冲区至少能放下middle - first个元素
+    // 左半边先移到缓冲区, 再从前往后归并回原区间, 右半边剩下的元素已经在正确的位置上
+    template <class RandomAccessIterator, class T, class Compare>
+    void __merge_with_buffer(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last,
+                             T *buffer, Compare comp){
+        T *buffer_end = TinySTL::move(first, middle, buffer);
+        T *left = buffer;
+        RandomAccessIterator right = middle, out = first;
+        while(left != buffer_end && right != last){
+            if(comp(*right, *left))
+                *out++ = std::move(*right++);
+            else
+                *out++ = std::move(*left++);
+        }
+        TinySTL::move(left, buffer_end, out);
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    void __stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, random_access_iterator_tag){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        const size_t len = last - first;
+        if(len <= _stable_sort_chunk){
+            TinySTL::__insertion_sort(first, last, comp);
+            return;
+        }
+        // 两半分别在缓冲区的帮助下排好, 再归并起来, 因此缓冲区只需要一半的大小
+        const size_t half = (len + 1) / 2;
+        _temporary_buffer<T> buffer(first, half);
+        RandomAccessIterator middle = first + half;
+        TinySTL::__merge_sort_with_buffer(first, middle, buffer.begin(), comp);
+        TinySTL::__merge_sort_with_buffer(middle, last, buffer.begin(), comp);
+        if(comp(*middle, *(middle - 1)))
+            TinySTL::__merge_with_buffer(first, middle, last, buffer.begin(), comp);
+    }
+    // 把区间[first, last)按comp排成升序, 相等元素保持原来的相对次序, 需要n/2个元素的临时缓冲区
+    template <class RandomAccessIterator, class Compare>
+    inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::__stable_sort(first, last, comp, iterator_category(first));
+    }
+    template <class RandomAccessIterator>
+    inline void stable_sort(RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::__stable_sort(first, last, _less(), iterator_category(first));
+    }
+
+    // 用[first, middle)上的最大堆从整个区间里挑出最小的middle - first个元素, 堆顶是其中最大的
+    template <class RandomAccessIterator, class Compare>
+    void __heap_select(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp){
+        TinySTL::make_heap(first, middle, comp);
+        for (RandomAccessIterator it = middle; it < last; ++it)
+            if(comp(*it, *first))
+                TinySTL::__pop_heap(first, middle, it, comp);
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void __partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last,
+                               Compare comp, random_access_iterator_tag){
+        if(first == middle)
+            return;
+        TinySTL::__heap_select(first, middle, last, comp);
+        TinySTL::sort_heap(first, middle, comp);
+    }
+    // 把最小的middle - first个元素按升序放到[first, middle), 其余元素的次序不确定
+    template <class RandomAccessIterator, class Compare>
+    inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp){
+        TinySTL::__partial_sort(first, middle, last, comp, iterator_category(first));
+    }
+    template <class RandomAccessIterator>
+    inline void partial_sort(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last){
+        TinySTL::__partial_sort(first, middle, last, _less(), iterator_category(first));
+    }
+
+    // 和sort使用相同的枢轴选择和分割, 但只继续处理包含nth的一边; 分割不平衡的次数太多时改用堆选择
+    template <class RandomAccessIterator, class Compare>
+    void __nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last,
+                       Compare comp, random_access_iterator_tag){
+        typedef typename _sort_traits<RandomAccessIterator, Compare>::is_branchless is_branchless;
+        if(nth >= last || last - first < 2)
+            return;
+        int bad_allowed = TinySTL::__lg(last - first);
+        bool leftmost = true;
+        while(last - first >= _insertion_sort_threshold){
+            TinySTL::__choose_pivot(first, last, comp);
+            if(!leftmost && !comp(*(first - 1), *first)){
+                RandomAccessIterator pivot_pos = TinySTL::__partition_left(first, last, comp);
+                if(nth <= pivot_pos) // [first, pivot_pos]里的元素都等于枢轴
+                    return;
+                first = pivot_pos + 1;
+                continue;
+            }
+            const ptrdiff_t size = last - first;
+            RandomAccessIterator pivot_pos = TinySTL::__partition_right(first, last, comp, is_branchless()).first;
+            if(pivot_pos == nth)
+                return;
+            if(pivot_pos - first < size / 8 || last - (pivot_pos + 1) < size / 8){
+                if(--bad_allowed == 0){
+                    TinySTL::__heap_select(first, nth + 1, last, comp);
+                    TinySTL::iter_swap(first, nth);
+                    return;
+                }
+                TinySTL::__break_patterns(first, pivot_pos, last);
+            }
+            if(nth < pivot_pos)
+                last = pivot_pos;
+            else{
+                first = pivot_pos + 1;
+                leftmost = false;
+            }
+        }
+        if(leftmost)
+            TinySTL::__insertion_sort(first, last, comp);
+        else
+            TinySTL::__unguarded_insertion_sort(first, last, comp);
+    }
+    // 重新排列区间, 使*nth等于排序后位于nth的元素, 它左边的元素都不大于它, 右边的都不小于它
+    template <class RandomAccessIterator, class Compare>
+    inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last, Compare comp){
+        TinySTL::__nth_element(first, nth, last, comp, iterator_category(first));
+    }
+    template <class RandomAccessIterator>
+    inline void nth_element(RandomAccessIterator first, RandomAccessIterator nth, RandomAccessIterator last){
+        TinySTL::__nth_element(first, nth, last, _less(), iterator_category(first));
+    }
+
+    // ***********[radix_sort]****************
+    /* 把键转换成无符号整数, 使无符号整数的大小顺序和键原来的顺序相同
+     * 有符号整数翻转符号位; IEEE浮点数是正数时翻转符号位, 是负数时翻转所有位
+     * 浮点数因此按全序排列: -NaN < -inf < ... < -0.0 < +0.0 < ... < +inf < +NaN
+     */
+    template <class Key, bool = std::is_integral<Key>::value>
+    struct _radix_key_traits{
+        typedef typename std::make_unsigned<Key>::type bits_type;
+        static bits_type encode(Key x){
+            return std::is_signed<Key>::value ? (bits_type)((bits_type)x ^ ((bits_type)1 << (sizeof(Key) * 8 - 1))) : (bits_type)x;
+        }
+    };
+    template <>
+    struct _radix_key_traits<bool, true>{
+        typedef unsigned char bits_type;
+        static bits_type encode(bool x) { return x; }
+    };
+    template <class Key>
+    struct _radix_key_traits<Key, false>{
+        static_assert(std::is_floating_point<Key>::value && (sizeof(Key) == 4 || sizeof(Key) == 8),
+                      "radix_sort only supports integer and IEEE float keys");
+        typedef typename std::conditional<sizeof(Key) == 4, uint32_t, uint64_t>::type bits_type;
+        static bits_type encode(Key x){
+            bits_type bits;
+            memcpy(&bits, &x, sizeof(bits));
+            const bits_type sign = (bits_type)1 << (sizeof(Key) * 8 - 1);
+            return (bits & sign) ? (bits_type)~bits : (bits_type)(bits | sign);
+        }
+    };
+
+    // 元素本身就是键
+    struct _identity_key{
+        template <class T>
+        const T& operator()(const T& x) const { return x; }
+    };
+
+    // 按编码后的键比较, 小区间用插入排序时和基数排序的顺序一致(包括浮点数的正负零和NaN)
+    template <class KeyOf>
+    struct _radix_key_less{
+        KeyOf key;
+        explicit _radix_key_less(KeyOf k) : key(k) {}
+        template <class T>
+        bool operator()(const T& a, const T& b) const{
+            typedef typename std::decay<decltype(key(a))>::type Key;
+            return _radix_key_traits<Key>::encode(key(a)) < _radix_key_traits<Key>::encode(key(b));
+        }
+    };
+
+    enum {
+        _radix_bits = 11,                       // 每一趟处理的位数, 32位的键3趟, 64位的键6趟; 2048个桶还能放进L1/L2 cache
+        _radix_buckets = 1 << _radix_bits,
+        _radix_sort_threshold = 64              // 少于这个数目的区间直接插入排序
+    };
+
+    /* 最低位优先(LSD)的基数排序, 每趟按11位分配, 是稳定的
+     * 先用一遍扫描统计出所有趟的直方图, 某一位在所有键上都相同的趟直接跳过(例如都是小整数时的高位)
+     * 元素在src和buffer之间来回分配, 返回最后结果所在的区间
+     */
+    template <class T, class KeyOf>
+    T *__radix_sort_passes(T *src, T *buffer, size_t n, KeyOf key){
+        typedef typename std::decay<decltype(key(*src))>::type Key;
+        typedef _radix_key_traits<Key> traits;
+        typedef typename traits::bits_type bits_type;
+        const int passes = (sizeof(bits_type) * 8 + _radix_bits - 1) / _radix_bits;
+        size_t *counts = allocator<size_t>::allocate(passes * _radix_buckets); // 64位的键要96KB, 不放在栈上
+        memset(counts, 0, passes * _radix_buckets * sizeof(size_t));
+        for (size_t i = 0; i < n; ++i){
+            bits_type bits = traits::encode(key(src[i]));
+            for (int p = 0; p < passes; ++p)
+                ++counts[p * _radix_buckets + ((bits >> (p * _radix_bits)) & (_radix_buckets - 1))];
+        }
+        const bits_type first_bits = traits::encode(key(src[0]));
+        T *dst = buffer;
+        for (int p = 0; p < passes; ++p){
+            const int shift = p * _radix_bits;
+            size_t *count = counts + p * _radix_buckets;
+            if(count[(first_bits >> shift) & (_radix_buckets - 1)] == n)
+                continue; // 这一位在所有键上都相同
+            size_t offset = 0;
+            for (int b = 0; b < _radix_buckets; ++b){
+                size_t c = count[b];
+                count[b] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i){
+                const size_t b = (traits::encode(key(src[i])) >> shift) & (_radix_buckets - 1);
+                dst[count[b]++] = std::move(src[i]);
+            }
+            T *t = src;
+            src = dst;
+            dst = t;
+        }
+        allocator<size_t>::deallocate(counts, passes * _radix_buckets);
+        return src;
+    }
+
+    // 平凡可复制的元素: 缓冲区不需要构造, 最后整块复制回来
+    template <class T, class KeyOf>
+    void __radix_sort(T *first, size_t n, KeyOf key, _true_type){
+        T *buffer = allocator<T>::allocate(n);
+        T *result = TinySTL::__radix_sort_passes(first, buffer, n, key);
+        if(result != first)
+            memcpy(first, result, n * sizeof(T));
+        allocator<T>::deallocate(buffer, n);
+    }
+    // 其他元素: 缓冲区里是构造好的元素, 按移动赋值分配
+    template <class T, class KeyOf>
+    void __radix_sort(T *first, size_t n, KeyOf key, _false_type){
+        _temporary_buffer<T> buffer(first, n);
+        T *result = TinySTL::__radix_sort_passes(first, buffer.begin(), n, key);
+        if(result != first)
+            TinySTL::move(result, result + n, first);
+    }
+
+    /* 对连续存放的区间(原生指针, 包括vector的迭代器)做基数排序, 键是key(*it), 必须是整数或float/double
+     * 复杂度是O(n * sizeof(键)), 不做比较; 排序是稳定的; 需要n个元素的临时缓冲区(由Alloc分配)
+     */
+    template <class T, class KeyOf>
+    void radix_sort(T *first, T *last, KeyOf key){
+        const size_t n = last - first;
+        if(n < _radix_sort_threshold){
+            TinySTL::__insertion_sort(first, last, _radix_key_less<KeyOf>(key));
+            return;
+        }
+        typedef typename _type_traits<T>::is_POD_type is_POD;
+        TinySTL::__radix_sort(first, n, key, is_POD());
+    }
+    template <class T>
+    inline void radix_sort(T *first, T *last){
+        TinySTL::radix_sort(first, last, _identity_key());
+    }
 }
 #endif
\ No newline at end of file
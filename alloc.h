@@ -2,42 +2,274 @@
 #define _ALLOC_H_
 
 #include <cstdlib>
+#include <cstdio>
+#ifdef TINYSTL_ALLOC_STATS
+#include <atomic>
+#endif
+
+#ifndef TINYSTL_NO_THREADS
+    #define __TINYSTL_THREAD_LOCAL thread_local
+#else
+    #define __TINYSTL_THREAD_LOCAL
+#endif
+
+/* 多线程模式(默认开启):
+ * 每个线程都有一份自己的线程缓存(thread_cache), 小区块的申请和释放只在线程缓存上进行, 不需要加锁
+ * 线程缓存为空或者超出上限时, 才会加锁去中心仓库(free_list和内存池)成批地取回或归还区块
+ * 如果确定只在单线程下使用, 可以在包含本头文件之前定义 TINYSTL_NO_THREADS 去掉加锁的开销
+ *
+ * 统计信息:
+ * 定义 TINYSTL_ALLOC_STATS 之后才会记录各种计数器, 没有定义时计数的语句全部被编译掉
+ * 快速路径上的计数器放在线程缓存里, 只由本线程写入, 不需要原子的读-改-写操作
+ */
+
+#ifdef TINYSTL_ALLOC_STATS
+    #define __ALLOC_STAT(stmt) stmt
+#else
+    #define __ALLOC_STAT(stmt)
+#endif
 
 namespace TinySTL{
     class Alloc{
+        friend struct __alloc_test_access; // 测试代码用来构造内存池的特殊状态
     private:
         enum {__ALIGN = 8}; // 小型区块的上调边界
-        enum {__MAX_BYTES = 128}; // 小型区块的上限
-        enum {__NFREELISTS = __MAX_BYTES / __ALIGN}; // 维护的自由链表个数
+        enum {__SMALL_BYTES = 128}; // 128字节以内按8字节等距分档
+        enum {__SMALL_CLASSES = __SMALL_BYTES / __ALIGN}; // 等距分档的个数
+        enum {__MAX_BYTES = 4096}; // 小型区块的上限
+        enum {__NFREELISTS = __SMALL_CLASSES + 4 * 5}; // 维护的自由链表个数, 128以上每翻一倍分4档, 共翻5倍
+        enum {__BATCH_OBJS = 20}; // 线程缓存与中心仓库之间一次搬运的区块个数(初始值)
+        enum {__BATCH_BYTES = 16 * 1024}; // 大区块一次搬运的字节数上限(初始值)
+        enum {__MAX_BATCH_BYTES = 64 * 1024}; // 自适应调整时一次搬运的字节数上限
+        enum {__MAX_CLASS_ALIGN = 64}; // 各档区块的自然对齐最多保证到64字节(一条cache line)
+        enum {__MMAP_CHUNK_BYTES = 2 * 1024 * 1024}; // mmap得到的chunk的大小和对齐单位(一个大页)
     private:
         // free_list的节点结构体
         union obj{
             union obj *next; //指向下一个节点
         };
-        // 16个自由链表, 分别负责分配区块大小为8, 16, 24, ... 128字节的空间
+        // 中心仓库的36个自由链表, 区块大小为8, 16, 24, ... 128字节, 然后是160, 192, 224, 256, 320, ... 4096字节
+        // 128字节以上的档位间隔是上一个2的幂的1/4, 因此内部碎片不超过25%
         static obj *free_list[__NFREELISTS];
+        static const unsigned short class_size[__NFREELISTS]; // 每一档的区块大小
+        static const unsigned char log2_table[32]; // log2_table[k]为不大于log2(k)的最大整数
+        // 线程缓存, 每个线程一份, 结构和中心仓库的free_list一样, 另外记录每条链表上的区块个数
+        struct thread_cache{
+            obj *list[__NFREELISTS];
+            size_t count[__NFREELISTS];
+            size_t limit[__NFREELISTS]; // 每条链表最多保留的区块数, 为0表示还没有从中心仓库取过这一档
+            bool destroyed; // 已经析构, 之后本线程其他thread_local对象的析构函数里的申请和释放都直接找中心仓库
+#ifdef TINYSTL_ALLOC_STATS
+            // 以下计数器只由本线程写入, 其他线程在取统计快照时读取
+            std::atomic<size_t> alloc_count[__NFREELISTS];
+            std::atomic<size_t> free_count[__NFREELISTS];
+            std::atomic<size_t> large_alloc_count; // 大于4096字节交给malloc的次数
+            std::atomic<size_t> large_free_count;
+            thread_cache *next_registered; // 所有注册过的线程缓存串成一条链表
+            bool registered;
+#endif
+            ~thread_cache(); // 线程退出时把缓存的区块全部还给中心仓库
+        };
+        // 当前线程的线程缓存, 是零初始化的, 第一次使用时各链表都为空
+        static __TINYSTL_THREAD_LOCAL thread_cache tls_cache;
     private:
         static char *start_free; // 内存池的起始位置
         static char *end_free; // 内存池的结束位置
-        static size_t heap_size; // 堆的大小
+        static size_t heap_size; // 堆的大小, 即目前所有chunk的总字节数
+    private:
+        // 每次向系统申请的大区块(chunk)的头部, 所有chunk串成一条链表, trim时用来判断哪些chunk可以还给系统
+        struct chunk_header{
+            chunk_header *next;
+            size_t size; // 整个chunk的字节数(包括头部)
+            size_t free_bytes; // trim时统计出的空闲字节数
+            bool mapped; // 是否是用mmap得到的, 归还时要用munmap
+        };
+        enum {CHUNK_HEADER_SIZE = (sizeof(chunk_header) + __ALIGN - 1) & ~(__ALIGN - 1)};
+        static chunk_header *chunk_list;
+        static size_t depot_free_bytes; // 中心仓库链表上的空闲字节数(不含内存池中剩余的部分)
+        static size_t trim_threshold; // 自动trim的阈值, 为0表示不自动trim
+        static size_t next_auto_trim; // 空闲字节数超过这个值时进行下一次自动trim
+        // 每一档当前的搬运个数, 为0表示使用初始值BATCH_OBJS, 由中心仓库的锁保护
+        // 自适应模式下, 每次refill要去内存池切新区块(说明这一档很热)就翻倍, 直到__MAX_BATCH_BYTES
+        // 线程缓存溢出要把区块还回来(说明取多了用不完)就减半, 直到初始值的1/4
+        static size_t batch_objs[__NFREELISTS];
+        static bool adaptive_refill;
+        static bool mmap_chunks; // chunk是否通过mmap申请
+#ifdef TINYSTL_ALLOC_STATS
     private:
-        //根据区块大小bytes决定使用第n号free_list, n从0开始
+        // 以下统计量都由中心仓库的锁保护
+        static thread_cache *registered_caches; // 注册过的线程缓存
+        static size_t retired_alloc_count[__NFREELISTS]; // 已退出线程的计数
+        static size_t retired_free_count[__NFREELISTS];
+        static size_t retired_large_alloc_count;
+        static size_t retired_large_free_count;
+        static size_t depot_count[__NFREELISTS]; // 中心仓库每条链表上的区块数
+        static size_t depot_out[__NFREELISTS]; // 从中心仓库分给线程缓存的区块数(净值)
+        static size_t peak_out[__NFREELISTS]; // depot_out的最大值
+        static size_t refill_count[__NFREELISTS];
+        static size_t chunk_alloc_count; // chunk_alloc的调用次数
+        static size_t system_alloc_count; // 向系统申请chunk的次数
+        static size_t peak_heap_size;
+        static size_t trimmed_bytes; // trim累计还给系统的字节数
+        static std::atomic<size_t> large_live_bytes; // 交给malloc的区块中还没有释放的字节数
+        static std::atomic<size_t> peak_large_bytes;
+        static void register_cache(thread_cache &cache);
+        static void stat_add(std::atomic<size_t> &counter, size_t n){
+            // 只有本线程会写这个计数器, 用load + store代替fetch_add, 避免带lock前缀的指令
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+        static void stat_large(size_t bytes, bool alloc);
+#endif
+    private:
+        //根据区块大小bytes决定使用第n号free_list, n从0开始, 要求0 < bytes <= __MAX_BYTES
         static size_t FREELIST_INDEX(size_t bytes){
-            return (((bytes) + __ALIGN-1) / __ALIGN - 1); 
+            if(bytes <= __SMALL_BYTES)
+                return (((bytes) + __ALIGN-1) / __ALIGN - 1);
+            // (128 << g, 256 << g]这一组分4档, 每档间隔为32 << g
+            size_t g = log2_table[(bytes - 1) >> 7];
+            return __SMALL_CLASSES + 4 * g + ((bytes - 1) >> (g + 5)) - 4;
+        }
+        // 第index号free_list的区块大小
+        static size_t CLASS_SIZE(size_t index){
+            return class_size[index];
+        }
+        // 第index号free_list的区块的自然对齐: 区块大小中最低的那个1所代表的2的幂, 最多64字节
+        // 内存池切割区块时会先对齐到这个边界, 因此同一档的区块都满足这个对齐, 例如192字节的区块按64字节对齐
+        static size_t CLASS_ALIGN(size_t index){
+            size_t align = class_size[index] & (0 - (size_t)class_size[index]);
+            return align > __MAX_CLASS_ALIGN ? (size_t)__MAX_CLASS_ALIGN : align;
+        }
+        // 把指针p上调到alignment的倍数
+        static char *ALIGN_UP(char *p, size_t alignment){
+            return (char *)(((size_t)p + alignment - 1) & ~(alignment - 1));
+        }
+        // 线程缓存与中心仓库之间每次搬运的区块个数, 区块越大搬得越少
+        static size_t BATCH_OBJS(size_t index){
+            size_t n = __BATCH_BYTES / class_size[index];
+            return n > (size_t)__BATCH_OBJS ? (size_t)__BATCH_OBJS : (n < 2 ? 2 : n);
+        }
+        // 第index号链表当前的搬运个数, 调用前必须已持有中心仓库的锁
+        static size_t current_batch(size_t index){
+            if(batch_objs[index] == 0)
+                batch_objs[index] = BATCH_OBJS(index);
+            return batch_objs[index];
         }
         //将bytes上调至8的倍数
         static size_t ROUND_UP(size_t bytes){
             return (((bytes) + __ALIGN - 1) & ~(__ALIGN - 1)); // 暂时我还不知道为什么这样进行逻辑运算
         }
-        // 这个函数主要用来从内存池中取空间给free_list
+        // 取得当前线程的线程缓存
+        static thread_cache &local_cache() { return tls_cache; }
+        // 把内存池中的一段零头切成区块挂到中心仓库的链表上, 调用前必须已持有中心仓库的锁
+        static void give_to_free_lists(char *p, size_t bytes);
+        // 向系统申请一个至少能放下bytes字节的chunk, bytes会被改成chunk中实际可用的字节数, 失败返回0
+        static chunk_header *system_alloc_chunk(size_t &bytes);
+        // 把chunk还给系统
+        static void system_free_chunk(chunk_header *chunk);
+        // 这个函数主要用来从内存池中取空间给free_list, 调用前必须已持有中心仓库的锁
         static char *chunk_alloc(size_t size, int &nobjs);
-        // 这个函数主要用来切割由chunk_alloc得到的大区块，并且把第一个区块返回给客户端
-        static void *refill(size_t n);
+        // 线程缓存为空时调用, 从中心仓库成批取回第index号链表的区块, 并且把第一个区块返回给客户端
+        static void *refill(size_t index);
+        // 把线程缓存第index号链表头部的nobjs个区块归还给中心仓库
+        // overflow表示是因为线程缓存超过上限而归还的, 只有这种情况才减少这一档的搬运个数
+        static void release_to_depot(thread_cache &cache, size_t index, size_t nobjs, bool overflow);
+        // 线程缓存的第index号链表超过上限时调用
+        static void cache_overflow(thread_cache &cache, size_t index);
+        // 线程缓存已经析构时, 直接从中心仓库申请一个区块, 或者把区块直接还给中心仓库
+        static void *depot_allocate(size_t index);
+        static void depot_deallocate(void *ptr, size_t index);
+        // 对齐要求超过8字节时的申请/释放路径
+        static size_t aligned_class_bytes(size_t bytes, size_t alignment);
+        static void *allocate_aligned(size_t bytes, size_t alignment);
+        static void deallocate_aligned(void *ptr, size_t bytes, size_t alignment);
+        static void *reallocate_aligned(void *ptr, size_t old_sz, size_t new_sz, size_t alignment);
+        static bool try_expand_aligned(void *ptr, size_t old_sz, size_t new_sz, size_t alignment);
+        // 找到地址p所属的chunk, chunks是按地址排好序的chunk数组
+        static chunk_header *find_chunk(chunk_header **chunks, size_t n, const char *p);
+        // 把完全空闲的chunk还给系统, 返回归还的字节数, 调用前必须已持有中心仓库的锁
+        static size_t trim_depot();
     public:
         static void *allocate(size_t bytes);
         static void deallocate(void *ptr, size_t bytes);
         static void *reallocate(void *ptr, size_t old_sz, size_t new_sz);
+        // 判断区块ptr能否原地从old_sz扩展(或收缩)到new_sz, 能的话返回true, 之后按new_sz释放
+        // 小区块要求新旧大小落在同一档, 大区块要求malloc实际给出的空间足够
+        static bool try_expand(void *ptr, size_t old_sz, size_t new_sz);
+
+        // 以下是带对齐要求的版本, alignment必须是2的幂, 释放时要传入和申请时相同的alignment
+        // 对齐不超过8字节时和上面的版本完全一样; 不超过64字节并且区块不大时, 从自然对齐足够的那一档分配;
+        // 否则直接向系统申请对齐的内存(posix_memalign/_aligned_malloc)
+        static void *allocate(size_t bytes, size_t alignment){
+            return alignment <= __ALIGN ? allocate(bytes) : allocate_aligned(bytes, alignment);
+        }
+        static void deallocate(void *ptr, size_t bytes, size_t alignment){
+            if(alignment <= __ALIGN)
+                deallocate(ptr, bytes);
+            else
+                deallocate_aligned(ptr, bytes, alignment);
+        }
+        static void *reallocate(void *ptr, size_t old_sz, size_t new_sz, size_t alignment){
+            return alignment <= __ALIGN ? reallocate(ptr, old_sz, new_sz)
+                                        : reallocate_aligned(ptr, old_sz, new_sz, alignment);
+        }
+        static bool try_expand(void *ptr, size_t old_sz, size_t new_sz, size_t alignment){
+            return alignment <= __ALIGN ? try_expand(ptr, old_sz, new_sz)
+                                        : try_expand_aligned(ptr, old_sz, new_sz, alignment);
+        }
+
+        // 把当前线程缓存中的区块还给中心仓库, 然后把所有区块都已回到中心仓库的chunk还给系统
+        // 返回还给系统的字节数. 其他线程缓存中的区块不受影响, 它们所在的chunk不会被归还
+        static size_t trim();
+        // 设置自动trim的阈值: 中心仓库中的空闲字节数每增长bytes, 就自动trim一次, 为0表示关闭(默认)
+        static void set_trim_threshold(size_t bytes);
+        // 打开(默认)或关闭每一档搬运个数的自适应调整, 同时把各档的搬运个数恢复为初始值
+        static void set_adaptive_refill(bool on);
+        // 选择之后的chunk从哪里申请: false表示malloc(默认), true表示mmap
+        // mmap得到的chunk按2MB对齐, 并且在支持的系统上用MADV_HUGEPAGE请求透明大页, 以减少遍历大容器时的TLB缺失
+        // 定义了TINYSTL_ALLOC_MMAP时默认使用mmap. 系统不支持mmap时返回false, 仍然使用malloc
+        // 已经申请的chunk不受影响, 归还时各自用对应的方式释放
+        static bool set_mmap_chunks(bool on);
+
+    public:
+        // 分配器的统计快照
+        // 其他线程的计数器是不加锁读取的, 因此快照里的使用中/空闲区块数只是近似值
+        struct stats{
+            enum {class_count = __NFREELISTS};
+            struct size_class{
+                size_t block_size; // 区块大小
+                size_t alloc_count; // allocate的次数
+                size_t free_count; // deallocate的次数
+                size_t live_blocks; // 正在被客户端使用的区块数
+                size_t free_blocks; // 空闲区块数(中心仓库 + 各线程缓存)
+                size_t depot_blocks; // 其中在中心仓库链表上的区块数
+                size_t peak_blocks; // 分给线程(使用中 + 线程缓存)的区块数的最大值
+                size_t refill_count; // 线程缓存为空去中心仓库取区块的次数
+                size_t batch_objs; // 当前一次搬运的区块个数
+            };
+            bool enabled; // 编译时是否定义了TINYSTL_ALLOC_STATS, 为false时只有不需要计数器的字段有效
+            size_class classes[class_count];
+            size_t heap_size; // 所有chunk的总字节数
+            size_t peak_heap_size;
+            size_t chunk_count; // 目前持有的chunk个数
+            size_t mapped_bytes; // 其中用mmap得到的chunk的总字节数
+            size_t chunk_alloc_count; // chunk_alloc的调用次数
+            size_t system_alloc_count; // 向系统申请chunk的次数
+            size_t pool_bytes; // 内存池(start_free到end_free)中剩余的字节数
+            size_t live_bytes; // 小区块中正在被使用的字节数
+            size_t free_bytes; // 小区块中空闲的字节数
+            size_t large_alloc_count; // 大于4096字节交给malloc的次数
+            size_t large_free_count;
+            size_t large_live_bytes;
+            size_t peak_large_bytes;
+            size_t trimmed_bytes; // trim累计还给系统的字节数
+            double fragmentation; // 碎片率: heap_size中没有被客户端使用的比例
+        };
+        // 取得一份统计快照
+        static void get_stats(stats &s);
+        // 以文本或JSON格式输出统计信息
+        static void print_stats(FILE *out = stdout);
+        static void print_stats_json(FILE *out = stdout);
     };
 }
 
-#endif
\ No newline at end of file
+#endif
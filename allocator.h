@@ -14,22 +14,58 @@ namespace TinySTL{
         typedef const T&    const_reference;
         typedef size_t      size_type;
         typedef ptrdiff_t   difference_type;
+
+        // 用来得到配置其他型别的配置器, 例如list要配置的是节点而不是T
+        template<class U>
+        struct rebind{
+            typedef allocator<U> other;
+        };
     public:
+        allocator() {}
+        template<class U>
+        allocator(const allocator<U>&) {}
+
         // 下面的函数主要是为了使接口符合STL标准
+        // 都按alignof(T)申请和释放, 因此alignas(32)/alignas(64)的型别也能得到正确对齐的空间
         static T *allocate(size_t n){
-            return 0 == n ? 0 : (T *)Alloc::allocate(n * sizeof(T));
+            return 0 == n ? 0 : (T *)Alloc::allocate(n * sizeof(T), alignof(T));
         }
         static T *allocate(){
-            return (T *)Alloc::allocate(sizeof(T));
+            return (T *)Alloc::allocate(sizeof(T), alignof(T));
         }
         static void deallocate(T *ptr, size_t n){
             if(n != 0)
-                Alloc::deallocate(static_cast<void *>(ptr), n * sizeof(T));
+                Alloc::deallocate(static_cast<void *>(ptr), n * sizeof(T), alignof(T));
         }
         static void deallocate(T *ptr){
-            Alloc::deallocate(static_cast<void *>(ptr), sizeof(T));
+            Alloc::deallocate(static_cast<void *>(ptr), sizeof(T), alignof(T));
+        }
+        // 需要比alignof(T)更严格的对齐时(例如按cache line对齐的缓冲区), 释放时要传入相同的alignment
+        static T *allocate(size_t n, size_t alignment){
+            if(alignment < alignof(T))
+                alignment = alignof(T);
+            return 0 == n ? 0 : (T *)Alloc::allocate(n * sizeof(T), alignment);
+        }
+        static void deallocate(T *ptr, size_t n, size_t alignment){
+            if(alignment < alignof(T))
+                alignment = alignof(T);
+            if(n != 0)
+                Alloc::deallocate(static_cast<void *>(ptr), n * sizeof(T), alignment);
+        }
+        // 只能用于可以逐字节搬移的T, 原有内容按字节拷贝到新空间
+        static T *reallocate(T *ptr, size_t old_n, size_t new_n){
+            return (T *)Alloc::reallocate(static_cast<void *>(ptr), old_n * sizeof(T), new_n * sizeof(T), alignof(T));
+        }
+        static bool try_expand(T *ptr, size_t old_n, size_t new_n){
+            return Alloc::try_expand(static_cast<void *>(ptr), old_n * sizeof(T), new_n * sizeof(T), alignof(T));
         }
     };
+
+    // 所有allocator都共用Alloc, 因此一个配置的空间可以由另一个释放
+    template<class T, class U>
+    inline bool operator==(const allocator<T>&, const allocator<U>&) { return true; }
+    template<class T, class U>
+    inline bool operator!=(const allocator<T>&, const allocator<U>&) { return false; }
 }
 
 #endif
\ No newline at end of file
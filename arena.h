@@ -0,0 +1,144 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <cstddef>
+#include <cstring>
+#include "alloc.h"
+
+/* 单调增长的区域(arena)配置器
+ * arena从Alloc成块地申请内存, 在块内用一个指针往后挪的方式分配空间(bump pointer)
+ * 单个对象的释放什么都不做, 整个区域在release()或arena析构时一次性还回去
+ * 适合一个请求内创建大量临时的vector/list, 请求结束时整体丢弃
+ */
+
+namespace TinySTL{
+    class arena{
+    private:
+        // 每个内存块的头部, 所有内存块串成一条链表
+        struct block{
+            block *next;
+            size_t size; // 整个内存块的字节数(包括头部)
+        };
+        enum {BLOCK_HEADER_SIZE = (sizeof(block) + 15) & ~15};
+        enum {DEFAULT_BLOCK_SIZE = 64 * 1024};
+
+        block *head; // 最新的内存块
+        char *cur; // 当前内存块中下一次分配的位置
+        char *end; // 当前内存块的结束位置
+        size_t block_size; // 每次申请的内存块大小
+        size_t used; // 已经分配出去的字节数
+
+        // 不允许拷贝, 否则两个arena会释放同一批内存块
+        arena(const arena &);
+        arena &operator=(const arena &);
+
+        static char *align_up(char *p, size_t alignment){
+            return (char *)(((size_t)p + alignment - 1) & ~(alignment - 1));
+        }
+        // 当前内存块不够用了, 申请一个至少能放下bytes字节(按alignment对齐)的新块
+        void new_block(size_t bytes, size_t alignment){
+            size_t size = BLOCK_HEADER_SIZE + bytes + alignment;
+            if(size < block_size)
+                size = block_size;
+            block *b = (block *)Alloc::allocate(size);
+            b->size = size;
+            b->next = head;
+            head = b;
+            cur = (char *)b + BLOCK_HEADER_SIZE;
+            end = (char *)b + size;
+        }
+    public:
+        explicit arena(size_t block_size = DEFAULT_BLOCK_SIZE)
+            : head(0), cur(0), end(0), block_size(block_size), used(0) {}
+        ~arena() { release(); }
+
+        // 分配bytes字节, 起始地址按alignment(2的幂)对齐
+        void *allocate(size_t bytes, size_t alignment = sizeof(void *)){
+            char *p = align_up(cur, alignment);
+            if(cur == 0 || p + bytes > end){
+                new_block(bytes, alignment);
+                p = align_up(cur, alignment);
+            }
+            cur = p + bytes;
+            used += bytes;
+            return p;
+        }
+
+        // 如果p是最后一次分配的空间, 并且当前内存块还放得下, 就原地把它从old_bytes扩展到new_bytes
+        bool try_expand(void *p, size_t old_bytes, size_t new_bytes){
+            if(p == 0 || (char *)p + old_bytes != cur || (char *)p + new_bytes > end)
+                return false;
+            cur = (char *)p + new_bytes;
+            used += new_bytes - old_bytes;
+            return true;
+        }
+
+        // 把所有内存块一次性还给Alloc, 之前分配出去的空间全部失效
+        void release(){
+            while(head != 0){
+                block *next = head->next;
+                Alloc::deallocate(head, head->size);
+                head = next;
+            }
+            cur = end = 0;
+            used = 0;
+        }
+
+        size_t bytes_used() const { return used; }
+    };
+
+    // 使用arena的配置器, 可以作为vector和list的Alloc参数
+    // 它只保存一个指向arena的指针, 拷贝或rebind出来的配置器都使用同一个arena
+    template<class T>
+    class arena_allocator{
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef T&          reference;
+        typedef const T*    const_pointer;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        template<class U>
+        struct rebind{
+            typedef arena_allocator<U> other;
+        };
+
+        arena *region;
+    public:
+        arena_allocator(arena &a) : region(&a) {}
+        template<class U>
+        arena_allocator(const arena_allocator<U> &x) : region(x.region) {}
+
+        T *allocate(size_t n){
+            return 0 == n ? 0 : (T *)region->allocate(n * sizeof(T), alignof(T));
+        }
+        T *allocate(){
+            return (T *)region->allocate(sizeof(T), alignof(T));
+        }
+        // 单个对象的释放什么都不做, 空间随arena一起释放
+        void deallocate(T *, size_t) {}
+        void deallocate(T *) {}
+
+        // 只能用于可以逐字节搬移的T, 最后一次分配的空间可以原地扩展, 否则重新分配再拷贝
+        T *reallocate(T *ptr, size_t old_n, size_t new_n){
+            if(try_expand(ptr, old_n, new_n))
+                return ptr;
+            T *result = allocate(new_n);
+            if(ptr != 0)
+                memcpy(result, ptr, (old_n < new_n ? old_n : new_n) * sizeof(T));
+            return result;
+        }
+        bool try_expand(T *ptr, size_t old_n, size_t new_n){
+            return region->try_expand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+        }
+    };
+
+    template<class T, class U>
+    inline bool operator==(const arena_allocator<T> &x, const arena_allocator<U> &y) { return x.region == y.region; }
+    template<class T, class U>
+    inline bool operator!=(const arena_allocator<T> &x, const arena_allocator<U> &y) { return x.region != y.region; }
+}
+
+#endif
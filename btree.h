@@ -0,0 +1,663 @@
+#ifndef _BTREE_H_
+#define _BTREE_H_
+
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "iterator.h"
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "functional.h"
+
+/* B树, 是btree_map和btree_set的底层
+ * 红黑树每个节点只放一个元素, 查找和遍历每一步都是一次cache miss; B树的一个节点放几十个元素, 大小是几条cache line,
+ * 树高只有红黑树的几分之一, 中序遍历时大部分时间是在同一个节点里顺序前进
+ * 元素在节点之间搬动, 因此插入和删除会使迭代器、指针和引用失效, 这一点和std::map不同
+ */
+
+namespace TinySTL{
+    enum { _btree_node_bytes = 256 }; // 叶节点的目标大小: 4条cache line, 正好是内存池的一个分档
+
+    // 叶节点只有元素, 内部节点在叶节点之后还有capacity + 1个孩子指针
+    template <class Value>
+    struct __btree_node{
+        enum { _header_bytes = sizeof(void *) + 8 };
+        enum { _fit = (int)((_btree_node_bytes - _header_bytes) / sizeof(Value)) };
+        enum { capacity = _fit > 3 ? _fit : 3 }; // 每个节点最多容纳的元素个数
+
+        __btree_node *parent;
+        unsigned short position; // 在父节点children中的下标
+        unsigned short count; // 元素个数
+        bool leaf;
+        typename std::aligned_storage<sizeof(Value) * capacity, alignof(Value)>::type storage;
+
+        Value *values() { return reinterpret_cast<Value *>(&storage); }
+        Value &value(size_t i) { return values()[i]; }
+        __btree_node *&child(size_t i);
+    };
+
+    template <class Value>
+    struct __btree_internal_node : public __btree_node<Value>{
+        __btree_node<Value> *children[__btree_node<Value>::capacity + 1];
+    };
+
+    template <class Value>
+    inline __btree_node<Value> *&__btree_node<Value>::child(size_t i){
+        return static_cast<__btree_internal_node<Value> *>(this)->children[i];
+    }
+
+    // 迭代器是(节点, 下标), end()是最右叶节点的末尾
+    template <class Value, class Ref, class Ptr>
+    struct __btree_iterator{
+        typedef __btree_iterator<Value, Value&, Value*> iterator;
+        typedef __btree_iterator<Value, Ref, Ptr>       self;
+
+        typedef bidirectional_iterator_tag  iterator_category;
+        typedef Value                       value_type;
+        typedef Ptr                         pointer;
+        typedef Ref                         reference;
+        typedef ptrdiff_t                   difference_type;
+
+        typedef __btree_node<Value> node_type;
+
+        node_type *node;
+        size_t position;
+
+        __btree_iterator() : node(0), position(0) {}
+        __btree_iterator(node_type *node, size_t position) : node(node), position(position) {}
+        // 对iterator本身来说这就是复制构造函数, 复制赋值要显式声明, 否则是deprecated的隐式版本
+        __btree_iterator(const iterator &x) : node(x.node), position(x.position) {}
+        self &operator=(const self &) = default;
+
+        bool operator==(const self &x) const { return node == x.node && position == x.position; }
+        bool operator!=(const self &x) const { return !(*this == x); }
+
+        reference operator*() const { return node->value(position); }
+        pointer operator->() const { return &(operator*()); }
+
+        // 停在叶节点末尾时, 向上找第一个还有元素没访问的祖先; 已经是最后一个元素时保持不动, 也就是end()
+        void climb(){
+            node_type *x = node;
+            const size_t i = position;
+            while(position == node->count && node->parent){
+                position = node->position;
+                node = node->parent;
+            }
+            if(position == node->count){
+                node = x;
+                position = i;
+            }
+        }
+
+        self &operator++(){
+            if(node->leaf){
+                if(++position == node->count)
+                    climb();
+            }
+            else{
+                // 内部节点的后继是右子树最左边的元素
+                node = node->child(position + 1);
+                while(!node->leaf)
+                    node = node->child(0);
+                position = 0;
+            }
+            return *this;
+        }
+        self operator++(int){
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        self &operator--(){
+            if(node->leaf){
+                if(position > 0){
+                    --position;
+                    return *this;
+                }
+                while(position == 0 && node->parent){
+                    position = node->position;
+                    node = node->parent;
+                }
+                --position;
+            }
+            else{
+                // 内部节点的前驱是左子树最右边的元素
+                node = node->child(position);
+                while(!node->leaf)
+                    node = node->child(node->count);
+                position = node->count - 1;
+            }
+            return *this;
+        }
+        self operator--(int){
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+    };
+
+    /* 和SGI STL的rb_tree一样由外层容器提供取键的方式, 这里只实现键唯一的版本
+     * 节点写满时分裂: 新元素插在最右边(顺序插入)时左半边保持全满, 因此有序输入建出来的树几乎没有空位;
+     * 删除后节点少于半满时先尝试和兄弟合并, 合并不下就从兄弟那里匀过来一些
+     */
+    template <class Value, class Key, class KeyOfValue, class Compare, class Alloc = allocator<Value>>
+    class btree : protected Alloc{
+    public:
+        typedef Key             key_type;
+        typedef Value           value_type;
+        typedef Compare         key_compare;
+        typedef size_t          size_type;
+        typedef ptrdiff_t       difference_type;
+        typedef Value*          pointer;
+        typedef const Value*    const_pointer;
+        typedef Value&          reference;
+        typedef const Value&    const_reference;
+        typedef Alloc           allocator_type;
+        typedef __btree_iterator<Value, Value&, Value*>             iterator;
+        typedef __btree_iterator<Value, const Value&, const Value*> const_iterator;
+    protected:
+        typedef __btree_node<Value>             node_type;
+        typedef __btree_internal_node<Value>    internal_node_type;
+        typedef typename Alloc::template rebind<node_type>::other           leaf_allocator; // 配置叶节点
+        typedef typename Alloc::template rebind<internal_node_type>::other  internal_allocator; // 配置内部节点
+        typedef typename _type_traits<Value>::is_relocatable_type is_relocatable; // 元素能否直接memmove
+
+        enum { node_capacity = node_type::capacity };
+        enum { min_node_values = node_capacity / 2 }; // 少于这个数的非根节点需要合并或者向兄弟借
+
+        Compare comp;
+        KeyOfValue get_key;
+        node_type *root;
+        node_type *leftmost; // begin()所在的叶节点
+        node_type *rightmost; // end()所在的叶节点
+        size_type num_elements;
+
+        node_type *new_leaf(){
+            node_type *x = leaf_allocator(get_allocator()).allocate(1);
+            x->parent = 0;
+            x->position = x->count = 0;
+            x->leaf = true;
+            return x;
+        }
+        node_type *new_internal(){
+            node_type *x = internal_allocator(get_allocator()).allocate(1);
+            x->parent = 0;
+            x->position = x->count = 0;
+            x->leaf = false;
+            return x;
+        }
+        void delete_node(node_type *x){
+            if(x->leaf)
+                leaf_allocator(get_allocator()).deallocate(x, 1);
+            else
+                internal_allocator(get_allocator()).deallocate(static_cast<internal_node_type *>(x), 1);
+        }
+        void destroy_subtree(node_type *x){
+            destory(x->values(), x->values() + x->count);
+            if(!x->leaf)
+                for (size_type i = 0; i <= x->count; ++i)
+                    destroy_subtree(x->child(i));
+            delete_node(x);
+        }
+
+        // 把n个元素从src搬到dst, 两段可以重叠; 搬完之后src上的元素就不存在了
+        static void relocate(Value *dst, Value *src, size_type n, _true_type){
+            if(n != 0)
+                memmove((void *)dst, (const void *)src, n * sizeof(Value));
+        }
+        static void relocate(Value *dst, Value *src, size_type n, _false_type){
+            if(dst < src){
+                for (size_type k = 0; k < n; ++k){
+                    construct(dst + k, std::move(src[k]));
+                    destory(src + k);
+                }
+            }
+            else{
+                for (size_type k = n; k-- > 0; ){
+                    construct(dst + k, std::move(src[k]));
+                    destory(src + k);
+                }
+            }
+        }
+        static void relocate(Value *dst, Value *src, size_type n) { relocate(dst, src, n, is_relocatable()); }
+        // 把src的n个孩子(从first开始)搬到dst的to位置, 并修正它们记录的父节点和下标
+        static void move_children(node_type *dst, size_type to, node_type *src, size_type first, size_type n){
+            if(n == 0)
+                return;
+            memmove(&dst->child(to), &src->child(first), n * sizeof(node_type *));
+            for (size_type k = to; k < to + n; ++k){
+                dst->child(k)->parent = dst;
+                dst->child(k)->position = (unsigned short)k;
+            }
+        }
+
+        // 节点内的二分查找
+        template <class K>
+        size_type node_lower_bound(node_type *x, const K &key) const{
+            size_type lo = 0, hi = x->count;
+            while(lo < hi){
+                const size_type mid = (lo + hi) / 2;
+                if(comp(get_key(x->value(mid)), key))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo;
+        }
+        template <class K>
+        size_type node_upper_bound(node_type *x, const K &key) const{
+            size_type lo = 0, hi = x->count;
+            while(lo < hi){
+                const size_type mid = (lo + hi) / 2;
+                if(comp(key, get_key(x->value(mid))))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            return lo;
+        }
+
+        void split(node_type *&x, size_type &i);
+        void merge(node_type *left, node_type *right);
+        void rotate_right(node_type *left, node_type *right, size_type n);
+        void rotate_left(node_type *left, node_type *right, size_type n);
+        void rebalance(node_type *x, iterator &tracked);
+        void copy_from(const btree &x);
+
+        // 在叶节点x的位置i插入新元素
+        template <class... Args>
+        iterator insert_at(node_type *x, size_type i, Args&&... args){
+            if(x->count < node_capacity && i == x->count){
+                construct(&x->value(i), std::forward<Args>(args)...);
+                ++x->count;
+                ++num_elements;
+                return iterator(x, i);
+            }
+            // 要挪动已有的元素, 而参数可能引用树中的元素, 所以先构造出新元素
+            value_type obj(std::forward<Args>(args)...);
+            if(x->count == node_capacity)
+                split(x, i);
+            relocate(&x->value(i + 1), &x->value(i), x->count - i);
+            try{
+                construct(&x->value(i), std::move(obj));
+            }
+            catch(...){
+                relocate(&x->value(i), &x->value(i + 1), x->count - i);
+                throw;
+            }
+            ++x->count;
+            ++num_elements;
+            return iterator(x, i);
+        }
+
+        // 键不存在时用args构造元素插入
+        template <class K, class... Args>
+        std::pair<iterator, bool> emplace_key(const K &key, Args&&... args){
+            if(root == 0)
+                root = leftmost = rightmost = new_leaf();
+            node_type *x = root;
+            size_type i;
+            while(true){
+                i = node_lower_bound(x, key);
+                if(i < x->count && !comp(key, get_key(x->value(i))))
+                    return std::pair<iterator, bool>(iterator(x, i), false);
+                if(x->leaf)
+                    break;
+                x = x->child(i);
+            }
+            return std::pair<iterator, bool>(insert_at(x, i, std::forward<Args>(args)...), true);
+        }
+    public:
+        explicit btree(const Compare &c = Compare(), const Alloc &alloc = Alloc())
+            : Alloc(alloc), comp(c), get_key(KeyOfValue()), root(0), leftmost(0), rightmost(0), num_elements(0) {}
+        btree(const btree &x)
+            : Alloc(x.get_allocator()), comp(x.comp), get_key(x.get_key), root(0), leftmost(0), rightmost(0), num_elements(0){
+            copy_from(x);
+        }
+        // 移动构造只是接管x的节点
+        btree(btree &&x) noexcept
+            : Alloc(x.get_allocator()), comp(x.comp), get_key(x.get_key), root(x.root), leftmost(x.leftmost), rightmost(x.rightmost),
+              num_elements(x.num_elements){
+            x.root = x.leftmost = x.rightmost = 0;
+            x.num_elements = 0;
+        }
+        btree &operator=(const btree &x){
+            if(this != &x){
+                btree tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        btree &operator=(btree &&x) noexcept{
+            btree tmp(std::move(x)); // 原来的元素随tmp一起析构
+            swap(tmp);
+            return *this;
+        }
+        ~btree() { clear(); }
+
+        allocator_type get_allocator() const { return *this; }
+        key_compare key_comp() const { return comp; }
+
+        void swap(btree &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            std::swap(comp, x.comp);
+            std::swap(root, x.root);
+            std::swap(leftmost, x.leftmost);
+            std::swap(rightmost, x.rightmost);
+            std::swap(num_elements, x.num_elements);
+        }
+
+        iterator begin() { return iterator(leftmost, 0); }
+        iterator end() { return iterator(rightmost, rightmost ? rightmost->count : 0); }
+        const_iterator begin() const { return const_cast<btree *>(this)->begin(); }
+        const_iterator end() const { return const_cast<btree *>(this)->end(); }
+
+        size_type size() const { return num_elements; }
+        bool empty() const { return num_elements == 0; }
+        // 树高, 叶节点为1
+        size_type height() const{
+            size_type h = 0;
+            for (node_type *x = root; x; x = x->leaf ? 0 : x->child(0))
+                ++h;
+            return h;
+        }
+
+        void clear(){
+            if(root)
+                destroy_subtree(root);
+            root = leftmost = rightmost = 0;
+            num_elements = 0;
+        }
+
+        iterator lower_bound(const key_type &key){
+            if(root == 0)
+                return end();
+            for (node_type *x = root; ; x = x->child(node_lower_bound(x, key))){
+                if(x->leaf){
+                    iterator it(x, node_lower_bound(x, key));
+                    if(it.position == x->count)
+                        it.climb();
+                    return it;
+                }
+            }
+        }
+        iterator upper_bound(const key_type &key){
+            if(root == 0)
+                return end();
+            for (node_type *x = root; ; x = x->child(node_upper_bound(x, key))){
+                if(x->leaf){
+                    iterator it(x, node_upper_bound(x, key));
+                    if(it.position == x->count)
+                        it.climb();
+                    return it;
+                }
+            }
+        }
+        const_iterator lower_bound(const key_type &key) const { return const_cast<btree *>(this)->lower_bound(key); }
+        const_iterator upper_bound(const key_type &key) const { return const_cast<btree *>(this)->upper_bound(key); }
+        std::pair<iterator, iterator> equal_range(const key_type &key){
+            return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+        }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const{
+            return std::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+        iterator find(const key_type &key){
+            iterator it = lower_bound(key);
+            return it == end() || comp(key, get_key(*it)) ? end() : it;
+        }
+        const_iterator find(const key_type &key) const { return const_cast<btree *>(this)->find(key); }
+        size_type count(const key_type &key) const { return find(key) != end() ? 1 : 0; }
+
+        // 键不存在时才插入, 返回元素的位置以及是否插入了
+        std::pair<iterator, bool> insert_unique(const value_type &obj) { return emplace_key(get_key(obj), obj); }
+        std::pair<iterator, bool> insert_unique(value_type &&obj) { return emplace_key(get_key(obj), std::move(obj)); }
+        // 有序的输入总是追加在最右边, 不需要从根开始查找, 整体是O(n)的; 无序的输入逐个查找插入
+        template <class InputIterator>
+        void insert_unique(InputIterator first, InputIterator last){
+            for (; first != last; ++first){
+                if(num_elements != 0 && comp(get_key(rightmost->value(rightmost->count - 1)), get_key(*first)))
+                    insert_at(rightmost, rightmost->count, *first);
+                else
+                    insert_unique(*first);
+            }
+        }
+        // 先构造出元素才能知道键, 键已经存在时这个元素被丢弃
+        template <class... Args>
+        std::pair<iterator, bool> emplace_unique(Args&&... args){
+            value_type obj(std::forward<Args>(args)...);
+            return emplace_key(get_key(obj), std::move(obj));
+        }
+        // 给外层容器使用: 键不存在时才用args构造元素, 例如map的try_emplace和operator[]
+        template <class K, class... Args>
+        std::pair<iterator, bool> try_emplace_unique(const K &key, Args&&... args){
+            return emplace_key(key, std::forward<Args>(args)...);
+        }
+
+        // 返回被删除元素的下一个位置
+        iterator erase(const_iterator position);
+        size_type erase(const key_type &key){
+            iterator it = find(key);
+            if(it == end())
+                return 0;
+            erase(it);
+            return 1;
+        }
+        // 删除会在节点之间搬动元素, last随之失效, 所以按个数删除
+        iterator erase(const_iterator first, const_iterator last){
+            if(first == begin() && last == end()){
+                clear();
+                return end();
+            }
+            size_type n = TinySTL::distance(first, last);
+            iterator it(first.node, first.position);
+            while(n-- > 0)
+                it = erase(it);
+            return it;
+        }
+    };
+
+    // *******************以下为btree类中一些模板的实现*******************
+    // 分裂写满的节点x, 中间的元素上移到父节点; 返回时(x, i)是原来的插入位置所在的节点和下标
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::split(node_type *&x, size_type &i){
+        node_type *right = x->leaf ? new_leaf() : new_internal();
+        try{
+            if(x == root){
+                node_type *r = new_internal();
+                r->child(0) = x;
+                x->parent = r;
+                x->position = 0;
+                root = r;
+            }
+            else if(x->parent->count == node_capacity){
+                node_type *p = x->parent;
+                size_type pi = x->position;
+                split(p, pi);
+            }
+        }
+        catch(...){
+            delete_node(right);
+            throw;
+        }
+        node_type *parent = x->parent;
+        const size_type p = x->position;
+        // 插在最右边时左边留满, 插在最左边时右边留满, 否则对半分
+        const size_type m = i == node_capacity ? node_capacity - 1 : (i == 0 ? 1 : node_capacity / 2);
+
+        right->count = (unsigned short)(node_capacity - m - 1);
+        relocate(right->values(), &x->value(m + 1), right->count);
+        if(!x->leaf)
+            move_children(right, 0, x, m + 1, right->count + 1);
+        // 中间的元素放到父节点的p位置, right成为父节点的第p + 1个孩子
+        relocate(&parent->value(p + 1), &parent->value(p), parent->count - p);
+        relocate(&parent->value(p), &x->value(m), 1);
+        move_children(parent, p + 2, parent, p + 1, parent->count - p);
+        parent->child(p + 1) = right;
+        right->parent = parent;
+        right->position = (unsigned short)(p + 1);
+        ++parent->count;
+        x->count = (unsigned short)m;
+        if(x == rightmost)
+            rightmost = right;
+        if(i > m){
+            x = right;
+            i -= m + 1;
+        }
+    }
+
+    // 把父节点中的分隔元素和right整个并入left, right是left右边的兄弟
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::merge(node_type *left, node_type *right){
+        node_type *parent = left->parent;
+        const size_type p = left->position;
+        relocate(&left->value(left->count), &parent->value(p), 1);
+        relocate(&left->value(left->count + 1), right->values(), right->count);
+        if(!left->leaf)
+            move_children(left, left->count + 1, right, 0, right->count + 1);
+        left->count += right->count + 1;
+
+        relocate(&parent->value(p), &parent->value(p + 1), parent->count - p - 1);
+        move_children(parent, p + 1, parent, p + 2, parent->count - p - 1);
+        --parent->count;
+        if(right == rightmost)
+            rightmost = left;
+        delete_node(right);
+    }
+
+    // 经过父节点的分隔元素, 把left末尾的n个元素挪给右兄弟right
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::rotate_right(node_type *left, node_type *right, size_type n){
+        node_type *parent = left->parent;
+        const size_type p = left->position;
+        relocate(&right->value(n), right->values(), right->count);
+        relocate(&right->value(n - 1), &parent->value(p), 1);
+        relocate(right->values(), &left->value(left->count - n + 1), n - 1);
+        relocate(&parent->value(p), &left->value(left->count - n), 1);
+        if(!left->leaf){
+            move_children(right, n, right, 0, right->count + 1);
+            move_children(right, 0, left, left->count - n + 1, n);
+        }
+        left->count -= (unsigned short)n;
+        right->count += (unsigned short)n;
+    }
+
+    // 经过父节点的分隔元素, 把right开头的n个元素挪给左兄弟left
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::rotate_left(node_type *left, node_type *right, size_type n){
+        node_type *parent = left->parent;
+        const size_type p = left->position;
+        relocate(&left->value(left->count), &parent->value(p), 1);
+        relocate(&left->value(left->count + 1), right->values(), n - 1);
+        relocate(&parent->value(p), &right->value(n - 1), 1);
+        relocate(right->values(), &right->value(n), right->count - n);
+        if(!left->leaf){
+            move_children(left, left->count + 1, right, 0, n);
+            move_children(right, 0, right, n, right->count - n + 1);
+        }
+        left->count += (unsigned short)n;
+        right->count -= (unsigned short)n;
+    }
+
+    // 从x开始向上修复元素太少的节点; tracked指向x中的某个位置, 元素被挪到别的节点时跟着修正
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::rebalance(node_type *x, iterator &tracked){
+        while(x != root && x->count < min_node_values){
+            node_type *parent = x->parent;
+            const size_type p = x->position;
+            node_type *left = p > 0 ? parent->child(p - 1) : 0;
+            node_type *right = p < parent->count ? parent->child(p + 1) : 0;
+            if(left && left->count + x->count + 1 <= node_capacity){
+                if(tracked.node == x){
+                    tracked.node = left;
+                    tracked.position += left->count + 1;
+                }
+                merge(left, x);
+                x = parent;
+            }
+            else if(right && x->count + right->count + 1 <= node_capacity){
+                merge(x, right);
+                x = parent;
+            }
+            else if(left){
+                // 合并不下说明兄弟至少比x多两个元素, 匀过来一半的差
+                const size_type n = (left->count - x->count) / 2;
+                if(tracked.node == x)
+                    tracked.position += n;
+                rotate_right(left, x, n);
+                return;
+            }
+            else{
+                rotate_left(x, right, (right->count - x->count) / 2);
+                return;
+            }
+        }
+        if(x == root && x->count == 0){
+            if(x->leaf){
+                delete_node(x);
+                root = leftmost = rightmost = 0;
+                tracked = iterator();
+            }
+            else{
+                root = x->child(0);
+                root->parent = 0;
+                root->position = 0;
+                delete_node(x);
+            }
+        }
+    }
+
+    template <class V, class K, class KoV, class Cmp, class A>
+    typename btree<V, K, KoV, Cmp, A>::iterator btree<V, K, KoV, Cmp, A>::erase(const_iterator position){
+        node_type *x = position.node;
+        size_type i = position.position;
+        const bool internal = !x->leaf;
+        destory(&x->value(i));
+        if(internal){
+            // 用左子树中最大的元素(一定在叶节点里)顶替被删除的元素, 再从叶节点删掉它
+            node_type *leaf = x->child(i);
+            while(!leaf->leaf)
+                leaf = leaf->child(leaf->count);
+            relocate(&x->value(i), &leaf->value(leaf->count - 1), 1);
+            x = leaf;
+            i = leaf->count - 1;
+        }
+        else{
+            relocate(&x->value(i), &x->value(i + 1), x->count - i - 1);
+        }
+        --x->count;
+        --num_elements;
+
+        iterator result(x, i);
+        rebalance(x, result);
+        if(result.node == 0)
+            return end();
+        if(result.position == result.node->count)
+            result.climb();
+        // result现在指向顶替上去的前驱, 它的下一个才是被删除元素的后继
+        if(internal)
+            ++result;
+        return result;
+    }
+
+    // 源树是有序的, 逐个追加在最右边
+    template <class V, class K, class KoV, class Cmp, class A>
+    void btree<V, K, KoV, Cmp, A>::copy_from(const btree &x){
+        if(x.empty())
+            return;
+        try{
+            root = leftmost = rightmost = new_leaf();
+            for (const_iterator it = x.begin(); it != x.end(); ++it)
+                insert_at(rightmost, rightmost->count, *it);
+        }
+        catch(...){
+            clear();
+            throw;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef _BTREE_MAP_H_
+#define _BTREE_MAP_H_
+
+#include <stdexcept>
+#include <initializer_list>
+#include "btree.h"
+
+/* 基于B树的有序map, 可以替代std::map
+ * 适合大量键的范围扫描: 一个节点连续存放几十个元素, 遍历基本是顺序访问内存
+ * 插入和删除会在节点之间搬动元素, 因此会使迭代器、指针和引用失效
+ * 用有序的区间构造(例如排好序的vector)只需要O(n)
+ */
+
+namespace TinySTL{
+    template <class Key, class T, class Compare = std::less<Key>, class Alloc = allocator<std::pair<const Key, T>>>
+    class btree_map{
+    private:
+        typedef btree<std::pair<const Key, T>, Key, _select1st<std::pair<const Key, T>>, Compare, Alloc> rep_type;
+        rep_type t; // 底层的B树
+    public:
+        typedef typename rep_type::key_type         key_type;
+        typedef T                                   mapped_type;
+        typedef typename rep_type::value_type       value_type;
+        typedef typename rep_type::key_compare      key_compare;
+        typedef typename rep_type::size_type        size_type;
+        typedef typename rep_type::difference_type  difference_type;
+        typedef typename rep_type::pointer          pointer;
+        typedef typename rep_type::const_pointer    const_pointer;
+        typedef typename rep_type::reference        reference;
+        typedef typename rep_type::const_reference  const_reference;
+        typedef typename rep_type::iterator         iterator;
+        typedef typename rep_type::const_iterator   const_iterator;
+        typedef typename rep_type::allocator_type   allocator_type;
+
+        btree_map() {}
+        explicit btree_map(const Compare &comp, const allocator_type &alloc = allocator_type()) : t(comp, alloc) {}
+        template <class InputIterator>
+        btree_map(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+        btree_map(std::initializer_list<value_type> ilist) { t.insert_unique(ilist.begin(), ilist.end()); }
+
+        allocator_type get_allocator() const { return t.get_allocator(); }
+        key_compare key_comp() const { return t.key_comp(); }
+
+        iterator begin() { return t.begin(); }
+        iterator end() { return t.end(); }
+        const_iterator begin() const { return t.begin(); }
+        const_iterator end() const { return t.end(); }
+        const_iterator cbegin() const { return t.begin(); }
+        const_iterator cend() const { return t.end(); }
+
+        size_type size() const { return t.size(); }
+        bool empty() const { return t.empty(); }
+
+        iterator find(const key_type &key) { return t.find(key); }
+        const_iterator find(const key_type &key) const { return t.find(key); }
+        size_type count(const key_type &key) const { return t.count(key); }
+        iterator lower_bound(const key_type &key) { return t.lower_bound(key); }
+        const_iterator lower_bound(const key_type &key) const { return t.lower_bound(key); }
+        iterator upper_bound(const key_type &key) { return t.upper_bound(key); }
+        const_iterator upper_bound(const key_type &key) const { return t.upper_bound(key); }
+        std::pair<iterator, iterator> equal_range(const key_type &key) { return t.equal_range(key); }
+        std::pair<const_iterator, const_iterator> equal_range(const key_type &key) const { return t.equal_range(key); }
+
+        mapped_type &at(const key_type &key){
+            iterator it = find(key);
+            if(it == end())
+                throw std::out_of_range("btree_map::at");
+            return it->second;
+        }
+        const mapped_type &at(const key_type &key) const { return const_cast<btree_map *>(this)->at(key); }
+        // 键不存在时插入值初始化的mapped_type
+        mapped_type &operator[](const key_type &key){
+            return t.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>()).first->second;
+        }
+        mapped_type &operator[](key_type &&key){
+            return t.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::tuple<>()).first->second;
+        }
+
+        std::pair<iterator, bool> insert(const value_type &obj) { return t.insert_unique(obj); }
+        std::pair<iterator, bool> insert(value_type &&obj) { return t.insert_unique(std::move(obj)); }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+        template <class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) { return t.emplace_unique(std::forward<Args>(args)...); }
+        // 键已经存在时不构造mapped_type, 也不移动args
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args){
+            return t.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args){
+            return t.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        iterator erase(const_iterator position) { return t.erase(position); }
+        size_type erase(const key_type &key) { return t.erase(key); }
+        iterator erase(const_iterator first, const_iterator last) { return t.erase(first, last); }
+        void clear() { t.clear(); }
+        void swap(btree_map &x) { t.swap(x.t); }
+    };
+
+    template <class Key, class T, class Compare, class Alloc>
+    inline void swap(btree_map<Key, T, Compare, Alloc> &x, btree_map<Key, T, Compare, Alloc> &y){
+        x.swap(y);
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef _BTREE_SET_H_
+#define _BTREE_SET_H_
+
+#include <initializer_list>
+#include "btree.h"
+
+/* 基于B树的有序set, 可以替代std::set
+ * 元素不能通过迭代器修改; 插入和删除会使迭代器、指针和引用失效
+ * 用有序的区间构造(例如排好序的vector)只需要O(n)
+ */
+
+namespace TinySTL{
+    template <class Key, class Compare = std::less<Key>, class Alloc = allocator<Key>>
+    class btree_set{
+    private:
+        typedef btree<Key, Key, _identity<Key>, Compare, Alloc> rep_type;
+        rep_type t; // 底层的B树
+    public:
+        typedef typename rep_type::key_type         key_type;
+        typedef typename rep_type::value_type       value_type;
+        typedef typename rep_type::key_compare      key_compare;
+        typedef typename rep_type::size_type        size_type;
+        typedef typename rep_type::difference_type  difference_type;
+        typedef typename rep_type::const_pointer    pointer;
+        typedef typename rep_type::const_pointer    const_pointer;
+        typedef typename rep_type::const_reference  reference;
+        typedef typename rep_type::const_reference  const_reference;
+        typedef typename rep_type::const_iterator   iterator; // 和SGI STL的set一样, 修改元素会破坏树的有序性
+        typedef typename rep_type::const_iterator   const_iterator;
+        typedef typename rep_type::allocator_type   allocator_type;
+
+        btree_set() {}
+        explicit btree_set(const Compare &comp, const allocator_type &alloc = allocator_type()) : t(comp, alloc) {}
+        template <class InputIterator>
+        btree_set(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+        btree_set(std::initializer_list<value_type> ilist) { t.insert_unique(ilist.begin(), ilist.end()); }
+
+        allocator_type get_allocator() const { return t.get_allocator(); }
+        key_compare key_comp() const { return t.key_comp(); }
+
+        iterator begin() const { return t.begin(); }
+        iterator end() const { return t.end(); }
+        const_iterator cbegin() const { return t.begin(); }
+        const_iterator cend() const { return t.end(); }
+
+        size_type size() const { return t.size(); }
+        bool empty() const { return t.empty(); }
+
+        iterator find(const key_type &key) const { return t.find(key); }
+        size_type count(const key_type &key) const { return t.count(key); }
+        iterator lower_bound(const key_type &key) const { return t.lower_bound(key); }
+        iterator upper_bound(const key_type &key) const { return t.upper_bound(key); }
+        std::pair<iterator, iterator> equal_range(const key_type &key) const { return t.equal_range(key); }
+
+        std::pair<iterator, bool> insert(const value_type &obj){
+            std::pair<typename rep_type::iterator, bool> p = t.insert_unique(obj);
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+        std::pair<iterator, bool> insert(value_type &&obj){
+            std::pair<typename rep_type::iterator, bool> p = t.insert_unique(std::move(obj));
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last) { t.insert_unique(first, last); }
+        template <class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args){
+            std::pair<typename rep_type::iterator, bool> p = t.emplace_unique(std::forward<Args>(args)...);
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+
+        iterator erase(const_iterator position) { return t.erase(position); }
+        size_type erase(const key_type &key) { return t.erase(key); }
+        iterator erase(const_iterator first, const_iterator last) { return t.erase(first, last); }
+        void clear() { t.clear(); }
+        void swap(btree_set &x) { t.swap(x.t); }
+    };
+
+    template <class Key, class Compare, class Alloc>
+    inline void swap(btree_set<Key, Compare, Alloc> &x, btree_set<Key, Compare, Alloc> &y){
+        x.swap(y);
+    }
+}
+
+#endif
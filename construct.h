@@ -2,13 +2,16 @@
 #define _CONSTRUCT_H_
 
 #include <new>
+#include <utility>
 #include "type_traits.h"
+#include "iterator.h"
 
 
 namespace TinySTL{
-    template<class T1, class T2>
-    inline void construct(T1* ptr, const T2& value){
-        new (ptr) T1(value);  // placement new, 调用T1的构造函数 T1::T1(value)
+    // 用参数args在ptr处构造一个T1对象, 参数原样转发, 因此右值参数会调用移动构造函数
+    template<class T1, class... Args>
+    inline void construct(T1* ptr, Args&&... args){
+        new ((void *)ptr) T1(std::forward<Args>(args)...);  // placement new, 调用T1的构造函数 T1::T1(args...)
                             // 它是opreator new 的一个重载版本，作用是在已分配的内存中创建一个对象。
     }
 
@@ -31,12 +34,18 @@ namespace TinySTL{
     template<class ForwardIterator>
     inline void __destory(ForwardIterator first, ForwardIterator last, _true_type) {}
 
+    // 根据元素型别T判断是否需要逐个析构
+    template<class ForwardIterator, class T>
+    inline void _destory(ForwardIterator first, ForwardIterator last, T*){
+        typedef typename _type_traits<T>::has_trivial_destructor trivial_destructor;
+        __destory(first, last, trivial_destructor());
+    }
+
     //destory的重载版本，释放区间[first, last)的内存
     template<class ForwardIterator>
     inline void destory(ForwardIterator first, ForwardIterator last){
-        typedef typename _type_traits<ForwardIterator>::is_POD_type is_POD;
-        __destory(first, last, is_POD());   // 判断迭代器类型是否为POD型(也就是标量型别或传统的C struct型别)
-                                            // POD型别的有自己的构造析构函数，我们什么都不用做
+        _destory(first, last, value_type(first));   // 判断迭代器所指的元素型别是否有trivial的析构函数(例如标量型别或传统的C struct型别)
+                                                    // 这样的型别析构时什么都不用做
     }
 
 }
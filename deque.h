@@ -0,0 +1,550 @@
+#ifndef _DEQUE_H_
+#define _DEQUE_H_
+
+#include <utility>
+#include "iterator.h"
+#include "allocator.h"
+#include "construct.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+
+/* 分段连续的双端队列
+ * 元素存放在若干个大小固定的缓冲区里, 中控器map依次保存各个缓冲区的指针
+ * 两端插入和删除都是O(1): 只在当前缓冲区用完时申请一个新的缓冲区, map用完时也只搬移缓冲区指针, 不会搬移元素,
+ * 因此两端插入删除不会使其他元素的引用失效
+ */
+
+namespace TinySTL{
+    // 每个缓冲区的字节数, 正好是配置器自由链表管理的最大区块, 用完的缓冲区会留在线程缓存里供下一次使用
+    enum { _deque_block_bytes = 4096 };
+
+    // 每个缓冲区能放下的元素个数, 元素比一个缓冲区还大时每个缓冲区只放一个
+    inline size_t __deque_buf_size(size_t size){
+        return size < _deque_block_bytes ? size_t(_deque_block_bytes / size) : size_t(1);
+    }
+
+    // deque的迭代器, 除了指向当前元素, 还要记住当前缓冲区的边界和它在map中的位置
+    template <class T, class Ref, class Ptr>
+    struct __deque_iterator{
+        typedef __deque_iterator<T, T&, T*>             iterator;
+        typedef __deque_iterator<T, const T&, const T*> const_iterator;
+        typedef __deque_iterator<T, Ref, Ptr>           self;
+
+        typedef random_access_iterator_tag  iterator_category;
+        typedef T                           value_type;
+        typedef Ptr                         pointer;
+        typedef Ref                         reference;
+        typedef ptrdiff_t                   difference_type;
+        typedef size_t                      size_type;
+        typedef T**                         map_pointer;
+
+        T *cur; // 当前元素
+        T *first; // 当前缓冲区的头
+        T *last; // 当前缓冲区的尾(不含)
+        map_pointer node; // 当前缓冲区在map中的位置
+
+        static difference_type buffer_size() { return difference_type(__deque_buf_size(sizeof(T))); }
+
+        __deque_iterator() : cur(0), first(0), last(0), node(0) {}
+        __deque_iterator(T *x, map_pointer y) : cur(x), first(*y), last(*y + buffer_size()), node(y) {}
+        // 对iterator本身来说这就是复制构造函数, 复制赋值要显式声明, 否则是deprecated的隐式版本
+        __deque_iterator(const iterator &x) : cur(x.cur), first(x.first), last(x.last), node(x.node) {}
+        self &operator=(const self &) = default;
+
+        // 跳到另一个缓冲区, cur由调用者设置
+        void set_node(map_pointer new_node){
+            node = new_node;
+            first = *new_node;
+            last = first + buffer_size();
+        }
+
+        reference operator*() const { return *cur; }
+        pointer operator->() const { return &(operator*()); }
+
+        difference_type operator-(const self &x) const{
+            return buffer_size() * (node - x.node - 1) + (cur - first) + (x.last - x.cur);
+        }
+
+        self &operator++(){
+            ++cur;
+            if(cur == last){ // 到了缓冲区的尾, 跳到下一个缓冲区的头
+                set_node(node + 1);
+                cur = first;
+            }
+            return *this;
+        }
+        self operator++(int){
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+        self &operator--(){
+            if(cur == first){ // 在缓冲区的头, 跳到上一个缓冲区的尾
+                set_node(node - 1);
+                cur = last;
+            }
+            --cur;
+            return *this;
+        }
+        self operator--(int){
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+
+        self &operator+=(difference_type n){
+            const difference_type offset = n + (cur - first);
+            if(offset >= 0 && offset < buffer_size()){
+                cur += n; // 还在同一个缓冲区里
+            }
+            else{
+                const difference_type node_offset = offset > 0 ? offset / buffer_size()
+                                                               : -((-offset - 1) / buffer_size()) - 1;
+                set_node(node + node_offset);
+                cur = first + (offset - node_offset * buffer_size());
+            }
+            return *this;
+        }
+        self operator+(difference_type n) const{
+            self temp = *this;
+            return temp += n;
+        }
+        self &operator-=(difference_type n) { return *this += -n; }
+        self operator-(difference_type n) const{
+            self temp = *this;
+            return temp -= n;
+        }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        bool operator==(const self &x) const { return cur == x.cur; }
+        bool operator!=(const self &x) const { return cur != x.cur; }
+        bool operator<(const self &x) const { return node == x.node ? cur < x.cur : node < x.node; }
+        bool operator>(const self &x) const { return x < *this; }
+        bool operator<=(const self &x) const { return !(x < *this); }
+        bool operator>=(const self &x) const { return !(*this < x); }
+    };
+
+    template <class T, class Ref, class Ptr>
+    inline __deque_iterator<T, Ref, Ptr> operator+(ptrdiff_t n, const __deque_iterator<T, Ref, Ptr> &x){
+        return x + n;
+    }
+
+    // 和vector一样以protected方式继承元素的配置器, map的配置器由它rebind得到
+    template <class T, class Alloc = allocator<T>>
+    class deque : protected Alloc{
+    public:
+        typedef T                   value_type;
+        typedef T*                  pointer;
+        typedef const T*            const_pointer;
+        typedef T&                  reference;
+        typedef const T&            const_reference;
+        typedef size_t              size_type;
+        typedef ptrdiff_t           difference_type;
+        typedef Alloc               allocator_type;
+        typedef __deque_iterator<T, T&, T*>             iterator;
+        typedef __deque_iterator<T, const T&, const T*> const_iterator;
+    protected:
+        typedef pointer* map_pointer;
+        typedef Alloc data_alloctor; // 配置缓冲区
+        typedef typename Alloc::template rebind<pointer>::other map_allocator; // 配置map
+
+        enum { _initial_map_size = 8 }; // map最少有8个位置
+
+        iterator start; // 第一个元素
+        iterator finish; // 最后一个元素的下一个位置, 它所在的缓冲区总是已经配置好的
+        map_pointer map;
+        size_type map_size; // map里可以容纳多少个缓冲区指针
+
+        static size_type buffer_size() { return __deque_buf_size(sizeof(T)); }
+
+        pointer allocate_node() { return data_alloctor::allocate(buffer_size()); }
+        void deallocate_node(pointer p) { data_alloctor::deallocate(p, buffer_size()); }
+        map_pointer allocate_map(size_type n) { return map_allocator(get_allocator()).allocate(n); }
+        void deallocate_map(map_pointer p, size_type n) { map_allocator(get_allocator()).deallocate(p, n); }
+
+        // 配置好能放下num_elements个元素的缓冲区, 它们位于map的中间, 以便两端都有扩展的余地
+        void create_map_and_nodes(size_type num_elements);
+        // 释放所有缓冲区和map, 不析构元素
+        void destroy_map_and_nodes(){
+            for (map_pointer cur = start.node; cur <= finish.node; ++cur)
+                deallocate_node(*cur);
+            deallocate_map(map, map_size);
+        }
+        void fill_initialize(size_type n, const T &value);
+
+        // 析构[first, last)内的元素, 按缓冲区分段调用destory
+        void destroy_data(iterator first, iterator last){
+            for (map_pointer node = first.node + 1; node < last.node; ++node)
+                destory(*node, *node + buffer_size());
+            if(first.node != last.node){
+                destory(first.cur, first.last);
+                destory(last.first, last.cur);
+            }
+            else{
+                destory(first.cur, last.cur);
+            }
+        }
+
+        // 保证map的尾端(头端)至少还有nodes_to_add个空位
+        void reserve_map_at_back(size_type nodes_to_add = 1){
+            if(nodes_to_add + 1 > map_size - (finish.node - map))
+                reallocate_map(nodes_to_add, false);
+        }
+        void reserve_map_at_front(size_type nodes_to_add = 1){
+            if(nodes_to_add > size_type(start.node - map))
+                reallocate_map(nodes_to_add, true);
+        }
+        void reallocate_map(size_type nodes_to_add, bool add_at_front);
+
+        // 最后一个缓冲区只剩一个空位时push_back, 要先配置下一个缓冲区
+        template <class... Args>
+        void push_back_aux(Args&&... args);
+        // 第一个缓冲区没有空位时push_front
+        template <class... Args>
+        void push_front_aux(Args&&... args);
+    public:
+        iterator begin() { return start; }
+        iterator end() { return finish; }
+        const_iterator begin() const { return start; }
+        const_iterator end() const { return finish; }
+        size_type size() const { return size_type(finish - start); }
+        bool empty() const { return start == finish; }
+        reference operator[](size_type n) { return start[difference_type(n)]; }
+        const_reference operator[](size_type n) const { return start[difference_type(n)]; }
+        reference front() { return *start; }
+        reference back() { return *(finish - 1); }
+        const_reference front() const { return *start; }
+        const_reference back() const { return *(finish - 1); }
+
+        deque() { create_map_and_nodes(0); }
+        explicit deque(const Alloc &alloc) : Alloc(alloc) { create_map_and_nodes(0); }
+        deque(size_type n, const T &value, const Alloc &alloc = Alloc()) : Alloc(alloc) { fill_initialize(n, value); }
+        explicit deque(size_type n, const Alloc &alloc = Alloc()) : Alloc(alloc) { fill_initialize(n, T()); }
+        deque(const deque &x) : Alloc(x.get_allocator()){
+            create_map_and_nodes(x.size());
+            try{
+                TinySTL::uninitialized_copy(x.begin(), x.end(), start);
+            }
+            catch(...){
+                destroy_map_and_nodes();
+                throw;
+            }
+        }
+        // 接管x的map和缓冲区, x换成一个新的空deque
+        deque(deque &&x) : Alloc(x.get_allocator()){
+            create_map_and_nodes(0);
+            swap(x);
+        }
+        deque &operator=(const deque &x){
+            if(this != &x){
+                deque tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        deque &operator=(deque &&x){
+            if(this != &x){
+                clear();
+                swap(x); // 原来的元素已经析构, 只剩下一个缓冲区留给x
+            }
+            return *this;
+        }
+        ~deque(){
+            destroy_data(start, finish);
+            destroy_map_and_nodes();
+        }
+
+        allocator_type get_allocator() const { return *this; }
+
+        void swap(deque &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            std::swap(start, x.start);
+            std::swap(finish, x.finish);
+            std::swap(map, x.map);
+            std::swap(map_size, x.map_size);
+        }
+
+        template <class... Args>
+        void emplace_back(Args&&... args){
+            if(finish.cur != finish.last - 1){ // 最后一个缓冲区还有至少两个空位
+                construct(finish.cur, std::forward<Args>(args)...);
+                ++finish.cur;
+            }
+            else{
+                push_back_aux(std::forward<Args>(args)...);
+            }
+        }
+        template <class... Args>
+        void emplace_front(Args&&... args){
+            if(start.cur != start.first){ // 第一个缓冲区前面还有空位
+                construct(start.cur - 1, std::forward<Args>(args)...);
+                --start.cur;
+            }
+            else{
+                push_front_aux(std::forward<Args>(args)...);
+            }
+        }
+        void push_back(const T &x) { emplace_back(x); }
+        void push_back(T &&x) { emplace_back(std::move(x)); }
+        void push_front(const T &x) { emplace_front(x); }
+        void push_front(T &&x) { emplace_front(std::move(x)); }
+
+        void pop_back(){
+            if(finish.cur == finish.first){ // 最后一个缓冲区是空的, 释放它, 回到上一个缓冲区
+                deallocate_node(finish.first);
+                finish.set_node(finish.node - 1);
+                finish.cur = finish.last;
+            }
+            --finish.cur;
+            destory(finish.cur);
+        }
+        void pop_front(){
+            destory(start.cur);
+            if(start.cur != start.last - 1){
+                ++start.cur;
+            }
+            else{ // 第一个缓冲区的最后一个元素, 释放这个缓冲区
+                deallocate_node(start.first);
+                start.set_node(start.node + 1);
+                start.cur = start.first;
+            }
+        }
+
+        // 在位置pos上用args构造一个元素, 返回指向它的迭代器; 搬移pos前后元素较少的那一边
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args);
+        iterator insert(iterator position, const T &x) { return emplace(position, x); }
+        iterator insert(iterator position, T &&x) { return emplace(position, std::move(x)); }
+        void insert(iterator position, size_type n, const T &x); // 从位置pos开始插入n个初值为x的元素
+
+        iterator erase(iterator position){
+            iterator next = position;
+            ++next;
+            const difference_type index = position - start;
+            if(size_type(index) < (size() >> 1)){ // 前面的元素较少, 把它们往后移一位
+                TinySTL::move_backward(start, position, next);
+                pop_front();
+            }
+            else{
+                TinySTL::move(next, finish, position);
+                pop_back();
+            }
+            return start + index;
+        }
+        iterator erase(iterator first, iterator last);
+
+        void resize(size_type new_size, const T &x){
+            if(new_size < size())
+                erase(start + difference_type(new_size), finish);
+            else
+                insert(finish, new_size - size(), x);
+        }
+        void resize(size_type new_size) { resize(new_size, T()); }
+        // 析构所有元素, 只保留一个缓冲区
+        void clear();
+    };
+
+    // deque只保存指向map和缓冲区的指针, 没有指向自身的指针, 可以按字节搬移到新地址
+    template <class T, class Alloc>
+    struct _relocatable_traits<deque<T, Alloc> >{
+        typedef _true_type is_relocatable_type;
+    };
+
+    // *******************以下为deque类中一些模板的实现*******************
+    template <class T, class Alloc>
+    inline void swap(deque<T, Alloc> &x, deque<T, Alloc> &y){
+        x.swap(y);
+    }
+
+    template <class T, class Alloc>
+    void deque<T, Alloc>::create_map_and_nodes(size_type num_elements){
+        const size_type num_nodes = num_elements / buffer_size() + 1; // 刚好整除时多配置一个, finish总要指向一个缓冲区
+        map_size = num_nodes + 2 > size_type(_initial_map_size) ? num_nodes + 2 : size_type(_initial_map_size);
+        map = allocate_map(map_size);
+        map_pointer nstart = map + (map_size - num_nodes) / 2;
+        map_pointer nfinish = nstart + num_nodes - 1;
+        map_pointer cur = nstart;
+        try{
+            for (; cur <= nfinish; ++cur)
+                *cur = allocate_node();
+        }
+        catch(...){
+            for (map_pointer p = nstart; p < cur; ++p)
+                deallocate_node(*p);
+            deallocate_map(map, map_size);
+            throw;
+        }
+        start.set_node(nstart);
+        finish.set_node(nfinish);
+        start.cur = start.first;
+        finish.cur = finish.first + num_elements % buffer_size();
+    }
+
+    template <class T, class Alloc>
+    void deque<T, Alloc>::fill_initialize(size_type n, const T &value){
+        create_map_and_nodes(n);
+        map_pointer cur = start.node;
+        try{
+            for (; cur < finish.node; ++cur)
+                TinySTL::uninitialized_fill_n(*cur, buffer_size(), value);
+            TinySTL::uninitialized_fill_n(finish.first, finish.cur - finish.first, value);
+        }
+        catch(...){
+            for (map_pointer p = start.node; p < cur; ++p)
+                destory(*p, *p + buffer_size());
+            destroy_map_and_nodes();
+            throw;
+        }
+    }
+
+    // map没有空位时: 如果map里的空位足够多, 只是偏向了一边, 就把缓冲区指针移回中间; 否则配置一个更大的map
+    template <class T, class Alloc>
+    void deque<T, Alloc>::reallocate_map(size_type nodes_to_add, bool add_at_front){
+        const size_type old_num_nodes = finish.node - start.node + 1;
+        const size_type new_num_nodes = old_num_nodes + nodes_to_add;
+        map_pointer new_nstart;
+        if(map_size > 2 * new_num_nodes){
+            new_nstart = map + (map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
+            if(new_nstart < start.node)
+                TinySTL::copy(start.node, finish.node + 1, new_nstart);
+            else
+                TinySTL::copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
+        }
+        else{
+            const size_type new_map_size = map_size + (map_size > nodes_to_add ? map_size : nodes_to_add) + 2;
+            map_pointer new_map = allocate_map(new_map_size);
+            new_nstart = new_map + (new_map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
+            TinySTL::copy(start.node, finish.node + 1, new_nstart);
+            deallocate_map(map, map_size);
+            map = new_map;
+            map_size = new_map_size;
+        }
+        // 缓冲区本身没有变, 只需要更新迭代器记录的map位置
+        start.set_node(new_nstart);
+        finish.set_node(new_nstart + old_num_nodes - 1);
+    }
+
+    template <class T, class Alloc>
+    template <class... Args>
+    void deque<T, Alloc>::push_back_aux(Args&&... args){
+        reserve_map_at_back();
+        *(finish.node + 1) = allocate_node();
+        try{
+            construct(finish.cur, std::forward<Args>(args)...); // 元素不会被搬移, args引用自己的元素也没有问题
+        }
+        catch(...){
+            deallocate_node(*(finish.node + 1));
+            throw;
+        }
+        finish.set_node(finish.node + 1);
+        finish.cur = finish.first;
+    }
+
+    template <class T, class Alloc>
+    template <class... Args>
+    void deque<T, Alloc>::push_front_aux(Args&&... args){
+        reserve_map_at_front();
+        *(start.node - 1) = allocate_node();
+        try{
+            construct(*(start.node - 1) + (buffer_size() - 1), std::forward<Args>(args)...);
+        }
+        catch(...){
+            deallocate_node(*(start.node - 1));
+            throw;
+        }
+        start.set_node(start.node - 1);
+        start.cur = start.last - 1;
+    }
+
+    template <class T, class Alloc>
+    template <class... Args>
+    typename deque<T, Alloc>::iterator deque<T, Alloc>::emplace(iterator position, Args&&... args){
+        if(position.cur == start.cur){
+            emplace_front(std::forward<Args>(args)...);
+            return start;
+        }
+        if(position.cur == finish.cur){
+            emplace_back(std::forward<Args>(args)...);
+            return finish - 1;
+        }
+        T x_copy(std::forward<Args>(args)...); // args可能引用自己的元素, 搬移之前先构造出来
+        const difference_type index = position - start;
+        if(size_type(index) < (size() >> 1)){
+            // 复制一份第一个元素放在最前面, 再把[start + 1, pos)往前移一位
+            emplace_front(std::move(front()));
+            iterator front1 = start + 1;
+            position = start + index;
+            TinySTL::move(front1 + 1, position + 1, front1);
+        }
+        else{
+            emplace_back(std::move(back()));
+            iterator back1 = finish - 1;
+            position = start + index;
+            TinySTL::move_backward(position, back1 - 1, back1);
+        }
+        *position = std::move(x_copy);
+        return position;
+    }
+
+    // 先在较近的一端放入n个x, 再把原来夹在中间的元素移到位, 最后把空出来的位置赋值为x
+    template <class T, class Alloc>
+    void deque<T, Alloc>::insert(iterator position, size_type n, const T &x){
+        if(n == 0)
+            return;
+        const T x_copy = x; // x可能就是自己的元素, 移动之后会改变, 先存一份
+        const difference_type index = position - start;
+        const difference_type count = difference_type(n);
+        if(size_type(index) < (size() >> 1)){
+            for (size_type i = 0; i < n; ++i)
+                emplace_front(x_copy);
+            TinySTL::move(start + count, start + (count + index), start);
+        }
+        else{
+            const difference_type old_size = difference_type(size());
+            for (size_type i = 0; i < n; ++i)
+                emplace_back(x_copy);
+            TinySTL::move_backward(start + index, start + old_size, finish);
+        }
+        TinySTL::fill(start + index, start + (index + count), x_copy);
+    }
+
+    template <class T, class Alloc>
+    typename deque<T, Alloc>::iterator deque<T, Alloc>::erase(iterator first, iterator last){
+        if(first == last) // 空区间不能把一整侧的元素移动给自己
+            return first;
+        if(first == start && last == finish){
+            clear();
+            return finish;
+        }
+        const difference_type n = last - first;
+        const difference_type elems_before = first - start;
+        if(size_type(elems_before) < (size() - n) / 2){ // 前面的元素较少, 往后移, 释放头部多出来的缓冲区
+            TinySTL::move_backward(start, first, last);
+            iterator new_start = start + n;
+            destroy_data(start, new_start);
+            for (map_pointer cur = start.node; cur < new_start.node; ++cur)
+                deallocate_node(*cur);
+            start = new_start;
+        }
+        else{ // 后面的元素较少, 往前移, 释放尾部多出来的缓冲区
+            TinySTL::move(last, finish, first);
+            iterator new_finish = finish - n;
+            destroy_data(new_finish, finish);
+            for (map_pointer cur = new_finish.node + 1; cur <= finish.node; ++cur)
+                deallocate_node(*cur);
+            finish = new_finish;
+        }
+        return start + elems_before;
+    }
+
+    template <class T, class Alloc>
+    void deque<T, Alloc>::clear(){
+        destroy_data(start, finish);
+        for (map_pointer cur = start.node + 1; cur <= finish.node; ++cur)
+            deallocate_node(*cur);
+        finish.set_node(start.node);
+        finish.cur = start.cur;
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef _FLAT_HASH_MAP_H_
+#define _FLAT_HASH_MAP_H_
+
+#include <stdexcept>
+#include <initializer_list>
+#include "flat_hashtable.h"
+
+/* 开放定址的哈希map, 可以替代std::unordered_map
+ * 元素直接存放在表里, 插入引起扩容或者erase之后, 迭代器、指针和引用都可能失效
+ * 查找和插入的用法与std::unordered_map相同, 另外支持异构查找(哈希和比较函数都定义了is_transparent时)
+ */
+
+namespace TinySTL{
+    template <class Key, class T, class HashFcn = std::hash<Key>, class EqualKey = std::equal_to<Key>,
+              class Alloc = allocator<std::pair<const Key, T>>>
+    class flat_hash_map{
+    private:
+        typedef flat_hashtable<std::pair<const Key, T>, Key, HashFcn, _select1st<std::pair<const Key, T>>, EqualKey, Alloc> ht;
+        ht rep; // 底层的哈希表
+    public:
+        typedef typename ht::key_type           key_type;
+        typedef T                               mapped_type;
+        typedef typename ht::value_type         value_type;
+        typedef typename ht::hasher             hasher;
+        typedef typename ht::key_equal          key_equal;
+        typedef typename ht::size_type          size_type;
+        typedef typename ht::difference_type    difference_type;
+        typedef typename ht::pointer            pointer;
+        typedef typename ht::const_pointer      const_pointer;
+        typedef typename ht::reference          reference;
+        typedef typename ht::const_reference    const_reference;
+        typedef typename ht::iterator           iterator;
+        typedef typename ht::const_iterator     const_iterator;
+        typedef typename ht::allocator_type     allocator_type;
+
+        flat_hash_map() {}
+        explicit flat_hash_map(size_type n, const hasher &hf = hasher(), const key_equal &eql = key_equal(),
+                               const allocator_type &alloc = allocator_type()) : rep(hf, eql, alloc){
+            rep.reserve(n);
+        }
+        template <class InputIterator>
+        flat_hash_map(InputIterator first, InputIterator last) { insert(first, last); }
+        flat_hash_map(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        allocator_type get_allocator() const { return rep.get_allocator(); }
+        hasher hash_function() const { return rep.hash_function(); }
+        key_equal key_eq() const { return rep.key_eq(); }
+
+        iterator begin() { return rep.begin(); }
+        iterator end() { return rep.end(); }
+        const_iterator begin() const { return rep.begin(); }
+        const_iterator end() const { return rep.end(); }
+        const_iterator cbegin() const { return rep.begin(); }
+        const_iterator cend() const { return rep.end(); }
+
+        size_type size() const { return rep.size(); }
+        bool empty() const { return rep.empty(); }
+        size_type bucket_count() const { return rep.bucket_count(); }
+        float load_factor() const { return rep.load_factor(); }
+        void reserve(size_type n) { rep.reserve(n); }
+        void rehash(size_type n) { rep.rehash(n); }
+
+        iterator find(const key_type &key) { return rep.find(key); }
+        const_iterator find(const key_type &key) const { return rep.find(key); }
+        size_type count(const key_type &key) const { return rep.count(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        iterator find(const K &key) { return rep.find(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        const_iterator find(const K &key) const { return rep.find(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        size_type count(const K &key) const { return rep.count(key); }
+
+        mapped_type &at(const key_type &key){
+            iterator it = find(key);
+            if(it == end())
+                throw std::out_of_range("flat_hash_map::at");
+            return it->second;
+        }
+        const mapped_type &at(const key_type &key) const { return const_cast<flat_hash_map *>(this)->at(key); }
+        // 键不存在时插入值初始化的mapped_type
+        mapped_type &operator[](const key_type &key){
+            return rep.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>()).first->second;
+        }
+        mapped_type &operator[](key_type &&key){
+            return rep.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::tuple<>()).first->second;
+        }
+
+        std::pair<iterator, bool> insert(const value_type &obj) { return rep.insert_unique(obj); }
+        std::pair<iterator, bool> insert(value_type &&obj) { return rep.insert_unique(std::move(obj)); }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last){
+            for (; first != last; ++first)
+                rep.insert_unique(*first);
+        }
+        template <class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args) { return rep.emplace_unique(std::forward<Args>(args)...); }
+        // 键已经存在时不构造mapped_type, 也不移动args
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(const key_type &key, Args&&... args){
+            return rep.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        template <class... Args>
+        std::pair<iterator, bool> try_emplace(key_type &&key, Args&&... args){
+            return rep.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        void erase(const_iterator position) { rep.erase(position); }
+        size_type erase(const key_type &key) { return rep.erase(key); }
+        void clear() { rep.clear(); }
+        void swap(flat_hash_map &x) { rep.swap(x.rep); }
+    };
+
+    template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+    inline void swap(flat_hash_map<Key, T, HashFcn, EqualKey, Alloc> &x, flat_hash_map<Key, T, HashFcn, EqualKey, Alloc> &y){
+        x.swap(y);
+    }
+}
+
+#endif
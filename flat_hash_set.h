@@ -0,0 +1,95 @@
+#ifndef _FLAT_HASH_SET_H_
+#define _FLAT_HASH_SET_H_
+
+#include <initializer_list>
+#include "flat_hashtable.h"
+
+/* 开放定址的哈希set, 可以替代std::unordered_set
+ * 元素不能通过迭代器修改; 插入引起扩容或者erase之后, 迭代器、指针和引用都可能失效
+ */
+
+namespace TinySTL{
+    template <class Value, class HashFcn = std::hash<Value>, class EqualKey = std::equal_to<Value>, class Alloc = allocator<Value>>
+    class flat_hash_set{
+    private:
+        typedef flat_hashtable<Value, Value, HashFcn, _identity<Value>, EqualKey, Alloc> ht;
+        ht rep; // 底层的哈希表
+    public:
+        typedef typename ht::key_type           key_type;
+        typedef typename ht::value_type         value_type;
+        typedef typename ht::hasher             hasher;
+        typedef typename ht::key_equal          key_equal;
+        typedef typename ht::size_type          size_type;
+        typedef typename ht::difference_type    difference_type;
+        typedef typename ht::const_pointer      pointer;
+        typedef typename ht::const_pointer      const_pointer;
+        typedef typename ht::const_reference    reference;
+        typedef typename ht::const_reference    const_reference;
+        typedef typename ht::const_iterator     iterator; // 和SGI STL的hash_set一样, 修改元素会破坏哈希表
+        typedef typename ht::const_iterator     const_iterator;
+        typedef typename ht::allocator_type     allocator_type;
+
+        flat_hash_set() {}
+        explicit flat_hash_set(size_type n, const hasher &hf = hasher(), const key_equal &eql = key_equal(),
+                               const allocator_type &alloc = allocator_type()) : rep(hf, eql, alloc){
+            rep.reserve(n);
+        }
+        template <class InputIterator>
+        flat_hash_set(InputIterator first, InputIterator last) { insert(first, last); }
+        flat_hash_set(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+        allocator_type get_allocator() const { return rep.get_allocator(); }
+        hasher hash_function() const { return rep.hash_function(); }
+        key_equal key_eq() const { return rep.key_eq(); }
+
+        iterator begin() const { return rep.begin(); }
+        iterator end() const { return rep.end(); }
+        const_iterator cbegin() const { return rep.begin(); }
+        const_iterator cend() const { return rep.end(); }
+
+        size_type size() const { return rep.size(); }
+        bool empty() const { return rep.empty(); }
+        size_type bucket_count() const { return rep.bucket_count(); }
+        float load_factor() const { return rep.load_factor(); }
+        void reserve(size_type n) { rep.reserve(n); }
+        void rehash(size_type n) { rep.rehash(n); }
+
+        iterator find(const key_type &key) const { return rep.find(key); }
+        size_type count(const key_type &key) const { return rep.count(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        iterator find(const K &key) const { return rep.find(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        size_type count(const K &key) const { return rep.count(key); }
+
+        std::pair<iterator, bool> insert(const value_type &obj){
+            std::pair<typename ht::iterator, bool> p = rep.insert_unique(obj);
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+        std::pair<iterator, bool> insert(value_type &&obj){
+            std::pair<typename ht::iterator, bool> p = rep.insert_unique(std::move(obj));
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+        template <class InputIterator>
+        void insert(InputIterator first, InputIterator last){
+            for (; first != last; ++first)
+                rep.insert_unique(*first);
+        }
+        template <class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args){
+            std::pair<typename ht::iterator, bool> p = rep.emplace_unique(std::forward<Args>(args)...);
+            return std::pair<iterator, bool>(p.first, p.second);
+        }
+
+        void erase(const_iterator position) { rep.erase(position); }
+        size_type erase(const key_type &key) { return rep.erase(key); }
+        void clear() { rep.clear(); }
+        void swap(flat_hash_set &x) { rep.swap(x.rep); }
+    };
+
+    template <class Value, class HashFcn, class EqualKey, class Alloc>
+    inline void swap(flat_hash_set<Value, HashFcn, EqualKey, Alloc> &x, flat_hash_set<Value, HashFcn, EqualKey, Alloc> &y){
+        x.swap(y);
+    }
+}
+
+#endif
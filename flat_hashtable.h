@@ -0,0 +1,527 @@
+#ifndef _FLAT_HASHTABLE_H_
+#define _FLAT_HASHTABLE_H_
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <stdint.h>
+#include "iterator.h"
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "functional.h"
+#include "simd.h"
+
+/* 开放定址的哈希表(Swiss table的做法), 是flat_hash_map和flat_hash_set的底层
+ * 元素直接存放在一个数组(slots)里, 不像std::unordered_map那样每个元素一个节点
+ * 另有一个控制字节数组(ctrl)和slots一一对应: 空位、墓碑、或者元素哈希值的低7位(h2)
+ * 查找时按哈希值的高位(h1)选定一组16个位置, 用SSE2一次比较整组的控制字节, 只有h2相同的位置才真正比较键,
+ * 组里有空位就说明键不存在; 否则按三角数序列探测下一组
+ * 删除时如果所在的组还有空位, 说明从来没有探测序列经过这一组, 直接标成空位, 否则才留下墓碑
+ */
+
+namespace TinySTL{
+    // 控制字节的取值: 空位、墓碑和表尾的哨兵都是负数, 存有元素的位置保存h2(0~127)
+    enum {
+        _ctrl_empty = -128,
+        _ctrl_deleted = -2,
+        _ctrl_sentinel = -1
+    };
+
+    // std::hash对整数是恒等函数, 直接取低位做h2、高位做h1会严重聚集, 因此再打散一次
+    inline size_t __hash_mix(size_t h){
+        const uint64_t m = (uint64_t)h * 0x9E3779B97F4A7C15ull;
+        return (size_t)(m ^ (m >> 32));
+    }
+
+    // 按8字节一组对字节串做乘法-异或哈希
+    inline size_t __hash_bytes(const char *p, size_t n){
+        uint64_t h = 0xcbf29ce484222325ull ^ n;
+        for (; n >= 8; p += 8, n -= 8){
+            uint64_t k;
+            memcpy(&k, p, 8);
+            h = (h ^ k) * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 29;
+        }
+        for (; n > 0; ++p, --n)
+            h = (h ^ (unsigned char)*p) * 0x100000001b3ull;
+        return (size_t)h;
+    }
+
+    // 可以异构查找的字符串哈希和比较: 用const char*查找std::string键的表时不需要构造临时的std::string
+    struct string_hash{
+        typedef void is_transparent;
+        size_t operator()(const std::string &s) const { return __hash_bytes(s.data(), s.size()); }
+        size_t operator()(const char *s) const { return __hash_bytes(s, strlen(s)); }
+    };
+    struct string_equal{
+        typedef void is_transparent;
+        bool operator()(const std::string &a, const std::string &b) const { return a == b; }
+        bool operator()(const std::string &a, const char *b) const { return a.compare(b) == 0; }
+        bool operator()(const char *a, const std::string &b) const { return b.compare(a) == 0; }
+    };
+
+    // 哈希函数和比较函数都定义了is_transparent时, find和count接受任何可以和键比较的型别
+    template <class T>
+    struct _void_type{
+        typedef void type;
+    };
+    template <class F, class = void>
+    struct _is_transparent : std::false_type {};
+    template <class F>
+    struct _is_transparent<F, typename _void_type<typename F::is_transparent>::type> : std::true_type {};
+
+    template <class Value, class Ref, class Ptr>
+    struct __flat_hashtable_iterator{
+        typedef __flat_hashtable_iterator<Value, Value&, Value*> iterator;
+        typedef __flat_hashtable_iterator<Value, Ref, Ptr>       self;
+
+        typedef forward_iterator_tag    iterator_category;
+        typedef Value                   value_type;
+        typedef Ptr                     pointer;
+        typedef Ref                     reference;
+        typedef ptrdiff_t               difference_type;
+
+        const int8_t *ctrl; // 当前位置的控制字节
+        Value *slot; // 当前位置的元素
+
+        __flat_hashtable_iterator() : ctrl(0), slot(0) {}
+        __flat_hashtable_iterator(const int8_t *ctrl, Value *slot) : ctrl(ctrl), slot(slot) {}
+        __flat_hashtable_iterator(const iterator &x) : ctrl(x.ctrl), slot(x.slot) {}
+
+        // 跳过空位和墓碑, 停在下一个元素或者表尾的哨兵上
+        // ctrl数组在哨兵之后还补了一组, 因此可以一次检查16个控制字节
+        void skip_free(){
+            while(true){
+                const uint32_t used = ~simd::group_match_less(ctrl, _ctrl_sentinel) & ((1u << simd::GROUP_WIDTH) - 1);
+                if(used != 0){
+                    const unsigned n = simd::lowest_bit(used);
+                    ctrl += n;
+                    slot += n;
+                    return;
+                }
+                ctrl += simd::GROUP_WIDTH;
+                slot += simd::GROUP_WIDTH;
+            }
+        }
+
+        bool operator==(const self &x) const { return ctrl == x.ctrl; }
+        bool operator!=(const self &x) const { return ctrl != x.ctrl; }
+
+        reference operator*() const { return *slot; }
+        pointer operator->() const { return slot; }
+
+        self &operator++(){
+            ++ctrl;
+            ++slot;
+            skip_free();
+            return *this;
+        }
+        self operator++(int){
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+    };
+
+    /* 和SGI STL的hashtable一样由外层容器提供取键的方式:
+     * Value是元素型别, Key是键型别, ExtractKey从元素取出键, HashFcn和EqualKey作用于键
+     * 容量总是16的整数倍(2的幂), 最多装到容量的7/8
+     */
+    template <class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc = allocator<Value>>
+    class flat_hashtable : protected Alloc{
+    public:
+        typedef Key             key_type;
+        typedef Value           value_type;
+        typedef HashFcn         hasher;
+        typedef EqualKey        key_equal;
+        typedef size_t          size_type;
+        typedef ptrdiff_t       difference_type;
+        typedef Value*          pointer;
+        typedef const Value*    const_pointer;
+        typedef Value&          reference;
+        typedef const Value&    const_reference;
+        typedef Alloc           allocator_type;
+        typedef __flat_hashtable_iterator<Value, Value&, Value*>             iterator;
+        typedef __flat_hashtable_iterator<Value, const Value&, const Value*> const_iterator;
+    protected:
+        typedef Alloc data_alloctor; // 配置slots
+        typedef typename Alloc::template rebind<int8_t>::other ctrl_allocator; // 配置ctrl
+        enum { _group_width = simd::GROUP_WIDTH };
+
+        typedef typename _type_traits<Value>::is_relocatable_type is_relocatable; // 扩容时能否直接memcpy
+
+        hasher hash;
+        key_equal equals;
+        ExtractKey get_key;
+
+        int8_t *ctrl; // capacity + 1 + 15个控制字节, 第capacity个是哨兵, 之后一组也是哨兵, 供迭代器整组读取
+        Value *slots;
+        size_type num_buckets; // 容量, 0或者16的整数倍
+        size_type num_elements;
+        size_type growth_left; // 还能放入多少个元素而不扩容, 墓碑也占用名额
+
+        // 容量为0时ctrl指向这一组哨兵, begin()直接等于end()
+        static int8_t *empty_ctrl(){
+            static const int8_t group[_group_width] = {
+                _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel,
+                _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel, _ctrl_sentinel};
+            return const_cast<int8_t *>(group);
+        }
+        static size_type ctrl_bytes(size_type buckets) { return buckets + _group_width; }
+        static size_type max_load(size_type buckets) { return buckets - buckets / 8; }
+        // 放得下n个元素的最小容量
+        static size_type buckets_for(size_type n){
+            size_type buckets = _group_width;
+            while(max_load(buckets) < n)
+                buckets *= 2;
+            return buckets;
+        }
+
+        static int8_t h2(size_t hash) { return (int8_t)(hash & 0x7f); }
+        size_type num_groups() const { return num_buckets / _group_width; }
+        template <class K>
+        size_t hash_of(const K &key) const { return __hash_mix(hash(key)); }
+
+        ctrl_allocator get_ctrl_allocator() const { return ctrl_allocator(get_allocator()); }
+        void reset_empty(){
+            ctrl = empty_ctrl();
+            slots = 0;
+            num_buckets = num_elements = growth_left = 0;
+        }
+        // 配置新的ctrl和slots, 全部标为空位; 不修改原来的成员
+        void allocate_table(size_type buckets, int8_t *&new_ctrl, Value *&new_slots){
+            new_ctrl = get_ctrl_allocator().allocate(ctrl_bytes(buckets));
+            try{
+                new_slots = data_alloctor::allocate(buckets);
+            }
+            catch(...){
+                get_ctrl_allocator().deallocate(new_ctrl, ctrl_bytes(buckets));
+                throw;
+            }
+            memset(new_ctrl, _ctrl_empty, buckets);
+            memset(new_ctrl + buckets, _ctrl_sentinel, _group_width);
+        }
+        void deallocate_table(){
+            if(num_buckets == 0)
+                return;
+            get_ctrl_allocator().deallocate(ctrl, ctrl_bytes(num_buckets));
+            data_alloctor::deallocate(slots, num_buckets);
+        }
+        void destroy_elements(){
+            if(!std::is_trivially_destructible<Value>::value)
+                for (size_type i = 0; i < num_buckets; ++i)
+                    if(ctrl[i] >= 0)
+                        destory(slots + i);
+        }
+
+        // 在new_ctrl里为哈希值hash找第一个空位或墓碑
+        static size_type find_first_non_full(const int8_t *table_ctrl, size_type groups, size_t hash){
+            size_type group = (hash >> 7) & (groups - 1);
+            for (size_type step = 1; ; ++step){
+                const uint32_t mask = simd::group_match_less(table_ctrl + group * _group_width, _ctrl_sentinel);
+                if(mask != 0)
+                    return group * _group_width + simd::lowest_bit(mask);
+                group = (group + step) & (groups - 1);
+            }
+        }
+
+        // 查找键key所在的位置, 不存在时返回num_buckets
+        template <class K>
+        size_type find_index(const K &key, size_t hash) const{
+            if(num_buckets == 0)
+                return 0;
+            const int8_t tag = h2(hash);
+            const size_type groups = num_groups();
+            size_type group = (hash >> 7) & (groups - 1);
+            for (size_type step = 1; ; ++step){
+                const int8_t *g = ctrl + group * _group_width;
+                uint32_t mask = simd::group_match(g, tag);
+                while(mask != 0){
+                    const size_type i = group * _group_width + simd::lowest_bit(mask);
+                    if(equals(get_key(slots[i]), key))
+                        return i;
+                    mask &= mask - 1;
+                }
+                if(simd::group_match(g, _ctrl_empty) != 0)
+                    return num_buckets;
+                group = (group + step) & (groups - 1);
+            }
+        }
+
+        // 在位置i放入哈希值为hash的新元素, 元素构造失败时恢复控制字节
+        template <class... Args>
+        std::pair<iterator, bool> insert_at(size_type i, size_t hash, Args&&... value_args){
+            if(ctrl[i] == _ctrl_empty)
+                --growth_left;
+            ctrl[i] = h2(hash);
+            ++num_elements;
+            try{
+                construct(slots + i, std::forward<Args>(value_args)...);
+            }
+            catch(...){
+                erase_meta(i);
+                throw;
+            }
+            return std::pair<iterator, bool>(iterator(ctrl + i, slots + i), true);
+        }
+        // 取消位置i上的元素(元素已经析构或者还没有构造)
+        void erase_meta(size_type i){
+            const size_type group = i / _group_width * _group_width;
+            if(simd::group_match(ctrl + group, _ctrl_empty) != 0){
+                ctrl[i] = _ctrl_empty;
+                ++growth_left;
+            }
+            else{
+                ctrl[i] = _ctrl_deleted;
+            }
+            --num_elements;
+        }
+        // 没有空位可用: 墓碑很多时在原容量上重新整理, 否则容量翻倍
+        void rehash_for_insert(){
+            if(num_buckets == 0)
+                resize_table(_group_width);
+            else if(num_elements <= max_load(num_buckets) / 2)
+                resize_table(num_buckets);
+            else
+                resize_table(num_buckets * 2);
+        }
+        void resize_table(size_type buckets);
+        void relocate_all(int8_t *new_ctrl, Value *new_slots, size_type buckets, _true_type);
+        void relocate_all(int8_t *new_ctrl, Value *new_slots, size_type buckets, _false_type);
+        void copy_from(const flat_hashtable &x);
+
+        // 用value_args构造元素插入; 键已经存在时什么都不做
+        template <class K, class... Args>
+        std::pair<iterator, bool> emplace_key(const K &key, Args&&... value_args){
+            const size_t h = hash_of(key);
+            const size_type found = find_index(key, h);
+            if(found != num_buckets)
+                return std::pair<iterator, bool>(iterator(ctrl + found, slots + found), false);
+            if(num_buckets == 0){
+                rehash_for_insert();
+                return insert_at(find_first_non_full(ctrl, num_groups(), h), h, std::forward<Args>(value_args)...);
+            }
+            const size_type i = find_first_non_full(ctrl, num_groups(), h);
+            if(growth_left != 0 || ctrl[i] == _ctrl_deleted)
+                return insert_at(i, h, std::forward<Args>(value_args)...);
+            // 需要扩容: 参数可能引用表中的元素, 扩容后就失效了, 所以先构造出新元素
+            value_type obj(std::forward<Args>(value_args)...);
+            rehash_for_insert();
+            return insert_at(find_first_non_full(ctrl, num_groups(), h), h, std::move(obj));
+        }
+    public:
+        explicit flat_hashtable(const HashFcn &hf = HashFcn(), const EqualKey &eql = EqualKey(), const Alloc &alloc = Alloc())
+            : Alloc(alloc), hash(hf), equals(eql), get_key(ExtractKey()){
+            reset_empty();
+        }
+        flat_hashtable(const flat_hashtable &x) : Alloc(x.get_allocator()), hash(x.hash), equals(x.equals), get_key(x.get_key){
+            reset_empty();
+            copy_from(x);
+        }
+        // 移动构造只是接管x的数组
+        flat_hashtable(flat_hashtable &&x) noexcept : Alloc(x.get_allocator()), hash(x.hash), equals(x.equals), get_key(x.get_key),
+            ctrl(x.ctrl), slots(x.slots), num_buckets(x.num_buckets), num_elements(x.num_elements), growth_left(x.growth_left){
+            x.reset_empty();
+        }
+        flat_hashtable &operator=(const flat_hashtable &x){
+            if(this != &x){
+                flat_hashtable tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        flat_hashtable &operator=(flat_hashtable &&x) noexcept{
+            flat_hashtable tmp(std::move(x)); // 原来的元素随tmp一起析构
+            swap(tmp);
+            return *this;
+        }
+        ~flat_hashtable(){
+            destroy_elements();
+            deallocate_table();
+        }
+
+        allocator_type get_allocator() const { return *this; }
+        hasher hash_function() const { return hash; }
+        key_equal key_eq() const { return equals; }
+
+        void swap(flat_hashtable &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            std::swap(hash, x.hash);
+            std::swap(equals, x.equals);
+            std::swap(ctrl, x.ctrl);
+            std::swap(slots, x.slots);
+            std::swap(num_buckets, x.num_buckets);
+            std::swap(num_elements, x.num_elements);
+            std::swap(growth_left, x.growth_left);
+        }
+
+        iterator begin(){
+            iterator it(ctrl, slots);
+            it.skip_free();
+            return it;
+        }
+        iterator end() { return iterator(ctrl + num_buckets, slots + num_buckets); }
+        const_iterator begin() const { return const_cast<flat_hashtable *>(this)->begin(); }
+        const_iterator end() const { return const_cast<flat_hashtable *>(this)->end(); }
+
+        size_type size() const { return num_elements; }
+        bool empty() const { return num_elements == 0; }
+        size_type bucket_count() const { return num_buckets; }
+        float load_factor() const { return num_buckets == 0 ? 0.0f : (float)num_elements / num_buckets; }
+
+        // 保证放入n个元素之前不会再扩容, 扩容时迭代器全部失效
+        void reserve(size_type n){
+            if(n > num_elements + growth_left)
+                resize_table(buckets_for(n));
+        }
+        // 按至少n个元素的需要重新整理, 同时清掉所有墓碑
+        void rehash(size_type n){
+            if(n < num_elements)
+                n = num_elements;
+            if(n == 0 && num_elements == 0){
+                destroy_elements();
+                deallocate_table();
+                reset_empty();
+                return;
+            }
+            resize_table(buckets_for(n));
+        }
+
+        iterator find(const key_type &key){
+            const size_type i = find_index(key, hash_of(key));
+            return iterator(ctrl + i, slots + i);
+        }
+        const_iterator find(const key_type &key) const { return const_cast<flat_hashtable *>(this)->find(key); }
+        size_type count(const key_type &key) const { return find(key) != end() ? 1 : 0; }
+
+        // 异构查找: 哈希函数和比较函数都是透明的才能使用
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        iterator find(const K &key){
+            const size_type i = find_index(key, hash_of(key));
+            return iterator(ctrl + i, slots + i);
+        }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        const_iterator find(const K &key) const { return const_cast<flat_hashtable *>(this)->find(key); }
+        template <class K, class = typename std::enable_if<_is_transparent<HashFcn>::value && _is_transparent<EqualKey>::value, K>::type>
+        size_type count(const K &key) const { return find(key) != end() ? 1 : 0; }
+
+        // 键不存在时才插入, 返回元素的位置以及是否插入了
+        std::pair<iterator, bool> insert_unique(const value_type &obj) { return emplace_key(get_key(obj), obj); }
+        std::pair<iterator, bool> insert_unique(value_type &&obj) { return emplace_key(get_key(obj), std::move(obj)); }
+        // 先构造出元素才能知道键, 键已经存在时这个元素被丢弃
+        template <class... Args>
+        std::pair<iterator, bool> emplace_unique(Args&&... args){
+            value_type obj(std::forward<Args>(args)...);
+            return emplace_key(get_key(obj), std::move(obj));
+        }
+        // 给外层容器使用: 键不存在时才用value_args构造元素, 例如map的try_emplace和operator[]
+        template <class K, class... Args>
+        std::pair<iterator, bool> try_emplace_unique(const K &key, Args&&... value_args){
+            return emplace_key(key, std::forward<Args>(value_args)...);
+        }
+
+        void erase(const_iterator position){
+            const size_type i = position.ctrl - ctrl;
+            destory(slots + i);
+            erase_meta(i);
+        }
+        size_type erase(const key_type &key){
+            const size_type i = find_index(key, hash_of(key));
+            if(i == num_buckets)
+                return 0;
+            destory(slots + i);
+            erase_meta(i);
+            return 1;
+        }
+
+        // 析构所有元素, 保留容量
+        void clear(){
+            if(num_elements == 0 && growth_left == max_load(num_buckets))
+                return;
+            destroy_elements();
+            if(num_buckets != 0)
+                memset(ctrl, _ctrl_empty, num_buckets);
+            num_elements = 0;
+            growth_left = num_buckets == 0 ? 0 : max_load(num_buckets);
+        }
+    };
+
+    // *******************以下为flat_hashtable类中一些模板的实现*******************
+    template <class V, class K, class HF, class ExK, class EqK, class A>
+    void flat_hashtable<V, K, HF, ExK, EqK, A>::resize_table(size_type buckets){
+        int8_t *new_ctrl;
+        V *new_slots;
+        allocate_table(buckets, new_ctrl, new_slots);
+        relocate_all(new_ctrl, new_slots, buckets, is_relocatable());
+        deallocate_table();
+        ctrl = new_ctrl;
+        slots = new_slots;
+        num_buckets = buckets;
+        growth_left = max_load(buckets) - num_elements;
+    }
+
+    // 可以按字节搬移的元素直接复制到新位置, 原来的位置不再析构
+    template <class V, class K, class HF, class ExK, class EqK, class A>
+    void flat_hashtable<V, K, HF, ExK, EqK, A>::relocate_all(int8_t *new_ctrl, V *new_slots, size_type buckets, _true_type){
+        const size_type groups = buckets / _group_width;
+        for (size_type i = 0; i < num_buckets; ++i){
+            if(ctrl[i] < 0)
+                continue;
+            const size_t h = hash_of(get_key(slots[i]));
+            const size_type j = find_first_non_full(new_ctrl, groups, h);
+            new_ctrl[j] = h2(h);
+            memcpy((void *)(new_slots + j), (const void *)(slots + i), sizeof(V));
+        }
+    }
+
+    // 其他元素先全部移动(移动构造可能抛出异常时复制)到新位置, 全部成功后才析构原来的元素
+    // map的元素是pair<const Key, T>, 键只能复制
+    template <class V, class K, class HF, class ExK, class EqK, class A>
+    void flat_hashtable<V, K, HF, ExK, EqK, A>::relocate_all(int8_t *new_ctrl, V *new_slots, size_type buckets, _false_type){
+        const size_type groups = buckets / _group_width;
+        size_type i = 0;
+        try{
+            for (; i < num_buckets; ++i){
+                if(ctrl[i] < 0)
+                    continue;
+                const size_t h = hash_of(get_key(slots[i]));
+                const size_type j = find_first_non_full(new_ctrl, groups, h);
+                construct(new_slots + j, std::move_if_noexcept(slots[i]));
+                new_ctrl[j] = h2(h);
+            }
+        }
+        catch(...){
+            for (size_type j = 0; j < buckets; ++j)
+                if(new_ctrl[j] >= 0)
+                    destory(new_slots + j);
+            get_ctrl_allocator().deallocate(new_ctrl, ctrl_bytes(buckets));
+            data_alloctor::deallocate(new_slots, buckets);
+            throw;
+        }
+        destroy_elements();
+    }
+
+    template <class V, class K, class HF, class ExK, class EqK, class A>
+    void flat_hashtable<V, K, HF, ExK, EqK, A>::copy_from(const flat_hashtable &x){
+        if(x.num_elements == 0)
+            return;
+        reserve(x.num_elements);
+        try{
+            for (size_type i = 0; i < x.num_buckets; ++i)
+                if(x.ctrl[i] >= 0)
+                    emplace_key(get_key(x.slots[i]), x.slots[i]);
+        }
+        catch(...){
+            destroy_elements();
+            deallocate_table();
+            reset_empty();
+            throw;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _FUNCTIONAL_H_
+#define _FUNCTIONAL_H_
+
+// 关联容器从元素中取出键的仿函数: set的元素就是键, map的元素是pair, 键是first
+namespace TinySTL{
+    template <class T>
+    struct _identity{
+        const T &operator()(const T &x) const { return x; }
+    };
+
+    template <class Pair>
+    struct _select1st{
+        const typename Pair::first_type &operator()(const Pair &x) const { return x.first; }
+    };
+}
+
+#endif
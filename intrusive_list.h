@@ -0,0 +1,297 @@
+#ifndef _INTRUSIVE_LIST_H_
+#define _INTRUSIVE_LIST_H_
+
+#include <cstddef>
+#include <utility>
+#include "iterator.h"
+#include "list.h"
+
+/* 侵入式双向链表
+ * list插入时要配置一个__list_node<T>并把元素复制进去; 这里前驱、后继指针(钩子)直接嵌在用户的对象里,
+ * 链表只把对象串起来, 插入和删除不配置内存、不复制对象, 也不负责对象的生存期
+ * 对象可以通过继承或者成员带多个钩子, 每个钩子挂在一条链表上, 因此同一个对象可以同时在多条链表里
+ * 链接操作和list共用__list_transfer/__list_merge/__list_sort/__list_reverse
+ */
+
+namespace TinySTL{
+    // 钩子: 不在链表中时prev和next都是空指针
+    // 复制对象不会复制它在链表中的位置, 所以复制出来的钩子总是未链接的; 析构时如果还在链表里就先摘下来
+    class list_hook : public __list_node_base{
+    public:
+        list_hook() { prev = next = 0; }
+        list_hook(const list_hook &) { prev = next = 0; }
+        list_hook &operator=(const list_hook &) { return *this; }
+        ~list_hook() { unlink(); }
+
+        bool is_linked() const { return next != 0; }
+        // 从所在的链表中摘下来, O(1), 不需要知道是哪一条链表
+        void unlink(){
+            if(next == 0)
+                return;
+            prev->next = next;
+            next->prev = prev;
+            prev = next = 0;
+        }
+    };
+
+    // 通过继承嵌入的钩子, 对象要挂在多条链表上时用不同的Tag区分各个基类
+    template <class Tag = void>
+    class list_base_hook : public list_hook {};
+
+    // 钩子的取法: 对象和钩子之间的转换
+    template <class T, class Tag = void>
+    struct base_hook{
+        static list_hook *to_hook(T *x) { return static_cast<list_base_hook<Tag> *>(x); }
+        static T *to_value(__list_node_base *x){
+            return static_cast<T *>(static_cast<list_base_hook<Tag> *>(static_cast<list_hook *>(x)));
+        }
+    };
+
+    // 钩子是T的成员Member
+    template <class T, list_hook T::*Member>
+    struct member_hook{
+        static list_hook *to_hook(T *x) { return &(x->*Member); }
+        static T *to_value(__list_node_base *x){
+            return reinterpret_cast<T *>(reinterpret_cast<char *>(static_cast<list_hook *>(x)) - offset());
+        }
+        // 成员相对于对象开头的偏移, 用一个对齐的假地址计算, 不访问内存
+        static ptrdiff_t offset(){
+            T *p = reinterpret_cast<T *>(static_cast<size_t>(256));
+            return reinterpret_cast<char *>(&(p->*Member)) - reinterpret_cast<char *>(p);
+        }
+    };
+
+    template <class T, class Hook, class Ref, class Ptr>
+    struct __intrusive_list_iterator{
+        typedef __intrusive_list_iterator<T, Hook, T&, T*>  iterator;
+        typedef __intrusive_list_iterator<T, Hook, Ref, Ptr> self;
+
+        typedef bidirectional_iterator_tag  iterator_category;
+        typedef T                           value_type;
+        typedef Ptr                         pointer;
+        typedef Ref                         reference;
+        typedef ptrdiff_t                   difference_type;
+
+        __list_node_base *node;
+
+        __intrusive_list_iterator() : node(0) {}
+        explicit __intrusive_list_iterator(__list_node_base *x) : node(x) {}
+        // 对iterator本身来说这就是复制构造函数, 复制赋值要显式声明, 否则是deprecated的隐式版本
+        __intrusive_list_iterator(const iterator &x) : node(x.node) {}
+        self &operator=(const self &) = default;
+
+        bool operator==(const self &x) const { return node == x.node; }
+        bool operator!=(const self &x) const { return node != x.node; }
+
+        reference operator*() const { return *Hook::to_value(node); }
+        pointer operator->() const { return &(operator*()); }
+
+        self &operator++(){
+            node = node->next;
+            return *this;
+        }
+        self operator++(int){
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+        self &operator--(){
+            node = node->prev;
+            return *this;
+        }
+        self operator--(int){
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+    };
+
+    /* Hook是base_hook<T, Tag>或者member_hook<T, &T::member>
+     * 哨兵直接放在链表对象里, 因此链表不能复制, 移动和swap之后要修正首尾节点指向哨兵的链接
+     * 元素可以通过钩子的unlink()自己离开链表, 所以和list一样不记录长度, size()是O(n)
+     * 链表析构或者clear()时只把对象摘下来, 不析构它们
+     */
+    template <class T, class Hook = base_hook<T>>
+    class intrusive_list{
+    public:
+        typedef T                   value_type;
+        typedef T*                  pointer;
+        typedef const T*            const_pointer;
+        typedef T&                  reference;
+        typedef const T&            const_reference;
+        typedef size_t              size_type;
+        typedef ptrdiff_t           difference_type;
+        typedef __intrusive_list_iterator<T, Hook, T&, T*>              iterator;
+        typedef __intrusive_list_iterator<T, Hook, const T&, const T*>  const_iterator;
+    protected:
+        typedef __list_node_base base_type;
+
+        base_type head; // 哨兵
+
+        // 按元素比较两个节点
+        template <class Compare>
+        struct node_compare{
+            Compare comp;
+            explicit node_compare(Compare c) : comp(c) {}
+            bool operator()(base_type *a, base_type *b) { return comp(*Hook::to_value(a), *Hook::to_value(b)); }
+        };
+        struct value_less{
+            bool operator()(const T &a, const T &b) const { return a < b; }
+        };
+
+        static list_hook *unlinked_hook(base_type *x){
+            list_hook *h = static_cast<list_hook *>(x);
+            h->prev = h->next = 0;
+            return h;
+        }
+        // 接管x的全部节点, *this原来是空的
+        void take_nodes(intrusive_list &x){
+            if(x.empty()){
+                head.prev = head.next = &head;
+                return;
+            }
+            head.next = x.head.next;
+            head.prev = x.head.prev;
+            head.next->prev = &head;
+            head.prev->next = &head;
+            x.head.prev = x.head.next = &x.head;
+        }
+    public:
+        intrusive_list() { head.prev = head.next = &head; }
+        template <class InputIterator>
+        intrusive_list(InputIterator first, InputIterator last){
+            head.prev = head.next = &head;
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+        intrusive_list(intrusive_list &&x) noexcept { take_nodes(x); }
+        intrusive_list &operator=(intrusive_list &&x) noexcept{
+            if(this != &x){
+                clear();
+                take_nodes(x);
+            }
+            return *this;
+        }
+        intrusive_list(const intrusive_list &) = delete;
+        intrusive_list &operator=(const intrusive_list &) = delete;
+        ~intrusive_list() { clear(); }
+
+        iterator begin() { return iterator(head.next); }
+        const_iterator begin() const { return const_iterator(head.next); }
+        iterator end() { return iterator(&head); }
+        const_iterator end() const { return const_iterator(const_cast<base_type *>(&head)); }
+
+        bool empty() const { return head.next == &head; }
+        size_type size() const { return TinySTL::distance(begin(), end()); }
+
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *--end(); }
+        const_reference back() const { return *--end(); }
+
+        // 对象的迭代器, 对象必须在这条链表里
+        static iterator iterator_to(reference x) { return iterator(Hook::to_hook(&x)); }
+        static const_iterator iterator_to(const_reference x) { return const_iterator(Hook::to_hook(const_cast<T *>(&x))); }
+
+        // 把x挂在position之前, x的这个钩子必须是未链接的
+        iterator insert(const_iterator position, reference x){
+            base_type *h = Hook::to_hook(&x);
+            base_type *pos = position.node;
+            h->next = pos;
+            h->prev = pos->prev;
+            pos->prev->next = h;
+            pos->prev = h;
+            return iterator(h);
+        }
+        template <class InputIterator>
+        void insert(const_iterator position, InputIterator first, InputIterator last){
+            for (; first != last; ++first)
+                insert(position, *first);
+        }
+        void push_back(reference x) { insert(end(), x); }
+        void push_front(reference x) { insert(begin(), x); }
+        void pop_back() { Hook::to_hook(&back())->unlink(); }
+        void pop_front() { Hook::to_hook(&front())->unlink(); }
+
+        // 摘下position上的对象, 返回下一个位置; 对象本身不受影响
+        iterator erase(const_iterator position){
+            base_type *next = position.node->next;
+            static_cast<list_hook *>(position.node)->unlink();
+            return iterator(next);
+        }
+        iterator erase(const_iterator first, const_iterator last){
+            while(first != last)
+                first = erase(first);
+            return iterator(last.node);
+        }
+        // 移除等于value的对象
+        void remove(const T &value){
+            for (iterator it = begin(); it != end(); )
+                if(*it == value)
+                    it = erase(it);
+                else
+                    ++it;
+        }
+        template <class Predicate>
+        void remove_if(Predicate pred){
+            for (iterator it = begin(); it != end(); )
+                if(pred(*it))
+                    it = erase(it);
+                else
+                    ++it;
+        }
+        void clear(){
+            base_type *x = head.next;
+            while(x != &head){
+                base_type *next = x->next;
+                unlinked_hook(x);
+                x = next;
+            }
+            head.prev = head.next = &head;
+        }
+
+        void swap(intrusive_list &x){
+            intrusive_list tmp(std::move(x));
+            x.take_nodes(*this);
+            take_nodes(tmp);
+        }
+
+        // 将x接合到position之前, x必须不同于*this
+        void splice(const_iterator position, intrusive_list &x){
+            if(!x.empty())
+                __list_transfer(position.node, x.head.next, &x.head);
+        }
+        // 将i所指的对象接合到position之前, position和i可指向同一条链表
+        void splice(const_iterator position, intrusive_list &, const_iterator i){
+            base_type *j = i.node->next;
+            if(position.node == i.node || position.node == j)
+                return;
+            __list_transfer(position.node, i.node, j);
+        }
+        // 将[first, last)接合到position之前, position不能位于[first, last)之内
+        void splice(const_iterator position, intrusive_list &, const_iterator first, const_iterator last){
+            if(first != last)
+                __list_transfer(position.node, first.node, last.node);
+        }
+
+        // 两条链表都必须递增有序, 合并后x为空
+        void merge(intrusive_list &x) { merge(x, value_less()); }
+        template <class Compare>
+        void merge(intrusive_list &x, Compare comp){
+            if(&x != this)
+                __list_merge(&head, &x.head, node_compare<Compare>(comp));
+        }
+        // 稳定的归并排序, 只改变链接
+        void sort() { sort(value_less()); }
+        template <class Compare>
+        void sort(Compare comp) { __list_sort(&head, node_compare<Compare>(comp)); }
+        void reverse() { __list_reverse(&head); }
+    };
+
+    template <class T, class Hook>
+    inline void swap(intrusive_list<T, Hook> &x, intrusive_list<T, Hook> &y){
+        x.swap(y);
+    }
+}
+
+#endif
@@ -1,20 +1,395 @@
 #ifndef _LIST_H_
 #define _LIST_H_
 
+#include <new>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
 #include "iterator.h"
 #include "allocator.h"
 #include "construct.h"
+#include "algorithm.h"
 namespace TinySTL{
+    // 节点的链接部分, list的节点和intrusive_list的钩子都以它为基类, 下面的链表操作只动链接, 两者共用
+    struct __list_node_base{
+        __list_node_base *prev; // 前驱
+        __list_node_base *next; // 后继
+    };
+
     // 定义list的节点结构体类型
     template <class T>
-    struct __list_node{
-        typedef void* void_pointer;
-        void_pointer prev; // 前驱
-        void_pointer next; // 后继
+    struct __list_node : public __list_node_base{
         T data; // 数据域
     };
 
-    // 定义list独有的迭代器类
+    // 用元素的比较函数比较两个list节点
+    template <class T, class Compare>
+    struct __list_node_compare{
+        Compare comp;
+        explicit __list_node_compare(Compare c) : comp(c) {}
+        bool operator()(__list_node_base *a, __list_node_base *b){
+            return comp(static_cast<__list_node<T> *>(a)->data, static_cast<__list_node<T> *>(b)->data);
+        }
+    };
+
+    // 将[first, last)内的所有节点移动到position之前, 区间不能为空
+    inline void __list_transfer(__list_node_base *position, __list_node_base *first, __list_node_base *last){
+        last->prev->next = position;
+        first->prev->next = last;
+        position->prev->next = first;
+        __list_node_base *tmp = position->prev;
+        position->prev = last->prev;
+        last->prev = first->prev;
+        first->prev = tmp;
+    }
+
+    // 把以x为哨兵的有序链表合并到以head为哨兵的有序链表中, x变为空
+    // comp比较两个节点上的元素; 相等时head上的元素在前, 因此是稳定的
+    template <class NodeCompare>
+    void __list_merge(__list_node_base *head, __list_node_base *x, NodeCompare comp){
+        __list_node_base *first1 = head->next;
+        __list_node_base *first2 = x->next;
+        while(first1 != head && first2 != x){
+            if(comp(first2, first1)){
+                __list_node_base *next = first2->next; // 暂存first2的后继,因为经过transfer后first2的链接会变
+                __list_transfer(first1, first2, next);
+                first2 = next;
+            }
+            else
+                first1 = first1->next;
+        }
+        // x没走到头,说明后面的元素都不比head上的小
+        if(first2 != x)
+            __list_transfer(head, first2, x);
+    }
+
+    // 交换每个节点(包括哨兵)的前驱和后继
+    inline void __list_reverse(__list_node_base *head){
+        __list_node_base *x = head;
+        do{
+            __list_node_base *tmp = x->next;
+            x->next = x->prev;
+            x->prev = tmp;
+            x = tmp;
+        } while(x != head);
+    }
+
+    // 从first开始找一段不下降的节点, 返回这一段之后的节点
+    template <class NodeCompare>
+    __list_node_base *__list_run_end(__list_node_base *first, __list_node_base *last, NodeCompare &comp){
+        __list_node_base *prev = first;
+        for (__list_node_base *x = first->next; x != last; prev = x, x = x->next)
+            if(comp(x, prev))
+                return x;
+        return last;
+    }
+
+    /* 不需要额外内存的归并排序: counter[i]存放大约2^i个有序段合并成的结果, 每次从head取下一整段已经有序的节点,
+     * 像二进制加法一样逐级合并进位; 输入里已有的有序段越长, 段数越少, 已经有序时只比较n - 1次
+     * 只改变链接, 节点不会离开这条链表
+     */
+    template <class NodeCompare>
+    void __list_merge_sort(__list_node_base *head, NodeCompare comp){
+        // 如果是1个元素或者0个元素,直接return
+        if(head->next == head || head->next->next == head)
+            return;
+        __list_node_base carry;
+        __list_node_base counter[64];
+        carry.prev = carry.next = &carry;
+        for (int i = 0; i < 64; ++i)
+            counter[i].prev = counter[i].next = &counter[i];
+        int fill = 0;
+        while(head->next != head){
+            __list_transfer(&carry, head->next, __list_run_end(head->next, head, comp));
+            int i = 0;
+            while(i < fill && counter[i].next != &counter[i]){
+                // counter[i]里的元素都在carry之前, 合并到counter[i]上再整段移回carry
+                __list_merge(&counter[i], &carry, comp);
+                __list_transfer(&carry, counter[i].next, &counter[i]);
+                ++i;
+            }
+            __list_transfer(&counter[i], carry.next, &carry);
+            if(i == fill)
+                ++fill;
+        }
+        for (int i = 1; i < fill; ++i)
+            if(counter[i - 1].next != &counter[i - 1])
+                __list_merge(&counter[i], &counter[i - 1], comp);
+        __list_transfer(head, counter[fill - 1].next, &counter[fill - 1]);
+    }
+
+    enum {
+        _list_sort_min_run = 32,            // 自然归并时短于这个长度的有序段用插入排序补足
+        _list_sort_first_buffer = 1024,     // 收集节点的缓冲区的初始大小
+        _list_sort_max_key_bytes = 16,      // 不超过这个大小的可平凡复制的元素, 排序时把元素复制到缓冲区里比较
+        _list_sort_long_run = 16            // 有序段的平均长度不小于这个值时, 直接在链表上自然归并
+    };
+
+    /* 预扫描: 输入里已有的有序段平均长度是否不小于_list_sort_long_run
+     * 这时直接在链表上做自然归并(__list_merge_sort)比收集到缓冲区再重新链接更快;
+     * 随机的输入很快就会出现足够多的下降, 只看开头的几十个节点就返回false
+     */
+    template <class NodeCompare>
+    bool __list_has_long_runs(__list_node_base *head, NodeCompare &comp){
+        size_t n = 0, runs = 1;
+        for (__list_node_base *x = head->next; x->next != head; x = x->next){
+            ++n;
+            if(comp(x->next, x) && ++runs * _list_sort_long_run > n + 4 * _list_sort_long_run)
+                return false;
+        }
+        return true;
+    }
+
+    // 排序缓冲区里的一项: 节点指针, 或者元素的副本加上节点指针
+    template <class T>
+    struct __list_keyed_node{
+        T key;
+        __list_node_base *node;
+    };
+    inline __list_node_base *__list_entry_node(__list_node_base *x) { return x; }
+    template <class T>
+    inline __list_node_base *__list_entry_node(const __list_keyed_node<T> &x) { return x.node; }
+
+    // 比较缓冲区里的元素副本
+    template <class T, class Compare>
+    struct __list_key_compare{
+        Compare comp;
+        explicit __list_key_compare(Compare c) : comp(c) {}
+        bool operator()(const __list_keyed_node<T> &a, const __list_keyed_node<T> &b) { return comp(a.key, b.key); }
+    };
+
+    // 元素小而且可以逐字节复制时, 比较缓冲区里的副本, 不必每次比较都去访问分散的节点
+    template <class T>
+    struct _list_sort_traits{
+        typedef typename _bool_type<std::is_trivially_copyable<T>::value &&
+                                    sizeof(T) <= _list_sort_max_key_bytes>::type by_key;
+    };
+
+    // 排序用的连续缓冲区, 配置失败时抛出std::bad_alloc
+    template <class E>
+    class __list_sort_buffer{
+    public:
+        __list_sort_buffer() : items(0), merge_space(0), ends(0), len(0), capacity(0) {}
+        ~__list_sort_buffer(){
+            if(items)
+                allocator<E>::deallocate(items, capacity);
+            if(merge_space)
+                allocator<E>::deallocate(merge_space, len);
+            if(ends)
+                allocator<size_t>::deallocate(ends, max_runs());
+        }
+        // 缓冲区按需翻倍, 大块的扩展交给Alloc::reallocate
+        void push_back(const E &x){
+            if(len == capacity){
+                const size_t n = capacity ? capacity * 2 : (size_t)_list_sort_first_buffer;
+                items = capacity ? allocator<E>::reallocate(items, capacity, n) : allocator<E>::allocate(n);
+                capacity = n;
+            }
+            items[len++] = x;
+        }
+        // 归并用的第二块缓冲区, 和元素个数一样大
+        E *merge_buffer(){
+            if(merge_space == 0)
+                merge_space = allocator<E>::allocate(len);
+            return merge_space;
+        }
+        // 记录各个有序段结束位置的数组, 除最后一段外每段至少_list_sort_min_run个元素
+        size_t *run_ends(){
+            if(ends == 0)
+                ends = allocator<size_t>::allocate(max_runs());
+            return ends;
+        }
+        E *begin() { return items; }
+        E *end() { return items + len; }
+        size_t size() const { return len; }
+    private:
+        __list_sort_buffer(const __list_sort_buffer &);
+        __list_sort_buffer &operator=(const __list_sort_buffer &);
+        size_t max_runs() const { return len / _list_sort_min_run + 2; }
+        E *items;
+        E *merge_space;
+        size_t *ends;
+        size_t len, capacity;
+    };
+
+    // 按顺序收集head上的全部节点
+    inline void __list_gather(__list_node_base *head, __list_sort_buffer<__list_node_base *> &buffer){
+        for (__list_node_base *x = head->next; x != head; x = x->next)
+            buffer.push_back(x);
+    }
+    template <class T>
+    inline void __list_gather(__list_node_base *head, __list_sort_buffer<__list_keyed_node<T> > &buffer){
+        for (__list_node_base *x = head->next; x != head; x = x->next){
+            __list_keyed_node<T> e = {static_cast<__list_node<T> *>(x)->data, x};
+            buffer.push_back(e);
+        }
+    }
+
+    // 按[first, last)的顺序重新链接head上的节点
+    template <class E>
+    void __list_relink(__list_node_base *head, E *first, E *last){
+        __list_node_base *prev = head;
+        for (; first != last; ++first){
+            __list_node_base *x = __list_entry_node(*first);
+            prev->next = x;
+            x->prev = prev;
+            prev = x;
+        }
+        prev->next = head;
+        head->prev = prev;
+    }
+
+    /* 缓冲区上的自然归并排序(稳定), 已经有序时返回false
+     * 1. 从左到右切段: 取最长的不下降段, 严格下降的段直接反转; 短于_list_sort_min_run的段用插入排序补足
+     * 2. 在两块缓冲区之间来回, 相邻两段两两归并, 每一轮段数减半
+     * 部分有序的输入段数少, 归并的轮数也少; 完全随机的输入等同于先插入排序再自底向上归并
+     */
+    template <class E, class Compare>
+    bool __list_natural_merge_sort(__list_sort_buffer<E> &buffer, Compare &comp){
+        E *const first = buffer.begin();
+        const size_t n = buffer.size();
+        size_t *ends = buffer.run_ends();
+        size_t runs = 0;
+        bool changed = false;
+        for (size_t lo = 0; lo < n; ){
+            size_t hi = lo + 1;
+            if(hi < n && comp(first[hi], first[lo])){
+                while(hi + 1 < n && comp(first[hi + 1], first[hi]))
+                    ++hi;
+                ++hi;
+                std::reverse(first + lo, first + hi);
+                changed = true;
+            }
+            else{
+                while(hi < n && !comp(first[hi], first[hi - 1]))
+                    ++hi;
+            }
+            if(hi - lo < _list_sort_min_run && hi < n){
+                const size_t end = lo + _list_sort_min_run < n ? lo + _list_sort_min_run : n;
+                TinySTL::__insertion_sort(first + lo, first + end, comp);
+                hi = end;
+                changed = true;
+            }
+            ends[runs++] = hi;
+            lo = hi;
+        }
+        if(runs > 1){
+            changed = true;
+            E *src = first, *dst = buffer.merge_buffer();
+            while(runs > 1){
+                size_t out = 0, lo = 0;
+                for (size_t r = 0; r + 1 < runs; r += 2){
+                    TinySTL::__move_merge(src + lo, src + ends[r], src + ends[r], src + ends[r + 1], dst + lo, comp);
+                    lo = ends[r + 1];
+                    ends[out++] = lo;
+                }
+                if(runs % 2){
+                    TinySTL::copy(src + lo, src + n, dst + lo);
+                    ends[out++] = n;
+                }
+                runs = out;
+                std::swap(src, dst);
+            }
+            if(src != first)
+                TinySTL::copy(src, src + n, first);
+        }
+        return changed;
+    }
+
+    // 串行的排序方式
+    struct __list_natural_sorter{
+        template <class E, class Compare>
+        bool operator()(__list_sort_buffer<E> &buffer, Compare &comp) const { return __list_natural_merge_sort(buffer, comp); }
+    };
+
+    /* 排序引擎: 把节点(或者元素的副本和节点)收集到连续的缓冲区里, 由sorter排好, 再一次重新链接
+     * 比较函数抛出异常时链表还没有改动; 缓冲区配置失败时改用不需要额外内存的__list_merge_sort
+     */
+    template <class NodeCompare, class Sorter>
+    void __list_sort(__list_node_base *head, NodeCompare comp, Sorter sorter){
+        if(head->next == head || head->next->next == head)
+            return;
+        bool fallback = false;
+        try{
+            __list_sort_buffer<__list_node_base *> buffer;
+            __list_gather(head, buffer);
+            if(sorter(buffer, comp))
+                __list_relink(head, buffer.begin(), buffer.end());
+        }
+        catch(const std::bad_alloc &){
+            fallback = true;
+        }
+        if(fallback)
+            __list_merge_sort(head, comp);
+    }
+    // 串行排序的入口: 先预扫描, 有序段够长时在链表上自然归并, 否则使用缓冲区
+    template <class NodeCompare>
+    inline void __list_sort(__list_node_base *head, NodeCompare comp){
+        if(__list_has_long_runs(head, comp))
+            __list_merge_sort(head, comp);
+        else
+            __list_sort(head, comp, __list_natural_sorter());
+    }
+
+    // list<T>的排序: 按_list_sort_traits选择比较元素副本还是比较节点
+    template <class T, class Compare, class Sorter>
+    void __list_sort_values(__list_node_base *head, Compare comp, Sorter sorter, _true_type){
+        if(head->next == head || head->next->next == head)
+            return;
+        bool fallback = false;
+        try{
+            __list_sort_buffer<__list_keyed_node<T> > buffer;
+            __list_gather(head, buffer);
+            __list_key_compare<T, Compare> key_comp(comp);
+            if(sorter(buffer, key_comp))
+                __list_relink(head, buffer.begin(), buffer.end());
+        }
+        catch(const std::bad_alloc &){
+            fallback = true;
+        }
+        if(fallback)
+            __list_merge_sort(head, __list_node_compare<T, Compare>(comp));
+    }
+    template <class T, class Compare, class Sorter>
+    inline void __list_sort_values(__list_node_base *head, Compare comp, Sorter sorter, _false_type){
+        __list_sort(head, __list_node_compare<T, Compare>(comp), sorter);
+    }
+
+    enum { _list_first_slab_bytes = 512 }; // 第一个slab的大小
+    enum { _list_max_slab_bytes = 64 * 1024 }; // slab每次翻倍, 到这个大小为止
+
+    // list的节点成块(slab)配置, 同一个slab中的节点在内存中连续, 按配置的顺序分给push_back/insert,
+    // 因此连续插入的节点遍历起来基本是顺序访问内存
+    // slab的头部就放在这段节点数组的开头, 占用最前面几个节点的位置
+    template <class T>
+    struct __list_slab{
+        __list_slab *next; // 同一个pool中的下一个slab
+        size_t size; // 整段空间有多少个节点大小(包括头部占用的)
+        size_t free; // 回收空slab时统计其中空闲的节点数
+    };
+
+    // 一条list使用的slab池
+    // 节点splice到另一条list之后, 它的内存仍然在原来的pool里, 所以这时两条list的pool要合并成一个:
+    // 被合并的pool交出全部slab, 只留下指向合并后pool的forward指针
+    // refs是直接指向这个pool的list个数加上转发到它的pool个数, 减到0时释放全部slab
+    // 共用的pool不会随某一条list释放, 所以这时list销毁的节点也要放回空闲链表, 空闲节点积累够多时释放完全空闲的slab
+    template <class T>
+    struct __list_pool{
+        typedef __list_node<T>* link_type;
+        __list_pool *forward;
+        size_t refs;
+        __list_slab<T> *slabs;
+        __list_slab<T> *last_slab;
+        link_type free_nodes; // erase之后回收的节点, 通过next串起来, 优先重用
+        link_type free_tail;
+        link_type cur; // 当前slab中还没有分出去的部分[cur, end)
+        link_type end;
+        size_t next_slab_nodes; // 下一个slab的节点数
+        size_t free_count; // 空闲链表里的节点数
+        size_t capacity; // 所有slab中可以分出去的节点总数
+        size_t reclaim_at; // 共用时空闲节点数达到它才去回收空slab, 每次回收后翻倍, 使回收的开销均摊到每次释放上
+    };
+
     template <class T, class Ref, class Ptr>
     struct __list_iterator{
         typedef __list_iterator<T, T&, T*>              iterator;
@@ -35,17 +410,19 @@ namespace TinySTL{
         // 构造器
         __list_iterator(link_type x) : node(x) {}
         __list_iterator() {}
+        // 对iterator本身来说这就是复制构造函数, 复制赋值要显式声明, 否则是deprecated的隐式版本
         __list_iterator(const iterator& x) : node(x.node) {}
+        self &operator=(const self &) = default;
 
-        bool operator==(const self &x) { return x.node == node; }
-        bool operator!=(const self &x) { return x.node != node; }
+        bool operator==(const self &x) const { return x.node == node; }
+        bool operator!=(const self &x) const { return x.node != node; }
 
         reference operator*() const { return (*node).data; }
-        reference operator->() const { return &(operator*()); }
+        pointer operator->() const { return &(operator*()); }
         
         // 前++
         self& operator++(){
-            node = node->next;
+            node = (link_type)node->next;
             return *this;
         }
 
@@ -58,7 +435,7 @@ namespace TinySTL{
 
         // 前--
         self& operator--(){
-            node = node->prev;
+            node = (link_type)node->prev;
             return *this;
         }
 
@@ -70,12 +447,19 @@ namespace TinySTL{
         }
     };
 
+    // list配置的是节点而不是T, 因此用rebind得到节点的配置器
+    // 和vector一样以protected方式继承节点配置器, 以便保存有状态的配置器
     template <class T, class Alloc = allocator<T>>
-    class list{
+    class list : protected Alloc::template rebind<__list_node<T> >::other{
     protected:
         typedef __list_node<T> list_node;
+        typedef __list_slab<T> slab_type;
+        typedef __list_pool<T> pool_type;
         list_node* node;
-        typedef Alloc list_node_allocator; // 专属的配置空间
+        pool_type* pool; // 节点所在的slab池, 第一次配置节点时才建立
+        typedef typename Alloc::template rebind<list_node>::other list_node_allocator; // 专属的配置空间
+        typedef typename Alloc::template rebind<pool_type>::other pool_allocator; // 配置pool
+        enum { slab_header_nodes = (sizeof(slab_type) + sizeof(list_node) - 1) / sizeof(list_node) };
 
     public:
         typedef T               value_type;
@@ -86,14 +470,237 @@ namespace TinySTL{
         typedef size_t          size_type;
         typedef ptrdiff_t       difference_type;
         typedef list_node*      link_type;
+        typedef Alloc           allocator_type;
     public:
         typedef __list_iterator<T, T&, T*>                  iterator;
         typedef __list_iterator<T, const T&, const T*>      const_iterator;
     protected:
-        // 配置一个节点
-        link_type get_node() { return list_node_allocator::allocate(); }
-        // 释放一个节点
-        void put_node(link_type p) { list_node_allocator::deallocate(p); }
+        // 找到当前使用的pool, 它已经合并到别的pool时改为直接指向合并后的pool
+        pool_type *get_pool(){
+            if(pool == 0){
+                pool = pool_allocator(get_allocator()).allocate(1);
+                pool->forward = 0;
+                pool->refs = 1;
+                pool->slabs = pool->last_slab = 0;
+                pool->free_nodes = pool->free_tail = pool->cur = pool->end = 0;
+                pool->next_slab_nodes = first_slab_nodes();
+                pool->free_count = pool->capacity = 0;
+                pool->reclaim_at = first_slab_nodes();
+            }
+            else if(pool->forward){
+                pool_type *root = pool->forward;
+                while(root->forward)
+                    root = root->forward;
+                ++root->refs;
+                release_pool(pool);
+                pool = root;
+            }
+            return pool;
+        }
+        // 放弃对p的引用, 引用数减到0时释放它的slab, 并继续放弃它转发到的pool
+        void release_pool(pool_type *p){
+            while(p != 0 && --p->refs == 0){
+                pool_type *next = p->forward;
+                free_slabs(p);
+                pool_allocator(get_allocator()).deallocate(p, 1);
+                p = next;
+            }
+        }
+        static size_t first_slab_nodes(){
+            const size_t n = _list_first_slab_bytes / sizeof(list_node);
+            return n > slab_header_nodes + 4 ? n : slab_header_nodes + 4;
+        }
+        void add_slab(pool_type *p){
+            const size_t n = p->next_slab_nodes;
+            link_type mem = list_node_allocator::allocate(n);
+            slab_type *s = reinterpret_cast<slab_type *>(mem);
+            s->next = 0;
+            s->size = n;
+            if(p->last_slab)
+                p->last_slab->next = s;
+            else
+                p->slabs = s;
+            p->last_slab = s;
+            p->cur = mem + slab_header_nodes;
+            p->end = mem + n;
+            p->capacity += n - slab_header_nodes;
+            if(n * sizeof(list_node) < _list_max_slab_bytes)
+                p->next_slab_nodes = n * 2;
+        }
+        // 整块释放p的所有slab, 其中的节点全部作废
+        void free_slabs(pool_type *p){
+            for (slab_type *s = p->slabs; s; ){
+                slab_type *next = s->next;
+                list_node_allocator::deallocate(reinterpret_cast<link_type>(s), s->size);
+                s = next;
+            }
+            p->slabs = p->last_slab = 0;
+            p->free_nodes = p->free_tail = p->cur = p->end = 0;
+            p->next_slab_nodes = first_slab_nodes();
+            p->free_count = p->capacity = 0;
+            p->reclaim_at = first_slab_nodes();
+        }
+        static bool slab_unused(slab_type *s) { return s->free == s->size - slab_header_nodes; }
+        // 在按地址排好序的slab数组中找到节点x所在的slab
+        static slab_type *slab_of(slab_type **order, size_t n, link_type x){
+            return *(std::upper_bound(order, order + n, reinterpret_cast<slab_type *>(x), std::less<slab_type *>()) - 1);
+        }
+        // 释放p中节点全部空闲的slab, 并从空闲链表中去掉这些slab里的节点
+        // 开销是O(空闲节点数 * log(slab数)); 临时数组配置失败时什么也不做
+        void reclaim_slabs(pool_type *p){
+            size_t n = 0;
+            for (slab_type *s = p->slabs; s; s = s->next)
+                ++n;
+            slab_type **order;
+            try{
+                order = allocator<slab_type *>::allocate(n);
+            }
+            catch(const std::bad_alloc &){
+                return;
+            }
+            n = 0;
+            for (slab_type *s = p->slabs; s; s = s->next){
+                s->free = 0;
+                order[n++] = s;
+            }
+            std::sort(order, order + n, std::less<slab_type *>());
+            for (link_type x = p->free_nodes; x; x = (link_type)x->next)
+                ++slab_of(order, n, x)->free;
+            if(p->cur != p->end)
+                slab_of(order, n, p->cur)->free += p->end - p->cur;
+            // 保留其余空闲节点原来的次序
+            link_type head = 0, tail = 0;
+            size_t count = 0;
+            for (link_type x = p->free_nodes; x; x = (link_type)x->next){
+                if(slab_unused(slab_of(order, n, x)))
+                    continue;
+                if(tail)
+                    tail->next = x;
+                else
+                    head = x;
+                tail = x;
+                ++count;
+            }
+            if(tail)
+                tail->next = 0;
+            if(p->cur != p->end && slab_unused(slab_of(order, n, p->cur)))
+                p->cur = p->end = 0;
+            allocator<slab_type *>::deallocate(order, n);
+            slab_type *prev = 0;
+            for (slab_type *s = p->slabs; s; ){
+                slab_type *next = s->next;
+                if(slab_unused(s)){
+                    p->capacity -= s->size - slab_header_nodes;
+                    list_node_allocator::deallocate(reinterpret_cast<link_type>(s), s->size);
+                    if(prev)
+                        prev->next = next;
+                    else
+                        p->slabs = next;
+                }
+                else
+                    prev = s;
+                s = next;
+            }
+            p->last_slab = prev;
+            p->free_nodes = head;
+            p->free_tail = tail;
+            p->free_count = count;
+            p->reclaim_at = 2 * count + first_slab_nodes();
+        }
+        // 别的list也在用这个pool时, 空闲节点积累够多才回收; 独占的pool留到clear或者整个pool释放
+        void reclaim_if_shared(pool_type *p){
+            if(p->refs > 1 && p->free_count >= p->reclaim_at)
+                reclaim_slabs(p);
+        }
+        // 把节点x放进p的空闲链表
+        static void push_free(pool_type *p, link_type x){
+            if(p->free_nodes == 0)
+                p->free_tail = x;
+            x->next = p->free_nodes;
+            p->free_nodes = x;
+            ++p->free_count;
+        }
+        // 把src的slab和空闲节点都交给dst
+        static void absorb_pool(pool_type *dst, pool_type *src){
+            if(src->slabs){
+                if(dst->last_slab)
+                    dst->last_slab->next = src->slabs;
+                else
+                    dst->slabs = src->slabs;
+                dst->last_slab = src->last_slab;
+            }
+            if(src->free_nodes){
+                src->free_tail->next = dst->free_nodes;
+                if(dst->free_nodes == 0)
+                    dst->free_tail = src->free_tail;
+                dst->free_nodes = src->free_nodes;
+            }
+            dst->free_count += src->free_count;
+            dst->capacity += src->capacity;
+            if(dst->cur == dst->end){
+                dst->cur = src->cur;
+                dst->end = src->end;
+            }
+            else{
+                // 只能保留一段还没有分出去的空间, src剩下的节点放进空闲链表, 否则它们所在的slab永远不会空闲
+                for (link_type x = src->cur; x != src->end; ++x)
+                    push_free(dst, x);
+            }
+            src->slabs = src->last_slab = 0;
+            src->free_nodes = src->free_tail = src->cur = src->end = 0;
+            src->free_count = src->capacity = 0;
+        }
+        // x的部分节点要移到*this, 此后两条list使用同一个pool
+        void share_pool(list &x){
+            if(&x == this || x.pool == 0)
+                return;
+            pool_type *b = x.get_pool();
+            if(pool == 0){
+                pool = b;
+                ++b->refs;
+                return;
+            }
+            pool_type *a = get_pool();
+            if(a == b)
+                return;
+            absorb_pool(a, b);
+            b->forward = a;
+            ++a->refs;
+        }
+        // x的全部节点要移到*this: x独占它的pool时直接接收它的slab, 两条list仍然各自独占自己的pool
+        void take_pool(list &x){
+            if(&x == this || x.pool == 0)
+                return;
+            pool_type *b = x.get_pool();
+            if(b->refs != 1){
+                share_pool(x);
+            }
+            else if(pool == 0){
+                pool = b;
+                x.pool = 0;
+            }
+            else{
+                absorb_pool(get_pool(), b);
+            }
+        }
+
+        // 配置一个节点: 先重用回收的节点, 再从当前slab中按顺序分出
+        link_type get_node(){
+            pool_type *p = get_pool();
+            if(p->free_nodes){
+                link_type x = p->free_nodes;
+                p->free_nodes = (link_type)x->next;
+                --p->free_count;
+                return x;
+            }
+            if(p->cur == p->end)
+                add_slab(p);
+            return p->cur++;
+        }
+        // 释放一个节点: 放回pool的空闲链表, slab要等整个pool释放或者回收空slab时才归还
+        void put_node(link_type p){
+            push_free(get_pool(), p);
+        }
         // 产生一个节点(配置并构造)
         link_type create_node(const T& x){
             link_type p = get_node();
@@ -105,9 +712,10 @@ namespace TinySTL{
             destory(&p->data); // 析构掉data位置上的对象
             put_node(p);  // 释放空间
         }
-        // 初始化一个空链表
+        // 初始化一个空链表, 哨兵节点单独配置, 不占用slab
         void empty_init(){
-            node = get_node();
+            pool = 0;
+            node = list_node_allocator::allocate(1);
             node->next = node;
             node->prev = node;
         }
@@ -135,13 +743,7 @@ namespace TinySTL{
 
         // 将[first, last)内的所有元素移动到pos之前
         void transfer(iterator position, iterator first, iterator last){
-            ((link_type)(last.node->prev))->next = position.node;
-            ((link_type)(first.node->prev))->next = last.node;
-            ((link_type)(position.node->prev))->next = first.node;
-            link_type tmp = (link_type)(position.node->prev);
-            position.node->prev = last.node->prev;
-            last.node->prev = first.node->prev;
-            first.node->prev = tmp;
+            __list_transfer(position.node, first.node, last.node);
         }
 
     public:
@@ -158,6 +760,9 @@ namespace TinySTL{
         reference back() { return *(--end()); }
         // 构造函数, 产生一个空链表
         list() { empty_init(); }
+        explicit list(const Alloc &alloc) : list_node_allocator(alloc) { empty_init(); }
+
+        allocator_type get_allocator() const { return allocator_type(static_cast<const list_node_allocator &>(*this)); }
         void push_back(const T &x) { insert(end(), x); }
         void push_front(const T &x) { insert(begin(), x); }
         void pop_back() { erase(--end()); }
@@ -165,6 +770,15 @@ namespace TinySTL{
 
         // 清除整个链表
         void clear();
+    protected:
+        void destroy_elements(_true_type) {}
+        void destroy_elements(_false_type){
+            for (link_type cur = (link_type)node->next; cur != node; cur = (link_type)cur->next)
+                destory(&cur->data);
+        }
+        void clear_nodes(_true_type);
+        void clear_nodes(_false_type);
+    public:
 
         // 将数值为value的所有元素移除
         void remove(const T &value);
@@ -174,46 +788,71 @@ namespace TinySTL{
 
         // 将x接合到pos所指的位置之前, x必须不同于*this
         void splice(iterator position, list &x){
-            if(!x.empty())
+            if(!x.empty()){
+                take_pool(x);
                 transfer(position, x.begin(), x.end());
+            }
         }
         // 将i所指的元素接合到pos所指的位置之前,pos和i可指向同一个list
-        void splice(iterator position, list &, iterator i){
+        void splice(iterator position, list &x, iterator i){
             iterator j = i;
             ++j;
             // 如果pos和i是同一个位置或者i已经在pos前一个位置了
             if(position == i || position == j)
                 return;
+            share_pool(x);
             transfer(position, i, j);
         }
         // 将[first, last)内的所有元素接合到pos所指的位置之前
         // pos和[first,last)可指向同一个list,但pos不能位于[first,last)之内
-        void splice(iterator position, list &, iterator first, iterator last){
-            if(first != last)
+        void splice(iterator position, list &x, iterator first, iterator last){
+            if(first != last){
+                share_pool(x);
                 transfer(position, first, last);
+            }
         }
 
         // 交换链表x和*this
         void swap(list &x) {
+            std::swap(static_cast<list_node_allocator &>(*this), static_cast<list_node_allocator &>(x));
             auto temp = node;
             node = x.node;
             x.node = temp;
+            pool_type *p = pool;
+            pool = x.pool;
+            x.pool = p;
         }
 
         // merge()将x合并到*this身上,两个lists的内容都必须递增有序
-        void merge(list &x);
+        void merge(list &x) { merge(x, _less()); }
+        template <class Compare>
+        void merge(list &x, Compare comp);
 
         // reverse()将*this的内容逆向重置
         void reverse();
 
         // list不能使用STL算法sort(), 必须使用自己的sort()成员函数
         // 因为STL的sort()算法只接受RamdonAccessIterator
-        // 本函数采用快排
-        void sort();
+        // 稳定的自然归并排序: 基本有序时直接在链表上归并, 否则收集到连续的缓冲区里排好再一次重新链接, 见__list_sort
+        void sort() { sort(_less()); }
+        template <class Compare>
+        void sort(Compare comp){
+            __list_node_compare<T, Compare> node_comp(comp);
+            if(__list_has_long_runs(node, node_comp))
+                __list_merge_sort(node, node_comp);
+            else
+                __list_sort_values<T>(node, comp, __list_natural_sorter(), typename _list_sort_traits<T>::by_key());
+        }
 
+        // 独占的pool随这条list一起释放, 只需要析构元素;
+        // pool还有别的list在用时节点要逐个放回pool, 否则它们所在的slab永远不会空闲
         ~list(){
-            clear();
-            put_node(node);
+            if(pool != 0 && get_pool()->refs > 1)
+                clear_nodes(_false_type());
+            else
+                destroy_elements(typename _type_traits<T>::has_trivial_destructor());
+            release_pool(pool);
+            list_node_allocator::deallocate(node, 1);
         }
     };
 
@@ -226,15 +865,32 @@ namespace TinySTL{
     // 清除整个链表
     template <class T, class Alloc>
     void list<T, Alloc>::clear(){
+        if(node->next == node)
+            return;
+        clear_nodes(typename _type_traits<T>::has_trivial_destructor());
+        // 恢复node的初始状态
+        node->prev = node;
+        node->next = node;
+    }
+    // 元素不需要析构, 而且pool只属于这条list时, 所有节点都在这条list或者空闲链表里, 整块释放slab即可
+    template <class T, class Alloc>
+    void list<T, Alloc>::clear_nodes(_true_type){
+        pool_type *p = get_pool();
+        if(p->refs == 1)
+            free_slabs(p);
+        else
+            clear_nodes(_false_type());
+    }
+    template <class T, class Alloc>
+    void list<T, Alloc>::clear_nodes(_false_type){
         link_type cur = (link_type)node->next; // cur指向begin()
         while (cur != node){
             link_type tmp = cur;
             cur = (link_type) cur->next;
             destory_node(tmp); // tmp本身就是个指针,存储的本身就是地址,因此不用加&
         }
-        // 恢复node的初始状态
-        node->prev = node;
-        node->next = node;
+        if(pool != 0)
+            reclaim_if_shared(get_pool());
     }
 
     // 将数值为value的所有元素移除
@@ -260,70 +916,27 @@ namespace TinySTL{
         }
     }
 
-    // merge()将x合并到*this身上,两个lists的内容都必须递增有序
+    // merge()将x合并到*this身上,两个lists的内容都必须按comp递增有序
     template <class T, class Alloc>
-    void list<T, Alloc>::merge(list<T, Alloc> &x){
-        // *this链表的首尾
-        iterator first1 = begin();
-        iterator last1 = end();
-        // 待插入链表的首尾
-        iterator first2 = x.begin();
-        iterator last2 = x.end();
-
-        while(first1 != last1 && first2 != last2){
-            if(*first1 > *first2){
-                iterator next = first2; // 暂存first2节点,因为经过transfer后first2位置会变
-                ++first2;
-                transfer(first1, next, first2);
-            }
-            else
-                ++first1;
+    template <class Compare>
+    void list<T, Alloc>::merge(list<T, Alloc> &x, Compare comp){
+        if(&x == this)
+            return;
+        // comp抛出异常时两条list各自留下一部分节点, 这时只能共用pool; 合并完成后x的节点才全部属于*this
+        try{
+            __list_merge(node, x.node, __list_node_compare<T, Compare>(comp));
         }
-        // 待插入链表没走到头,说明后面的元素都比*this大
-        if(first2 != last2)
-            transfer(last1, first2, last2);
+        catch(...){
+            share_pool(x);
+            throw;
+        }
+        take_pool(x);
     }
 
     // reverse()将*this的内容逆向重置
     template <class T, class Alloc>
     void list<T, Alloc>::reverse(){
-        if(size() == 0 || size() == 1)
-            return;
-        iterator first = begin() + 1;
-        while(first != end()){
-            iterator old = first; // 必须要这样暂存first指向的节点,因为经过transfer后first会边
-            ++first;
-            transfer(begin(), old, first);
-        }
-    }
-
-    // list不能使用STL算法sort(), 必须使用自己的sort()成员函数
-    // 因为STL的sort()算法只接受RamdonAccessIterator
-    // 本函数采用快排
-    // 目前还不能理解这个sort为什么这么写,回头好好看看
-    template <class T, class Alloc>
-    void list<T, Alloc>::sort(){
-        // 如果是1个元素或者0个元素,直接return
-        if(size() == 0 || size() == 1)
-            return;
-
-        list<T, Alloc> carry;
-        list<T, Alloc> counter[64];
-        int fill = 0;
-        while(!empty()){
-            carry.splice(carry.begin(), *this, begin());
-            int i = 0;
-            while(i < fill && !counter[i].empty()){
-                counter[i].merge(carry);
-                carry.swap(counter[i++]);
-            }
-            carry.swap(counter[i]);
-            if(i == fill)
-                ++fill;
-        }
-        for (int i = 1; i < fill;++i)
-            counter[i].merage(counter[i - 1]);
-        swap(counter[fill - 1]);
+        __list_reverse(node);
     }
     
 }
@@ -0,0 +1,524 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "thread_pool.h"
+#include "type_traits.h"
+#include "iterator.h"
+#include "construct.h"
+#include "algorithm.h"
+#include "uninitialized.h"
+#include "list.h"
+
+/* 带执行策略的算法
+ * seq: 和不带策略的版本相同, 在当前线程执行
+ * par: 随机访问的区间拆分成大约L2 cache大小的块, 由thread_pool的各个线程并行处理; 其他迭代器退回到seq
+ * 拆分是确定的: 同样长度的区间, 第k块总是优先交给同一个线程, 因此用par初始化的内存(first touch, 操作系统
+ * 把页面分配在第一次写它的线程所在的NUMA节点上)在之后的par算法里仍然主要由同一个线程访问
+ */
+
+namespace TinySTL{
+    struct sequenced_policy {};
+    struct parallel_policy {};
+    constexpr sequenced_policy seq = sequenced_policy();
+    constexpr parallel_policy par = parallel_policy();
+
+    enum {
+        _parallel_chunk_bytes = 256 * 1024  // 每个任务处理的字节数, 大约是L2 cache的大小
+    };
+
+    // 每块的元素个数
+    template <class T>
+    inline size_t __parallel_grain(){
+        return sizeof(T) >= _parallel_chunk_bytes ? 1 : _parallel_chunk_bytes / sizeof(T);
+    }
+
+    // 两个迭代器都是随机访问迭代器时才拆分
+    template <class Iterator1, class Iterator2 = Iterator1>
+    struct _parallel_traits{
+        typedef typename _bool_type<
+            std::is_same<typename iterator_traits<Iterator1>::iterator_category, random_access_iterator_tag>::value &&
+            std::is_same<typename iterator_traits<Iterator2>::iterator_category, random_access_iterator_tag>::value>::type is_parallel;
+    };
+
+    /* 把[0, n)按grain个元素一块拆分, 对每块调用f(begin, end), 每块的起点都是grain的整数倍
+     * 各块按顺序平均分给各个线程, 调用者自己处理第一段, 工作线程i处理第i + 1段, 先做完的线程会去偷别人的块
+     * f抛出的第一个异常在所有块结束后重新抛出
+     */
+    template <class Function>
+    void parallel_for(size_t n, size_t grain, Function f){
+        thread_pool &pool = thread_pool::instance();
+        const size_t threads = pool.concurrency();
+        const size_t chunks = (n + grain - 1) / grain;
+        if(threads == 1 || chunks <= 1){
+            for (size_t begin = 0; begin < n; begin += grain)
+                f(begin, n - begin > grain ? begin + grain : n);
+            return;
+        }
+        task_group group(pool);
+        size_t c = 0;
+        for (; c < chunks && c * threads / chunks == 0; ++c) {} // [0, c)是调用者自己的块
+        const size_t own = c;
+        for (; c < chunks; ++c){
+            const size_t begin = c * grain, end = n - begin > grain ? begin + grain : n;
+            group.run([f, begin, end]() mutable{ f(begin, end); }, c * threads / chunks - 1);
+        }
+        for (c = 0; c < own; ++c)
+            f(c * grain, n - c * grain > grain ? c * grain + grain : n);
+        group.wait();
+    }
+
+    // *************[fill]****************
+    template <class ForwardIterator, class T>
+    inline void __par_fill(ForwardIterator first, ForwardIterator last, const T& value, _false_type){
+        TinySTL::fill(first, last, value);
+    }
+    template <class RandomAccessIterator, class T>
+    void __par_fill(RandomAccessIterator first, RandomAccessIterator last, const T& value, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type V;
+        TinySTL::parallel_for(last - first, __parallel_grain<V>(), [first, &value](size_t b, size_t e){
+            TinySTL::fill(first + b, first + e, value);
+        });
+    }
+    template <class ForwardIterator, class T>
+    inline void fill(const sequenced_policy&, ForwardIterator first, ForwardIterator last, const T& value){
+        TinySTL::fill(first, last, value);
+    }
+    template <class ForwardIterator, class T>
+    inline void fill(const parallel_policy&, ForwardIterator first, ForwardIterator last, const T& value){
+        TinySTL::__par_fill(first, last, value, typename _parallel_traits<ForwardIterator>::is_parallel());
+    }
+
+    // *************[copy]****************
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator __par_copy(InputIterator first, InputIterator last, OutputIterator result, _false_type){
+        return TinySTL::copy(first, last, result);
+    }
+    template <class RandomAccessIterator1, class RandomAccessIterator2>
+    RandomAccessIterator2 __par_copy(RandomAccessIterator1 first, RandomAccessIterator1 last, RandomAccessIterator2 result, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator1>::value_type V;
+        TinySTL::parallel_for(last - first, __parallel_grain<V>(), [first, result](size_t b, size_t e){
+            TinySTL::copy(first + b, first + e, result + b);
+        });
+        return result + (last - first);
+    }
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator copy(const sequenced_policy&, InputIterator first, InputIterator last, OutputIterator result){
+        return TinySTL::copy(first, last, result);
+    }
+    // 两个区间不能重叠
+    template <class InputIterator, class OutputIterator>
+    inline OutputIterator copy(const parallel_policy&, InputIterator first, InputIterator last, OutputIterator result){
+        typedef typename _parallel_traits<InputIterator, OutputIterator>::is_parallel is_parallel;
+        return TinySTL::__par_copy(first, last, result, is_parallel());
+    }
+
+    // *************[uninitialized_copy]、[uninitialized_fill_n]****************
+    /* 每块各自commit or rollback; 某一块抛出异常时, 等所有块结束后再析构已经构造好的那些块, 然后继续抛出
+     * construct_chunk(b, e)构造第[b, e)个元素
+     */
+    template <class ForwardIterator, class Construct>
+    void __par_construct(ForwardIterator result, size_t n, Construct construct_chunk){
+        typedef typename iterator_traits<ForwardIterator>::value_type T;
+        const size_t grain = __parallel_grain<T>();
+        const size_t chunks = (n + grain - 1) / grain;
+        std::unique_ptr<bool[]> done(new bool[chunks + 1]());
+        try{
+            TinySTL::parallel_for(n, grain, [&](size_t b, size_t e){
+                construct_chunk(b, e);
+                done[b / grain] = true;
+            });
+        }
+        catch(...){
+            for (size_t c = 0; c < chunks; ++c)
+                if(done[c])
+                    destory(result + c * grain, result + (n - c * grain > grain ? c * grain + grain : n));
+            throw;
+        }
+    }
+
+    template <class InputIterator, class ForwardIterator>
+    inline ForwardIterator __par_uninitialized_copy(InputIterator first, InputIterator last, ForwardIterator result, _false_type){
+        return TinySTL::uninitialized_copy(first, last, result);
+    }
+    template <class RandomAccessIterator1, class RandomAccessIterator2>
+    RandomAccessIterator2 __par_uninitialized_copy(RandomAccessIterator1 first, RandomAccessIterator1 last,
+                                                   RandomAccessIterator2 result, _true_type){
+        TinySTL::__par_construct(result, last - first, [first, result](size_t b, size_t e){
+            TinySTL::uninitialized_copy(first + b, first + e, result + b);
+        });
+        return result + (last - first);
+    }
+    template <class InputIterator, class ForwardIterator>
+    inline ForwardIterator uninitialized_copy(const sequenced_policy&, InputIterator first, InputIterator last, ForwardIterator result){
+        return TinySTL::uninitialized_copy(first, last, result);
+    }
+    template <class InputIterator, class ForwardIterator>
+    inline ForwardIterator uninitialized_copy(const parallel_policy&, InputIterator first, InputIterator last, ForwardIterator result){
+        typedef typename _parallel_traits<InputIterator, ForwardIterator>::is_parallel is_parallel;
+        return TinySTL::__par_uninitialized_copy(first, last, result, is_parallel());
+    }
+
+    template <class ForwardIterator, class Size, class T>
+    inline ForwardIterator __par_uninitialized_fill_n(ForwardIterator first, Size n, const T& x, _false_type){
+        return TinySTL::uninitialized_fill_n(first, n, x);
+    }
+    template <class RandomAccessIterator, class Size, class T>
+    RandomAccessIterator __par_uninitialized_fill_n(RandomAccessIterator first, Size n, const T& x, _true_type){
+        if(n <= 0)
+            return first;
+        TinySTL::__par_construct(first, (size_t)n, [first, &x](size_t b, size_t e){
+            TinySTL::uninitialized_fill_n(first + b, e - b, x);
+        });
+        return first + n;
+    }
+    template <class ForwardIterator, class Size, class T>
+    inline ForwardIterator uninitialized_fill_n(const sequenced_policy&, ForwardIterator first, Size n, const T& x){
+        return TinySTL::uninitialized_fill_n(first, n, x);
+    }
+    // 由各个线程分别构造(并第一次写入)自己那一段, 见文件开头关于first touch的说明
+    template <class ForwardIterator, class Size, class T>
+    inline ForwardIterator uninitialized_fill_n(const parallel_policy&, ForwardIterator first, Size n, const T& x){
+        return TinySTL::__par_uninitialized_fill_n(first, n, x, typename _parallel_traits<ForwardIterator>::is_parallel());
+    }
+
+    // *************[transform]****************
+    template <class InputIterator, class OutputIterator, class UnaryOperation>
+    inline OutputIterator __par_transform(InputIterator first, InputIterator last, OutputIterator result,
+                                          UnaryOperation op, _false_type){
+        return TinySTL::transform(first, last, result, op);
+    }
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class UnaryOperation>
+    RandomAccessIterator2 __par_transform(RandomAccessIterator1 first, RandomAccessIterator1 last, RandomAccessIterator2 result,
+                                          UnaryOperation op, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator1>::value_type V;
+        TinySTL::parallel_for(last - first, __parallel_grain<V>(), [first, result, &op](size_t b, size_t e){
+            TinySTL::transform(first + b, first + e, result + b, op);
+        });
+        return result + (last - first);
+    }
+    template <class InputIterator, class OutputIterator, class UnaryOperation>
+    inline OutputIterator transform(const sequenced_policy&, InputIterator first, InputIterator last,
+                                    OutputIterator result, UnaryOperation op){
+        return TinySTL::transform(first, last, result, op);
+    }
+    // op会被多个线程同时调用
+    template <class InputIterator, class OutputIterator, class UnaryOperation>
+    inline OutputIterator transform(const parallel_policy&, InputIterator first, InputIterator last,
+                                    OutputIterator result, UnaryOperation op){
+        typedef typename _parallel_traits<InputIterator, OutputIterator>::is_parallel is_parallel;
+        return TinySTL::__par_transform(first, last, result, op, is_parallel());
+    }
+
+    template <class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
+    inline OutputIterator __par_transform(InputIterator1 first1, InputIterator1 last1, InputIterator2 first2,
+                                          OutputIterator result, BinaryOperation op, _false_type){
+        return TinySTL::transform(first1, last1, first2, result, op);
+    }
+    template <class RandomAccessIterator1, class RandomAccessIterator2, class RandomAccessIterator3, class BinaryOperation>
+    RandomAccessIterator3 __par_transform(RandomAccessIterator1 first1, RandomAccessIterator1 last1, RandomAccessIterator2 first2,
+                                          RandomAccessIterator3 result, BinaryOperation op, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator1>::value_type V;
+        TinySTL::parallel_for(last1 - first1, __parallel_grain<V>(), [first1, first2, result, &op](size_t b, size_t e){
+            TinySTL::transform(first1 + b, first1 + e, first2 + b, result + b, op);
+        });
+        return result + (last1 - first1);
+    }
+    template <class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
+    inline OutputIterator transform(const sequenced_policy&, InputIterator1 first1, InputIterator1 last1,
+                                    InputIterator2 first2, OutputIterator result, BinaryOperation op){
+        return TinySTL::transform(first1, last1, first2, result, op);
+    }
+    template <class InputIterator1, class InputIterator2, class OutputIterator, class BinaryOperation>
+    inline OutputIterator transform(const parallel_policy&, InputIterator1 first1, InputIterator1 last1,
+                                    InputIterator2 first2, OutputIterator result, BinaryOperation op){
+        typedef typename _bool_type<
+            std::is_same<typename _parallel_traits<InputIterator1, InputIterator2>::is_parallel, _true_type>::value &&
+            std::is_same<typename _parallel_traits<InputIterator1, OutputIterator>::is_parallel, _true_type>::value>::type is_parallel;
+        return TinySTL::__par_transform(first1, last1, first2, result, op, is_parallel());
+    }
+
+    // *************[reduce]****************
+    // 每块先各自归约, 再按块的顺序把部分结果结合起来; 块的划分只和区间长度有关, 因此同样的输入结果总是相同的
+    template <class RandomAccessIterator, class T, class Reduce, class Combine>
+    T __par_reduce_chunks(RandomAccessIterator first, RandomAccessIterator last, T init, Reduce reduce_chunk, Combine combine){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type V;
+        const size_t n = last - first, grain = __parallel_grain<V>();
+        const size_t chunks = (n + grain - 1) / grain;
+        std::vector<T> partial(chunks, init);
+        TinySTL::parallel_for(n, grain, [&](size_t b, size_t e){
+            partial[b / grain] = reduce_chunk(first + b, first + e);
+        });
+        for (size_t c = 0; c < chunks; ++c)
+            init = combine(init, partial[c]);
+        return init;
+    }
+
+    template <class InputIterator, class T, class BinaryOperation>
+    inline T __par_reduce(InputIterator first, InputIterator last, T init, BinaryOperation op, _false_type){
+        return TinySTL::reduce(first, last, init, op);
+    }
+    template <class RandomAccessIterator, class T, class BinaryOperation>
+    T __par_reduce(RandomAccessIterator first, RandomAccessIterator last, T init, BinaryOperation op, _true_type){
+        // 每块以自己的第一个元素为初值, 不需要op的单位元
+        return TinySTL::__par_reduce_chunks(first, last, init, [&op](RandomAccessIterator b, RandomAccessIterator e){
+            T value = *b;
+            return TinySTL::reduce(b + 1, e, value, op);
+        }, op);
+    }
+    template <class InputIterator, class T>
+    inline T __par_sum(InputIterator first, InputIterator last, T init, _false_type){
+        return TinySTL::reduce(first, last, init);
+    }
+    template <class RandomAccessIterator, class T>
+    T __par_sum(RandomAccessIterator first, RandomAccessIterator last, T init, _true_type){
+        // 每块从T()开始求和, 整数和init型别相同时可以用accumulate的向量化内核
+        return TinySTL::__par_reduce_chunks(first, last, init, [](RandomAccessIterator b, RandomAccessIterator e){
+            return TinySTL::accumulate(b, e, T());
+        }, [](const T& a, const T& b){ return a + b; });
+    }
+
+    template <class InputIterator, class T, class BinaryOperation>
+    inline T reduce(const sequenced_policy&, InputIterator first, InputIterator last, T init, BinaryOperation op){
+        return TinySTL::reduce(first, last, init, op);
+    }
+    template <class InputIterator, class T>
+    inline T reduce(const sequenced_policy&, InputIterator first, InputIterator last, T init){
+        return TinySTL::reduce(first, last, init);
+    }
+    template <class InputIterator>
+    inline typename iterator_traits<InputIterator>::value_type
+    reduce(const sequenced_policy&, InputIterator first, InputIterator last){
+        return TinySTL::reduce(first, last);
+    }
+    // op必须满足结合律和交换律, 并且可以被多个线程同时调用
+    template <class InputIterator, class T, class BinaryOperation>
+    inline T reduce(const parallel_policy&, InputIterator first, InputIterator last, T init, BinaryOperation op){
+        return TinySTL::__par_reduce(first, last, init, op, typename _parallel_traits<InputIterator>::is_parallel());
+    }
+    template <class InputIterator, class T>
+    inline T reduce(const parallel_policy&, InputIterator first, InputIterator last, T init){
+        return TinySTL::__par_sum(first, last, init, typename _parallel_traits<InputIterator>::is_parallel());
+    }
+    template <class InputIterator>
+    inline typename iterator_traits<InputIterator>::value_type
+    reduce(const parallel_policy&, InputIterator first, InputIterator last){
+        typedef typename iterator_traits<InputIterator>::value_type T;
+        return TinySTL::__par_sum(first, last, T(), typename _parallel_traits<InputIterator>::is_parallel());
+    }
+
+    // *************[sort]****************
+    /* 并行的pdqsort: 分割以后左边作为新任务交给线程池, 当前线程继续处理右边, 区间小于一块时用串行的sort
+     * 和串行版本一样处理重复元素、已经有序的区间和不平衡的分割
+     */
+    template <class RandomAccessIterator, class Compare>
+    void __par_sort_loop(RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+                         int bad_allowed, bool leftmost, task_group &group){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        typedef typename iterator_traits<RandomAccessIterator>::difference_type Distance;
+        typedef typename _sort_traits<RandomAccessIterator, Compare>::is_branchless is_branchless;
+        const Distance grain = (Distance)__parallel_grain<T>();
+        while(last - first > grain){
+            const Distance size = last - first;
+            TinySTL::__choose_pivot(first, last, comp);
+            if(!leftmost && !comp(*(first - 1), *first)){
+                first = TinySTL::__partition_left(first, last, comp) + 1;
+                continue;
+            }
+            std::pair<RandomAccessIterator, bool> part = TinySTL::__partition_right(first, last, comp, is_branchless());
+            RandomAccessIterator pivot_pos = part.first;
+            const Distance l_size = pivot_pos - first, r_size = last - (pivot_pos + 1);
+            if(l_size < size / 8 || r_size < size / 8){
+                if(--bad_allowed == 0){
+                    TinySTL::make_heap(first, last, comp);
+                    TinySTL::sort_heap(first, last, comp);
+                    return;
+                }
+                TinySTL::__break_patterns(first, pivot_pos, last);
+            }
+            else if(part.second && TinySTL::__partial_insertion_sort(first, pivot_pos, comp)
+                                && TinySTL::__partial_insertion_sort(pivot_pos + 1, last, comp))
+                return;
+            group.run([first, pivot_pos, comp, bad_allowed, leftmost, &group]{
+                TinySTL::__par_sort_loop(first, pivot_pos, comp, bad_allowed, leftmost, group);
+            });
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+        if(last - first > 1)
+            TinySTL::__pdqsort_loop(first, last, comp, bad_allowed, leftmost, is_branchless());
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void __par_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, _false_type){
+        TinySTL::sort(first, last, comp);
+    }
+    template <class RandomAccessIterator, class Compare>
+    void __par_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, _true_type){
+        if(last - first < 2)
+            return;
+        if(thread_pool::instance().concurrency() == 1){
+            TinySTL::sort(first, last, comp);
+            return;
+        }
+        task_group group;
+        TinySTL::__par_sort_loop(first, last, comp, TinySTL::__lg(last - first), true, group);
+        group.wait();
+    }
+    template <class RandomAccessIterator, class Compare>
+    inline void sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::sort(first, last, comp);
+    }
+    template <class RandomAccessIterator>
+    inline void sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::sort(first, last);
+    }
+    // comp会被多个线程同时调用
+    template <class RandomAccessIterator, class Compare>
+    inline void sort(const parallel_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::__par_sort(first, last, comp, typename _parallel_traits<RandomAccessIterator>::is_parallel());
+    }
+    template <class RandomAccessIterator>
+    inline void sort(const parallel_policy&, RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::__par_sort(first, last, _less(), typename _parallel_traits<RandomAccessIterator>::is_parallel());
+    }
+
+    // *************[stable_sort]****************
+    /* 并行的归并排序: 两半分别交给线程池排好, 再并行归并
+     * 归并时把较长一段的中点在另一段里二分查找, 切成互不相关的两个子归并, 直到小于一块;
+     * 左段的元素和右段相等时总在前面, 因此是稳定的
+     */
+    template <class T, class RandomAccessIterator, class Compare>
+    void __par_merge(T *first1, T *last1, T *first2, T *last2, RandomAccessIterator result, Compare comp){
+        const ptrdiff_t len1 = last1 - first1, len2 = last2 - first2;
+        if(len1 + len2 <= (ptrdiff_t)__parallel_grain<T>() || len1 == 0 || len2 == 0){
+            TinySTL::__move_merge(first1, last1, first2, last2, result, comp);
+            return;
+        }
+        T *mid1, *mid2;
+        if(len1 >= len2){
+            // 右段中严格小于*mid1的元素排在它前面
+            mid1 = first1 + len1 / 2;
+            T *lo = first2, *hi = last2;
+            while(lo < hi){
+                T *mid = lo + (hi - lo) / 2;
+                if(comp(*mid, *mid1))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            mid2 = lo;
+        }
+        else{
+            // 左段中不大于*mid2的元素排在它前面
+            mid2 = first2 + len2 / 2;
+            T *lo = first1, *hi = last1;
+            while(lo < hi){
+                T *mid = lo + (hi - lo) / 2;
+                if(comp(*mid2, *mid))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            mid1 = lo;
+        }
+        RandomAccessIterator mid_result = result + ((mid1 - first1) + (mid2 - first2));
+        task_group group;
+        group.run([first1, mid1, first2, mid2, result, comp]{
+            TinySTL::__par_merge(first1, mid1, first2, mid2, result, comp);
+        });
+        TinySTL::__par_merge(mid1, last1, mid2, last2, mid_result, comp);
+        group.wait();
+    }
+
+    // buffer和[first, last)一样长, 排好的结果留在原区间
+    template <class RandomAccessIterator, class T, class Compare>
+    void __par_merge_sort(RandomAccessIterator first, RandomAccessIterator last, T *buffer, Compare comp){
+        const ptrdiff_t len = last - first;
+        if(len <= (ptrdiff_t)__parallel_grain<T>()){
+            TinySTL::__merge_sort_with_buffer(first, last, buffer, comp);
+            return;
+        }
+        const ptrdiff_t half = len / 2;
+        RandomAccessIterator middle = first + half;
+        {
+            task_group group;
+            group.run([first, middle, buffer, comp]{
+                TinySTL::__par_merge_sort(first, middle, buffer, comp);
+            });
+            TinySTL::__par_merge_sort(middle, last, buffer + half, comp);
+            group.wait();
+        }
+        if(!comp(*middle, *(middle - 1))) // 两半首尾相接, 已经有序
+            return;
+        TinySTL::move(first, last, buffer);
+        TinySTL::__par_merge(buffer, buffer + half, buffer + half, buffer + len, first, comp);
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    inline void __par_stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, _false_type){
+        TinySTL::stable_sort(first, last, comp);
+    }
+    template <class RandomAccessIterator, class Compare>
+    void __par_stable_sort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, _true_type){
+        typedef typename iterator_traits<RandomAccessIterator>::value_type T;
+        if(thread_pool::instance().concurrency() == 1 || last - first <= (ptrdiff_t)__parallel_grain<T>()){
+            TinySTL::stable_sort(first, last, comp);
+            return;
+        }
+        _temporary_buffer<T> buffer(first, last - first);
+        TinySTL::__par_merge_sort(first, last, buffer.begin(), comp);
+    }
+    template <class RandomAccessIterator, class Compare>
+    inline void stable_sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::stable_sort(first, last, comp);
+    }
+    template <class RandomAccessIterator>
+    inline void stable_sort(const sequenced_policy&, RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::stable_sort(first, last);
+    }
+    // comp会被多个线程同时调用; 需要和区间一样大的临时缓冲区
+    template <class RandomAccessIterator, class Compare>
+    inline void stable_sort(const parallel_policy&, RandomAccessIterator first, RandomAccessIterator last, Compare comp){
+        TinySTL::__par_stable_sort(first, last, comp, typename _parallel_traits<RandomAccessIterator>::is_parallel());
+    }
+    template <class RandomAccessIterator>
+    inline void stable_sort(const parallel_policy&, RandomAccessIterator first, RandomAccessIterator last){
+        TinySTL::__par_stable_sort(first, last, _less(), typename _parallel_traits<RandomAccessIterator>::is_parallel());
+    }
+
+    // *************[list::sort]****************
+    // 缓冲区上并行的稳定排序
+    struct __list_parallel_sorter{
+        template <class E, class Compare>
+        bool operator()(__list_sort_buffer<E> &buffer, Compare &comp) const{
+            TinySTL::stable_sort(par, buffer.begin(), buffer.end(), comp);
+            return true;
+        }
+    };
+    // 和list::sort(comp)一样先收集到连续的缓冲区里, 只是缓冲区上的排序交给线程池; 只有一个线程时就是list::sort(comp)
+    template <class T, class Alloc, class Compare>
+    void sort(const parallel_policy&, list<T, Alloc> &l, Compare comp){
+        if(thread_pool::instance().concurrency() == 1){
+            l.sort(comp);
+            return;
+        }
+        __list_sort_values<T>(l.end().node, comp, __list_parallel_sorter(), typename _list_sort_traits<T>::by_key());
+    }
+    template <class T, class Alloc>
+    inline void sort(const parallel_policy&, list<T, Alloc> &l){
+        TinySTL::sort(par, l, _less());
+    }
+    template <class T, class Alloc, class Compare>
+    inline void sort(const sequenced_policy&, list<T, Alloc> &l, Compare comp){
+        l.sort(comp);
+    }
+    template <class T, class Alloc>
+    inline void sort(const sequenced_policy&, list<T, Alloc> &l){
+        l.sort();
+    }
+}
+
+#endif
@@ -0,0 +1,574 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+/* 算法的SIMD内核
+ * 在x86上同时编译SSE2和AVX2两个版本, 第一次调用时用cpuid检测CPU支持哪个, 之后直接使用检测结果(运行期分派)
+ * 其他平台或编译器上退化成普通的循环, 交给编译器自动向量化
+ * 定义TINYSTL_NO_SIMD可以关闭所有手写的向量化版本
+ */
+
+#if !defined(TINYSTL_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__SSE2__))
+    #define __TINYSTL_SIMD_X86
+    #include <immintrin.h>
+    #define __TINYSTL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace TinySTL{
+namespace simd{
+    // 超过这个字节数的填充使用non-temporal store, 绕过cache直接写内存, 大块初始化时能跑满内存带宽
+    enum {STREAM_THRESHOLD = 4 * 1024 * 1024};
+
+    // 把大小为sizeof(U)的值重复到64位里, 例如0x1234 -> 0x1234123412341234
+    template <class U>
+    inline uint64_t broadcast_pattern(U bits){
+        uint64_t x = (uint64_t)bits;
+        for (size_t width = sizeof(U) * 8; width < 64; width *= 2)
+            x |= x << width;
+        return x;
+    }
+
+    // 如果64位的重复模式每个字节都相同(例如0, -1, 0x0101...), 可以直接交给memset
+    inline bool is_byte_pattern(uint64_t pattern){
+        return pattern == (pattern & 0xff) * 0x0101010101010101ull;
+    }
+
+    // 通用版本: 64位一组地写, 不足8字节的尾部逐个元素写
+    // 元素的对齐可能小于它的大小(例如两个int组成的结构体), 因此都用memcpy写, 编译器会把它变成一条mov
+    template <class U>
+    inline void fill_portable(U *dst, U bits, size_t n){
+        uint64_t pattern = broadcast_pattern(bits);
+        char *p = (char *)dst;
+        char *end = p + n * sizeof(U);
+        for (; p + 8 <= end; p += 8)
+            memcpy(p, &pattern, 8);
+        for (; p < end; p += sizeof(U))
+            memcpy(p, &bits, sizeof(U));
+    }
+
+#ifdef __TINYSTL_SIMD_X86
+    // SSE2是x86-64的基本指令集(32位下要求编译时打开了SSE2), 不需要检测
+    template <class U>
+    inline void fill_sse2(U *dst, U bits, size_t n){
+        char *p = (char *)dst;
+        char *end = p + n * sizeof(U);
+        uint64_t pattern = broadcast_pattern(bits);
+        __m128i v = _mm_set1_epi64x((long long)pattern);
+        // 先写一个不对齐的16字节, 然后从下一个16字节边界开始对齐地写; 重叠部分写的是同样的内容
+        if(end - p >= 16){
+            _mm_storeu_si128((__m128i *)p, v);
+            char *q = (char *)(((size_t)p + 16) & ~(size_t)15);
+            // q相对p的偏移不一定是sizeof(U)的倍数, 需要把模式转到对应的相位
+            size_t shift = (size_t)(q - p) % sizeof(U);
+            if(shift != 0){
+                uint64_t rotated = (pattern >> (shift * 8)) | (pattern << (64 - shift * 8));
+                v = _mm_set1_epi64x((long long)rotated);
+            }
+            const bool stream = (size_t)(end - p) >= (size_t)STREAM_THRESHOLD;
+            for (; q + 64 <= end; q += 64){
+                if(stream){
+                    _mm_stream_si128((__m128i *)q, v);
+                    _mm_stream_si128((__m128i *)(q + 16), v);
+                    _mm_stream_si128((__m128i *)(q + 32), v);
+                    _mm_stream_si128((__m128i *)(q + 48), v);
+                }
+                else{
+                    _mm_store_si128((__m128i *)q, v);
+                    _mm_store_si128((__m128i *)(q + 16), v);
+                    _mm_store_si128((__m128i *)(q + 32), v);
+                    _mm_store_si128((__m128i *)(q + 48), v);
+                }
+            }
+            if(stream)
+                _mm_sfence();
+            for (; q + 16 <= end; q += 16)
+                _mm_store_si128((__m128i *)q, v);
+            // 剩下不足16字节, 以元素为单位写完
+            p = q - (size_t)(q - (char *)dst) % sizeof(U);
+        }
+        for (; p < end; p += sizeof(U))
+            memcpy(p, &bits, sizeof(U));
+    }
+
+    template <class U>
+    __TINYSTL_TARGET_AVX2 inline void fill_avx2(U *dst, U bits, size_t n){
+        char *p = (char *)dst;
+        char *end = p + n * sizeof(U);
+        uint64_t pattern = broadcast_pattern(bits);
+        if(end - p >= 32){
+            __m256i v = _mm256_set1_epi64x((long long)pattern);
+            _mm256_storeu_si256((__m256i *)p, v);
+            char *q = (char *)(((size_t)p + 32) & ~(size_t)31);
+            size_t shift = (size_t)(q - p) % sizeof(U);
+            if(shift != 0){
+                uint64_t rotated = (pattern >> (shift * 8)) | (pattern << (64 - shift * 8));
+                v = _mm256_set1_epi64x((long long)rotated);
+            }
+            const bool stream = (size_t)(end - p) >= (size_t)STREAM_THRESHOLD;
+            for (; q + 128 <= end; q += 128){
+                if(stream){
+                    _mm256_stream_si256((__m256i *)q, v);
+                    _mm256_stream_si256((__m256i *)(q + 32), v);
+                    _mm256_stream_si256((__m256i *)(q + 64), v);
+                    _mm256_stream_si256((__m256i *)(q + 96), v);
+                }
+                else{
+                    _mm256_store_si256((__m256i *)q, v);
+                    _mm256_store_si256((__m256i *)(q + 32), v);
+                    _mm256_store_si256((__m256i *)(q + 64), v);
+                    _mm256_store_si256((__m256i *)(q + 96), v);
+                }
+            }
+            if(stream)
+                _mm_sfence();
+            for (; q + 32 <= end; q += 32)
+                _mm256_store_si256((__m256i *)q, v);
+            p = q - (size_t)(q - (char *)dst) % sizeof(U);
+        }
+        for (; p < end; p += sizeof(U))
+            memcpy(p, &bits, sizeof(U));
+    }
+
+    // 运行期检测CPU是否支持AVX2, 函数内的静态变量只初始化一次
+    inline bool has_avx2(){
+        static const bool result = __builtin_cpu_supports("avx2");
+        return result;
+    }
+#endif
+
+    // 把[dst, dst + n)填满bits, U是1/2/4/8字节的无符号整数
+    template <class U>
+    inline void fill(U *dst, U bits, size_t n){
+        if(n == 0)
+            return;
+        // 每个字节都相同的模式(最常见的是0)交给memset, 它本身就是高度优化过的
+        if(sizeof(U) == 1 || is_byte_pattern(broadcast_pattern(bits))){
+            memset(dst, (int)(bits & 0xff), n * sizeof(U));
+            return;
+        }
+#ifdef __TINYSTL_SIMD_X86
+        if(has_avx2())
+            fill_avx2(dst, bits, n);
+        else
+            fill_sse2(dst, bits, n);
+#else
+        fill_portable(dst, bits, n);
+#endif
+    }
+
+    // 按元素大小选择对应宽度的无符号整数
+    template <size_t Size> struct uint_of_size {};
+    template <> struct uint_of_size<1> { typedef uint8_t type; };
+    template <> struct uint_of_size<2> { typedef uint16_t type; };
+    template <> struct uint_of_size<4> { typedef uint32_t type; };
+    template <> struct uint_of_size<8> { typedef uint64_t type; };
+
+    // 把value按字节重新解释成同样大小的无符号整数, 再填充到[first, first + n)
+    template <class T>
+    inline void fill_value(T *first, const T &value, size_t n){
+        typedef typename uint_of_size<sizeof(T)>::type U;
+        U bits;
+        memcpy(&bits, &value, sizeof(T));
+        fill((U *)first, bits, n);
+    }
+
+    // ***************** 查找和归约 ***********************
+    // 以下内核只接受指向算术型别的连续区间, 整数按大小和有无符号归到intN_t/uintN_t, 浮点数保持原样
+    template <size_t Size, bool Signed> struct int_of_size {};
+    template <> struct int_of_size<1, true> { typedef int8_t type; };
+    template <> struct int_of_size<1, false> { typedef uint8_t type; };
+    template <> struct int_of_size<2, true> { typedef int16_t type; };
+    template <> struct int_of_size<2, false> { typedef uint16_t type; };
+    template <> struct int_of_size<4, true> { typedef int32_t type; };
+    template <> struct int_of_size<4, false> { typedef uint32_t type; };
+    template <> struct int_of_size<8, true> { typedef int64_t type; };
+    template <> struct int_of_size<8, false> { typedef uint64_t type; };
+
+    template <class T, bool = std::is_integral<T>::value>
+    struct canonical{
+        typedef T type;
+    };
+    template <class T>
+    struct canonical<T, true>{
+        typedef typename int_of_size<sizeof(T), std::is_signed<T>::value>::type type;
+    };
+
+    // 有查找和归约内核的元素型别: 1、2、4、8字节的整数以及float、double(long double等其他算术型别没有)
+    template <class T>
+    struct has_kernel{
+        enum {value = (std::is_integral<T>::value &&
+                       (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+                      std::is_same<T, float>::value || std::is_same<T, double>::value};
+    };
+
+    // min/max按块计算, 每块的元素个数, 最后只需要在一个块里重新找位置
+    enum {REDUCE_BLOCK = 1024};
+
+#ifdef __TINYSTL_SIMD_X86
+    /* 每种元素型别的AVX2操作
+     * eq_mask/nan_mask返回movemask的结果, 每个元素占mask_bits位
+     * 只有has_minmax为true的型别才提供min/max, 只有has_add为true的型别才提供add(64位整数没有AVX2的min/max指令)
+     */
+    template <class C> struct avx2_ops {};
+
+    template <class C>
+    struct avx2_int_ops{
+        typedef __m256i vec;
+        enum {lanes = 32 / sizeof(C), mask_bits = sizeof(C)};
+        static __TINYSTL_TARGET_AVX2 vec load(const void *p) { return _mm256_loadu_si256((const __m256i *)p); }
+        static __TINYSTL_TARGET_AVX2 unsigned nan_mask(vec) { return 0; }
+    };
+
+#define __TINYSTL_AVX2_INT_OPS(C, BITS, SET1, MIN, MAX, HAS_MINMAX) \
+    template <> \
+    struct avx2_ops<C> : avx2_int_ops<C>{ \
+        enum {has_minmax = HAS_MINMAX, has_add = 1}; \
+        static __TINYSTL_TARGET_AVX2 vec set1(C x) { return SET1; } \
+        static __TINYSTL_TARGET_AVX2 unsigned eq_mask(vec a, vec b) { return (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi##BITS(a, b)); } \
+        static __TINYSTL_TARGET_AVX2 vec add(vec a, vec b) { return _mm256_add_epi##BITS(a, b); } \
+        static __TINYSTL_TARGET_AVX2 vec min(vec a, vec b) { (void)a; (void)b; return MIN; } \
+        static __TINYSTL_TARGET_AVX2 vec max(vec a, vec b) { (void)a; (void)b; return MAX; } \
+    };
+
+    __TINYSTL_AVX2_INT_OPS(int8_t, 8, _mm256_set1_epi8((char)x), _mm256_min_epi8(a, b), _mm256_max_epi8(a, b), 1)
+    __TINYSTL_AVX2_INT_OPS(uint8_t, 8, _mm256_set1_epi8((char)x), _mm256_min_epu8(a, b), _mm256_max_epu8(a, b), 1)
+    __TINYSTL_AVX2_INT_OPS(int16_t, 16, _mm256_set1_epi16((short)x), _mm256_min_epi16(a, b), _mm256_max_epi16(a, b), 1)
+    __TINYSTL_AVX2_INT_OPS(uint16_t, 16, _mm256_set1_epi16((short)x), _mm256_min_epu16(a, b), _mm256_max_epu16(a, b), 1)
+    __TINYSTL_AVX2_INT_OPS(int32_t, 32, _mm256_set1_epi32((int)x), _mm256_min_epi32(a, b), _mm256_max_epi32(a, b), 1)
+    __TINYSTL_AVX2_INT_OPS(uint32_t, 32, _mm256_set1_epi32((int)x), _mm256_min_epu32(a, b), _mm256_max_epu32(a, b), 1)
+    // 有符号64位整数用比较+混合实现min/max, 无符号64位整数没有比较指令, 不提供
+    __TINYSTL_AVX2_INT_OPS(int64_t, 64, _mm256_set1_epi64x((long long)x), _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)),
+                           _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a)), 1)
+    __TINYSTL_AVX2_INT_OPS(uint64_t, 64, _mm256_set1_epi64x((long long)x), a, b, 0)
+#undef __TINYSTL_AVX2_INT_OPS
+
+    // 浮点数按值比较: NaN不等于任何数, -0.0等于+0.0
+    template <>
+    struct avx2_ops<float>{
+        typedef __m256 vec;
+        enum {lanes = 8, mask_bits = 1, has_minmax = 1, has_add = 0};
+        static __TINYSTL_TARGET_AVX2 vec load(const void *p) { return _mm256_loadu_ps((const float *)p); }
+        static __TINYSTL_TARGET_AVX2 vec set1(float x) { return _mm256_set1_ps(x); }
+        static __TINYSTL_TARGET_AVX2 unsigned eq_mask(vec a, vec b) { return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+        static __TINYSTL_TARGET_AVX2 unsigned nan_mask(vec a) { return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, a, _CMP_UNORD_Q)); }
+        static __TINYSTL_TARGET_AVX2 vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+        static __TINYSTL_TARGET_AVX2 vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+        static __TINYSTL_TARGET_AVX2 vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+    };
+    template <>
+    struct avx2_ops<double>{
+        typedef __m256d vec;
+        enum {lanes = 4, mask_bits = 1, has_minmax = 1, has_add = 0};
+        static __TINYSTL_TARGET_AVX2 vec load(const void *p) { return _mm256_loadu_pd((const double *)p); }
+        static __TINYSTL_TARGET_AVX2 vec set1(double x) { return _mm256_set1_pd(x); }
+        static __TINYSTL_TARGET_AVX2 unsigned eq_mask(vec a, vec b) { return (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+        static __TINYSTL_TARGET_AVX2 unsigned nan_mask(vec a) { return (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(a, a, _CMP_UNORD_Q)); }
+        static __TINYSTL_TARGET_AVX2 vec min(vec a, vec b) { return _mm256_min_pd(a, b); }
+        static __TINYSTL_TARGET_AVX2 vec max(vec a, vec b) { return _mm256_max_pd(a, b); }
+        static __TINYSTL_TARGET_AVX2 vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+    };
+
+    // 每次处理4个向量(128字节), 4个比较结果合并后只判断一次
+    template <class T>
+    __TINYSTL_TARGET_AVX2 const T *find_avx2(const T *first, const T *last, T value){
+        typedef typename canonical<T>::type C;
+        typedef avx2_ops<C> ops;
+        const ptrdiff_t lanes = ops::lanes;
+        typename ops::vec v = ops::set1((C)value);
+        for (; last - first >= 4 * lanes; first += 4 * lanes){
+            unsigned m0 = ops::eq_mask(ops::load(first), v);
+            unsigned m1 = ops::eq_mask(ops::load(first + lanes), v);
+            unsigned m2 = ops::eq_mask(ops::load(first + 2 * lanes), v);
+            unsigned m3 = ops::eq_mask(ops::load(first + 3 * lanes), v);
+            if((m0 | m1 | m2 | m3) != 0){
+                if(m0 != 0) return first + __builtin_ctz(m0) / ops::mask_bits;
+                if(m1 != 0) return first + lanes + __builtin_ctz(m1) / ops::mask_bits;
+                if(m2 != 0) return first + 2 * lanes + __builtin_ctz(m2) / ops::mask_bits;
+                return first + 3 * lanes + __builtin_ctz(m3) / ops::mask_bits;
+            }
+        }
+        for (; last - first >= lanes; first += lanes){
+            unsigned m = ops::eq_mask(ops::load(first), v);
+            if(m != 0)
+                return first + __builtin_ctz(m) / ops::mask_bits;
+        }
+        for (; first != last; ++first)
+            if(*first == value)
+                return first;
+        return last;
+    }
+
+    template <class T>
+    __TINYSTL_TARGET_AVX2 size_t count_avx2(const T *first, const T *last, T value){
+        typedef typename canonical<T>::type C;
+        typedef avx2_ops<C> ops;
+        const ptrdiff_t lanes = ops::lanes;
+        typename ops::vec v = ops::set1((C)value);
+        size_t bits = 0;
+        for (; last - first >= 2 * lanes; first += 2 * lanes){
+            bits += __builtin_popcount(ops::eq_mask(ops::load(first), v));
+            bits += __builtin_popcount(ops::eq_mask(ops::load(first + lanes), v));
+        }
+        for (; last - first >= lanes; first += lanes)
+            bits += __builtin_popcount(ops::eq_mask(ops::load(first), v));
+        size_t n = bits / ops::mask_bits;
+        for (; first != last; ++first)
+            if(*first == value)
+                ++n;
+        return n;
+    }
+
+    // 求[first, last)中的最小值和最大值, 区间不能为空. 浮点数中有NaN时返回false
+    template <class T>
+    __TINYSTL_TARGET_AVX2 bool block_minmax_avx2(const T *first, const T *last, T &lo, T &hi){
+        typedef typename canonical<T>::type C;
+        typedef avx2_ops<C> ops;
+        const ptrdiff_t lanes = ops::lanes;
+        C mn = (C)*first, mx = (C)*first;
+        if(last - first >= lanes){
+            typename ops::vec vmin = ops::load(first), vmax = vmin;
+            unsigned nan = ops::nan_mask(vmin);
+            const T *p = first + lanes;
+            for (; last - p >= lanes; p += lanes){
+                typename ops::vec x = ops::load(p);
+                nan |= ops::nan_mask(x);
+                vmin = ops::min(vmin, x);
+                vmax = ops::max(vmax, x);
+            }
+            // 最后不足一个向量的部分, 重新读取最后lanes个元素, 重复计算不影响结果
+            if(p != last){
+                typename ops::vec x = ops::load(last - lanes);
+                nan |= ops::nan_mask(x);
+                vmin = ops::min(vmin, x);
+                vmax = ops::max(vmax, x);
+            }
+            if(nan != 0)
+                return false;
+            C a[ops::lanes], b[ops::lanes];
+            memcpy(a, &vmin, sizeof(a));
+            memcpy(b, &vmax, sizeof(b));
+            mn = a[0], mx = b[0];
+            for (int i = 1; i < ops::lanes; ++i){
+                if(a[i] < mn) mn = a[i];
+                if(mx < b[i]) mx = b[i];
+            }
+        }
+        else{
+            for (const T *p = first; p != last; ++p){
+                C x = (C)*p;
+                if(x != x)
+                    return false;
+                if(x < mn) mn = x;
+                if(mx < x) mx = x;
+            }
+        }
+        lo = (T)mn;
+        hi = (T)mx;
+        return true;
+    }
+
+    // 整数的和, 按元素型别的宽度回绕(和逐个相加的结果相同)
+    template <class T>
+    __TINYSTL_TARGET_AVX2 T sum_avx2(const T *first, const T *last){
+        typedef typename canonical<T>::type C;
+        typedef typename std::make_unsigned<C>::type U;
+        typedef avx2_ops<C> ops;
+        const ptrdiff_t lanes = ops::lanes;
+        typename ops::vec s0 = ops::set1(0), s1 = s0;
+        for (; last - first >= 2 * lanes; first += 2 * lanes){
+            s0 = ops::add(s0, ops::load(first));
+            s1 = ops::add(s1, ops::load(first + lanes));
+        }
+        for (; last - first >= lanes; first += lanes)
+            s0 = ops::add(s0, ops::load(first));
+        s0 = ops::add(s0, s1);
+        U a[ops::lanes];
+        memcpy(a, &s0, sizeof(a));
+        U sum = 0;
+        for (int i = 0; i < ops::lanes; ++i)
+            sum += a[i];
+        for (; first != last; ++first)
+            sum += (U)*first;
+        return (T)sum;
+    }
+
+    // 浮点数按值逐个比较, 返回两个区间是否相等
+    template <class T>
+    __TINYSTL_TARGET_AVX2 bool equal_avx2(const T *first1, const T *last1, const T *first2){
+        typedef avx2_ops<typename canonical<T>::type> ops;
+        const ptrdiff_t lanes = ops::lanes;
+        const unsigned all = ops::lanes * ops::mask_bits == 32 ? ~0u : (1u << (ops::lanes * ops::mask_bits)) - 1;
+        for (; last1 - first1 >= lanes; first1 += lanes, first2 += lanes)
+            if(ops::eq_mask(ops::load(first1), ops::load(first2)) != all)
+                return false;
+        for (; first1 != last1; ++first1, ++first2)
+            if(!(*first1 == *first2))
+                return false;
+        return true;
+    }
+#endif
+
+    // 以下是对外的接口, 运行期选择AVX2内核或普通循环
+    template <class T>
+    inline const T *find(const T *first, const T *last, T value){
+#ifdef __TINYSTL_SIMD_X86
+        if(has_avx2())
+            return find_avx2(first, last, value);
+#endif
+        for (; first != last; ++first)
+            if(*first == value)
+                return first;
+        return last;
+    }
+
+    template <class T>
+    inline size_t count(const T *first, const T *last, T value){
+#ifdef __TINYSTL_SIMD_X86
+        if(has_avx2())
+            return count_avx2(first, last, value);
+#endif
+        size_t n = 0;
+        for (; first != last; ++first)
+            n += (*first == value);
+        return n;
+    }
+
+    // 是否有向量化的min/max内核
+    template <class T, bool = has_kernel<T>::value>
+    struct has_minmax_kernel{
+        enum {value = 0};
+    };
+#ifdef __TINYSTL_SIMD_X86
+    template <class T>
+    struct has_minmax_kernel<T, true>{
+        enum {value = avx2_ops<typename canonical<T>::type>::has_minmax};
+    };
+#endif
+
+    // 按块求最小值和最大值, 再回到最小值第一次出现的块和最大值第一次(last_max为true时是最后一次)出现的块里找位置
+    // 返回值first为第一个最小元素, second为最大元素; 遇到NaN返回(0, 0), 由调用者改用逐个比较的版本
+    template <class T>
+    std::pair<const T *, const T *> minmax_positions(const T *first, const T *last, bool want_min, bool want_max, bool last_max){
+        std::pair<const T *, const T *> result(0, 0);
+#ifdef __TINYSTL_SIMD_X86
+        if(!has_avx2() || first == last)
+            return result;
+        T best_min = *first, best_max = *first;
+        const T *min_block = first, *max_block = first;
+        for (const T *b = first; b != last; ){
+            const T *e = last - b > REDUCE_BLOCK ? b + REDUCE_BLOCK : last;
+            T lo, hi;
+            if(!block_minmax_avx2(b, e, lo, hi))
+                return result;
+            if(lo < best_min){ best_min = lo; min_block = b; }
+            if(last_max ? !(hi < best_max) : best_max < hi){ best_max = hi; max_block = b; }
+            b = e;
+        }
+        if(want_min)
+            result.first = find_avx2(min_block, last, best_min);
+        if(want_max && !last_max)
+            result.second = find_avx2(max_block, last, best_max);
+        if(want_max && last_max){
+            const T *e = last - max_block > REDUCE_BLOCK ? max_block + REDUCE_BLOCK : last;
+            while(!(*--e == best_max)) {}
+            result.second = e;
+        }
+#else
+        (void)first; (void)last; (void)want_min; (void)want_max; (void)last_max;
+#endif
+        return result;
+    }
+
+    // 整数求和是否有向量化内核
+    template <class T, bool = std::is_integral<T>::value && has_kernel<T>::value>
+    struct has_sum_kernel{
+        enum {value = 0};
+    };
+#ifdef __TINYSTL_SIMD_X86
+    template <class T>
+    struct has_sum_kernel<T, true>{
+        enum {value = avx2_ops<typename canonical<T>::type>::has_add};
+    };
+#endif
+
+    template <class T>
+    inline T sum(const T *first, const T *last){
+#ifdef __TINYSTL_SIMD_X86
+        if(has_avx2())
+            return sum_avx2(first, last);
+#endif
+        typedef typename std::make_unsigned<typename canonical<T>::type>::type U;
+        U s = 0;
+        for (; first != last; ++first)
+            s += (U)*first;
+        return (T)s;
+    }
+
+    // 两个区间逐个元素比较是否相等; 整数和指针按字节相等就是按值相等, 直接交给memcmp
+    template <class T>
+    inline bool equal(const T *first1, const T *last1, const T *first2){
+        if(!std::is_floating_point<T>::value)
+            return memcmp(first1, first2, (last1 - first1) * sizeof(T)) == 0;
+#ifdef __TINYSTL_SIMD_X86
+        if(has_avx2())
+            return equal_avx2(first1, last1, first2);
+#endif
+        for (; first1 != last1; ++first1, ++first2)
+            if(!(*first1 == *first2))
+                return false;
+        return true;
+    }
+
+    // ***************** 哈希表的控制字节组 *****************
+    // flat_hashtable每GROUP_WIDTH个控制字节为一组, 一次比较一整组, 返回的掩码第i位表示第i个字节满足条件
+    // SSE2是x86-64的基本指令集, 不需要运行期检测; 其他平台逐个字节比较
+    enum {GROUP_WIDTH = 16};
+
+    // 等于h的字节
+    inline uint32_t group_match(const int8_t *group, int8_t h){
+#ifdef __TINYSTL_SIMD_X86
+        const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h)));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < GROUP_WIDTH; ++i)
+            mask |= (uint32_t)(group[i] == h) << i;
+        return mask;
+#endif
+    }
+
+    // 小于h的字节
+    inline uint32_t group_match_less(const int8_t *group, int8_t h){
+#ifdef __TINYSTL_SIMD_X86
+        const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(h), ctrl));
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < GROUP_WIDTH; ++i)
+            mask |= (uint32_t)(group[i] < h) << i;
+        return mask;
+#endif
+    }
+
+    // 掩码中最低的置位是第几位, mask不能为0
+    inline unsigned lowest_bit(uint32_t mask){
+#if defined(__GNUC__) || defined(__clang__)
+        return (unsigned)__builtin_ctz(mask);
+#else
+        unsigned n = 0;
+        while(!(mask & 1)){
+            mask >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+}
+}
+
+#endif
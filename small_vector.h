@@ -0,0 +1,294 @@
+#ifndef _SMALL_VECTOR_H_
+#define _SMALL_VECTOR_H_
+
+#include <cstring>
+#include <utility>
+#include "allocator.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+
+/* 带有内联缓冲区的vector
+ * 前N个元素直接存放在对象内部的缓冲区里, 超过N个才向配置器申请空间(之后按两倍扩容, 和vector相同)
+ * 大多数只有几个元素、用完就丢弃的vector因此完全不需要申请内存
+ * 接口和vector相同; 注意元素在内联缓冲区里时, 移动和swap要逐个移动元素, 迭代器也会随之失效
+ */
+
+namespace TinySTL{
+    template<class T, size_t N, class Alloc = allocator<T>>
+    class small_vector : protected Alloc{
+        static_assert(N > 0, "small_vector needs at least one inline element");
+    public:
+        typedef T           value_type;
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+        typedef T*          pointer;
+        typedef T&          reference;
+        typedef const T&    const_reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+        typedef Alloc       allocator_type;
+    protected:
+        iterator start; // 表示目前使用的空间的头, 指向buffer或者配置器申请的空间
+        iterator finish; // 表示目前使用的空间的尾
+        iterator end_of_storage; // 表示目前可用的空间的尾
+        alignas(T) unsigned char buffer[N * sizeof(T)]; // 内联缓冲区, 只是一块未初始化的内存
+        typedef Alloc data_alloctor;
+
+        iterator inline_storage() { return reinterpret_cast<iterator>(buffer); }
+        void reset_to_inline(){
+            start = finish = inline_storage();
+            end_of_storage = start + N;
+        }
+        void deallocate(){
+            if(!is_inline())
+                data_alloctor::deallocate(start, end_of_storage - start);
+        }
+
+        // 把[first, last)搬到未初始化的空间result, 并结束原来的元素
+        // 可平凡搬移的型别直接按字节复制
+        static void relocate(iterator first, iterator last, iterator result, _true_type){
+            if(first != last)
+                memcpy((void *)result, (const void *)first, (last - first) * sizeof(T));
+        }
+        // 其他型别逐个移动(移动构造可能抛出异常时复制), 成功后再析构原来的元素
+        static void relocate(iterator first, iterator last, iterator result, _false_type){
+            TinySTL::uninitialized_move_if_noexcept(first, last, result);
+            destory(first, last);
+        }
+
+        // 把容量扩大到至少min_capacity(一般是原来的两倍), 元素搬到配置器申请的新空间, 返回新的finish
+        iterator grow(size_type min_capacity){
+            typedef typename _type_traits<T>::is_relocatable_type is_relocatable;
+            size_type len = 2 * capacity();
+            if(len < min_capacity)
+                len = min_capacity;
+            iterator new_start = data_alloctor::allocate(len);
+            const size_type old_size = size();
+            try{
+                relocate(start, finish, new_start, is_relocatable());
+            }
+            catch(...){
+                data_alloctor::deallocate(new_start, len);
+                throw;
+            }
+            deallocate();
+            start = new_start;
+            finish = new_start + old_size;
+            end_of_storage = new_start + len;
+            return finish;
+        }
+    public:
+        iterator begin() { return start; }
+        iterator end() { return finish; }
+        const_iterator begin() const { return start; }
+        const_iterator end() const { return finish; }
+        pointer data() { return start; }
+        size_type size() const { return size_type(finish - start); }
+        size_type capacity() const { return size_type(end_of_storage - start); }
+        bool empty() const { return start == finish; }
+        // 元素是否还在内联缓冲区里
+        bool is_inline() const { return start == reinterpret_cast<const T *>(buffer); }
+        reference operator[](size_type n) { return *(begin() + n); }
+        const_reference operator[](size_type n) const { return *(begin() + n); }
+        reference front() { return *start; }
+        reference back() { return *(finish - 1); }
+
+        small_vector() { reset_to_inline(); }
+        explicit small_vector(const Alloc &alloc) : Alloc(alloc) { reset_to_inline(); }
+        small_vector(size_type n, const T &value, const Alloc &alloc = Alloc()) : Alloc(alloc){
+            reset_to_inline();
+            fill_initialize(n, value);
+        }
+        explicit small_vector(size_type n, const Alloc &alloc = Alloc()) : Alloc(alloc){
+            reset_to_inline();
+            fill_initialize(n, T());
+        }
+        small_vector(const small_vector &x) : Alloc(x.get_allocator()){
+            reset_to_inline();
+            if(x.size() > N)
+                grow(x.size());
+            try{
+                finish = TinySTL::uninitialized_copy(x.start, x.finish, start);
+            }
+            catch(...){
+                deallocate();
+                throw;
+            }
+        }
+        // 元素在x的配置器空间里时直接接管, 在x的内联缓冲区里时只能逐个移动过来
+        small_vector(small_vector &&x) noexcept(std::is_nothrow_move_constructible<T>::value) : Alloc(x.get_allocator()){
+            reset_to_inline();
+            take(x);
+        }
+        // 和vector一样, 赋值之后配置器也换成x的, 否则接管过来的空间会被另一个配置器释放
+        small_vector &operator=(const small_vector &x){
+            if(this != &x){
+                small_vector tmp(x);
+                clear();
+                deallocate();
+                static_cast<Alloc &>(*this) = static_cast<const Alloc &>(tmp);
+                reset_to_inline();
+                take(tmp);
+            }
+            return *this;
+        }
+        small_vector &operator=(small_vector &&x) noexcept(std::is_nothrow_move_constructible<T>::value){
+            if(this != &x){
+                clear();
+                deallocate();
+                static_cast<Alloc &>(*this) = static_cast<const Alloc &>(x);
+                reset_to_inline();
+                take(x);
+            }
+            return *this;
+        }
+        ~small_vector(){
+            destory(start, finish);
+            deallocate();
+        }
+
+        allocator_type get_allocator() const { return *this; }
+
+        // 通过移动赋值交换, 配置器随元素一起交换
+        void swap(small_vector &x){
+            small_vector tmp(std::move(x));
+            x = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        // 保证至少能放下n个元素, 不会把元素搬回内联缓冲区
+        void reserve(size_type n){
+            if(n > capacity())
+                grow(n);
+        }
+
+        template <class... Args>
+        void emplace_back(Args&&... args){
+            if(finish != end_of_storage){
+                construct(finish, std::forward<Args>(args)...);
+                ++finish;
+            }
+            else{
+                T x_copy(std::forward<Args>(args)...); // args可能引用自己的元素, 扩容之前先构造出来
+                iterator position = grow(size() + 1);
+                construct(position, std::move(x_copy));
+                finish = position + 1;
+            }
+        }
+        void push_back(const T &x) { emplace_back(x); }
+        void push_back(T &&x) { emplace_back(std::move(x)); }
+
+        void pop_back(){
+            --finish;
+            destory(finish);
+        }
+
+        // 在位置pos上用args构造一个元素, 返回指向它的迭代器
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args){
+            const size_type offset = position - start;
+            if(position == finish){
+                emplace_back(std::forward<Args>(args)...);
+                return start + offset;
+            }
+            T x_copy(std::forward<Args>(args)...); // args可能引用自己的元素, 搬移之前先构造出来
+            if(finish == end_of_storage)
+                grow(size() + 1);
+            position = start + offset;
+            construct(finish, std::move(*(finish - 1)));
+            ++finish;
+            TinySTL::move_backward(position, finish - 2, finish - 1);
+            *position = std::move(x_copy);
+            return position;
+        }
+        iterator insert(iterator position, const T &x) { return emplace(position, x); }
+        iterator insert(iterator position, T &&x) { return emplace(position, std::move(x)); }
+        void insert(iterator position, size_type n, const T &value); // 从位置pos开始插入n个初值为x的元素
+
+        iterator erase(iterator position){
+            if(position + 1 != end())
+                TinySTL::move(position + 1, end(), position);
+            --finish;
+            destory(finish);
+            return position;
+        }
+        iterator erase(iterator first, iterator last){
+            if(first == last) // 空区间不能把后面的元素移动给自己
+                return first;
+            iterator i = TinySTL::move(last, finish, first);
+            destory(i, finish);
+            finish = finish - (last - first);
+            return first;
+        }
+
+        void resize(size_type new_size, const T& x){
+            if(new_size < size())
+                erase(begin() + new_size, end());
+            else
+                insert(end(), new_size - size(), x);
+        }
+        void resize(size_type new_size) { resize(new_size, T()); }
+        void clear() { erase(begin(), end()); }
+    private:
+        // 构造函数里使用, 元素的构造抛出异常时析构函数不会被调用, 要自己归还空间
+        void fill_initialize(size_type n, const T &value){
+            if(n > N)
+                grow(n);
+            try{
+                finish = TinySTL::uninitialized_fill_n(start, n, value);
+            }
+            catch(...){
+                deallocate();
+                throw;
+            }
+        }
+        // *this为空并且使用内联缓冲区, 接管x的元素, 之后x为空
+        void take(small_vector &x){
+            typedef typename _type_traits<T>::is_relocatable_type is_relocatable;
+            if(!x.is_inline()){
+                start = x.start;
+                finish = x.finish;
+                end_of_storage = x.end_of_storage;
+                x.reset_to_inline();
+            }
+            else{
+                relocate(x.start, x.finish, start, is_relocatable());
+                finish = start + x.size();
+                x.finish = x.start;
+            }
+        }
+    };
+
+    template <class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::insert(iterator position, size_type n, const T &value){
+        if(n == 0)
+            return;
+        T x = value; // value可能就是自己的元素, 扩容或搬移之后会失效, 先存一份
+        const size_type offset = position - start;
+        if(size_type(end_of_storage - finish) < n)
+            grow(size() + n);
+        position = start + offset;
+        const size_type elems_after = finish - position;
+        iterator old_finish = finish;
+        if(elems_after > n){
+            TinySTL::uninitialized_move(finish - n, finish, finish);
+            finish += n;
+            TinySTL::move_backward(position, old_finish - n, old_finish);
+            TinySTL::fill(position, position + n, x);
+        }
+        else{
+            TinySTL::uninitialized_fill_n(finish, n - elems_after, x);
+            finish += n - elems_after;
+            TinySTL::uninitialized_move(position, old_finish, finish);
+            finish += elems_after;
+            TinySTL::fill(position, old_finish, x);
+        }
+    }
+
+    template <class T, size_t N, class Alloc>
+    inline void swap(small_vector<T, N, Alloc>& x, small_vector<T, N, Alloc>& y){
+        x.swap(y);
+    }
+}
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef _SOA_VECTOR_H_
+#define _SOA_VECTOR_H_
+
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include "allocator.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+
+/* 按列存放的vector(structure of arrays)
+ * soa_vector<int, float, double>相当于vector<struct{int; float; double;}>, 但每个字段各自存放在一块连续的空间里,
+ * 只访问一两个字段的循环不会把其他字段也读进cache, column<I>()得到的span可以直接交给algorithm.h里的向量化内核
+ * 一行的元素只能通过下标访问, 没有指向一整行的迭代器
+ */
+
+namespace TinySTL{
+    // 一段连续的元素, 不拥有它们, 只是一对指针
+    template <class T>
+    struct span{
+        typedef T           value_type;
+        typedef T*          iterator;
+        typedef T*          pointer;
+        typedef T&          reference;
+        typedef size_t      size_type;
+
+        T *first;
+        T *last;
+
+        span() : first(0), last(0) {}
+        span(T *first, T *last) : first(first), last(last) {}
+        span(T *first, size_type n) : first(first), last(first + n) {}
+
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+        pointer data() const { return first; }
+        size_type size() const { return size_type(last - first); }
+        bool empty() const { return first == last; }
+        reference operator[](size_type n) const { return first[n]; }
+    };
+
+    // C++11没有std::index_sequence, 用它对各列展开参数包
+    template <size_t... I>
+    struct _index_sequence {};
+    template <size_t N, size_t... I>
+    struct _make_index_sequence : _make_index_sequence<N - 1, N - 1, I...> {};
+    template <size_t... I>
+    struct _make_index_sequence<0, I...>{
+        typedef _index_sequence<I...> type;
+    };
+
+    /* Alloc是任意型别的配置器, 每一列用rebind得到自己的配置器
+     * 一般直接使用soa_vector<Fields...>
+     */
+    template <class Alloc, class... Fields>
+    class basic_soa_vector : protected Alloc{
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one column");
+    public:
+        typedef size_t                  size_type;
+        typedef ptrdiff_t               difference_type;
+        typedef Alloc                   allocator_type;
+        typedef std::tuple<Fields...>   value_type; // 一行的值
+        typedef std::tuple<Fields&...>  reference; // 一行各列的引用
+        typedef std::tuple<const Fields&...> const_reference;
+
+        // 第I列的型别
+        template <size_t I>
+        struct column_type{
+            typedef typename std::tuple_element<I, std::tuple<Fields...> >::type type;
+        };
+    protected:
+        typedef typename _make_index_sequence<sizeof...(Fields)>::type columns_index;
+
+        std::tuple<Fields*...> columns; // 各列的起始地址
+        size_type count; // 行数
+        size_type cap; // 各列都能放下cap行
+
+        template <class F>
+        F *allocate_column(size_type n){
+            return typename Alloc::template rebind<F>::other(get_allocator()).allocate(n);
+        }
+        template <class F>
+        void deallocate_column(F *p, size_type n){
+            typename Alloc::template rebind<F>::other(get_allocator()).deallocate(p, n);
+        }
+
+        // 把一列的[first, last)搬到未初始化的空间result, 可平凡搬移的型别直接按字节复制
+        template <class F>
+        static void relocate_column(F *first, F *last, F *result, _true_type){
+            if(first != last)
+                memcpy((void *)result, (const void *)first, (last - first) * sizeof(F));
+        }
+        template <class F>
+        static void relocate_column(F *first, F *last, F *result, _false_type){
+            TinySTL::uninitialized_move_if_noexcept(first, last, result);
+        }
+        // 搬移之后结束原来的元素, 按字节搬走的元素不需要也不能再析构
+        template <class F>
+        static void release_column(F *, F *, _true_type) {}
+        template <class F>
+        static void release_column(F *first, F *last, _false_type) { destory(first, last); }
+
+        /* 把所有列的容量都扩大到n
+         * 先配置好所有的新空间, 再逐列搬移, 全部成功之后才析构原来的元素
+         * 某一列抛出异常时丢弃新空间, 原来的元素还在, 但之前已经移动过的列只剩下移动后的值(基本保证)
+         */
+        template <size_t... I>
+        void reallocate(size_type n, _index_sequence<I...>);
+
+        // 在第pos行用args逐列构造元素, 某一列抛出异常时析构已经构造的列
+        template <size_t... I, class... Args>
+        void construct_row(size_type pos, _index_sequence<I...>, Args&&... args){
+            size_type done = 0;
+            try{
+                int expand[] = {0, (construct(std::get<I>(columns) + pos, std::forward<Args>(args)), ++done, 0)...};
+                (void)expand;
+            }
+            catch(...){
+                int expand[] = {0, (I < done ? destory(std::get<I>(columns) + pos) : void(), 0)...};
+                (void)expand;
+                throw;
+            }
+        }
+        template <size_t... I>
+        void construct_row_from(size_type pos, value_type &&x, _index_sequence<I...>){
+            construct_row(pos, columns_index(), std::move(std::get<I>(x))...);
+        }
+        // 析构所有列的[first, last)行
+        template <size_t... I>
+        void destroy_rows(size_type first, size_type last, _index_sequence<I...>){
+            int expand[] = {0, (destory(std::get<I>(columns) + first, std::get<I>(columns) + last), 0)...};
+            (void)expand;
+        }
+        template <size_t... I>
+        void deallocate_columns(_index_sequence<I...>){
+            int expand[] = {0, (deallocate_column(std::get<I>(columns), cap), 0)...};
+            (void)expand;
+        }
+        // 所有列的[last, count)行往前移到first
+        template <size_t... I>
+        void move_rows(size_type first, size_type last, _index_sequence<I...>){
+            int expand[] = {0, (TinySTL::move(std::get<I>(columns) + last, std::get<I>(columns) + count,
+                                              std::get<I>(columns) + first), 0)...};
+            (void)expand;
+        }
+        template <size_t... I>
+        reference make_row(size_type n, _index_sequence<I...>){
+            return reference(std::get<I>(columns)[n]...);
+        }
+        template <size_t... I>
+        const_reference make_row(size_type n, _index_sequence<I...>) const{
+            return const_reference(std::get<I>(columns)[n]...);
+        }
+        template <size_t... I>
+        void copy_from(const basic_soa_vector &x, _index_sequence<I...>);
+
+        void grow(size_type min_capacity){
+            size_type len = 2 * cap;
+            if(len < min_capacity)
+                len = min_capacity;
+            reallocate(len, columns_index());
+        }
+    public:
+        size_type size() const { return count; }
+        size_type capacity() const { return cap; }
+        bool empty() const { return count == 0; }
+
+        // 第I列的所有元素
+        template <size_t I>
+        span<typename column_type<I>::type> column(){
+            return span<typename column_type<I>::type>(std::get<I>(columns), count);
+        }
+        template <size_t I>
+        span<const typename column_type<I>::type> column() const{
+            return span<const typename column_type<I>::type>(std::get<I>(columns), count);
+        }
+        // 第n行第I列的元素
+        template <size_t I>
+        typename column_type<I>::type &get(size_type n) { return std::get<I>(columns)[n]; }
+        template <size_t I>
+        const typename column_type<I>::type &get(size_type n) const { return std::get<I>(columns)[n]; }
+        // 第n行, 各列的引用组成的tuple
+        reference operator[](size_type n) { return make_row(n, columns_index()); }
+        const_reference operator[](size_type n) const { return make_row(n, columns_index()); }
+        reference back() { return (*this)[count - 1]; }
+
+        basic_soa_vector() : count(0), cap(0) {}
+        explicit basic_soa_vector(const Alloc &alloc) : Alloc(alloc), count(0), cap(0) {}
+        basic_soa_vector(const basic_soa_vector &x) : Alloc(x.get_allocator()), count(0), cap(0){
+            copy_from(x, columns_index());
+        }
+        // 移动构造只是接管x的各列空间
+        basic_soa_vector(basic_soa_vector &&x) noexcept : Alloc(x.get_allocator()), columns(x.columns), count(x.count), cap(x.cap){
+            x.columns = std::tuple<Fields*...>();
+            x.count = x.cap = 0;
+        }
+        basic_soa_vector &operator=(const basic_soa_vector &x){
+            if(this != &x){
+                basic_soa_vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        basic_soa_vector &operator=(basic_soa_vector &&x) noexcept{
+            basic_soa_vector tmp(std::move(x)); // 原来的元素随tmp一起析构
+            swap(tmp);
+            return *this;
+        }
+        ~basic_soa_vector(){
+            destroy_rows(0, count, columns_index());
+            deallocate_columns(columns_index());
+        }
+
+        allocator_type get_allocator() const { return *this; }
+
+        void swap(basic_soa_vector &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            std::swap(columns, x.columns);
+            std::swap(count, x.count);
+            std::swap(cap, x.cap);
+        }
+
+        void reserve(size_type n){
+            if(n > cap)
+                reallocate(n, columns_index());
+        }
+
+        // 在尾部添加一行, 第i个参数用来构造第i列的元素
+        template <class... Args>
+        void emplace_back(Args&&... args){
+            static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back needs one argument per column");
+            if(count != cap){
+                construct_row(count, columns_index(), std::forward<Args>(args)...);
+            }
+            else{
+                value_type x_copy(std::forward<Args>(args)...); // args可能引用自己的元素, 扩容之前先构造出来
+                grow(count + 1);
+                construct_row_from(count, std::move(x_copy), columns_index());
+            }
+            ++count;
+        }
+        void push_back(const Fields&... values) { emplace_back(values...); }
+        void push_back(const value_type &x) { push_back_tuple(x, columns_index()); }
+
+        void pop_back(){
+            --count;
+            destroy_rows(count, count + 1, columns_index());
+        }
+
+        // 删除第first到第last-1行, 后面的行往前移, 各列分别调用move
+        void erase(size_type first, size_type last){
+            if(first == last)
+                return;
+            move_rows(first, last, columns_index());
+            destroy_rows(count - (last - first), count, columns_index());
+            count -= last - first;
+        }
+        void erase(size_type position) { erase(position, position + 1); }
+
+        // 增加的行各列都是值初始化的元素
+        void resize(size_type new_size){
+            if(new_size < count){
+                erase(new_size, count);
+            }
+            else{
+                reserve(new_size);
+                while(count < new_size)
+                    emplace_back(Fields()...);
+            }
+        }
+        void clear() { erase(0, count); }
+    private:
+        template <size_t... I>
+        void push_back_tuple(const value_type &x, _index_sequence<I...>) { emplace_back(std::get<I>(x)...); }
+    };
+
+    template <class... Fields>
+    using soa_vector = basic_soa_vector<allocator<char>, Fields...>;
+
+    // *******************以下为soa_vector类中一些模板的实现*******************
+    template <class Alloc, class... Fields>
+    template <size_t... I>
+    void basic_soa_vector<Alloc, Fields...>::reallocate(size_type n, _index_sequence<I...>){
+        std::tuple<Fields*...> new_columns;
+        size_type allocated = 0;
+        try{
+            int expand[] = {0, (std::get<I>(new_columns) = allocate_column<Fields>(n), ++allocated, 0)...};
+            (void)expand;
+        }
+        catch(...){
+            int expand[] = {0, (I < allocated ? deallocate_column(std::get<I>(new_columns), n) : void(), 0)...};
+            (void)expand;
+            throw;
+        }
+        size_type moved = 0;
+        try{
+            int expand[] = {0, (relocate_column(std::get<I>(columns), std::get<I>(columns) + count, std::get<I>(new_columns),
+                                                typename _type_traits<Fields>::is_relocatable_type()), ++moved, 0)...};
+            (void)expand;
+        }
+        catch(...){
+            int release[] = {0, (I < moved ? release_column(std::get<I>(new_columns), std::get<I>(new_columns) + count,
+                                                            typename _type_traits<Fields>::is_relocatable_type()) : void(), 0)...};
+            int discard[] = {0, (deallocate_column(std::get<I>(new_columns), n), 0)...};
+            (void)release;
+            (void)discard;
+            throw;
+        }
+        int release[] = {0, (release_column(std::get<I>(columns), std::get<I>(columns) + count,
+                                            typename _type_traits<Fields>::is_relocatable_type()), 0)...};
+        (void)release;
+        deallocate_columns(columns_index());
+        columns = new_columns;
+        cap = n;
+    }
+
+    template <class Alloc, class... Fields>
+    template <size_t... I>
+    void basic_soa_vector<Alloc, Fields...>::copy_from(const basic_soa_vector &x, _index_sequence<I...>){
+        if(x.count == 0)
+            return;
+        reallocate(x.count, columns_index());
+        size_type copied = 0;
+        try{
+            int expand[] = {0, (TinySTL::uninitialized_copy(std::get<I>(x.columns), std::get<I>(x.columns) + x.count,
+                                                            std::get<I>(columns)), ++copied, 0)...};
+            (void)expand;
+        }
+        catch(...){
+            int expand[] = {0, (I < copied ? destory(std::get<I>(columns), std::get<I>(columns) + x.count) : void(), 0)...};
+            (void)expand;
+            deallocate_columns(columns_index());
+            throw;
+        }
+        count = x.count;
+    }
+
+    template <class Alloc, class... Fields>
+    inline void swap(basic_soa_vector<Alloc, Fields...> &x, basic_soa_vector<Alloc, Fields...> &y){
+        x.swap(y);
+    }
+}
+
+#endif
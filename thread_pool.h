@@ -0,0 +1,246 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* 工作窃取(work-stealing)线程池
+ * 每个工作线程有自己的任务队列: 自己从队尾取任务(后进先出, 刚拆分出来的任务的数据还在cache里),
+ * 空闲的线程从别的队列的队头偷任务(先进先出, 偷到的往往是拆分得较早、较大的任务)
+ * 等待任务组完成的线程(包括不属于线程池的调用者)先一起执行队列里的任务, 因此任务里可以再拆分任务; 队列空了才睡眠
+ */
+
+namespace TinySTL{
+    class thread_pool{
+    public:
+        typedef std::function<void()> task;
+    private:
+        struct worker_queue{
+            std::mutex lock;
+            std::deque<task> tasks;
+        };
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<worker_queue> > queues;
+        std::mutex sleep_lock; // 和wake一起用于让空闲的线程睡眠
+        std::condition_variable wake;
+        std::atomic<size_t> pending; // 所有队列里的任务总数
+        std::atomic<size_t> next_queue; // 外部线程提交任务时轮流放进各个队列
+        bool stopping;
+
+        // 不允许拷贝
+        thread_pool(const thread_pool &);
+        thread_pool &operator=(const thread_pool &);
+
+        // 当前线程所属的线程池和它在线程池里的编号, 不是工作线程时为0
+        static thread_pool *&current_pool(){
+            static thread_local thread_pool *pool = 0;
+            return pool;
+        }
+        static size_t &current_index(){
+            static thread_local size_t index = 0;
+            return index;
+        }
+
+        bool pop_local(size_t index, task &t){
+            worker_queue &q = *queues[index];
+            std::lock_guard<std::mutex> guard(q.lock);
+            if(q.tasks.empty())
+                return false;
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            --pending;
+            return true;
+        }
+        // 从start开始依次尝试各个队列, 偷队头的任务
+        bool steal(size_t start, task &t){
+            const size_t n = queues.size();
+            for (size_t i = 0; i < n; ++i){
+                worker_queue &q = *queues[(start + i) % n];
+                std::lock_guard<std::mutex> guard(q.lock);
+                if(!q.tasks.empty()){
+                    t = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                    --pending;
+                    return true;
+                }
+            }
+            return false;
+        }
+        void worker_loop(size_t index){
+            current_pool() = this;
+            current_index() = index;
+            task t;
+            while(true){
+                if(pop_local(index, t) || steal(index + 1, t)){
+                    t();
+                    t = nullptr;
+                    continue;
+                }
+                std::unique_lock<std::mutex> guard(sleep_lock);
+                if(stopping)
+                    return;
+                wake.wait(guard, [this]{ return stopping || pending.load() != 0; });
+            }
+        }
+        void start(size_t workers){
+            for (size_t i = 0; i < workers; ++i)
+                queues.push_back(std::unique_ptr<worker_queue>(new worker_queue));
+            for (size_t i = 0; i < workers; ++i)
+                threads.push_back(std::thread(&thread_pool::worker_loop, this, i));
+        }
+        // 执行完队列里剩下的任务后结束所有工作线程
+        void stop(){
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (size_t i = 0; i < threads.size(); ++i)
+                threads[i].join();
+            threads.clear();
+            queues.clear();
+            stopping = false;
+        }
+    public:
+        explicit thread_pool(size_t workers) : pending(0), next_queue(0), stopping(false) { start(workers); }
+        ~thread_pool() { stop(); }
+
+        // 全局的线程池, 工作线程数是CPU核数减一(调用者自己也参与计算)
+        static thread_pool &instance(){
+            static thread_pool pool(default_workers());
+            return pool;
+        }
+        static size_t default_workers(){
+            const unsigned n = std::thread::hardware_concurrency();
+            return n > 1 ? n - 1 : 0;
+        }
+
+        // 可以同时执行任务的线程数, 包括等待任务的调用者
+        size_t concurrency() const { return threads.size() + 1; }
+
+        // 重新设置工作线程数, 只能在线程池空闲时调用(例如测试不同线程数下的性能)
+        void resize(size_t workers){
+            stop();
+            start(workers);
+        }
+
+        /* 提交一个任务, 任务不能抛出异常(需要异常时使用task_group)
+         * preferred指定放进哪个工作线程的队列, 否则工作线程放进自己的队列, 外部线程轮流放进各个队列
+         * 没有工作线程时直接在当前线程执行
+         */
+        void submit(task t, size_t preferred = (size_t)-1){
+            if(queues.empty()){
+                t();
+                return;
+            }
+            size_t index = preferred;
+            if(index >= queues.size())
+                index = current_pool() == this ? current_index() : next_queue++ % queues.size();
+            {
+                // 和push_back在同一把锁里加pending, 取走这个任务的线程减pending之前一定已经加过了
+                std::lock_guard<std::mutex> guard(queues[index]->lock);
+                queues[index]->tasks.push_back(std::move(t));
+                ++pending;
+            }
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock); // 保证正在检查pending的线程不会错过通知
+            }
+            wake.notify_all();
+        }
+
+        // 执行一个队列里的任务, 没有任务时返回false; 等待中的线程用它来帮忙, 而不是阻塞
+        bool run_one(){
+            if(queues.empty() || pending.load() == 0)
+                return false;
+            task t;
+            const bool found = current_pool() == this ? (pop_local(current_index(), t) || steal(current_index() + 1, t))
+                                                      : steal(next_queue.load() % queues.size(), t);
+            if(!found)
+                return false;
+            t();
+            return true;
+        }
+
+        // 等待的线程没有任务可以帮忙执行时睡眠, 直到finished()为true, 或者又有任务提交
+        template <class Predicate>
+        void wait_for_work(Predicate finished){
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [&]{ return finished() || pending.load() != 0; });
+        }
+        // 在sleep_lock里执行f, 再唤醒睡眠的线程; 等待的线程在同一把锁里检查条件, 所以不会错过
+        template <class Function>
+        void notify_waiters(Function f){
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+                f();
+            }
+            wake.notify_all();
+        }
+    };
+
+    /* 一组任务, wait()等待它们全部完成, 并重新抛出其中第一个异常
+     * 析构时也会等待还没完成的任务, 因此任务可以放心地引用调用者的局部变量
+     */
+    class task_group{
+    private:
+        thread_pool &pool;
+        std::atomic<size_t> remaining;
+        std::mutex error_lock;
+        std::exception_ptr error;
+
+        task_group(const task_group &);
+        task_group &operator=(const task_group &);
+
+        // 能帮忙就执行队列里的任务, 队列空了就睡眠, 直到最后一个任务完成或者有新的任务
+        void join(){
+            while(remaining.load() != 0)
+                if(!pool.run_one())
+                    pool.wait_for_work([this]{ return remaining.load() == 0; });
+        }
+        // 最后一个任务在sleep_lock里把remaining减到0, 等待的线程看到0时这个任务已经不会再访问this
+        void finish_one(){
+            size_t n = remaining.load();
+            while(n > 1)
+                if(remaining.compare_exchange_weak(n, n - 1))
+                    return;
+            pool.notify_waiters([this]{ --remaining; });
+        }
+    public:
+        explicit task_group(thread_pool &pool = thread_pool::instance()) : pool(pool), remaining(0) {}
+        ~task_group() { join(); }
+
+        template <class Function>
+        void run(Function f, size_t preferred = (size_t)-1){
+            ++remaining;
+            pool.submit([this, f]() mutable{
+                try{
+                    f();
+                }
+                catch(...){
+                    std::lock_guard<std::mutex> guard(error_lock);
+                    if(!error)
+                        error = std::current_exception();
+                }
+                finish_one(); // 这之后不能再访问this, 等待的线程可能已经销毁了task_group
+            }, preferred);
+        }
+        void wait(){
+            join();
+            if(error){
+                std::exception_ptr e = error;
+                error = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+    };
+}
+
+#endif
@@ -1,264 +1,51 @@
 #ifndef _TYPE_TRAITS_H_
 #define _TYPE_TRAITS_H_
 
+#include <type_traits>
+
 namespace TinySTL{
     struct _false_type {};
     struct _true_type {};
 
-    // 萃取剂，萃取出这几种类型，一般的情况全置为false_type，然后偏特化其他的情况
+    // 把编译期的布尔值转换成_true_type或_false_type, 以便用重载来分派
+    template<bool>
+    struct _bool_type{
+        typedef _false_type type;
+    };
+    template<>
+    struct _bool_type<true>{
+        typedef _true_type type;
+    };
+
+    /* 可平凡搬移(trivially relocatable)的opt-in
+     * 如果一个型别"移动构造到新地址再析构旧对象"等价于把它按字节拷贝过去(例如只持有指向堆内存的指针, 并且没有指向自身的指针),
+     * 就可以特化这个模板把is_relocatable_type定义为_true_type, vector扩容时会整块搬移它, 既不调用移动构造也不调用析构
+     * 平凡可复制的型别总是可以平凡搬移的, 不需要特化
+     */
+    template<class T>
+    struct _relocatable_traits
+    {
+        typedef _false_type		is_relocatable_type;
+    };
+
+    /* 萃取剂, 萃取出这几种类型
+     * 以前只有手工列出的内置型别才会被标记为POD, 现在借助编译器的内建判断(std::is_trivially_*)自动推导,
+     * 因此像struct {int a; float b;}这样的用户型别也能走memmove的快速路径
+     * is_POD_type表示可以按字节复制和赋值, is_relocatable_type表示可以按字节搬移到新地址
+     */
     template<class T>
 	struct _type_traits
 	{
-		typedef _false_type		has_trivial_default_constructor;
-		typedef _false_type		has_trivial_copy_constructor;
-		typedef _false_type		has_trivial_assignment_operator;
-		typedef _false_type		has_trivial_destructor;
-		typedef _false_type		is_POD_type;
-	};
-
-    // 以下为各种偏特化版本
-    // bool的偏特化版本
-    template<>
-	struct _type_traits<bool>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<char>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned char>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<signed char>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<wchar_t>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<short>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned short>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<int>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned int>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<long>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned long>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<long long>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned long long>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<float>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<double>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<long double>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-
-	template<class T>
-	struct _type_traits<T*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<class T>
-	struct _type_traits<const T*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<unsigned char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<signed char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<const char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<const unsigned char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
-	};
-
-	template<>
-	struct _type_traits<const signed char*>
-	{
-		typedef _true_type		has_trivial_default_constructor;
-		typedef _true_type		has_trivial_copy_constructor;
-		typedef _true_type		has_trivial_assignment_operator;
-		typedef _true_type		has_trivial_destructor;
-		typedef _true_type		is_POD_type;
+		typedef typename _bool_type<std::is_trivially_default_constructible<T>::value>::type	has_trivial_default_constructor;
+		typedef typename _bool_type<std::is_trivially_copy_constructible<T>::value>::type		has_trivial_copy_constructor;
+		typedef typename _bool_type<std::is_trivially_copy_assignable<T>::value>::type		has_trivial_assignment_operator;
+		typedef typename _bool_type<std::is_trivially_destructible<T>::value>::type			has_trivial_destructor;
+		typedef typename _bool_type<std::is_trivially_copyable<T>::value &&
+			std::is_trivially_copy_assignable<T>::value>::type									is_POD_type;
+		typedef typename _bool_type<std::is_trivially_copyable<T>::value ||
+			std::is_same<typename _relocatable_traits<T>::is_relocatable_type, _true_type>::value>::type is_relocatable_type;
 	};
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,31 +1,49 @@
 #ifndef _UNINITIALIZED_H_
 #define _UNINITIALIZED_H_
 
+#include <type_traits>
+#include <utility>
 #include "type_traits.h"
 #include "construct.h"
 #include "algorithm.h"
 
 namespace TinySTL{
 
+    // 以下函数都根据迭代器所指的元素型别(而不是迭代器本身的型别)判断是否为POD型
+    // 不是POD型时逐个构造, 中途抛出异常则把已经构造好的元素析构掉再继续抛出(commit or rollback)
+
     // ***************** uninitialized_copy模块 ***********************
     // 如果是POD型
     template <class InputIterator, class ForwardIterator>
-    ForwardIterator __uninitialized_copy_aux(InputIterator first, InputIterator last, 
+    ForwardIterator __uninitialized_copy_aux(InputIterator first, InputIterator last,
                                              ForwardIterator result, _true_type){
-        return copy(first, last, result); // 是POD型，直接调用STL算法copy()
+        return TinySTL::copy(first, last, result); // 是POD型，直接调用STL算法copy()
     }
 
     // 如果不是POD型
     template <class InputIterator, class ForwardIterator>
-    ForwardIterator __uninitialized_copy_aux(InputIterator first, InputIterator last, 
+    ForwardIterator __uninitialized_copy_aux(InputIterator first, InputIterator last,
                                              ForwardIterator result, _false_type){
         ForwardIterator cur = result;
-        for (; first != last; ++cur, ++first){
-            construct(cur, *first); //一个个构造
+        try{
+            for (; first != last; ++cur, ++first){
+                construct(&*cur, *first); //一个个构造
+            }
+        }
+        catch(...){
+            destory(result, cur);
+            throw;
         }
         return cur;
     }
 
+    template <class InputIterator, class ForwardIterator, class T>
+    inline ForwardIterator __uninitialized_copy(InputIterator first, InputIterator last,
+                                                ForwardIterator result, T*){
+        typedef typename _type_traits<T>::is_POD_type is_POD;
+        return __uninitialized_copy_aux(first, last, result, is_POD());
+    }
+
     /* 该函数的作用是将区间[first, last)的内容复制到已result为起始位置的空间中
      * 迭代器first指向输入端的起始位置
      * 迭代器last指向输入端的结束位置(前闭后开区间)
@@ -33,8 +51,73 @@ namespace TinySTL{
      */
     template <class InputIterator, class ForwardIterator>
     ForwardIterator uninitialized_copy(InputIterator first, InputIterator last, ForwardIterator result){
-        typedef typename _type_traits<InputIterator>::is_POD_type is_POD;
-        return __uninitialized_copy_aux(first, last, result, is_POD());
+        return __uninitialized_copy(first, last, result, value_type(result));
+    }
+
+    // ***************** uninitialized_move模块 ***********************
+    // 如果是POD型, 移动和复制是一回事
+    template <class InputIterator, class ForwardIterator>
+    ForwardIterator __uninitialized_move_aux(InputIterator first, InputIterator last,
+                                             ForwardIterator result, _true_type){
+        return TinySTL::copy(first, last, result);
+    }
+
+    // 如果不是POD型, 逐个移动构造
+    template <class InputIterator, class ForwardIterator>
+    ForwardIterator __uninitialized_move_aux(InputIterator first, InputIterator last,
+                                             ForwardIterator result, _false_type){
+        ForwardIterator cur = result;
+        try{
+            for (; first != last; ++cur, ++first){
+                construct(&*cur, std::move(*first));
+            }
+        }
+        catch(...){
+            destory(result, cur);
+            throw;
+        }
+        return cur;
+    }
+
+    template <class InputIterator, class ForwardIterator, class T>
+    inline ForwardIterator __uninitialized_move(InputIterator first, InputIterator last,
+                                                ForwardIterator result, T*){
+        typedef typename _type_traits<T>::is_POD_type is_POD;
+        return __uninitialized_move_aux(first, last, result, is_POD());
+    }
+
+    /* 该函数的作用是将区间[first, last)的内容移动到以result为起始位置的空间中
+     * 移动之后原区间的元素仍然存在(处于被移走的状态), 由调用者负责析构
+     */
+    template <class InputIterator, class ForwardIterator>
+    ForwardIterator uninitialized_move(InputIterator first, InputIterator last, ForwardIterator result){
+        return __uninitialized_move(first, last, result, value_type(result));
+    }
+
+    template <class InputIterator, class ForwardIterator>
+    inline ForwardIterator __uninitialized_move_if_noexcept_aux(InputIterator first, InputIterator last,
+                                                                ForwardIterator result, _true_type){
+        return TinySTL::uninitialized_move(first, last, result);
+    }
+    template <class InputIterator, class ForwardIterator>
+    inline ForwardIterator __uninitialized_move_if_noexcept_aux(InputIterator first, InputIterator last,
+                                                                ForwardIterator result, _false_type){
+        return TinySTL::uninitialized_copy(first, last, result);
+    }
+
+    // 移动构造不会抛出异常(或者元素根本不能复制)时移动, 否则复制
+    // 这样vector扩容到一半抛出异常时, 旧空间中的元素还保持原样
+    template <class InputIterator, class ForwardIterator, class T>
+    inline ForwardIterator __uninitialized_move_if_noexcept(InputIterator first, InputIterator last,
+                                                            ForwardIterator result, T*){
+        typedef typename _bool_type<std::is_nothrow_move_constructible<T>::value ||
+                                    !std::is_copy_constructible<T>::value>::type use_move;
+        return __uninitialized_move_if_noexcept_aux(first, last, result, use_move());
+    }
+
+    template <class InputIterator, class ForwardIterator>
+    ForwardIterator uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator result){
+        return __uninitialized_move_if_noexcept(first, last, result, value_type(result));
     }
 
     // ***************** uninitialized_fill模块 ***********************
@@ -42,7 +125,7 @@ namespace TinySTL{
     template <class ForwardIterator, class T>
     inline void __uninitialized_fill_aux(ForwardIterator first, ForwardIterator last,
                                          const T& x, _true_type){
-        fill(first, last, x); // 调用STL算法fill()
+        TinySTL::fill(first, last, x); // 调用STL算法fill()
     }
 
     // 如果不是POD型
@@ -50,12 +133,24 @@ namespace TinySTL{
     inline void __uninitialized_fill_aux(ForwardIterator first, ForwardIterator last,
                                          const T& x, _false_type){
         ForwardIterator cur = first;
-        while (cur != last){
-            construct(cur, x);
-            ++cur;
+        try{
+            while (cur != last){
+                construct(&*cur, x);
+                ++cur;
+            }
+        }
+        catch(...){
+            destory(first, cur);
+            throw;
         }
     }
 
+    template <class ForwardIterator, class T, class T1>
+    inline void __uninitialized_fill(ForwardIterator first, ForwardIterator last, const T& x, T1*){
+        typedef typename _type_traits<T1>::is_POD_type is_POD;
+        __uninitialized_fill_aux(first, last, x, is_POD());
+    }
+
     /* 该函数的作用是将区间[first, last)以x进行填充
      * 迭代器first指向输出端的起始位置
      * 迭代器last指向输出端的结束位置
@@ -63,36 +158,46 @@ namespace TinySTL{
      */
     template <class ForwardIterator, class T>
     inline void uninitialized_fill(ForwardIterator first, ForwardIterator last, const T& x){
-        typedef typename _type_traits<ForwardIterator>::is_POD_type is_POD;
-        __uninitialized_fill_aux(first, last, x, is_POD());
+        __uninitialized_fill(first, last, x, value_type(first));
     }
 
     // ***************** uninitialized_fill_n模块 ***********************
     // 如果是POD型
     template <class ForwardIterator, class Size, class T>
     inline ForwardIterator __uninitialized_fill_n_aux(ForwardIterator first, Size n, const T& x, _true_type){
-        return fill_n(first, n, x);// 调用STL算法fill_n()
+        return TinySTL::fill_n(first, n, x);// 调用STL算法fill_n()
     }
 
     // 如果不是POD型
     template <class ForwardIterator, class Size, class T>
     inline ForwardIterator __uninitialized_fill_n_aux(ForwardIterator first, Size n, const T& x, _false_type){
         ForwardIterator cur = first;
-        for (; n > 0; ++cur, --n)
-            construct(cur, x);
+        try{
+            for (; n > 0; ++cur, --n)
+                construct(&*cur, x);
+        }
+        catch(...){
+            destory(first, cur);
+            throw;
+        }
         return cur;
     }
-    
+
+    template <class ForwardIterator, class Size, class T, class T1>
+    inline ForwardIterator __uninitialized_fill_n(ForwardIterator first, Size n, const T& x, T1*){
+        typedef typename _type_traits<T1>::is_POD_type is_POD;
+        return __uninitialized_fill_n_aux(first, n, x, is_POD());
+    }
+
     /* 该函数的作用是将区间[first, first + n)以x进行填充
      * 迭代器first指向输出端的起始位置
      * x表示初值
      */
     template <class ForwardIterator, class Size, class T>
     inline ForwardIterator uninitialized_fill_n(ForwardIterator first, Size n, const T& x){
-        typedef typename _type_traits<ForwardIterator>::is_POD_type is_POD;
-        return __uninitialized_fill_n_aux(first, n, x, is_POD());
+        return __uninitialized_fill_n(first, n, x, value_type(first));
     }
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,725 @@
+#ifndef _UNROLLED_LIST_H_
+#define _UNROLLED_LIST_H_
+
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <initializer_list>
+#include "iterator.h"
+#include "allocator.h"
+#include "construct.h"
+#include "type_traits.h"
+#include "algorithm.h"
+
+/* 展开链表(unrolled linked list)
+ * list每个节点只放一个元素, 遍历每一步都是一次cache miss; 这里每个节点放至多K个元素, 节点之间仍然是双向链表,
+ * 遍历大部分时间是在同一个节点里顺序前进, 在迭代器附近插入和删除只需要挪动一个节点里的元素
+ * 节点写满时从中间分裂, 删除后节点太空时和相邻节点合并, 除哨兵外不存在空节点
+ * 元素会在节点内和节点之间搬动, 因此插入和删除会使同一节点(以及被分裂、合并的节点)上的迭代器失效, 这一点和list不同
+ */
+
+namespace TinySTL{
+    enum { _unrolled_node_bytes = 256 }; // 节点的目标大小: 4条cache line, 正好是内存池的一个分档
+
+    // K的默认值: 节点大约_unrolled_node_bytes字节, 至少放4个元素
+    template <class T>
+    struct __unrolled_default_capacity{
+        enum { _fit = (int)((_unrolled_node_bytes - 3 * sizeof(void *)) / sizeof(T)) };
+        enum { value = _fit > 4 ? _fit : 4 };
+    };
+
+    // 哨兵节点只有链接, 不带元素数组
+    struct __unrolled_node_base{
+        __unrolled_node_base *prev;
+        __unrolled_node_base *next;
+    };
+
+    template <class T, size_t K>
+    struct __unrolled_node : public __unrolled_node_base{
+        size_t count; // 元素个数, 元素总是放在data()的前count个位置
+        typename std::aligned_storage<sizeof(T) * K, alignof(T)>::type storage;
+
+        T *data() { return reinterpret_cast<T *>(&storage); }
+    };
+
+    // 迭代器是(节点, 下标), end()是(哨兵, 0)
+    template <class T, size_t K, class Ref, class Ptr>
+    struct __unrolled_iterator{
+        typedef __unrolled_iterator<T, K, T&, T*> iterator;
+        typedef __unrolled_iterator<T, K, Ref, Ptr> self;
+
+        typedef bidirectional_iterator_tag  iterator_category;
+        typedef T                           value_type;
+        typedef Ptr                         pointer;
+        typedef Ref                         reference;
+        typedef ptrdiff_t                   difference_type;
+
+        typedef __unrolled_node_base    base_type;
+        typedef __unrolled_node<T, K>   node_type;
+
+        base_type *node;
+        size_t index;
+
+        __unrolled_iterator() : node(0), index(0) {}
+        __unrolled_iterator(base_type *node, size_t index) : node(node), index(index) {}
+        // 对iterator本身来说这就是复制构造函数, 复制赋值要显式声明, 否则是deprecated的隐式版本
+        __unrolled_iterator(const iterator &x) : node(x.node), index(x.index) {}
+        self &operator=(const self &) = default;
+
+        bool operator==(const self &x) const { return node == x.node && index == x.index; }
+        bool operator!=(const self &x) const { return !(*this == x); }
+
+        reference operator*() const { return static_cast<node_type *>(node)->data()[index]; }
+        pointer operator->() const { return &(operator*()); }
+
+        self &operator++(){
+            if(++index == static_cast<node_type *>(node)->count){
+                node = node->next;
+                index = 0;
+            }
+            return *this;
+        }
+        self operator++(int){
+            self temp = *this;
+            ++*this;
+            return temp;
+        }
+        self &operator--(){
+            if(index == 0){
+                node = node->prev;
+                index = static_cast<node_type *>(node)->count;
+            }
+            --index;
+            return *this;
+        }
+        self operator--(int){
+            self temp = *this;
+            --*this;
+            return temp;
+        }
+    };
+
+    /* 节点从内存池按大小分档配置, 哨兵直接放在容器对象里, 因此移动和swap之后要修正首尾节点指向哨兵的链接
+     * splice(position, x)和splice(position, x, first, last)按节点整段接过来, 只在三个端点处分裂节点;
+     * 单个元素的splice、merge和sort则是搬动元素, 不保留原来的节点
+     */
+    template <class T, size_t K = __unrolled_default_capacity<T>::value, class Alloc = allocator<T>>
+    class unrolled_list : protected Alloc{
+    public:
+        typedef T                   value_type;
+        typedef T*                  pointer;
+        typedef const T*            const_pointer;
+        typedef T&                  reference;
+        typedef const T&            const_reference;
+        typedef size_t              size_type;
+        typedef ptrdiff_t           difference_type;
+        typedef Alloc               allocator_type;
+        typedef __unrolled_iterator<T, K, T&, T*>               iterator;
+        typedef __unrolled_iterator<T, K, const T&, const T*>   const_iterator;
+
+        enum { node_capacity = K };
+    protected:
+        typedef __unrolled_node_base    base_type;
+        typedef __unrolled_node<T, K>   node_type;
+        typedef typename Alloc::template rebind<node_type>::other node_allocator;
+        typedef typename _type_traits<T>::is_relocatable_type is_relocatable; // 元素能否直接memmove
+        typedef typename _type_traits<T>::has_trivial_destructor trivial_destructor;
+
+        // 删除后少于半满、并且和相邻节点加起来不超过3/4时合并, 留出余量避免在边界上反复分裂合并
+        enum { merge_below = K / 2, merge_limit = K - K / 4 };
+
+        base_type head; // 哨兵
+        size_type length;
+
+        static node_type *as_node(base_type *x) { return static_cast<node_type *>(x); }
+        static iterator make_iterator(const const_iterator &x) { return iterator(x.node, x.index); }
+
+        node_type *new_node(){
+            node_type *x = node_allocator(get_allocator()).allocate(1);
+            x->count = 0;
+            return x;
+        }
+        // 节点上的元素要先析构或者搬走
+        void delete_node(node_type *x) { node_allocator(get_allocator()).deallocate(x, 1); }
+
+        // 把x链接在pos之前
+        static void link_before(base_type *pos, base_type *x){
+            x->next = pos;
+            x->prev = pos->prev;
+            pos->prev->next = x;
+            pos->prev = x;
+        }
+        static void unlink(base_type *x){
+            x->prev->next = x->next;
+            x->next->prev = x->prev;
+        }
+        void reset_head(){
+            head.prev = head.next = &head;
+            length = 0;
+        }
+        // 哨兵的地址随对象变化, 接管另一条链时修正首尾节点
+        void attach_chain(base_type *first, base_type *last){
+            if(first == 0){
+                head.prev = head.next = &head;
+                return;
+            }
+            head.next = first;
+            head.prev = last;
+            first->prev = &head;
+            last->next = &head;
+        }
+
+        // 把n个元素从src搬到dst, 两段可以重叠; 搬完之后src上的元素就不存在了
+        static void relocate(T *dst, T *src, size_type n, _true_type){
+            if(n != 0)
+                memmove((void *)dst, (const void *)src, n * sizeof(T));
+        }
+        static void relocate(T *dst, T *src, size_type n, _false_type){
+            if(dst < src){
+                for (size_type k = 0; k < n; ++k){
+                    construct(dst + k, std::move(src[k]));
+                    destory(src + k);
+                }
+            }
+            else{
+                for (size_type k = n; k-- > 0; ){
+                    construct(dst + k, std::move(src[k]));
+                    destory(src + k);
+                }
+            }
+        }
+        static void relocate(T *dst, T *src, size_type n) { relocate(dst, src, n, is_relocatable()); }
+
+        // 把节点x从下标i处一分为二, 后半段放进紧跟在x后面的新节点, 返回新节点
+        node_type *split(node_type *x, size_type i){
+            node_type *y = new_node();
+            relocate(y->data(), x->data() + i, x->count - i);
+            y->count = x->count - i;
+            x->count = i;
+            link_before(x->next, y);
+            return y;
+        }
+        // 让it指向节点的开头: 下标不为0时分裂节点; 同一节点上位置更靠后的a和b跟着修正
+        void cut(iterator &it, iterator &a, iterator &b){
+            if(it.index == 0)
+                return;
+            node_type *x = as_node(it.node);
+            const size_type i = it.index;
+            node_type *y = split(x, i);
+            if(a.node == x && a.index >= i)
+                a = iterator(y, a.index - i);
+            if(b.node == x && b.index >= i)
+                b = iterator(y, b.index - i);
+            it = iterator(y, 0);
+        }
+
+        // 在end()之前, 也就是pos之前新开一个节点放新元素
+        template <class... Args>
+        iterator emplace_in_new_node(base_type *pos, Args&&... args){
+            node_type *x = new_node();
+            try{
+                construct(x->data(), std::forward<Args>(args)...);
+            }
+            catch(...){
+                delete_node(x);
+                throw;
+            }
+            x->count = 1;
+            link_before(pos, x);
+            return iterator(x, 0);
+        }
+
+        // 把从节点first的下标i开始到节点last为止的n个元素接在pos之前, 下标i之前的元素已经搬走, 剩下的挪到节点开头; 返回n
+        size_type link_rest(base_type *first, size_type i, base_type *last, size_type n, base_type *pos){
+            if(n == 0)
+                return 0;
+            node_type *f = as_node(first);
+            if(i != 0){
+                relocate(f->data(), f->data() + i, f->count - i);
+                f->count -= i;
+            }
+            first->prev = pos->prev;
+            pos->prev->next = first;
+            last->next = pos;
+            pos->prev = last;
+            return n;
+        }
+        // 释放通过next串起来的空节点
+        void delete_nodes(base_type *x){
+            while(x != 0){
+                base_type *next = x->next;
+                delete_node(as_node(x));
+                x = next;
+            }
+        }
+
+        // 删除(x, i)处的元素, 返回下一个元素; merge为false时不合并节点, 其他节点上的迭代器不失效
+        iterator erase_at(node_type *x, size_type i, bool merge);
+        void destroy_nodes(_true_type);
+        void destroy_nodes(_false_type);
+        template <class Compare>
+        void sort_elements(Compare comp);
+        // 把缓冲区里的元素按顺序搬回各个节点, 然后释放缓冲区
+        void put_back(T *buffer){
+            size_type n = 0;
+            for (base_type *x = head.next; x != &head; x = x->next){
+                relocate(as_node(x)->data(), buffer + n, as_node(x)->count);
+                n += as_node(x)->count;
+            }
+            Alloc::deallocate(buffer, length);
+        }
+    public:
+        explicit unrolled_list(const Alloc &alloc = Alloc()) : Alloc(alloc) { reset_head(); }
+        explicit unrolled_list(size_type n, const T &value = T(), const Alloc &alloc = Alloc()) : Alloc(alloc){
+            reset_head();
+            try{
+                insert(end(), n, value);
+            }
+            catch(...){
+                clear();
+                throw;
+            }
+        }
+        template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+        unrolled_list(InputIterator first, InputIterator last, const Alloc &alloc = Alloc()) : Alloc(alloc){
+            reset_head();
+            try{
+                insert(end(), first, last);
+            }
+            catch(...){
+                clear();
+                throw;
+            }
+        }
+        unrolled_list(std::initializer_list<T> ilist, const Alloc &alloc = Alloc()) : Alloc(alloc){
+            reset_head();
+            try{
+                insert(end(), ilist.begin(), ilist.end());
+            }
+            catch(...){
+                clear();
+                throw;
+            }
+        }
+        unrolled_list(const unrolled_list &x) : Alloc(x.get_allocator()){
+            reset_head();
+            try{
+                insert(end(), x.begin(), x.end());
+            }
+            catch(...){
+                clear();
+                throw;
+            }
+        }
+        // 移动构造只是接管x的节点
+        unrolled_list(unrolled_list &&x) noexcept : Alloc(x.get_allocator()){
+            length = x.length;
+            if(x.empty())
+                attach_chain(0, 0);
+            else
+                attach_chain(x.head.next, x.head.prev);
+            x.reset_head();
+        }
+        unrolled_list &operator=(const unrolled_list &x){
+            if(this != &x){
+                unrolled_list tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        unrolled_list &operator=(unrolled_list &&x) noexcept{
+            unrolled_list tmp(std::move(x)); // 原来的元素随tmp一起析构
+            swap(tmp);
+            return *this;
+        }
+        ~unrolled_list() { clear(); }
+
+        allocator_type get_allocator() const { return *this; }
+
+        iterator begin() { return iterator(head.next, 0); }
+        const_iterator begin() const { return const_iterator(const_cast<base_type *>(head.next), 0); }
+        iterator end() { return iterator(&head, 0); }
+        const_iterator end() const { return const_iterator(const_cast<base_type *>(&head), 0); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        bool empty() const { return length == 0; }
+        size_type size() const { return length; }
+
+        reference front() { return *begin(); }
+        const_reference front() const { return *begin(); }
+        reference back() { return *--end(); }
+        const_reference back() const { return *--end(); }
+
+        template <class... Args>
+        iterator emplace(const_iterator position, Args&&... args);
+        iterator insert(const_iterator position, const T &value) { return emplace(position, value); }
+        iterator insert(const_iterator position, T &&value) { return emplace(position, std::move(value)); }
+        iterator insert(const_iterator position, size_type n, const T &value);
+        template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+        iterator insert(const_iterator position, InputIterator first, InputIterator last);
+
+        template <class... Args>
+        void emplace_back(Args&&... args) { emplace(end(), std::forward<Args>(args)...); }
+        template <class... Args>
+        void emplace_front(Args&&... args) { emplace(begin(), std::forward<Args>(args)...); }
+        void push_back(const T &value) { emplace(end(), value); }
+        void push_back(T &&value) { emplace(end(), std::move(value)); }
+        void push_front(const T &value) { emplace(begin(), value); }
+        void push_front(T &&value) { emplace(begin(), std::move(value)); }
+        void pop_back() { erase_at(as_node(head.prev), as_node(head.prev)->count - 1, true); }
+        void pop_front() { erase_at(as_node(head.next), 0, true); }
+
+        iterator erase(const_iterator position) { return erase_at(as_node(position.node), position.index, true); }
+        iterator erase(const_iterator first, const_iterator last);
+        void clear(){
+            destroy_nodes(trivial_destructor());
+            reset_head();
+        }
+
+        void swap(unrolled_list &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            base_type *first = empty() ? 0 : head.next, *last = head.prev;
+            base_type *x_first = x.empty() ? 0 : x.head.next, *x_last = x.head.prev;
+            attach_chain(x_first, x_last);
+            x.attach_chain(first, last);
+            std::swap(length, x.length);
+        }
+
+        // 整段接过来, 被接过来的元素上的迭代器仍然有效, 只是属于*this了
+        void splice(const_iterator position, unrolled_list &x);
+        void splice(const_iterator position, unrolled_list &x, const_iterator i);
+        void splice(const_iterator position, unrolled_list &x, const_iterator first, const_iterator last);
+        void merge(unrolled_list &x) { merge(x, std::less<T>()); }
+        template <class Compare>
+        void merge(unrolled_list &x, Compare comp);
+        void sort() { sort_elements(std::less<T>()); }
+        template <class Compare>
+        void sort(Compare comp) { sort_elements(comp); }
+        void reverse();
+    };
+
+    template <class T, size_t K, class Alloc>
+    template <class... Args>
+    typename unrolled_list<T, K, Alloc>::iterator unrolled_list<T, K, Alloc>::emplace(const_iterator position, Args&&... args){
+        base_type *x = position.node;
+        size_type i = position.index;
+        // 插在某个节点开头(包括end())时, 前一个节点还有空位就追加在它末尾, 不必挪动元素
+        if(i == 0 && x->prev != &head && as_node(x->prev)->count < K){
+            x = x->prev;
+            i = as_node(x)->count;
+        }
+        iterator result;
+        if(x == &head){
+            // 空表, 或者最后一个节点已满
+            result = emplace_in_new_node(&head, std::forward<Args>(args)...);
+        }
+        else if(i == as_node(x)->count){
+            node_type *n = as_node(x);
+            if(i == K){
+                result = emplace_in_new_node(n->next, std::forward<Args>(args)...);
+            }
+            else{
+                construct(n->data() + i, std::forward<Args>(args)...);
+                ++n->count;
+                result = iterator(n, i);
+            }
+        }
+        else{
+            // 要挪动已有的元素, 而参数可能引用表中的元素, 所以先构造出新元素
+            value_type obj(std::forward<Args>(args)...);
+            node_type *n = as_node(x);
+            if(n->count == K){
+                node_type *y = split(n, K / 2);
+                if(i >= K / 2){
+                    n = y;
+                    i -= K / 2;
+                }
+            }
+            relocate(n->data() + i + 1, n->data() + i, n->count - i);
+            try{
+                construct(n->data() + i, std::move(obj));
+            }
+            catch(...){
+                relocate(n->data() + i, n->data() + i + 1, n->count - i);
+                throw;
+            }
+            ++n->count;
+            result = iterator(n, i);
+        }
+        ++length;
+        return result;
+    }
+
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator unrolled_list<T, K, Alloc>::insert(const_iterator position, size_type n, const T &value){
+        if(n == 0)
+            return make_iterator(position);
+        // value可能是表中的元素, 先复制一份
+        const value_type obj(value);
+        iterator result = emplace(position, obj);
+        iterator it = result;
+        for (size_type k = 1; k < n; ++k)
+            it = emplace(++it, obj);
+        return result;
+    }
+
+    // 逐个插在上一个新元素之后; 在末尾插入时节点都是写满的
+    template <class T, size_t K, class Alloc>
+    template <class InputIterator, class>
+    typename unrolled_list<T, K, Alloc>::iterator unrolled_list<T, K, Alloc>::insert(const_iterator position, InputIterator first, InputIterator last){
+        if(first == last)
+            return make_iterator(position);
+        iterator result = emplace(position, *first);
+        iterator it = result;
+        for (++first; first != last; ++first)
+            it = emplace(++it, *first);
+        return result;
+    }
+
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator unrolled_list<T, K, Alloc>::erase_at(node_type *x, size_type i, bool merge){
+        destory(x->data() + i);
+        relocate(x->data() + i, x->data() + i + 1, x->count - i - 1);
+        --x->count;
+        --length;
+        base_type *next = x->next;
+        if(x->count == 0){
+            unlink(x);
+            delete_node(x);
+            return iterator(next, 0);
+        }
+        iterator result = i < x->count ? iterator(x, i) : iterator(next, 0);
+        if(!merge || x->count >= merge_below)
+            return result;
+        if(next != &head && x->count + as_node(next)->count <= merge_limit){
+            // 把后一个节点并进来
+            node_type *y = as_node(next);
+            if(result.node == y)
+                result = iterator(x, x->count + result.index);
+            relocate(x->data() + x->count, y->data(), y->count);
+            x->count += y->count;
+            unlink(y);
+            delete_node(y);
+        }
+        else if(x->prev != &head && as_node(x->prev)->count + x->count <= merge_limit){
+            // 并到前一个节点里
+            node_type *y = as_node(x->prev);
+            if(result.node == x)
+                result = iterator(y, y->count + result.index);
+            relocate(y->data() + y->count, x->data(), x->count);
+            y->count += x->count;
+            unlink(x);
+            delete_node(x);
+        }
+        return result;
+    }
+
+    // 先数出个数, 删除时节点会合并, last可能失效
+    template <class T, size_t K, class Alloc>
+    typename unrolled_list<T, K, Alloc>::iterator unrolled_list<T, K, Alloc>::erase(const_iterator first, const_iterator last){
+        size_type n = TinySTL::distance(first, last);
+        iterator it = make_iterator(first);
+        while(n-- > 0)
+            it = erase_at(as_node(it.node), it.index, true);
+        return it;
+    }
+
+    // 元素不需要析构时直接释放节点
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::destroy_nodes(_true_type){
+        base_type *x = head.next;
+        while(x != &head){
+            base_type *next = x->next;
+            delete_node(as_node(x));
+            x = next;
+        }
+    }
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::destroy_nodes(_false_type){
+        base_type *x = head.next;
+        while(x != &head){
+            base_type *next = x->next;
+            destory(as_node(x)->data(), as_node(x)->data() + as_node(x)->count);
+            delete_node(as_node(x));
+            x = next;
+        }
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator position, unrolled_list &x){
+        if(&x == this || x.empty())
+            return;
+        iterator pos = make_iterator(position), unused;
+        cut(pos, unused, unused);
+        base_type *first = x.head.next, *last = x.head.prev;
+        const size_type n = x.length;
+        x.reset_head();
+        first->prev = pos.node->prev;
+        pos.node->prev->next = first;
+        last->next = pos.node;
+        pos.node->prev = last;
+        length += n;
+    }
+
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator position, unrolled_list &x, const_iterator i){
+        const_iterator j = i;
+        ++j;
+        if(position == i || position == j)
+            return;
+        value_type obj(std::move(*i));
+        iterator pos = make_iterator(position);
+        // 同一条表时删除不合并节点, 只有同一节点上靠后的位置需要前移
+        if(pos.node == i.node && pos.index > i.index)
+            --pos.index;
+        x.erase_at(as_node(i.node), i.index, &x != this);
+        emplace(pos, std::move(obj));
+    }
+
+    // 在first、last、position三处分裂节点, 然后把[first, last)的节点整段摘下来接到position之前
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::splice(const_iterator position, unrolled_list &x, const_iterator first, const_iterator last){
+        if(first == last)
+            return;
+        iterator pos = make_iterator(position), f = make_iterator(first), l = make_iterator(last);
+        cut(f, pos, l);
+        cut(l, pos, f);
+        cut(pos, f, l);
+        if(pos == f || pos == l)
+            return;
+        base_type *first_node = f.node, *last_node = l.node->prev;
+        if(&x != this){
+            size_type n = 0;
+            for (base_type *y = first_node; y != l.node; y = y->next)
+                n += as_node(y)->count;
+            x.length -= n;
+            length += n;
+        }
+        first_node->prev->next = l.node;
+        l.node->prev = first_node->prev;
+        first_node->prev = pos.node->prev;
+        pos.node->prev->next = first_node;
+        last_node->next = pos.node;
+        pos.node->prev = last_node;
+    }
+
+    /* 在原有的节点上归并: 两条表的元素从前往后逐个搬进*this末尾的输出节点, 搬空的输入节点接着用作输出节点,
+     * 输入节点上搬走的位置最多占两个节点, 所以最多只多配置两个节点
+     * 比较时抛出异常(或者配置节点失败)时, 已经归并的元素加上*this剩下的元素留在*this, x剩下的元素留在x, 两条表都仍然有序
+     */
+    template <class T, size_t K, class Alloc>
+    template <class Compare>
+    void unrolled_list<T, K, Alloc>::merge(unrolled_list &x, Compare comp){
+        if(&x == this || x.empty())
+            return;
+        // 两条链先从哨兵上摘下来, 链尾的next仍然指向原来的哨兵, 用它判断链是否走完
+        base_type *a = head.next, *b = x.head.next;
+        base_type *const a_last = head.prev, *const b_last = x.head.prev;
+        size_type a_rest = length, b_rest = x.length; // 还没有搬走的元素个数
+        size_type ai = 0, bi = 0; // 在a、b节点里的下标, 之前的元素已经搬走
+        reset_head();
+        x.reset_head();
+        base_type *spare = 0; // 搬空的输入节点, 通过next串起来
+        node_type *out = 0;
+        try{
+            while(a != &head && b != &x.head){
+                const bool from_b = comp(as_node(b)->data()[bi], as_node(a)->data()[ai]);
+                if(out == 0 || out->count == K){
+                    if(spare){
+                        out = as_node(spare);
+                        spare = spare->next;
+                        out->count = 0;
+                    }
+                    else
+                        out = new_node();
+                    link_before(&head, out);
+                }
+                base_type *&src = from_b ? b : a;
+                size_type &i = from_b ? bi : ai;
+                node_type *s = as_node(src);
+                relocate(out->data() + out->count, s->data() + i, 1);
+                ++out->count;
+                ++length;
+                --(from_b ? b_rest : a_rest);
+                if(++i == s->count){
+                    src = s->next;
+                    i = 0;
+                    s->next = spare;
+                    spare = s;
+                }
+            }
+        }
+        catch(...){
+            length += link_rest(a, ai, a_last, a_rest, &head);
+            x.length = x.link_rest(b, bi, b_last, b_rest, &x.head);
+            delete_nodes(spare);
+            throw;
+        }
+        length += link_rest(a, ai, a_last, a_rest, &head);
+        length += link_rest(b, bi, b_last, b_rest, &head);
+        delete_nodes(spare);
+    }
+
+    /* 把元素搬到一块连续的缓冲区里用TinySTL::stable_sort排序(和list::sort一样是稳定的), 再按顺序搬回原来的节点, 节点结构不变
+     * 比较时抛出异常的话, 元素按缓冲区里的顺序搬回去, 不会丢失
+     */
+    template <class T, size_t K, class Alloc>
+    template <class Compare>
+    void unrolled_list<T, K, Alloc>::sort_elements(Compare comp){
+        if(length < 2)
+            return;
+        T *buffer = Alloc::allocate(length);
+        size_type n = 0;
+        for (base_type *x = head.next; x != &head; x = x->next){
+            relocate(buffer + n, as_node(x)->data(), as_node(x)->count);
+            n += as_node(x)->count;
+        }
+        try{
+            TinySTL::stable_sort(buffer, buffer + n, comp);
+        }
+        catch(...){
+            put_back(buffer);
+            throw;
+        }
+        put_back(buffer);
+    }
+
+    // 反转节点的顺序和每个节点里元素的顺序
+    template <class T, size_t K, class Alloc>
+    void unrolled_list<T, K, Alloc>::reverse(){
+        base_type *x = &head;
+        do{
+            std::swap(x->prev, x->next);
+            x = x->prev;
+            if(x != &head){
+                T *data = as_node(x)->data();
+                for (size_type i = 0, j = as_node(x)->count - 1; i < j; ++i, --j)
+                    std::swap(data[i], data[j]);
+            }
+        } while(x != &head);
+    }
+
+    template <class T, size_t K, class Alloc>
+    bool operator==(const unrolled_list<T, K, Alloc> &a, const unrolled_list<T, K, Alloc> &b){
+        if(a.size() != b.size())
+            return false;
+        typename unrolled_list<T, K, Alloc>::const_iterator i = a.begin(), j = b.begin();
+        for (; i != a.end(); ++i, ++j)
+            if(!(*i == *j))
+                return false;
+        return true;
+    }
+    template <class T, size_t K, class Alloc>
+    bool operator!=(const unrolled_list<T, K, Alloc> &a, const unrolled_list<T, K, Alloc> &b){
+        return !(a == b);
+    }
+
+    template <class T, size_t K, class Alloc>
+    void swap(unrolled_list<T, K, Alloc> &a, unrolled_list<T, K, Alloc> &b){
+        a.swap(b);
+    }
+}
+
+#endif
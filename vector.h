@@ -1,12 +1,31 @@
 #ifndef _VECTOR_H_
 #define _VECTOR_H_
 
+#include <cstring>
+#include <utility>
 #include "allocator.h"
 #include "uninitialized.h"
 #include "algorithm.h"
 namespace TinySTL{
+    // 执行策略定义在parallel.h, 这里只需要声明; 使用vector(par, n)时包含parallel.h即可, 普通的vector不会引入线程池
+    struct parallel_policy;
+
+    // 配置器是否提供try_expand和reallocate(见allocator.h), 只提供allocate/deallocate的配置器也可以用于vector
+    template <class Alloc, class T>
+    struct _alloc_can_expand{
+        template <class A>
+        static _true_type test(decltype(std::declval<A &>().try_expand((T *)0, 0, 0)) *,
+                               decltype(std::declval<A &>().reallocate((T *)0, 0, 0)) *);
+        template <class A>
+        static _false_type test(...);
+        typedef decltype(test<Alloc>(0, 0)) type;
+    };
+
+    // vector以protected方式继承配置器: 无状态的配置器(如allocator<T>)不占空间,
+    // 有状态的配置器(如arena_allocator<T>)则作为vector的一部分保存下来
+    // 下面的data_alloctor::allocate(n)对静态成员函数和普通成员函数都适用
     template<class T, class Alloc = allocator<T>>
-    class vector{
+    class vector : protected Alloc{
     public:
         // vector的嵌套型别定义
         typedef T           value_type;
@@ -15,6 +34,7 @@ namespace TinySTL{
         typedef T&          reference;
         typedef size_t      size_type;
         typedef ptrdiff_t   difference_type;
+        typedef Alloc       allocator_type;
     protected:
         iterator start; // 表示目前使用的空间的头
         iterator finish; // 表示目前使用的空间的尾
@@ -27,7 +47,7 @@ namespace TinySTL{
         }
         iterator allocate_and_fill(size_type n, const T& value){
             iterator result = data_alloctor::allocate(n); // 分配n个空间
-            uninitialized_fill_n(result, n, value); // 全局函数,给区间[result, result+n)填充n个值为value的元素
+            TinySTL::uninitialized_fill_n(result, n, value); // 全局函数,给区间[result, result+n)填充n个值为value的元素
             return result;
         }
         // 用于初始化填充vector
@@ -36,6 +56,40 @@ namespace TinySTL{
             finish = start + n;
             end_of_storage = finish;
         }
+        // 把容量扩大到len, 成功返回true, pos会被调整到新空间中的对应位置
+        // 可平凡搬移的型别可以逐字节搬移: 先试着原地扩展, 不行再交给reallocate(大区块走realloc),
+        // 都不需要逐个移动元素, 也不需要析构旧空间中的元素
+        bool expand_storage(iterator &position, size_type len, _true_type){
+            const size_type offset = position - start;
+            if(start == 0)
+                start = finish = data_alloctor::allocate(len);
+            else
+                resize_storage(len, typename _alloc_can_expand<Alloc, T>::type());
+            end_of_storage = start + len;
+            position = start + offset;
+            return true;
+        }
+        void resize_storage(size_type len, _true_type){
+            const size_type old_capacity = capacity();
+            if(!data_alloctor::try_expand(start, old_capacity, len)){
+                iterator new_start = data_alloctor::reallocate(start, old_capacity, len);
+                finish = new_start + (finish - start);
+                start = new_start;
+            }
+        }
+        // 配置器没有try_expand/reallocate: 申请新空间, 按字节搬过去, 再释放旧空间
+        void resize_storage(size_type len, _false_type){
+            const size_type old_size = size();
+            iterator new_start = data_alloctor::allocate(len);
+            memcpy((void *)new_start, (const void *)start, old_size * sizeof(T));
+            deallocate();
+            start = new_start;
+            finish = new_start + old_size;
+        }
+        // 不能平凡搬移, 只能由调用者申请新空间再逐个移动或拷贝
+        bool expand_storage(iterator &, size_type, _false_type){
+            return false;
+        }
     public:
         iterator begin() { return start; }
         iterator end() { return finish; }
@@ -47,8 +101,53 @@ namespace TinySTL{
         reference back() const { return *(finish - 1); }
 
         vector() : start(nullptr), finish(nullptr), end_of_storage(nullptr){}
-        vector(size_type n, const T &value) { fill_initialize(n, value); }
-        explicit vector(size_type n) { fill_initialize(n, T()); }
+        explicit vector(const Alloc &alloc) : Alloc(alloc), start(nullptr), finish(nullptr), end_of_storage(nullptr){}
+        vector(size_type n, const T &value, const Alloc &alloc = Alloc()) : Alloc(alloc) { fill_initialize(n, value); }
+        explicit vector(size_type n, const Alloc &alloc = Alloc()) : Alloc(alloc) { fill_initialize(n, T()); }
+        // 由线程池的各个线程分别构造自己那一段元素, 页面在之后用par处理它们的线程上第一次被写入(first touch)
+        vector(const parallel_policy &policy, size_type n, const T &value, const Alloc &alloc = Alloc()) : Alloc(alloc){
+            start = data_alloctor::allocate(n);
+            try{
+                // 不加限定, 实例化时通过参数找到parallel.h里带策略的版本
+                uninitialized_fill_n(policy, start, n, value);
+            }
+            catch(...){
+                data_alloctor::deallocate(start, n);
+                throw;
+            }
+            finish = end_of_storage = start + n;
+        }
+        vector(const parallel_policy &policy, size_type n, const Alloc &alloc = Alloc()) : vector(policy, n, T(), alloc) {}
+        vector(const vector &x) : Alloc(x.get_allocator()){
+            start = data_alloctor::allocate(x.size());
+            finish = TinySTL::uninitialized_copy(x.start, x.finish, start);
+            end_of_storage = finish;
+        }
+        // 移动构造只是接管x的空间, 不会移动或复制任何元素
+        vector(vector &&x) noexcept : Alloc(x.get_allocator()), start(x.start), finish(x.finish), end_of_storage(x.end_of_storage){
+            x.start = x.finish = x.end_of_storage = nullptr;
+        }
+        vector &operator=(const vector &x){
+            if(this != &x){
+                vector tmp(x);
+                swap(tmp);
+            }
+            return *this;
+        }
+        vector &operator=(vector &&x) noexcept{
+            vector tmp(std::move(x)); // 原来的元素随tmp一起析构
+            swap(tmp);
+            return *this;
+        }
+
+        allocator_type get_allocator() const { return *this; }
+
+        void swap(vector &x){
+            std::swap(static_cast<Alloc &>(*this), static_cast<Alloc &>(x));
+            std::swap(start, x.start);
+            std::swap(finish, x.finish);
+            std::swap(end_of_storage, x.end_of_storage);
+        }
 
         // vector的析构函数,以下函数要两个结合使用才能正确析构类
         ~vector(){
@@ -56,9 +155,41 @@ namespace TinySTL{
             deallocate(); // deallocate只负责释放申请的空间,而不负责析构对象
         }
 
-        void insert_aux(iterator position, const T &x); // 在pos位置上插入值x
+        template <class... Args>
+        void insert_aux(iterator position, Args&&... args); // 在pos位置上用args构造一个元素
+        template <class... Args>
+        void realloc_insert(iterator position, _true_type, Args&&... args); // 没有备用空间时在pos位置上用args构造一个元素
+        template <class... Args>
+        void realloc_insert(iterator position, _false_type, Args&&... args);
         void insert(iterator position, size_type n, const T &x); // 从位置pos开始插入n个初值为x的元素
-        void insert(iterator position, const T &x);// 在位置pos上插入元素x
+        iterator insert(iterator position, const T &x);// 在位置pos上插入元素x
+        iterator insert(iterator position, T &&x) { return emplace(position, std::move(x)); }
+
+        // 在位置pos上直接用args构造一个元素, 返回指向它的迭代器
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args){
+            const size_type offset = position - start;
+            if(finish != end_of_storage && position == end()){
+                construct(finish, std::forward<Args>(args)...);
+                ++finish;
+            }
+            else{
+                insert_aux(position, std::forward<Args>(args)...);
+            }
+            return start + offset;
+        }
+
+        // 在尾部直接用args构造一个元素, 省掉一次临时对象的复制或移动
+        template <class... Args>
+        void emplace_back(Args&&... args){
+            if(finish != end_of_storage){
+                construct(finish, std::forward<Args>(args)...);
+                ++finish;
+            }
+            else{
+                insert_aux(end(), std::forward<Args>(args)...);
+            }
+        }
 
         void push_back(const T& x){
             if(finish != end_of_storage){ // 查看之前分配的空间是否已经用完了
@@ -69,6 +200,7 @@ namespace TinySTL{
                 insert_aux(end(), x);
             }
         }
+        void push_back(T &&x) { emplace_back(std::move(x)); }
 
         void pop_back(){
             --finish; // 由于左闭右开原则,先--
@@ -78,7 +210,7 @@ namespace TinySTL{
         // 删除位置pos上的某个元素
         iterator erase(iterator position){
             if(position + 1 != end())
-                copy(position + 1, end(), position);// copy是全局函数,在algorithm头文件里
+                TinySTL::move(position + 1, end(), position);// move是全局函数,在algorithm头文件里
             --finish;
             destory(finish);
             return position;
@@ -86,7 +218,9 @@ namespace TinySTL{
 
         // 删除区间[first, last)位置上的元素
         iterator erase(iterator first, iterator last){
-            iterator i = copy(last, finish, first); // copy全局函数,把区间[last, finish)内的元素移动到以first为起始位置的空间上
+            if(first == last) // 空区间: 否则后面的元素都要自己移动给自己, 有的型别(如std::string)自移动后会变空
+                return first;
+            iterator i = TinySTL::move(last, finish, first); // move全局函数,把区间[last, finish)内的元素移动到以first为起始位置的空间上
             destory(i, finish); //移动完之后释放后面区间的对象
             finish = finish - (last - first); // 更新finish的值
             return first;
@@ -102,61 +236,115 @@ namespace TinySTL{
         void clear() { erase(begin(), end()); }
     };
 
+    // vector只保存三个指针和配置器, 按字节搬移到新地址之后仍然有效, 因此vector<vector<T> >扩容时可以整块搬移
+    template <class T, class Alloc>
+    struct _relocatable_traits<vector<T, Alloc> >{
+        typedef _true_type is_relocatable_type;
+    };
+
     // **********************以下实现insert和insert_aux函数**********************
-    // 在pos位置上插入值x
+    // 在pos位置上用args构造一个元素
     template <class T, class Alloc>
-    void vector<T, Alloc>::insert_aux(iterator position, const T&x){
+    template <class... Args>
+    void vector<T, Alloc>::insert_aux(iterator position, Args&&... args){
+        typedef typename _type_traits<T>::is_relocatable_type is_relocatable;
         if(finish != end_of_storage){ // 原vector还有空间，不需要再申请
-            construct(finish, *(finish - 1)); // 先再finish位置构造一个，并且把初值设置为最后一个元素
+            if(position == finish){
+                construct(finish, std::forward<Args>(args)...);
+                ++finish;
+                return;
+            }
+            T x_copy(std::forward<Args>(args)...); // args可能引用vector里的元素, 下面搬移元素时会被改掉, 先构造出来
+            construct(finish, std::move(*(finish - 1))); // 先再finish位置构造一个，并且把初值设置为最后一个元素
             ++finish; // 调整vector的size
-            copy_backward(position, finish - 2, finish - 1);
-            *position = x;
+            TinySTL::move_backward(position, finish - 2, finish - 1);
+            *position = std::move(x_copy);
         }
         else{
-            const size_type old_size = size();
-            // 如果原大小为0,则配置一个元素,如果不为0,则配置原来大小的2倍
-            const size_type len = old_size == 0 ? 1 : 2 * old_size;
-
-            iterator new_start = data_alloctor::allocate(len); // 申请空间
-            iterator new_finish = new_start;
+            realloc_insert(position, is_relocatable(), std::forward<Args>(args)...);
+        }
+    }
 
-            new_finish = uninitialized_copy(start, position, new_start); // 移动元素到新的空间
-            construct(new_finish, x); // 构造插入的元素
-            ++new_finish;
-            // 将安插点之后的元素也拷贝过来,因为本函数也可能会被insert(p, x)调用
-            new_finish = uninitialized_copy(position, finish, new_finish);
+    // 没有备用空间时在pos位置上用args构造一个元素, 可平凡搬移的型别的版本
+    // 先试着原地扩展或realloc, 成功之后就变成了有备用空间的情况
+    template <class T, class Alloc>
+    template <class... Args>
+    void vector<T, Alloc>::realloc_insert(iterator position, _true_type, Args&&... args){
+        const size_type old_size = size();
+        const size_type len = old_size == 0 ? 1 : 2 * old_size;
+        T x_copy(std::forward<Args>(args)...); // 旧空间可能被释放, 先构造出来
+        expand_storage(position, len, _true_type());
+        insert_aux(position, std::move(x_copy));
+    }
 
-            // 析构掉原有数据,释放空间
-            destory(begin(), end());
-            deallocate();
+    // 没有备用空间时在pos位置上用args构造一个元素, 不能平凡搬移的型别的版本
+    // 原有元素的移动构造不会抛出异常时逐个移动到新空间, 否则逐个复制, 以保证抛出异常时原vector不受影响
+    template <class T, class Alloc>
+    template <class... Args>
+    void vector<T, Alloc>::realloc_insert(iterator position, _false_type, Args&&... args){
+        const size_type old_size = size();
+        // 如果原大小为0,则配置一个元素,如果不为0,则配置原来大小的2倍
+        const size_type len = old_size == 0 ? 1 : 2 * old_size;
 
-            // 调整新的迭代器
-            start = new_start;
-            finish = new_finish;
-            end_of_storage = start + len;
+        iterator new_start = data_alloctor::allocate(len); // 申请空间
+        iterator new_position = new_start + (position - start);
+        iterator new_finish = new_start;
+        int constructed = 0; // 记录已经完成到哪一步, 抛出异常时据此清理新空间
+        try{
+            // 先构造插入的元素, 因为args可能引用旧空间里的元素
+            construct(new_position, std::forward<Args>(args)...);
+            ++constructed;
+            new_finish = TinySTL::uninitialized_move_if_noexcept(start, position, new_start); // 移动元素到新的空间
+            ++constructed;
+            // 将安插点之后的元素也移动过来,因为本函数也可能会被insert(p, x)调用
+            new_finish = TinySTL::uninitialized_move_if_noexcept(position, finish, new_position + 1);
         }
+        catch(...){
+            if(constructed >= 2)
+                destory(new_start, new_position);
+            if(constructed >= 1)
+                destory(new_position);
+            data_alloctor::deallocate(new_start, len);
+            throw;
+        }
+
+        // 析构掉原有数据,释放空间
+        destory(begin(), end());
+        deallocate();
+
+        // 调整新的迭代器
+        start = new_start;
+        finish = new_finish;
+        end_of_storage = start + len;
     }
 
     // 从位置pos开始插入n个初值为x的元素
     template <class T, class Alloc>
-    void vector<T, Alloc>::insert(iterator position, size_type n, const T& x){
+    void vector<T, Alloc>::insert(iterator position, size_type n, const T& value){
+        typedef typename _type_traits<T>::is_relocatable_type is_relocatable;
         if(n != 0){
+            T x = value; // value可能就是vector里的元素, 搬移或重新申请空间之后会失效, 先存一份
+            // 备用空间不够时, 可平凡搬移的型别先试着原地扩展或realloc到新长度
+            if(size_type(end_of_storage - finish) < n){
+                const size_type old_size = size();
+                expand_storage(position, old_size + max(old_size, n), is_relocatable());
+            }
             if(size_type(end_of_storage - finish) >= n){ // 备用空间大于新增元素个数
                 const size_type elems_after = finish - position; // 计算插入点之后现有的元素
                 iterator old_finish = finish;
                 if(elems_after > n){ // 插入点之后的元素大于要插入的元素个数
-                    uninitialized_copy(finish - n, finish, finish);
+                    TinySTL::uninitialized_move(finish - n, finish, finish);
                     finish += n;
-                    copy_backward(position, old_finish - n, old_finish);
-                    fill(position, position + n, x); // fill是algorithm里的函数
+                    TinySTL::move_backward(position, old_finish - n, old_finish);
+                    TinySTL::fill(position, position + n, x); // fill是algorithm里的函数
                 }
                 else{
                     // 插入点之后的元素个数小于要插入的元素个数
-                    uninitialized_fill_n(finish, n - elems_after, x);
+                    TinySTL::uninitialized_fill_n(finish, n - elems_after, x);
                     finish += n - elems_after;
-                    uninitialized_copy(position, old_finish, finish);
+                    TinySTL::uninitialized_move(position, old_finish, finish);
                     finish += elems_after;
-                    fill(position, old_finish, x); // fill是algorithm里的函数
+                    TinySTL::fill(position, old_finish, x); // fill是algorithm里的函数
                 }
             }
             else{
@@ -168,12 +356,12 @@ namespace TinySTL{
                 // 配置新空间
                 iterator new_start = data_alloctor::allocate(len);
                 iterator new_finish = new_start;
-                // 先将插入点之前的元素复制过来
-                new_finish = uninitialized_copy(start, position, new_start);
+                // 先将插入点之前的元素移动过来(移动构造可能抛出异常时复制)
+                new_finish = TinySTL::uninitialized_move_if_noexcept(start, position, new_start);
                 // 再在插入点插入元素
-                new_finish = uninitialized_fill_n(new_finish, n, x);
-                // 再把插入点之后的元素复制过来
-                new_finish = uninitialized_copy(position, finish, new_finish);
+                new_finish = TinySTL::uninitialized_fill_n(new_finish, n, x);
+                // 再把插入点之后的元素移动过来
+                new_finish = TinySTL::uninitialized_move_if_noexcept(position, finish, new_finish);
 
                 // 析构并释放原vector
                 destory(begin(), end());
@@ -182,15 +370,16 @@ namespace TinySTL{
                 // 以下调整新vector的标记
                 start = new_start;
                 finish = new_finish;
-                end_of_storage = finish + len;
+                end_of_storage = start + len;
             }
 
         }
     }
 
-    // 在位置pos上插入元素x
+    // 在位置pos上插入元素x, 返回指向新元素的迭代器
     template <class T,class Alloc>
-    void vector<T, Alloc>::insert(iterator position, const T &x){
+    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(iterator position, const T &x){
+        const size_type offset = position - start;
         // 如果要插入的元素在末尾
         if(finish != end_of_storage && position == end()){
             construct(end(), x);
@@ -199,6 +388,7 @@ namespace TinySTL{
         else{
             insert_aux(position, x); // 要插入的元素在中间位置,调用insert_aux函数进行插入
         }
+        return start + offset;
     }
 }
 #endif
\ No newline at end of file